@@ -51,6 +51,20 @@ const API = {
     return response.json();
   },
 
+  /**
+   * Subscribe to state events pushed by the device
+   * @param {Object} handlers - Event name -> callback receiving the parsed data
+   * @returns {EventSource} Event stream (reconnects by itself)
+   */
+  subscribe(handlers) {
+    // LED frames are only streamed to pages that draw them
+    const source = new EventSource(handlers.frame ? '/events?frames=1' : '/events');
+    Object.entries(handlers).forEach(([event, callback]) => {
+      source.addEventListener(event, e => callback(JSON.parse(e.data)));
+    });
+    return source;
+  },
+
   /**
    * POST with confirmation dialog
    * @param {string} message - Confirmation message
@@ -4,10 +4,22 @@
 #include <WiFiClientSecure.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
+#include "retry_backoff.h"
+#include "json_writer.h"
+#include "firmware_download.h"
 
 // Forward declaration to avoid circular dependency
 class LEDController;
 
+enum class UpdateStage {
+    DOWNLOADING,
+    INSTALLED,      // Restart follows immediately
+    FAILED
+};
+
+// Called during performUpdate(), which blocks the main loop until done
+typedef void (*UpdateProgressCallback)(UpdateStage stage, size_t written, size_t total);
+
 class AutoUpdater {
 public:
     AutoUpdater();
@@ -18,22 +30,51 @@ public:
     String getLatestVersion() const { return latestVersion; }
     String getDownloadUrl() const { return downloadUrl; }
     bool performUpdate();
+    void setProgressCallback(UpdateProgressCallback callback);
+
+    // Members of an object opened by the caller
+    void writeStatusJSON(JsonWriter& json);
 
 private:
     String githubUpdateUrl;
     String currentVersion;
     unsigned long updateCheckInterval;
-    unsigned long lastUpdateCheck;
+    RetryBackoff checkBackoff;     // Interval after a check, backoff after a failed one
     LEDController* ledController;
+    UpdateProgressCallback progressCallback;
+    int lastReportedPercent;
+
+    // Heap a check takes: TLS handshake plus the filtered release document
+    size_t lastCheckHeap;
+    size_t peakCheckHeap;
+    unsigned long lastParseMs;
+
+    // Pause GitHub asked for with a rate limit or Retry-After
+    unsigned long holdStart;
+    unsigned long holdMs;
+
+    // Since boot
+    uint32_t checks;
+    uint32_t notModified;       // Answered 304 against the stored ETag
+    uint32_t releaseFetches;
+    uint32_t rateLimited;
+    int rateRemaining;          // Requests left in GitHub's window, -1 unknown
     
     // Update status
     bool updateAvailable;
     String latestVersion;
     String downloadUrl;
+    String checksumUrl;         // sha256sum listing of the release, empty if none
+    FirmwareDownload firmwareDownload;
     
     String compareVersions(String current, String latest);
     bool downloadAndInstallUpdate(String url);
     void showUpdateSuccessFeedback();
+    void reportProgress(UpdateStage stage, size_t written, size_t total);
+    void recordCheckHeap(size_t freeBefore, size_t minFreeBefore);
+    void applyRateLimit(HTTPClient& http);
+    bool isRateLimited() const;
+    unsigned long jitteredInterval() const;
 };
 
 #endif // AUTO_UPDATER_H
@@ -2,8 +2,8 @@
 #define BIRTHDAY_MANAGER_H
 
 #include <Arduino.h>
-#include <Preferences.h>
 #include <vector>
+#include "json_writer.h"
 
 class BirthdayManager {
 public:
@@ -33,13 +33,12 @@ public:
     uint8_t getBirthdayCount() const;
 
     // For web UI
-    String getBirthdaysJSON() const;
+    void writeBirthdaysJSON(JsonWriter& json) const;
 
     // Save settings
     void save();
 
 private:
-    Preferences preferences;
     std::vector<uint16_t> birthdays;  // Stored as MMDD (e.g., 115 for Jan 15, 1225 for Dec 25)
     DisplayMode displayMode;
 
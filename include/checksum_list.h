@@ -0,0 +1,19 @@
+#ifndef CHECKSUM_LIST_H
+#define CHECKSUM_LIST_H
+
+#include <Arduino.h>
+
+// sha256sum listings, like the checksums.txt published with a release:
+// "<64 hex digits>  <name>" per line, '*' before the name in binary mode.
+class ChecksumList {
+public:
+    static const size_t DIGEST_SIZE = 32;
+
+    // False if no well formed line names fileName
+    static bool find(const String& listing, const String& fileName, uint8_t digest[DIGEST_SIZE]);
+
+private:
+    static bool parseDigest(const char* hex, uint8_t digest[DIGEST_SIZE]);
+};
+
+#endif // CHECKSUM_LIST_H
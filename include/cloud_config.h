@@ -24,11 +24,16 @@ struct CloudSettings {
     }
 };
 
+// Cloud settings are read from NVS once in begin() and kept in RAM, so the
+// checks CloudManager runs every loop never touch flash. Changes update the
+// copy and are written through to NVS right away.
 class CloudConfig {
 public:
+    CloudConfig();
+
     void begin();
 
-    // Load settings from NVS
+    // Copy of the settings in RAM
     CloudSettings load();
 
     // Save settings to NVS
@@ -38,10 +43,10 @@ public:
     void clear();
 
     // Check if cloud is configured
-    bool isConfigured();
+    bool isConfigured() const { return configured; }
 
     // Check if device is paired
-    bool isPaired();
+    bool isPaired() const { return settings.isPaired; }
 
     // Save individual settings
     void setMqttCredentials(const char* url, const char* username, const char* password);
@@ -49,9 +54,24 @@ public:
     void setPaired(bool paired, const char* ownerId = nullptr);
     void setCloudEnabled(bool enabled);
 
+    // Namespace opens during the last full minute, and since boot
+    uint32_t getNvsAccessesPerMinute();
+    uint32_t getNvsAccesses() const { return nvsAccesses; }
+
 private:
     Preferences preferences;
     static const char* NAMESPACE;
+
+    CloudSettings settings;
+    bool configured;    // MQTT URL and username are set
+
+    uint32_t nvsAccesses;
+    uint32_t windowAccesses;
+    uint32_t lastMinuteAccesses;
+    unsigned long windowStart;
+
+    bool open(bool readOnly);
+    void updateConfigured();
 };
 
 #endif // CLOUD_CONFIG_H
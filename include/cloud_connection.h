@@ -0,0 +1,74 @@
+#ifndef CLOUD_CONNECTION_H
+#define CLOUD_CONNECTION_H
+
+#include <Arduino.h>
+#include "retry_backoff.h"
+
+// Steps of a connection attempt; loop() advances one step at a time and
+// never waits for the network, every step has its own timeout
+enum class ConnectStep {
+    IDLE,               // Waiting for the next attempt
+    WS_CONNECTING,      // WebSocket (TLS) handshake in progress
+    WS_SETTLING,        // WebSocket up, short pause before the MQTT handshake
+    MQTT_CONNECTING,    // CONNECT sent, waiting for CONNACK
+    SUBSCRIBING,        // Subscribe to commands and publish the first status
+    ONLINE
+};
+
+// The steps of the cloud's MQTT over WebSocket connection, apart from the
+// libraries that carry it. CloudManager is the transport on the device; the
+// host tests drive the same steps with a scripted one.
+class CloudConnection {
+public:
+    class Transport {
+    public:
+        virtual ~Transport() {}
+
+        virtual bool isNetworkUp() = 0;
+        // Starts the WebSocket (TLS) handshake, false if it cannot start now
+        virtual bool openSocket() = 0;
+        // Services the WebSocket, true while it is up
+        virtual bool pollSocket() = 0;
+        virtual bool isSocketUp() = 0;
+        // The handshake is done, e.g. its TLS slot can go to someone else
+        virtual void socketOpened() = 0;
+        // Sends CONNECT; a CONNACK may arrive right away or in a later pollMqtt()
+        virtual void sendConnect() = 0;
+        // Services MQTT, true while it is connected
+        virtual bool pollMqtt() = 0;
+        virtual bool subscribe() = 0;
+        // Connected: publish the first status
+        virtual void online() = 0;
+        // Regular work while connected, like publishing changes
+        virtual void serviceOnline() = 0;
+        // Closes MQTT and the WebSocket; reason is nullptr when asked to disconnect,
+        // failed is set when an attempt failed rather than a connection ending
+        virtual void closed(const char* reason, bool failed) = 0;
+    };
+
+    static const unsigned long WS_CONNECT_TIMEOUT_MS = 10000;
+    static const unsigned long WS_SETTLE_MS = 500;      // Pause before the MQTT handshake
+    static const unsigned long MQTT_CONNECT_TIMEOUT_MS = 5000;
+
+    CloudConnection(Transport& transport, RetryBackoff& backoff);
+
+    // Advances the current step, starts an attempt once the backoff is due
+    void loop();
+    // Starts an attempt now, false if it could not even start
+    bool connect();
+    void disconnect();
+
+    ConnectStep getStep() const { return step; }
+    bool isOnline() const { return step == ConnectStep::ONLINE; }
+
+private:
+    Transport& transport;
+    RetryBackoff& backoff;
+    ConnectStep step;
+    unsigned long stepStartTime;
+
+    void enterStep(ConnectStep next);
+    void fail(const char* reason);
+};
+
+#endif // CLOUD_CONNECTION_H
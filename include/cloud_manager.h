@@ -9,6 +9,11 @@
 #include <MQTTPubSubClient.h>
 #include "cloud_config.h"
 #include "device_identity.h"
+#include "json_writer.h"
+#include "retry_backoff.h"
+#include "cloud_connection.h"
+#include "device_shadow.h"
+#include "fixed_pool_allocator.h"
 
 // Forward declarations
 class LEDController;
@@ -22,6 +27,13 @@ enum class CloudState {
     ERROR
 };
 
+// Wire format of status messages; commands are accepted in either. Every
+// connection starts with JSON until the backend asks for MessagePack.
+enum class PayloadEncoding {
+    JSON,
+    MSGPACK
+};
+
 // Command types from cloud
 enum class CloudCommandType {
     POWER,
@@ -35,19 +47,22 @@ enum class CloudCommandType {
 // Command callback signature
 typedef void (*CloudCommandCallback)(CloudCommandType type, JsonObject& payload);
 
-class CloudManager {
+// Carries the cloud connection over the WebSocket and MQTT libraries
+class CloudManager : private CloudConnection::Transport {
 public:
     CloudManager();
 
     // Initialize with dependencies
-    void begin(LEDController* ledController = nullptr);
+    void begin(LEDController* ledController, const char* firmwareVersion);
 
     // Main loop - must be called regularly
     void loop();
 
-    // Connection management
+    // Connection management; connect() only starts an attempt, loop() carries it on
     bool connect();
     void disconnect();
+    // Disconnects and forgets the stored credentials
+    void clearCredentials();
     bool isConnected();
     CloudState getState();
 
@@ -58,38 +73,57 @@ public:
     String getPairingCode();
     int getPairingTimeRemaining(); // seconds
 
-    // Status publishing
+    // Full shadow state plus telemetry; changes alone go out from loop()
     void publishStatus();
 
     // Command handling
     void setCommandCallback(CloudCommandCallback callback);
+    // Commands from any transport (JSON or MessagePack), e.g. the LAN broker;
+    // all of them go through the same version check and callback
+    void handleMessage(const char* payload, size_t size);
+    void handleCommand(JsonObject& command);
+
+    // Reported state, sampled from the LEDs once a second even while offline
+    const DeviceShadow& getShadow() const { return shadow; }
 
     // Get status for web interface
-    String getStatusJSON();
+    void writeStatusJSON(JsonWriter& json);
 
 private:
     CloudConfig config;
     LEDController* ledController;
     CloudState state;
 
-    // HTTP client for provisioning
+    // HTTP client for provisioning; registration and the polls share one
+    // keep-alive TLS session, so only the first request pays a handshake
     WiFiClientSecure wifiClient;
+    HTTPClient apiHttp;
+    bool apiHandshake;
 
     // MQTT over WebSocket (512 byte buffer for larger messages)
     WebSocketsClient wsClient;
     arduino::mqtt::PubSubClient<512> mqtt;
-    bool mqttConnected;
-    unsigned long lastReconnectAttempt;
-    unsigned long lastStatusPublish;
-    int consecutiveFailures;
-    bool inLongBackoff;
+    RetryBackoff reconnectBackoff;
+    CloudConnection connection;
+    DeviceShadow shadow;
+    PayloadEncoding encoding;
+    size_t lastPublishSize;
+    unsigned long lastParseUs;
+
+    // Commands are parsed without touching the heap; ArduinoJson's first
+    // slot pool alone takes about 1 KB on a 32-bit target
+    static const size_t COMMAND_POOL_SIZE = 3072;
+    uint8_t commandPoolBuffer[COMMAND_POOL_SIZE];
+    FixedPoolAllocator commandPool;
+    unsigned long lastShadowSample;
+    unsigned long lastHeartbeat;
 
     // Pairing state
     bool pairingActive;
     String pairingCode;
     String pairingSessionId;
     unsigned long pairingStartTime;
-    unsigned long lastPairingPoll;
+    RetryBackoff pairingBackoff;
     String currentApiUrl;
 
     // Command callback
@@ -98,9 +132,29 @@ private:
     // Internal methods
     bool registerForPairing();
     bool pollPairingStatus();
+    bool beginApiRequest(const String& url);
+    void endApiRequest(bool ok);
+    void closeApiSession();
     void handleCredentialsReceived(const char* mqttUrl, const char* username, const char* password);
-    void handleCommand(JsonObject& command);
+    void applyDesired(JsonObject desired);
+    void sampleShadow();
+    void publishShadowChanges();
+    void publishHeartbeat();
+    bool publishDocument(JsonDocument& doc);
     void setupMqttCallbacks();
+
+    // CloudConnection::Transport
+    bool isNetworkUp() override;
+    bool openSocket() override;
+    bool pollSocket() override;
+    bool isSocketUp() override;
+    void socketOpened() override;
+    void sendConnect() override;
+    bool pollMqtt() override;
+    bool subscribe() override;
+    void online() override;
+    void serviceOnline() override;
+    void closed(const char* reason, bool failed) override;
 };
 
 #endif // CLOUD_MANAGER_H
@@ -0,0 +1,66 @@
+#ifndef COMPRESSED_IMAGE_DECODER_H
+#define COMPRESSED_IMAGE_DECODER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// Decoder for firmware images packed by scripts/compress_firmware.py: a
+// 12 byte header followed by a heatshrink (LZSS) stream. Input may arrive
+// in pieces of any size, so a download can stop and resume anywhere;
+// decoded bytes are handed on in pieces of at most OUTPUT_SIZE. Besides a
+// few bytes of state, memory is the window the image was packed with
+// (4 KB by default), allocated when the header arrives.
+class CompressedImageDecoder {
+public:
+    static const size_t HEADER_SIZE = 12;
+    static const uint8_t MAX_WINDOW_BITS = 13;
+    static const size_t OUTPUT_SIZE = 256;
+
+    // Returns false to stop decoding, e.g. when the flash write failed
+    typedef std::function<bool(const uint8_t* data, size_t length)> Sink;
+
+    CompressedImageDecoder();
+    ~CompressedImageDecoder();
+
+    // Forgets the current image and frees the window
+    void reset();
+    // False on a bad header, on data past the end of the image, or when the sink stops
+    bool feed(const uint8_t* data, size_t length, const Sink& sink);
+
+    bool hasHeader() const { return window != nullptr; }
+    size_t getImageSize() const { return imageSize; }
+    size_t getDecoded() const { return decoded; }
+    bool isComplete() const { return hasHeader() && decoded == imageSize; }
+
+private:
+    enum class Field : uint8_t {
+        TAG,        // 1 bit: literal or back-reference
+        LITERAL,    // 8 bits
+        INDEX,      // Window bits: distance - 1
+        COUNT       // Lookahead bits: length - 1
+    };
+
+    uint8_t header[HEADER_SIZE];
+    size_t headerLength;
+    uint8_t windowBits;
+    uint8_t lookaheadBits;
+    uint8_t* window;
+    uint16_t windowMask;
+    uint16_t windowPos;
+    size_t imageSize;
+    size_t decoded;
+
+    uint32_t bitBuffer;
+    uint8_t bitCount;
+    Field field;
+    uint16_t distance;
+
+    uint8_t output[OUTPUT_SIZE];
+    size_t outputLength;
+
+    bool parseHeader();
+    bool emit(uint8_t value, const Sink& sink);
+    bool flush(const Sink& sink);
+};
+
+#endif // COMPRESSED_IMAGE_DECODER_H
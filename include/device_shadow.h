@@ -0,0 +1,75 @@
+#ifndef DEVICE_SHADOW_H
+#define DEVICE_SHADOW_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// The clock's state as the cloud sees it. The reported half mirrors what the
+// clock shows; every published change bumps a version that survives restarts,
+// and only the fields that changed since the last publish are sent. The
+// desired half remembers the newest command version applied, so a command
+// that arrives late cannot undo a newer one.
+class DeviceShadow {
+public:
+    enum Field : uint8_t {
+        POWER = 0x01,
+        BRIGHTNESS = 0x02,
+        COLOR = 0x04,
+        PATTERN = 0x08,
+        FIRMWARE = 0x10,
+        DESIRED_VERSION = 0x20,
+        ALL_FIELDS = 0x3F
+    };
+
+    DeviceShadow();
+
+    // Restores the versions from the settings store
+    void begin(const char* firmwareVersion);
+
+    // Reported state; unchanged values are no-ops
+    void setPower(bool on);
+    void setBrightness(uint8_t brightness);
+    void setColor(uint8_t r, uint8_t g, uint8_t b);
+    void setPattern(const char* pattern);
+
+    bool hasChanges() const { return changed != 0; }
+    // Everything goes out with the next publish, e.g. after a reconnect
+    void markAllChanged() { changed = ALL_FIELDS; }
+
+    // Adds the version and the changed (or all) fields to doc and clears them.
+    // Returns false if there was nothing to report.
+    bool writeReported(JsonObject doc, bool full);
+
+    // False if version is not newer than the last desired state applied
+    bool acceptDesired(uint32_t version);
+
+    uint32_t getVersion() const { return version; }
+    uint32_t getDesiredVersion() const { return desiredVersion; }
+    // Counts every reported change in RAM, for other publishers of the state
+    uint32_t getRevision() const { return revision; }
+
+    bool getPower() const { return power; }
+    uint8_t getBrightness() const { return brightness; }
+    uint8_t getColorR() const { return colorR; }
+    uint8_t getColorG() const { return colorG; }
+    uint8_t getColorB() const { return colorB; }
+    const char* getPattern() const { return pattern; }
+
+private:
+    bool power;
+    uint8_t brightness;
+    uint8_t colorR;
+    uint8_t colorG;
+    uint8_t colorB;
+    const char* pattern;      // One of the static pattern names
+    const char* firmwareVersion;
+
+    uint8_t changed;          // Field bits not published yet
+    uint32_t version;
+    uint32_t desiredVersion;
+    uint32_t revision;
+
+    void markChanged(Field field) { changed |= field; revision++; }
+};
+
+#endif // DEVICE_SHADOW_H
@@ -0,0 +1,77 @@
+#ifndef FIRMWARE_DOWNLOAD_H
+#define FIRMWARE_DOWNLOAD_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <mbedtls/sha256.h>
+#include "json_writer.h"
+#include "checksum_list.h"
+#include "compressed_image_decoder.h"
+
+// Streams a firmware image into the OTA partition in small chunks and
+// hashes it on the way. A dropped connection continues with an HTTP Range
+// request from the last byte written - a few times within one run(), and
+// again on the next run() for the same URL, since the OTA partition stays
+// open in between. The image is only installed once its SHA-256 matches
+// the digest published with the release. Images ending in ".hs" are
+// compressed (see CompressedImageDecoder) and decoded on the way to flash;
+// ranges, progress and the digest then refer to the compressed file.
+class FirmwareDownload {
+public:
+    static const size_t DIGEST_SIZE = ChecksumList::DIGEST_SIZE;
+
+    enum class Result {
+        INSTALLED,      // Verified and marked for boot, restart to run it
+        INTERRUPTED,    // Connection kept failing, the next run() resumes
+        FAILED          // Nothing to resume, the next run() starts over
+    };
+
+    typedef std::function<void(size_t written, size_t total)> ProgressHandler;
+
+    FirmwareDownload();
+    ~FirmwareDownload();
+
+    // Without an expected digest (older releases) the image is installed unverified
+    Result run(const String& url, const uint8_t* expectedDigest, ProgressHandler progress);
+    // Drops an interrupted download and frees the OTA partition
+    void abort();
+
+    size_t getWritten() const { return written; }
+    size_t getTotal() const { return total; }
+
+    // Finds fileName in a sha256sum listing, like a release's checksums.txt
+    static bool fetchChecksum(const String& sumsUrl, const String& fileName, uint8_t digest[DIGEST_SIZE]);
+
+    // Members of an object opened by the caller
+    void writeStatusJSON(JsonWriter& json);
+
+private:
+    enum class Transfer {
+        COMPLETE,       // Every byte of the image is written
+        LOST,           // Connection dropped or stalled, resumable
+        ERROR           // Server or flash refused, not resumable
+    };
+
+    String url;
+    bool active;                // OTA partition open with written bytes of url
+    bool compressed;
+    size_t written;             // Bytes of the download, compressed or not
+    size_t total;
+    mbedtls_sha256_context sha;
+    CompressedImageDecoder decoder;
+
+    // Since boot
+    uint32_t requests;
+    uint32_t resumes;           // Requests that continued with a Range header
+    uint32_t restarts;          // Servers that answered a range with the whole image
+    uint32_t digestMismatches;
+    bool lastVerified;
+
+    void start(const String& newUrl);
+    Transfer transfer(ProgressHandler& progress);
+    Transfer receive(WiFiClient& stream, ProgressHandler& progress);
+    bool writeImage(uint8_t* data, size_t length);
+};
+
+#endif // FIRMWARE_DOWNLOAD_H
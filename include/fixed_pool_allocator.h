@@ -0,0 +1,33 @@
+#ifndef FIXED_POOL_ALLOCATOR_H
+#define FIXED_POOL_ALLOCATOR_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+// ArduinoJson allocator over a fixed buffer, for documents that are parsed,
+// used and dropped in one go (MQTT commands). Allocation just moves a
+// pointer, nothing is freed until reset(); a document that does not fit
+// fails to parse with NoMemory instead of growing the heap.
+class FixedPoolAllocator : public ArduinoJson::Allocator {
+public:
+    FixedPoolAllocator(uint8_t* buffer, size_t size);
+
+    void* allocate(size_t size) override;
+    void deallocate(void* pointer) override;
+    void* reallocate(void* pointer, size_t newSize) override;
+
+    // Only while no document uses the pool
+    void reset() { used = 0; }
+
+    size_t getUsed() const { return used; }
+    size_t getPeakUsed() const { return peakUsed; }
+
+private:
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+    size_t peakUsed;
+    size_t lastBlock;     // Offset of the newest block, it can grow in place
+};
+
+#endif // FIXED_POOL_ALLOCATOR_H
@@ -0,0 +1,165 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <functional>
+#include <HTTP_Method.h>
+
+#ifndef CONTENT_LENGTH_UNKNOWN
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#endif
+
+// Event-driven HTTP/1.1 server polled from loop(). Serves several clients
+// at once over non-blocking sockets with keep-alive, each connection with
+// fixed request/response buffers. Handlers use the same calls as the
+// Arduino WebServer (on, arg, hasArg, header, send, send_P, sendContent).
+//
+// Handlers run one at a time on the loop task and never wait for the
+// socket: output beyond the response buffer is kept on the heap and written
+// in the background. send() and sendContent() copy what they are given;
+// send_P() keeps only the pointer, so it is for flash resident data (web
+// assets) and never for a buffer on the handler's stack.
+//
+// A handler can turn its connection into a Server-Sent Events stream with
+// beginEventStream(); sendEvent() then pushes to every open stream that
+// subscribed to the event's channel.
+class HttpServer {
+public:
+    typedef std::function<void(void)> THandlerFunction;
+
+    static const int MAX_CONNECTIONS = 6;
+    static const int MAX_EVENT_STREAMS = 3;           // Leaves the other slots for requests
+    static const size_t REQUEST_BUFFER_SIZE = 1536;   // Request line, headers and form body
+    static const size_t RESPONSE_BUFFER_SIZE = 1024;  // Status line, headers and small bodies
+    static const uint8_t EVENT_CHANNEL_DEFAULT = 0x01;
+    static const uint8_t EVENT_CHANNEL_ALL = 0xFF;
+    static const int MAX_ROUTES = 64;
+
+    HttpServer(int port = 80);
+    ~HttpServer();
+
+    void begin();
+    void handleClient();
+
+    void on(const String& uri, THandlerFunction handler);
+    void on(const String& uri, HTTPMethod method, THandlerFunction handler);
+    void onNotFound(THandlerFunction handler);
+
+    // Request of the handler currently running
+    bool hasArg(const String& name);
+    String arg(const String& name);
+    String header(const String& name);
+    // Raw request body, e.g. binary uploads; valid until the handler returns
+    const uint8_t* body() const;
+    size_t bodyLength() const;
+
+    // Response of the handler currently running
+    void sendHeader(const String& name, const String& value);
+    void setContentLength(size_t length);
+    void send(int code, const char* contentType = nullptr, const String& content = String());
+    void send(int code, const char* contentType, const char* content);
+    void send(int code, const char* contentType, const char* content, size_t length);
+    void send(int code, const String& contentType, const String& content);
+    // content must stay valid until the response is sent: flash only
+    void send_P(int code, const char* contentType, const char* content, size_t length);
+    void sendContent(const char* content, size_t length);
+    void sendContent(const String& content);
+
+    // Runs once the current response has been sent, e.g. a restart
+    void afterResponse(THandlerFunction action);
+
+    // Server-Sent Events: the current request becomes a stream that stays
+    // open and receives the events of the given channels (bit mask)
+    void beginEventStream(uint8_t channels = EVENT_CHANNEL_DEFAULT);
+    int getEventStreamCount(uint8_t channels = EVENT_CHANNEL_ALL) const;
+    // Queues "event: <event>" with one line of data on every stream of the channel
+    void sendEvent(const char* event, const char* data, size_t length, uint8_t channel = EVENT_CHANNEL_DEFAULT);
+    // Pushes queued events out while loop() is blocked (e.g. firmware download)
+    void flushEventStreams();
+
+private:
+    enum class State {
+        FREE,
+        READING,
+        WRITING,
+        STREAMING
+    };
+
+    struct Connection {
+        int fd;
+        State state;
+        unsigned long lastActivity;
+        uint16_t requestsServed;
+        bool keepAlive;
+
+        // Request, parsed in place
+        char request[REQUEST_BUFFER_SIZE];
+        size_t requestLength;
+        size_t headerLength;        // 0 until the blank line arrived
+        size_t contentLength;
+        HTTPMethod method;
+        size_t pathStart;
+        size_t pathLength;
+        size_t queryStart;
+        size_t queryLength;
+
+        // Response: buffered head/small body, then an optional large body
+        char response[RESPONSE_BUFFER_SIZE];
+        size_t responseLength;
+        size_t responseSent;
+        char* heapBody;             // Output that did not fit the buffer
+        size_t heapCapacity;
+        const char* flashBody;
+        size_t bodyLength;
+        size_t bodySent;
+        bool responseStarted;
+        bool chunked;
+        bool failed;
+        uint8_t eventChannels;      // 0 unless this is an event stream
+        unsigned long streamStart;  // When the event stream opened, the oldest is evicted first
+    };
+
+    struct Route {
+        String uri;
+        HTTPMethod method;
+        THandlerFunction handler;
+    };
+
+    int port;
+    int listenFd;
+    Connection connections[MAX_CONNECTIONS];
+    Route routes[MAX_ROUTES];
+    int routeCount;
+    THandlerFunction notFoundHandler;
+    unsigned long lastEventPing;
+
+    // State of the handler currently running
+    Connection* current;
+    String pendingHeaders;
+    size_t pendingContentLength;
+    THandlerFunction pendingAction;
+    Connection* pendingActionConnection;
+
+    void acceptConnections();
+    void readRequest(Connection& conn);
+    bool parseRequestHead(Connection& conn);
+    void dispatch(Connection& conn);
+    void writeResponse(Connection& conn);
+    void finishResponse(Connection& conn);
+    void closeConnection(Connection& conn);
+    void resetResponse(Connection& conn);
+    void sendError(Connection& conn, int code);
+    void serviceStream(Connection& conn);
+    bool drainResponse(Connection& conn);
+    void queueEvent(Connection& conn, const char* head, size_t headLength, const char* data, size_t length);
+
+    void writeHead(int code, const char* contentType, size_t contentLength);
+    void appendResponse(Connection& conn, const char* data, size_t length);
+    int sendSome(Connection& conn, const char* data, size_t length);
+
+    bool findArg(const char* params, size_t length, const String& name, String* value);
+    static String urlDecode(const char* text, size_t length);
+    static const char* statusText(int code);
+};
+
+#endif // HTTP_SERVER_H
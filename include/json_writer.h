@@ -0,0 +1,67 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+// Streaming JSON writer over a caller supplied (usually stack) buffer.
+// Nothing is allocated: when the buffer fills up it is handed to the flush
+// callback (e.g. an HTTP chunk) and reused. Without a callback the output
+// is truncated and hasOverflowed() reports it.
+//
+// A nullptr key writes a bare value, for array elements and the root.
+class JsonWriter {
+public:
+    typedef void (*FlushCallback)(void* context, const char* data, size_t length);
+
+    JsonWriter(char* buffer, size_t size, FlushCallback flush = nullptr, void* context = nullptr);
+
+    void beginObject(const char* key = nullptr);
+    void endObject();
+    void beginArray(const char* key = nullptr);
+    void endArray();
+
+    void add(const char* key, const char* value);
+    void add(const char* key, const String& value) { add(key, value.c_str()); }
+    void add(const char* key, bool value);
+    void add(const char* key, int value);
+    void add(const char* key, unsigned int value);
+    void add(const char* key, long value);
+    void add(const char* key, unsigned long value);
+    void add(const char* key, long long value);
+    void add(const char* key, double value, int decimals = 2);
+    void addNull(const char* key);
+
+    // Already serialized JSON (object, array, number) inserted as is
+    void addRaw(const char* key, const char* json);
+
+    // Passes buffered output to the flush callback
+    void flush();
+
+    // Buffered output, only complete if nothing was flushed or dropped
+    const char* c_str();
+    size_t length() const { return used; }
+    bool hasOverflowed() const { return overflowed; }
+
+private:
+    // Bit per nesting level: set once the level has its first member
+    static const uint8_t MAX_DEPTH = 31;
+
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    FlushCallback flushCallback;
+    void* flushContext;
+    uint32_t memberMask;
+    uint8_t depth;
+    bool overflowed;
+
+    void writeKey(const char* key);
+    void writeEscaped(const char* text);
+    void write(const char* data, size_t length);
+    void write(const char* text) { write(text, strlen(text)); }
+    void write(char c);
+    void open(char bracket);
+    void close(char bracket);
+};
+
+#endif // JSON_WRITER_H
@@ -2,7 +2,6 @@
 #define LED_CONTROLLER_H
 
 #include <FastLED.h>
-#include <Preferences.h>
 #include "led_mapping_manager.h"
 #include "birthday_manager.h"
 #include <freertos/FreeRTOS.h>
@@ -18,7 +17,8 @@ enum class LEDPattern {
     CLOCK_DISPLAY,
     SETUP_MODE,
     UPDATE_MODE,
-    STARTUP_ANIMATION
+    STARTUP_ANIMATION,
+    SCENE           // Frame uploaded via LEDFrameDecoder, held until the next pattern change
 };
 
 class LEDController {
@@ -27,7 +27,9 @@ public:
     void begin(int pin, int numLeds, int brightness = 128);
     void update();
     
-    // Pattern control
+    // Pattern control. Color and brightness only record the value; the LED
+    // task applies the newest one with its next frame, so a burst of slider
+    // updates between two frames costs one FastLED update.
     void setPattern(LEDPattern pattern);
     void setSolidColor(CRGB color);
     void setBrightness(uint8_t brightness);
@@ -44,6 +46,9 @@ public:
     void showWiFiConnecting();
     void showError();
     void showStartupAnimation();
+    // Decodes an LEDFrameDecoder frame into the LEDs and holds it (SCENE).
+    // False, with the LEDs untouched, if the frame is malformed.
+    bool showScene(const uint8_t* data, size_t length);
     
     // Status LED functions
     void setWiFiStatusLED(uint8_t state); // 0=off, 1=connecting, 2=AP mode
@@ -84,9 +89,23 @@ public:
     int getNumLeds() const { return numLeds; }
     int getDataPin() const { return dataPin; }
     CRGB getSolidColor() const { return solidColor; }
+    // Set calls since boot, and how many of them reached the LEDs
+    uint32_t getBrightnessRequests() const { return brightnessRequests; }
+    uint32_t getBrightnessApplied() const { return brightnessApplied; }
+    uint32_t getColorRequests() const { return colorRequests; }
+    uint32_t getColorApplied() const { return colorApplied; }
+    uint32_t getSceneFrames() const { return sceneFrames; }
+    // Command-to-photon latency: markInput() once a command has been applied,
+    // with the time it arrived; the next frame the LED task shows stops the clock
+    void markInput(unsigned long receivedUs);
+    uint32_t getLastInputLatencyUs() const { return lastInputLatencyUs; }
+    uint32_t getMaxInputLatencyUs() const { return maxInputLatencyUs; }
+    uint32_t getInputLatencySamples() const { return inputLatencySamples; }
+    uint32_t getSceneRejected() const { return sceneRejected; }
+    // Composed frame as written by the LED task, for read-only mirroring
+    const CRGB* getFrameBuffer() const { return leds; }
 
 private:
-    Preferences preferences;
     LEDMappingManager mappingManager;
     BirthdayManager* birthdayManager;
     CRGB* leds;
@@ -121,6 +140,23 @@ private:
     unsigned long birthdayAlternateTimer;
     bool showBirthdayNow;
     
+    // Input stage, written by the main task and taken by the LED task
+    volatile bool brightnessPending;
+    volatile bool colorPending;
+    uint32_t brightnessRequests;
+    uint32_t brightnessApplied;
+    uint32_t colorRequests;
+    uint32_t colorApplied;
+    uint32_t sceneFrames;
+    uint32_t sceneRejected;
+    volatile unsigned long inputMarkUs;
+    volatile bool inputMarked;
+    unsigned long frameMarkUs;      // Mark taken over by the frame being composed
+    bool frameMarked;
+    uint32_t lastInputLatencyUs;
+    uint32_t maxInputLatencyUs;
+    uint32_t inputLatencySamples;
+
     // FreeRTOS task management
     TaskHandle_t ledTaskHandle;
     SemaphoreHandle_t ledMutex;
@@ -129,6 +165,8 @@ private:
     // Static task function
     static void ledTaskFunction(void* parameter);
     void ledTaskLoop();
+    void applyPendingInput();
+    void showFrame();
     
     // Pattern implementations
     void updateRainbow();
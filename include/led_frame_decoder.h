@@ -0,0 +1,36 @@
+#ifndef LED_FRAME_DECODER_H
+#define LED_FRAME_DECODER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Scene frames uploaded by external systems (MQTT scene topic, POST
+// /led/frame), one color per physical LED in strip order. Decoded straight
+// into the LED frame buffer; nothing is allocated.
+//
+// Format, integers little endian:
+//   [0]    format, FLAG_RLE set if the pixels are run-length encoded
+//   [1..2] LED count, at most the strip length; the remaining LEDs turn off
+//   RGB565:  count x color u16              RLE: runs of [length u8][color u16]
+//   PALETTE: palette size n (1..255), n x (r, g, b), then
+//            count x index u8                RLE: runs of [length u8][index u8]
+class LEDFrameDecoder {
+public:
+    enum Format : uint8_t {
+        RGB565 = 0,
+        PALETTE = 1
+    };
+
+    static const uint8_t FLAG_RLE = 0x80;
+    static const size_t HEADER_SIZE = 3;
+
+    // Checks the whole frame first, so a malformed one leaves leds untouched
+    static bool decode(const uint8_t* data, size_t length, CRGB* leds, int count);
+    static bool isValid(const uint8_t* data, size_t length, int count) { return walk(data, length, nullptr, count); }
+
+private:
+    // Validates, and writes the pixels if leds is set
+    static bool walk(const uint8_t* data, size_t length, CRGB* leds, int count);
+};
+
+#endif // LED_FRAME_DECODER_H
@@ -0,0 +1,58 @@
+#ifndef LED_FRAME_ENCODER_H
+#define LED_FRAME_ENCODER_H
+
+#include <Arduino.h>
+#include <FastLED.h>
+
+// Compact binary snapshots of the LED frame buffer for the web UI mirror.
+// A keyframe carries the whole frame, as palette indices when it has few
+// colors (the clock face usually has two or three) or as RGB otherwise.
+// Later frames only carry the runs of LEDs that changed since the last one.
+//
+// Format, integers little endian:
+//   [0]    frame type
+//   [1..2] LED count
+//   KEY_RGB:     count x (r, g, b)
+//   KEY_PALETTE: palette size n, n x (r, g, b), count 4-bit indices, low nibble first
+//   DELTA:       runs of [start u16][length u8][length x (r, g, b)] up to the end
+//
+// The frame buffer is read in place, without the LED task's mutex: every
+// pixel is read once, so a frame caught mid-update is only torn, and the
+// next delta carries the rest.
+class LEDFrameEncoder {
+public:
+    enum FrameType : uint8_t {
+        KEY_RGB = 0,
+        KEY_PALETTE = 1,
+        DELTA = 2
+    };
+
+    static const size_t HEADER_SIZE = 3;
+    static const int MAX_PALETTE_SIZE = 16;
+
+    LEDFrameEncoder();
+    ~LEDFrameEncoder();
+
+    // Largest output for count LEDs: a KEY_RGB frame
+    static size_t maxEncodedSize(int count) { return HEADER_SIZE + 3 * (size_t)count; }
+
+    // Changes since the previous call, as a delta or a keyframe, whichever is
+    // smaller. Returns 0 if nothing changed; the data stays valid until the next call.
+    size_t encodeNext(const CRGB* leds, int count);
+    const uint8_t* getData() const { return output; }
+
+    // The next frame is a keyframe, e.g. for a new viewer
+    void reset() { keyframePending = true; }
+
+private:
+    CRGB* previous;       // What the viewers show right now
+    uint8_t* output;
+    int capacity;         // LEDs both buffers are sized for
+    bool keyframePending;
+
+    void allocate(int count);
+    size_t encodeDelta(const CRGB* leds, int count, size_t limit);
+    size_t encodeKeyframe(int count);
+};
+
+#endif // LED_FRAME_ENCODER_H
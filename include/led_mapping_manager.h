@@ -1,8 +1,8 @@
 #ifndef LED_MAPPING_MANAGER_H
 #define LED_MAPPING_MANAGER_H
 
-#include <Preferences.h>
 #include "../mappings/mapping_base.h"
+#include "json_writer.h"
 
 // Mapping types
 enum class MappingType {
@@ -46,8 +46,10 @@ public:
     void illuminateMinuteDots(bool* ledStates, uint8_t numDots);
     
     // Getters for web interface
-    String getMappingInfoJSON() const;
-    String getAvailableMappingsJSON() const;
+    void writeMappingInfoJSON(JsonWriter& json) const;
+    void writeAvailableMappingsJSON(JsonWriter& json) const;
+    // Faceplate layout for the web mirror: LED index of every cell and the letters of every word
+    void writeLayoutJSON(JsonWriter& json) const;
     
     // Status LED and startup sequence configuration (rotation is applied automatically)
     uint8_t getWiFiStatusLED() const;
@@ -70,7 +72,7 @@ private:
     uint8_t coordsToIndex(int8_t row, int8_t col) const;
     void rotateCoords(int8_t& row, int8_t& col) const;
     uint8_t transformLedIndex(uint8_t originalIndex) const;
-    Preferences preferences;
+    void writeWordsJSON(JsonWriter& json, const WordMapping* words, uint8_t count) const;
     MappingType currentMappingType;
     
     // Current mapping data pointers
@@ -0,0 +1,17 @@
+#ifndef LIGHT_COMMAND_H
+#define LIGHT_COMMAND_H
+
+#include <ArduinoJson.h>
+
+// Home Assistant's JSON schema light commands, translated into the cloud's
+// "desired" command with the shadow's field names, so the LAN and the cloud
+// apply them the same way.
+class LightCommand {
+public:
+    // Home Assistant sends "ON" with every change; only switching on from
+    // off (poweredOn false) selects the clock face, otherwise the current
+    // pattern stays. command is only filled in when the payload parses.
+    static DeserializationError translate(const char* payload, size_t size, bool poweredOn, JsonDocument& command);
+};
+
+#endif // LIGHT_COMMAND_H
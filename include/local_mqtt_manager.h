@@ -0,0 +1,92 @@
+#ifndef LOCAL_MQTT_MANAGER_H
+#define LOCAL_MQTT_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <ArduinoJson.h>
+#include <MQTTPubSubClient.h>
+#include "json_writer.h"
+#include "retry_backoff.h"
+
+// Forward declarations
+class LEDController;
+class CloudManager;
+
+// Steps of a connection attempt to the LAN broker
+enum class LocalMqttStep {
+    IDLE,               // Waiting for the next attempt
+    MQTT_CONNECTING,    // TCP (or TLS) up, CONNECT sent, waiting for CONNACK
+    ONLINE
+};
+
+// Optional MQTT connection to a broker in the same network, plain TCP or
+// TLS, next to the cloud connection. Commands go through the cloud's command
+// handler and the state is published from its shadow, so both paths behave
+// the same. Home Assistant picks the clock up as a JSON schema light from a
+// retained discovery message.
+//
+// Topics below qlockthree/<device id>/lan:
+//   set           Home Assistant light commands
+//   state         Light state, retained
+//   availability  online/offline, retained; offline is the last will
+//   command       Commands in the cloud format (JSON or MessagePack)
+//   scene         Binary LEDFrameDecoder frames
+class LocalMqttManager {
+public:
+    LocalMqttManager();
+
+    // Loads the broker settings; cloudManager provides the command handler and shadow
+    void begin(LEDController* ledController, CloudManager* cloudManager, const char* firmwareVersion);
+
+    // Main loop - must be called regularly
+    void loop();
+
+    // Stores the broker and reconnects to it
+    void configure(bool enabled, const String& host, uint16_t port, bool tls,
+                   const String& username, const String& password);
+    bool isConnected();
+
+    // Get status for web interface
+    void writeStatusJSON(JsonWriter& json);
+
+private:
+    LEDController* ledController;
+    CloudManager* cloudManager;
+    const char* firmwareVersion;
+
+    // Settings
+    bool enabled;
+    String host;
+    uint16_t port;
+    bool tls;
+    String username;
+    String password;
+
+    // Transport; only one of the clients is in use at a time
+    WiFiClient tcpClient;
+    WiFiClientSecure tlsClient;
+    arduino::mqtt::PubSubClient<512> mqtt;
+    LocalMqttStep step;
+    unsigned long stepStartTime;
+    RetryBackoff reconnectBackoff;
+    String baseTopic;
+
+    // Statistics since boot
+    unsigned long lastConnectMs;    // TCP connect plus TLS handshake
+    uint32_t commands;
+    uint32_t statePublishes;
+    uint32_t publishedRevision;
+    bool statePending;
+
+    void connect();
+    void disconnect();
+    void enterStep(LocalMqttStep next);
+    bool subscribeTopics();
+    void connectionFailed(const char* reason);
+    void publishDiscovery();
+    void publishState();
+    void handleLightCommand(const char* payload, size_t size);
+    bool publishDocument(const String& topic, JsonDocument& doc);
+};
+
+#endif // LOCAL_MQTT_MANAGER_H
@@ -0,0 +1,61 @@
+#ifndef RETRY_BACKOFF_H
+#define RETRY_BACKOFF_H
+
+#include <Arduino.h>
+#include "json_writer.h"
+
+// Retry schedule for one network operation: every failure in a row doubles
+// the delay up to a cap, and each delay is randomized between half and all
+// of its value so a fleet of clocks that failed together drifts apart.
+// WiFi coming back (resetAll) restarts every schedule from a random point
+// within the base delay instead of hitting the server in lockstep.
+class RetryBackoff {
+public:
+    RetryBackoff(const char* name, unsigned long baseDelayMs, unsigned long maxDelayMs);
+
+    // True once the next attempt is due
+    bool isDue();
+    unsigned long getTimeUntilDue();
+
+    // Next attempt after the given interval, e.g. the regular poll period
+    void recordSuccess(unsigned long nextAttemptMs = 0);
+    // Next attempt after the doubled, jittered delay
+    void recordFailure();
+
+    // Next attempt within a random part of the base delay
+    void reset();
+    // Next attempt right away, for user initiated actions
+    void retryNow();
+
+    uint32_t getConsecutiveFailures() const { return consecutiveFailures; }
+    unsigned long getCurrentDelay() const { return currentDelay; }
+
+    // Members of an object opened by the caller
+    void writeStatusJSON(JsonWriter& json);
+
+    // Called from the WiFi event task when the station gets an IP
+    static void resetAll();
+    // One object per schedule, named after it
+    static void writeAllJSON(JsonWriter& json);
+
+private:
+    const char* name;
+    unsigned long baseDelay;
+    unsigned long maxDelay;
+    unsigned long lastScheduled;
+    unsigned long currentDelay;
+    uint32_t consecutiveFailures;
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t wifiResets;
+    uint32_t seenGeneration;
+
+    RetryBackoff* next;
+    static RetryBackoff* first;
+    static volatile uint32_t generation;
+
+    void schedule(unsigned long delayMs);
+    void checkWiFiReset();
+};
+
+#endif // RETRY_BACKOFF_H
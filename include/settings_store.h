@@ -0,0 +1,103 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "json_writer.h"
+
+// Persistent settings of all modules behind one NVS namespace and handle.
+// Values are cached in RAM on first access, so reads never touch flash.
+// Writing an unchanged value is a no-op; changed values are committed in
+// one batch once changes have settled (a slider drag becomes one write).
+// flush() writes immediately and also runs on every controlled restart.
+//
+// Keys are prefixed with their module ("led.bright") and at most 15
+// characters, the NVS limit. Each key takes a cache entry on first access;
+// a key that finds the table full is not stored, which checkCapacity()
+// turns into a crash at boot rather than settings silently not persisting.
+class SettingsStore {
+public:
+    static const int MAX_ENTRIES = 48; // 31 keys in use, room for new settings
+
+    SettingsStore();
+
+    // Opens NVS; the first boot moves values from the old per-module namespaces
+    void begin();
+    // Runs at the end of setup(): aborts if a key found the table full
+    void checkCapacity();
+    // Commits pending changes once they are due
+    void loop();
+    void flush();
+
+    int32_t getInt(const char* key, int32_t defaultValue);
+    uint32_t getUInt(const char* key, uint32_t defaultValue);
+    int64_t getLong64(const char* key, int64_t defaultValue);
+    bool getBool(const char* key, bool defaultValue) { return getUInt(key, defaultValue ? 1 : 0) != 0; }
+    String getString(const char* key, const char* defaultValue = "");
+    bool isKey(const char* key);
+
+    void setInt(const char* key, int32_t value);
+    void setUInt(const char* key, uint32_t value);
+    void setLong64(const char* key, int64_t value);
+    void setBool(const char* key, bool value) { setUInt(key, value ? 1 : 0); }
+    void setString(const char* key, const String& value);
+    void remove(const char* key);
+
+    // Factory reset: every value is gone, in RAM and in NVS
+    void clear();
+
+    // Counts every change, lets callers detect that something was modified
+    uint32_t getVersion() const { return version; }
+    bool hasPendingChanges() const { return version != committedVersion; }
+
+    // Members of an object opened by the caller
+    void writeStatusJSON(JsonWriter& json);
+
+private:
+    enum class Type : uint8_t {
+        INT,
+        UINT,
+        LONG64,
+        STRING
+    };
+
+    struct Entry {
+        char key[16];
+        Type type;
+        bool present;       // Has a value (stored or pending), otherwise defaults apply
+        bool dirty;         // Differs from NVS
+        int64_t number;
+        String text;
+    };
+
+    Preferences preferences;
+    bool opened;
+    Entry entries[MAX_ENTRIES];
+    int entryCount;
+    uint32_t version;
+    uint32_t committedVersion;
+    unsigned long firstChangeTime;
+    unsigned long lastChangeTime;
+
+    // Since boot
+    uint32_t setCalls;
+    uint32_t unchangedSets;
+    uint32_t nvsReads;
+    uint32_t nvsWrites;
+    uint32_t commits;
+    uint32_t refusedKeys;
+
+    static SettingsStore* instance;
+
+    Entry* find(const char* key, Type type);
+    void setNumber(const char* key, Type type, int64_t value);
+    void markChanged(Entry& entry);
+    void commit();
+    void migrateLegacyNamespaces();
+    static void shutdownHandler();
+};
+
+// Shared by all modules, begin() runs first thing in setup()
+extern SettingsStore settingsStore;
+
+#endif // SETTINGS_STORE_H
@@ -3,8 +3,14 @@
 
 #include <WiFi.h>
 #include <time.h>
-#include <Preferences.h>
 #include <ArduinoJson.h>
+#include <sys/time.h>
+#include "timezone_rules.h"
+#include "time_source_manager.h"
+#include "json_writer.h"
+
+// Called from loop() when an NTP sync completes or a requested sync times out
+typedef void (*TimeSyncCallback)(bool success);
 
 class TimeManager {
 public:
@@ -15,10 +21,29 @@ public:
     void setTimezone(const char* timezone);
     void setNTPServers(const char* primary, const char* secondary = nullptr, const char* tertiary = nullptr);
     
-    // Time synchronization
+    // Time synchronization (sources are queried in the background, loop() picks up results)
+    void loop();
     bool syncTime();
     bool isTimeSynced();
+    bool isSyncInProgress();
     unsigned long getLastSyncTime();
+    void setSyncCallback(TimeSyncCallback callback);
+    
+    // Secondary time source: Date header of any HTTP response (AutoUpdater, CloudManager)
+    static void reportHttpDate(const String& dateHeader, unsigned long requestStartMs);
+    
+    // Last-known time persistence (RTC memory survives soft resets, NVS is the fallback)
+    void restoreLastKnownTime();
+    void checkpointTime();
+    bool isTimeProvisional();
+    unsigned long getTimeUncertaintyMs();
+    
+    // Minute-edge display scheduling: pollMinuteEdge() returns true once the local
+    // minute has changed, recordMinuteFlip() measures how late the render was
+    bool pollMinuteEdge();
+    void recordMinuteFlip();
+    struct tm getDisplayTime();
+    unsigned long getMicrosUntilMinuteEdge();
     
     // Time retrieval
     struct tm getCurrentTime();
@@ -27,21 +52,25 @@ public:
     String getTimezoneString();
     
     // Timezone management
-    bool setTimezoneByName(const char* timezoneName);
-    String getAvailableTimezones();
+    bool setTimezoneByName(const char* timezoneName); // Short name or IANA name
+    String getTimezoneName();
+    void writeAvailableTimezonesJSON(JsonWriter& json);
     
     // Configuration persistence
     void saveSettings();
     void loadSettings();
     
     // Status information
-    String getStatusJSON();
+    void writeStatusJSON(JsonWriter& json);
+    // Compact subset for push events: wall clock, sync state and zone
+    void writeClockJSON(JsonWriter& json);
     bool isDST();
     int getTimezoneOffset();
     
 private:
-    Preferences preferences;
     String currentTimezone;
+    String currentTimezoneName;
+    TimezoneRules tzRules;
     String ntpServer1;
     String ntpServer2;
     String ntpServer3;
@@ -49,10 +78,50 @@ private:
     unsigned long lastSyncTime;
     unsigned long syncInterval;
     
+    // Wall clock estimate (from NTP or a restored snapshot) and its error bound
+    bool hasTimeEstimate;
+    bool timeRestored;
+    unsigned long estimateBaseMillis;
+    unsigned long estimateBaseUncertaintyMs;
+    long lastSyncCorrectionMs;
+    unsigned long lastCheckpoint;
+    
+    // Reference point of the last sync/restore for offset and drift measurement
+    int64_t referenceEpochUs;
+    int64_t referenceTimerUs;
+    
+    // Time sources (NTP servers, LAN peers, HTTP Date) and sync state
+    TimeSourceManager timeSources;
+    unsigned long referenceErrorMs;
+    float driftPpm;
+    bool driftKnown;
+    unsigned long syncCount;
+    TimeSyncCallback syncCallback;
+    
+    // Display schedule: next local minute boundary (UTC epoch us) and flip latency stats
+    int64_t nextMinuteEdgeUs;
+    int64_t pendingFlipEdgeUs;
+    struct tm displayTime;
+    long lastFlipLatencyUs;
+    long maxFlipLatencyUs;
+    unsigned long minuteFlipCount;
+    
     // Internal methods
     void configureTimezone();
+    void applyTimezone(const char* timezone, const char* name);
     bool performNTPSync();
     void updateSyncStatus();
+    void persistTime(bool toNVS, bool cleanShutdown);
+    void applyTimeEstimate(const TimeEstimate& estimate);
+    void handleSyncResult(int64_t syncedUs, int64_t timerUs, unsigned long errorMs);
+    void adaptSyncInterval();
+    void refreshDisplayTime(int64_t nowUs);
+    time_t findNextMinuteEdge(time_t now, const struct tm& local);
+    void toLocalTime(time_t utc, struct tm& out);
+    
+    // Shutdown hook (ESP.restart, OTA, /dev/reboot) to save time on the way down
+    static void shutdownHandler();
+    static TimeManager* instance;
     
     // Timezone data
     struct TimezoneInfo {
@@ -0,0 +1,73 @@
+#ifndef TIME_SAMPLE_FILTER_H
+#define TIME_SAMPLE_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Platform independent half of the time source subsystem: keeps the latest
+// offset measurement per source and combines them into one estimate.
+// No Arduino dependencies, so it builds and runs on a Linux host as well.
+
+enum class TimeSourceType : uint8_t {
+    NTP,
+    PEER,
+    HTTP_DATE
+};
+
+struct TimeSample {
+    TimeSourceType type;
+    uint32_t sourceId;   // IPv4 address of the server/peer, 0 for HTTP
+    int64_t offsetUs;    // Source time minus local system clock
+    int64_t errorUs;     // True offset lies within offsetUs +/- errorUs
+    int64_t delayUs;     // Round trip delay of the measurement
+    int64_t takenAtUs;   // Monotonic time of the measurement
+    bool selected;       // Part of the last chosen estimate
+};
+
+struct TimeEstimate {
+    int64_t offsetUs;    // Correction to apply to the system clock
+    int64_t errorUs;     // Bound of the combined estimate
+    int sourcesUsed;
+    int sourcesTotal;
+};
+
+class TimeSampleFilter {
+public:
+    static const int MAX_SAMPLES = 8;
+    static const size_t NTP_PACKET_SIZE = 48;
+
+    TimeSampleFilter();
+
+    // Replaces the previous sample of the same source
+    void addSample(const TimeSample& sample);
+
+    // Intersection of all sample intervals (Marzullo), then a quality weighted
+    // median of the sources agreeing with the majority. False if no majority.
+    bool select(int64_t nowUs, TimeEstimate& estimate);
+
+    // Keep stored offsets valid after the system clock was stepped
+    void applyClockStep(int64_t stepUs);
+    void clear();
+
+    int getSampleCount() const { return sampleCount; }
+    const TimeSample& getSample(int index) const { return samples[index]; }
+
+    // NTP v4 client packets; timestamps are local system clock epoch us
+    static void buildNtpRequest(uint8_t* packet, int64_t transmitEpochUs);
+    static bool parseNtpResponse(const uint8_t* packet, size_t length, int64_t originateEpochUs,
+                                 int64_t receiveEpochUs, TimeSample& sample);
+
+    // "Sun, 06 Nov 1994 08:49:37 GMT" -> Unix seconds
+    static bool parseHttpDate(const char* header, int64_t* epochSeconds);
+
+private:
+    TimeSample samples[MAX_SAMPLES];
+    int sampleCount;
+
+    void expire(int64_t nowUs);
+    static int64_t agedError(const TimeSample& sample, int64_t nowUs);
+    static int64_t ntpToEpochUs(const uint8_t* timestamp);
+    static void epochUsToNtp(int64_t epochUs, uint8_t* timestamp);
+};
+
+#endif // TIME_SAMPLE_FILTER_H
@@ -0,0 +1,107 @@
+#ifndef TIME_SOURCE_MANAGER_H
+#define TIME_SOURCE_MANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <lwip/ip_addr.h>
+#include "time_sample_filter.h"
+#include "json_writer.h"
+
+// Network side of time selection: queries all NTP servers in parallel,
+// asks other qlockthrees on the LAN for their clock, accepts HTTP Date
+// headers from other requests and feeds everything into a TimeSampleFilter.
+class TimeSourceManager {
+public:
+    enum class RoundResult {
+        NONE,       // No round finished since the last poll
+        SUCCESS,    // Estimate available
+        FAILED      // No sources or no majority agreement
+    };
+
+    static const int MAX_NTP_SERVERS = 3;
+
+    TimeSourceManager();
+
+    // Looks the servers up, then sends one query to each as its address
+    // arrives, plus a peer broadcast; results via pollRound()
+    bool startRound(const String* servers, int count);
+    bool isRoundActive() const { return roundActive; }
+
+    // Sends queries for resolved servers, receives replies and answers peer
+    // queries (only when shareTime is set). The sockets are closed while
+    // WiFi is down and opened fresh once it is back.
+    void loop(bool shareTime, unsigned long localErrorMs);
+    RoundResult pollRound(TimeEstimate& estimate);
+
+    // Secondary source: Date header of an HTTP response
+    void addHttpDate(const char* dateHeader, unsigned long requestStartMs);
+
+    // Stored samples are relative to the system clock
+    void applyClockStep(int64_t stepUs);
+
+    // Array elements, one object per source
+    void writeSourcesJSON(JsonWriter& json);
+
+private:
+    enum class QueryState : uint8_t {
+        RESOLVING,  // Waiting for the DNS reply
+        SENT,       // Query out, waiting for the NTP reply
+        ANSWERED,
+        FAILED      // Not resolved, or the same address as another server
+    };
+
+    struct NtpQuery {
+        String server;
+        IPAddress address;
+        int64_t transmitEpochUs;
+        QueryState state;
+    };
+
+    // Filled in by the DNS callback in the lwIP task, picked up by loop()
+    struct Lookup {
+        volatile uint32_t address;
+        volatile uint8_t status;
+    };
+
+    // Peer time exchange on UDP, same firmware on both ends
+    struct PeerPacket {
+        char magic[4];          // "QLKT"
+        uint8_t version;
+        uint8_t type;           // PEER_QUERY or PEER_RESPONSE
+        uint8_t reserved[2];
+        int64_t originateUs;    // Requester's clock when the query was sent
+        int64_t peerEpochUs;    // Responder's clock when the response was sent
+        int64_t peerErrorUs;    // Responder's own error bound
+    };
+
+    TimeSampleFilter filter;
+    WiFiUDP ntpUdp;
+    WiFiUDP peerUdp;
+    bool socketsOpen;
+
+    NtpQuery queries[MAX_NTP_SERVERS];
+    Lookup lookups[MAX_NTP_SERVERS];
+    int queryCount;
+    uint32_t roundId;       // Lookups of an earlier round are ignored
+    unsigned long lastQueryTime;
+    int64_t peerQueryEpochUs;
+    bool roundActive;
+    bool roundComplete;
+    unsigned long roundStartTime;
+
+    static TimeSourceManager* instance;
+
+    void openSockets();
+    void closeSockets();
+    void startLookup(int index);
+    void sendResolvedQueries();
+    void receiveNtp();
+    void receivePeers(bool shareTime, unsigned long localErrorMs);
+    void sendPeerQuery();
+    static int64_t epochNowUs();
+    static const char* typeName(TimeSourceType type);
+    static void onDnsFound(const char* name, const ip_addr_t* address, void* arg);
+};
+
+#endif // TIME_SOURCE_MANAGER_H
@@ -0,0 +1,39 @@
+#ifndef TIMEZONE_DATABASE_H
+#define TIMEZONE_DATABASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Built-in IANA timezone table (zone name -> POSIX TZ rule), generated by
+// scripts/generate_timezones.py into src/timezone_data.cpp. All tables are
+// const and stay in flash; lookups are a binary search without allocation.
+class TimezoneDatabase {
+public:
+    // POSIX rule for an IANA name like "Europe/Berlin", nullptr if unknown
+    static const char* findRule(const char* name);
+
+    // Index based access for listing all zones
+    static int count() { return entryCount; }
+    static size_t getName(int index, char* buffer, size_t size);
+    static const char* getRule(int index);
+
+    static const char* getVersion() { return version; }
+
+private:
+    struct Entry {
+        uint16_t name;    // Offset into names (without region prefix)
+        uint16_t rule;    // Offset into rules
+        uint8_t region;   // Index into regions, 0 = no prefix
+    };
+
+    static int compareName(const char* name, const Entry& entry);
+
+    static const char version[];
+    static const char* const regions[];
+    static const char names[];
+    static const char rules[];
+    static const Entry entries[];
+    static const int entryCount;
+};
+
+#endif // TIMEZONE_DATABASE_H
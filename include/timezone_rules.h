@@ -0,0 +1,62 @@
+#ifndef TIMEZONE_RULES_H
+#define TIMEZONE_RULES_H
+
+#include <time.h>
+#include <stdint.h>
+
+// Parsed POSIX TZ string (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") with the DST
+// transitions of one year cached as UTC instants, so converting UTC to local
+// time is an add plus a compare instead of a locked localtime_r() call.
+// Follows newlib's tzset()/localtime_r() semantics, including the year of a
+// lookup being the UTC year and the default rules when none are given.
+class TimezoneRules {
+public:
+    TimezoneRules();
+
+    // Returns false (and leaves the rules invalid) if the string can't be parsed
+    bool parse(const char* posix);
+    bool isValid() const { return valid; }
+
+    // UTC offset east of Greenwich in seconds and DST flag for a UTC instant
+    long getUtcOffset(time_t utc, bool* isDst = nullptr);
+
+    // Broken-down local time, identical to localtime_r() for the same TZ
+    bool toLocal(time_t utc, struct tm& out);
+
+    // Days since 1970-01-01 for a proleptic Gregorian date (month 1-12)
+    static int64_t daysFromCivil(int year, int month, int day);
+
+private:
+    // One transition rule: Jn (1-365, no leap day), n (0-365) or Mm.w.d
+    struct Rule {
+        char type;      // 'J', 'D' or 'M'
+        int day;        // J/D day number or M weekday (0 = Sunday)
+        int week;       // M: 1-5, 5 = last
+        int month;      // M: 1-12
+        long seconds;   // Local time of day of the transition
+    };
+
+    bool valid;
+    bool hasDst;
+    long stdOffset;     // Seconds west of UTC, as in the TZ string
+    long dstOffset;
+    Rule rules[2];      // [0] = DST start, [1] = DST end
+
+    // Cached year: [yearStart, nextYearStart) in UTC plus its transitions
+    int cachedYear;
+    time_t yearStart;
+    time_t nextYearStart;
+    time_t dstStart;
+    time_t dstEnd;
+    bool northern;
+
+    void cacheYear(time_t utc);
+    time_t transitionTime(int year, const Rule& rule, long offset);
+
+    static const char* parseName(const char* p);
+    static const char* parseOffset(const char* p, long* seconds);
+    static const char* parseRule(const char* p, Rule* rule, bool end);
+    static bool isLeapYear(int year);
+};
+
+#endif // TIMEZONE_RULES_H
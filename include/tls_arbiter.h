@@ -0,0 +1,63 @@
+#ifndef TLS_ARBITER_H
+#define TLS_ARBITER_H
+
+#include <Arduino.h>
+#include "json_writer.h"
+
+// Gatekeeper for TLS handshakes. A handshake takes tens of KB of heap on
+// top of every session that is already open (cloud WebSocket, LAN broker,
+// update check, firmware download), so only one runs at a time, and none
+// starts while the heap could not take it; the caller fails the attempt
+// and retries later instead of running out of memory in the middle.
+//
+// Every open session is remembered with the heap its handshake left in
+// use, so the status shows what TLS currently costs and the peak so far.
+class TlsArbiter {
+public:
+    static const int MAX_SESSIONS = 6;
+
+    TlsArbiter();
+
+    // False while another owner's handshake runs or the heap is too low
+    bool beginHandshake(const char* owner);
+    // connected: the session stays open, and keeps its heap, until endSession()
+    void endHandshake(const char* owner, bool connected);
+    // Also cancels a handshake of the owner that never ended
+    void endSession(const char* owner);
+    // A request went out over a session that was still open
+    void recordReuse() { reused++; }
+
+    bool isHandshaking() const { return handshakeOwner != nullptr; }
+
+    // Members of an object opened by the caller
+    void writeStatusJSON(JsonWriter& json);
+
+private:
+    struct Session {
+        const char* owner;
+        size_t heap;
+    };
+
+    Session sessions[MAX_SESSIONS];
+    int sessionCount;
+
+    const char* handshakeOwner;
+    unsigned long handshakeStart;
+    size_t freeBefore;
+    size_t minFreeBefore;
+
+    size_t peakHeap;            // All sessions plus a handshake, at the worst moment
+    size_t lastHandshakeHeap;
+    uint32_t handshakes;
+    uint32_t failed;
+    uint32_t reused;
+    uint32_t refusedBusy;
+    uint32_t refusedHeap;
+
+    size_t sessionHeap() const;
+    void releaseHandshake();
+};
+
+extern TlsArbiter tlsArbiter;
+
+#endif // TLS_ARBITER_H
@@ -1,8 +1,10 @@
 #ifndef WEB_SERVER_MANAGER_H
 #define WEB_SERVER_MANAGER_H
 
-#include <WebServer.h>
+#include "http_server.h"
 #include <ESPmDNS.h>
+#include "json_writer.h"
+#include "led_frame_encoder.h"
 
 // Forward declarations
 class WiFiManagerHelper;
@@ -11,6 +13,9 @@ class LEDController;
 class TimeManager;
 class BirthdayManager;
 class CloudManager;
+class LocalMqttManager;
+struct WebAsset;
+enum class UpdateStage;
 
 class WebServerManager {
 public:
@@ -20,15 +25,30 @@ public:
     void handleClient();
     void setBirthdayManager(BirthdayManager* manager) { birthdayManager = manager; }
     void setCloudManager(CloudManager* manager) { cloudManager = manager; }
+    void setLocalMqttManager(LocalMqttManager* manager) { localMqttManager = manager; }
+    
+    // Pushed right away, the main loop is blocked during the download
+    void publishUpdateProgress(UpdateStage stage, size_t written, size_t total);
 
 private:
-    WebServer server;
+    // State pushed to /events subscribers whenever its JSON changes
+    enum EventTopic {
+        EVENT_LED,
+        EVENT_TIME,
+        EVENT_DEV,
+        EVENT_CLOUD,
+        EVENT_UPDATE,
+        EVENT_TOPIC_COUNT
+    };
+
+    HttpServer server;
     WiFiManagerHelper* wifiManagerHelper;
     AutoUpdater* autoUpdater;
     LEDController* ledController;
     TimeManager* timeManager;
     BirthdayManager* birthdayManager;
     CloudManager* cloudManager;
+    LocalMqttManager* localMqttManager;
 
     // Debug mode state pointers
     bool* debugModeEnabled;
@@ -37,6 +57,23 @@ private:
     
     void setupRoutes();
     
+    // Server-Sent Events
+    uint32_t eventHashes[EVENT_TOPIC_COUNT];
+    unsigned long lastEventCheck;
+    void handleEvents();
+    void publishStateEvents();
+    template <typename BodyWriter>
+    void publishIfChanged(EventTopic topic, const char* event, BodyWriter writeBody);
+
+    // LED mirror: throttled frame deltas for subscribers of /events?frames=1
+    LEDFrameEncoder frameEncoder;
+    unsigned long lastFramePublish;
+    void publishFrame();
+    
+    // Embedded gzip assets with ETag/If-None-Match revalidation
+    void sendAsset(const char* path);
+    void sendAsset(const WebAsset* asset);
+    
     // Route handlers
     void handleRoot();
     void handleStatus();
@@ -50,6 +87,7 @@ private:
     void handleTimeSync();
     void handleSetTimezone();
     void handleSetNTP();
+    void handleTimeZones();
     
     // LED configuration handlers
     void handleLEDStatus();
@@ -59,6 +97,9 @@ private:
     void handleLEDMapping();
     void handleSetLEDMapping();
     void handleSetRotation();
+    void handleLEDFrame();
+    void handleLEDFramePost();
+    void handleLEDLayout();
 
     // Debug mode handlers
     void handleDevPage();
@@ -82,11 +123,18 @@ private:
     void handleCloudPairStop();
     void handleCloudDisconnect();
 
+    // LAN MQTT handlers
+    void handleLocalMqttStatus();
+    void handleLocalMqttConfig();
+
     // JSON generators
-    String getStatusJSON();
-    String getLEDStatusJSON();
-    String getTimeStatusJSON();
-    String getDevStatusJSON();
+    void writeStatusJSON(JsonWriter& json);
+    void writeLEDStatusJSON(JsonWriter& json);
+    void writeDevStatusJSON(JsonWriter& json);
+    
+    // Streams the body written by writeBody, chunked once it outgrows the stack buffer
+    template <typename BodyWriter>
+    void sendJSON(int code, BodyWriter writeBody);
 };
 
 #endif // WEB_SERVER_MANAGER_H
@@ -3,7 +3,6 @@
 
 #include <WiFi.h>
 #include <WiFiManager.h>
-#include <Preferences.h>
 
 class WiFiManagerHelper {
 public:
@@ -20,7 +19,6 @@ public:
 
 private:
     WiFiManager wifiManager;
-    Preferences preferences;
     String savedSSID;
     String savedPassword;
     bool configModeActive;
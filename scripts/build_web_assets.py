@@ -0,0 +1,299 @@
+#!/usr/bin/env python3
+"""
+Generate src/web_assets_data.cpp from the web UI files in data/.
+
+Runs as a PlatformIO pre-build script (see extra_scripts in platformio.ini)
+and can also be called directly. Every file is:
+  - minified conservatively (comments, indentation and blank lines removed;
+    line breaks in scripts are kept so automatic semicolon insertion still works,
+    strings, template literals and regular expressions are left as written)
+  - tagged with a content hash used as strong ETag
+  - gzipped, the firmware only stores and sends the compressed bytes
+
+Pages reference CSS/JS as "/css/x.css?v=<hash>", so those can be cached by
+the browser forever; pages themselves are revalidated with If-None-Match.
+
+The output is only rewritten when it changed, so unchanged assets don't
+trigger a rebuild.
+
+Usage: python3 scripts/build_web_assets.py [data_dir] [output_file]
+"""
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO/SCons
+    PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+    IN_PLATFORMIO = True
+except NameError:
+    IN_PLATFORMIO = False
+    PROJECT_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(sys.argv[0])), ".."))
+
+DEFAULT_DATA = os.path.join(PROJECT_DIR, "data")
+DEFAULT_OUTPUT = os.path.join(PROJECT_DIR, "src", "web_assets_data.cpp")
+
+CONTENT_TYPES = {
+    ".html": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+}
+
+# Subdirectories whose files are linked from pages and get versioned URLs
+VERSIONED_DIRS = ("css", "js")
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{};,>])\s*", r"\1", text)
+    text = re.sub(r":\s+", ":", text)  # Not before ':', "a :hover" differs from "a:hover"
+    return text.replace(";}", "}").strip()
+
+
+# After one of these (or at the start) a '/' begins a regular expression, otherwise it divides
+REGEX_PRECEDERS = set("(,=:[!&|?{};+-*%<>~^")
+REGEX_KEYWORDS = {"return", "typeof", "instanceof", "in", "of", "new", "delete", "void",
+                  "throw", "case", "do", "else", "yield", "await"}
+
+
+def strip_js_comments(text):
+    """Removes // and /* */ comments from a script.
+
+    Strings, template literals (including ${} nesting) and regular expressions
+    are copied untouched. Returns the text and, per line, whether that line
+    starts inside a template literal, where whitespace is content.
+    """
+    out = []
+    literal_lines = [False]
+    templates = []  # Open ${} brace depth for each template literal we are inside
+    in_template = False
+    i = 0
+    n = len(text)
+
+    def previous_token():
+        j = len(out) - 1
+        while j >= 0 and out[j] in " \t\n":
+            j -= 1
+        if j < 0:
+            return ""
+        k = j
+        while k >= 0 and (out[k].isalnum() or out[k] in "_$"):
+            k -= 1
+        return "".join(out[k + 1:j + 1]) if k < j else out[j]
+
+    while i < n:
+        c = text[i]
+        if in_template:
+            if c == "\\":
+                out.append(text[i:i + 2])
+                i += 2
+                continue
+            if c == "`":
+                in_template = False
+            elif text.startswith("${", i):
+                templates.append(1)
+                in_template = False
+                out.append("${")
+                i += 2
+                continue
+            elif c == "\n":
+                literal_lines.append(True)
+            out.append(c)
+            i += 1
+            continue
+
+        if text.startswith("//", i):
+            while i < n and text[i] != "\n":
+                i += 1
+            continue
+        if text.startswith("/*", i):
+            end = text.find("*/", i + 2)
+            end = n if end < 0 else end + 2
+            # Keep a line break so automatic semicolon insertion sees the same code
+            if "\n" in text[i:end]:
+                out.append("\n")
+                literal_lines.append(False)
+            else:
+                out.append(" ")
+            i = end
+            continue
+
+        if c in "'\"":
+            j = i + 1
+            while j < n and text[j] != c and text[j] != "\n":
+                j += 2 if text[j] == "\\" else 1
+            out.append(text[i:j + 1])
+            i = j + 1
+            continue
+        if c == "/":
+            token = previous_token()
+            if not token or token[-1] in REGEX_PRECEDERS or token in REGEX_KEYWORDS:
+                j = i + 1
+                in_class = False
+                while j < n and text[j] != "\n" and (in_class or text[j] != "/"):
+                    if text[j] == "\\":
+                        j += 1
+                    elif text[j] == "[":
+                        in_class = True
+                    elif text[j] == "]":
+                        in_class = False
+                    j += 1
+                out.append(text[i:j + 1])
+                i = j + 1
+                continue
+        if c == "`":
+            in_template = True
+        elif c == "{" and templates:
+            templates[-1] += 1
+        elif c == "}" and templates:
+            templates[-1] -= 1
+            if templates[-1] == 0:
+                templates.pop()
+                in_template = True
+        elif c == "\n":
+            literal_lines.append(False)
+        out.append(c)
+        i += 1
+    return "".join(out), literal_lines
+
+
+def minify_lines(text, literal_lines=None):
+    """Drops indentation and blank lines, except on lines inside template literals."""
+    lines = text.split("\n")
+    literal_lines = literal_lines or [False] * len(lines)
+    out = []
+    for i, line in enumerate(lines):
+        # A line continuing into a template literal keeps its trailing whitespace
+        continues = i + 1 < len(lines) and literal_lines[i + 1]
+        if literal_lines[i]:
+            out.append(line.rstrip() if not continues else line)
+            continue
+        line = line.lstrip() if continues else line.strip()
+        if line:
+            out.append(line)
+    return "\n".join(out)
+
+
+def minify_js(text):
+    return minify_lines(*strip_js_comments(text))
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    # Inline scripts get the script minifier, the markup around them only loses indentation
+    parts = re.split(r"(<script\b[^>]*>.*?</script>)", text, flags=re.S | re.I)
+    out = []
+    for i, part in enumerate(parts):
+        if i % 2:
+            start = part.index(">") + 1
+            end = part.lower().rindex("</script>")
+            script = minify_js(part[start:end])
+            part = part[:start] + ("\n" + script + "\n" if script else "") + part[end:]
+        else:
+            part = minify_lines(part)
+        if part:
+            out.append(part)
+    return "\n".join(out)
+
+
+MINIFIERS = {
+    ".html": minify_html,
+    ".css": minify_css,
+    ".js": minify_js,
+}
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:16]
+
+
+def collect(data_dir):
+    files = []
+    for root, _, names in os.walk(data_dir):
+        for name in names:
+            ext = os.path.splitext(name)[1]
+            if ext in CONTENT_TYPES:
+                files.append(os.path.relpath(os.path.join(root, name), data_dir).replace(os.sep, "/"))
+    # Versioned assets first: their hashes are needed to rewrite the pages
+    files.sort(key=lambda p: (p.split("/")[0] not in VERSIONED_DIRS, p))
+    return files
+
+
+def build(data_dir):
+    assets = []
+    versions = {}
+    for path in collect(data_dir):
+        ext = os.path.splitext(path)[1]
+        with open(os.path.join(data_dir, path), encoding="utf-8") as f:
+            text = f.read()
+
+        text = MINIFIERS[ext](text)
+        if ext == ".html":
+            for url, version in versions.items():
+                text = text.replace('"%s"' % url, '"%s?v=%s"' % (url, version))
+
+        raw = text.encode("utf-8")
+        digest = content_hash(raw)
+        immutable = path.split("/")[0] in VERSIONED_DIRS
+        if immutable:
+            versions["/" + path] = digest
+
+        # mtime=0 keeps the output identical between builds
+        compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+        assets.append((path, CONTENT_TYPES[ext], digest, compressed, immutable, os.path.getsize(os.path.join(data_dir, path))))
+    return assets
+
+
+def emit(assets):
+    lines = [
+        "// Generated by scripts/build_web_assets.py from data/ - do not edit.",
+        "// Minified, gzipped web UI files served by WebServerManager.",
+        "",
+        '#include "web/web_assets.h"',
+        "",
+    ]
+    for i, (path, _, _, data, _, _) in enumerate(assets):
+        lines.append("// %s" % path)
+        lines.append("static const uint8_t asset_%d[] = {" % i)
+        for start in range(0, len(data), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in data[start:start + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("const WebAsset WEB_ASSETS[] = {")
+    for i, (path, content_type, digest, data, immutable, _) in enumerate(assets):
+        lines.append('    {"%s", "%s", "\\"%s\\"", asset_%d, %d, %s},' %
+                     (path, content_type, digest, i, len(data), "true" if immutable else "false"))
+    lines.append("};")
+    lines.append("")
+    lines.append("const size_t WEB_ASSET_COUNT = sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);")
+    return "\n".join(lines) + "\n"
+
+
+def main(data_dir, output):
+    assets = build(data_dir)
+    source = emit(assets)
+
+    if os.path.exists(output):
+        with open(output, encoding="utf-8") as f:
+            if f.read() == source:
+                return
+
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(source)
+
+    original = sum(a[5] for a in assets)
+    compressed = sum(len(a[3]) for a in assets)
+    print("Web assets: %d files, %d -> %d bytes (%.0f%%)" %
+          (len(assets), original, compressed, 100.0 * compressed / original if original else 0))
+
+
+if IN_PLATFORMIO:
+    main(DEFAULT_DATA, DEFAULT_OUTPUT)
+elif __name__ == "__main__":
+    main(sys.argv[1] if len(sys.argv) > 1 else DEFAULT_DATA,
+         sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT)
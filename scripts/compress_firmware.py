@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Compress a firmware image for over-the-air updates from GitHub releases.
+
+The output is a heatshrink (LZSS) stream behind a 12 byte header, which the
+auto-updater decompresses while writing the update partition
+(CompressedImageDecoder). Heatshrink only needs a window of recently
+decoded bytes on the device - 2^window_bits, 4 KB by default - where gzip
+would need 32 KB.
+
+Header, little endian:
+  0  4  magic "QHS1"
+  4  1  window bits
+  5  1  lookahead bits
+  6  2  reserved, 0
+  8  4  size of the decompressed image
+
+The stream itself is plain heatshrink: a 1 bit tag per symbol, MSB first;
+1 is a literal byte, 0 a back-reference of (distance - 1) in window bits and
+(length - 1) in lookahead bits. The last byte is padded with zeros, the
+decoder stops at the image size from the header.
+
+Usage: python3 scripts/compress_firmware.py firmware.bin [output.bin.hs]
+           [--window BITS] [--lookahead BITS]
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"QHS1"
+DEFAULT_WINDOW_BITS = 12
+DEFAULT_LOOKAHEAD_BITS = 4
+# Candidates followed per position; more finds slightly longer matches, slowly
+MAX_CHAIN = 48
+
+
+class BitWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.acc = 0
+        self.bits = 0
+
+    def write(self, value, count):
+        self.acc = (self.acc << count) | value
+        self.bits += count
+        while self.bits >= 8:
+            self.bits -= 8
+            self.out.append((self.acc >> self.bits) & 0xFF)
+        self.acc &= (1 << self.bits) - 1
+
+    def finish(self):
+        if self.bits:
+            self.out.append((self.acc << (8 - self.bits)) & 0xFF)
+            self.bits = 0
+        return bytes(self.out)
+
+
+def compress(data, window_bits=DEFAULT_WINDOW_BITS, lookahead_bits=DEFAULT_LOOKAHEAD_BITS):
+    """Greedy LZSS with hash chains over 3 byte prefixes."""
+    window = 1 << window_bits
+    max_length = 1 << lookahead_bits
+    # A back-reference pays off once it is shorter than its literals
+    min_length = (1 + window_bits + lookahead_bits) // 9 + 1
+
+    writer = BitWriter()
+    heads = {}
+    chain = [0] * len(data)
+    size = len(data)
+    pos = 0
+
+    def insert(p):
+        if p + 3 <= size:
+            key = data[p:p + 3]
+            chain[p] = heads.get(key, -1)
+            heads[key] = p
+
+    while pos < size:
+        best_length = 0
+        best_distance = 0
+        if pos + 3 <= size:
+            limit = min(max_length, size - pos)
+            candidate = heads.get(data[pos:pos + 3], -1)
+            steps = 0
+            while candidate >= 0 and pos - candidate <= window and steps < MAX_CHAIN:
+                length = 3
+                while length < limit and data[candidate + length] == data[pos + length]:
+                    length += 1
+                if length > best_length:
+                    best_length = length
+                    best_distance = pos - candidate
+                    if length == limit:
+                        break
+                candidate = chain[candidate]
+                steps += 1
+
+        if best_length >= min_length:
+            writer.write(0, 1)
+            writer.write(best_distance - 1, window_bits)
+            writer.write(best_length - 1, lookahead_bits)
+            for p in range(pos, pos + best_length):
+                insert(p)
+            pos += best_length
+        else:
+            writer.write(0x100 | data[pos], 9)
+            insert(pos)
+            pos += 1
+
+    header = MAGIC + struct.pack("<BBHI", window_bits, lookahead_bits, 0, size)
+    return header + writer.finish()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("input")
+    parser.add_argument("output", nargs="?")
+    parser.add_argument("--window", type=int, default=DEFAULT_WINDOW_BITS)
+    parser.add_argument("--lookahead", type=int, default=DEFAULT_LOOKAHEAD_BITS)
+    args = parser.parse_args()
+
+    if not 4 <= args.lookahead < args.window <= 13:
+        parser.error("need 4 <= lookahead < window <= 13")
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    packed = compress(data, args.window, args.lookahead)
+
+    output = args.output or args.input + ".hs"
+    with open(output, "wb") as f:
+        f.write(packed)
+    print("%s: %d -> %d bytes (%.1f%%)" % (os.path.basename(output), len(data), len(packed),
+                                         100.0 * len(packed) / max(1, len(data))))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""
+Generate src/timezone_data.cpp from a compiled IANA zoneinfo tree.
+
+Every TZif (v2+) file ends with the POSIX TZ string that describes the zone's
+current rules - that is all the firmware needs. The output is a flash-resident
+table sorted by zone name for binary search:
+  - region prefixes ("America", "Europe", ...) stored once, 1 byte per zone
+  - names and POSIX rules stored as NUL-separated blobs, rules deduplicated
+  - small index entries referencing both blobs by offset
+
+Usage: python3 scripts/generate_timezones.py [zoneinfo_dir] [output_file]
+"""
+
+import os
+import sys
+
+DEFAULT_ZONEINFO = "/usr/share/zoneinfo"
+DEFAULT_OUTPUT = os.path.normpath(os.path.join(os.path.dirname(__file__), "..", "src", "timezone_data.cpp"))
+
+# Files in the zoneinfo tree that are not zones
+SKIP = {"posixrules", "localtime", "Factory", "leapseconds", "leap-seconds.list",
+        "tzdata.zi", "zone.tab", "zone1970.tab", "zonenow.tab", "iso3166.tab",
+        "SECURITY", "+VERSION"}
+SKIP_DIRS = {"posix", "right"}
+
+
+def read_posix_footer(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if not data.startswith(b"TZif") or data[4:5] in (b"\0", b""):
+        return None  # Not TZif or version 1 without footer
+    footer = data.rstrip(b"\n").rsplit(b"\n", 1)
+    if len(footer) != 2:
+        return None
+    rule = footer[1].decode("ascii")
+    return rule or None
+
+
+def read_version(zoneinfo):
+    for candidate in ("+VERSION", "tzdata.zi"):
+        path = os.path.join(zoneinfo, candidate)
+        if os.path.isfile(path):
+            with open(path) as f:
+                line = f.readline().strip()
+            return line.replace("# version", "").strip()
+    return "unknown"
+
+
+def collect_zones(zoneinfo):
+    zones = {}
+    for root, dirs, files in os.walk(zoneinfo):
+        dirs[:] = [d for d in dirs if d not in SKIP_DIRS]
+        for name in files:
+            if name in SKIP or name.endswith(".tab"):
+                continue
+            path = os.path.join(root, name)
+            zone = os.path.relpath(path, zoneinfo)
+            rule = read_posix_footer(path)
+            if rule:
+                zones[zone] = rule
+    return zones
+
+
+def c_string(text):
+    return text.replace("\\", "\\\\").replace("\"", "\\\"")
+
+
+def main():
+    zoneinfo = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_ZONEINFO
+    output = sys.argv[2] if len(sys.argv) > 2 else DEFAULT_OUTPUT
+
+    zones = collect_zones(zoneinfo)
+    if not zones:
+        sys.exit(f"No TZif v2+ files found in {zoneinfo}")
+
+    names = sorted(zones)  # Byte order, matches strcmp in the firmware
+
+    regions = [""]
+    entries = []
+    name_blob, name_offsets = [], {}
+    rule_blob, rule_offsets = [], {}
+    name_size = rule_size = 0
+
+    for zone in names:
+        # Split at the first slash: "America/Argentina/Salta" -> "America", "Argentina/Salta"
+        region, rest = zone.split("/", 1) if "/" in zone else ("", zone)
+        if region not in regions:
+            regions.append(region)
+
+        name_offsets[zone] = name_size
+        name_blob.append(rest)
+        name_size += len(rest) + 1
+
+        rule = zones[zone]
+        if rule not in rule_offsets:
+            rule_offsets[rule] = rule_size
+            rule_blob.append(rule)
+            rule_size += len(rule) + 1
+
+        entries.append((name_offsets[zone], regions.index(region), rule_offsets[rule]))
+
+    if len(regions) > 255 or name_size > 0xFFFF or rule_size > 0xFFFF:
+        sys.exit("Table exceeds the compact index format")
+
+    lines = []
+    lines.append("// Generated by scripts/generate_timezones.py - do not edit by hand.")
+    lines.append(f"// Source: IANA tzdata {read_version(zoneinfo)}, {len(entries)} zones, "
+                 f"{len(rule_blob)} distinct rules")
+    lines.append("")
+    lines.append("#include \"timezone_database.h\"")
+    lines.append("")
+    lines.append(f"const char TimezoneDatabase::version[] = \"{read_version(zoneinfo)}\";")
+    lines.append("")
+    lines.append("const char* const TimezoneDatabase::regions[] = {")
+    for region in regions:
+        lines.append(f"    \"{c_string(region)}\",")
+    lines.append("};")
+    lines.append("")
+    lines.append("// Zone names without their region prefix, NUL separated")
+    lines.append("const char TimezoneDatabase::names[] =")
+    for rest in name_blob:
+        lines.append(f"    \"{c_string(rest)}\\0\"")
+    lines.append("    ;")
+    lines.append("")
+    lines.append("// Deduplicated POSIX TZ rules, NUL separated")
+    lines.append("const char TimezoneDatabase::rules[] =")
+    for rule in rule_blob:
+        lines.append(f"    \"{c_string(rule)}\\0\"")
+    lines.append("    ;")
+    lines.append("")
+    lines.append("// Sorted by full zone name: {name offset, rule offset, region}")
+    lines.append("const TimezoneDatabase::Entry TimezoneDatabase::entries[] = {")
+    for zone, (name_off, region_idx, rule_off) in zip(names, entries):
+        lines.append(f"    {{{name_off}, {rule_off}, {region_idx}}}, // {zone}")
+    lines.append("};")
+    lines.append("")
+    lines.append("const int TimezoneDatabase::entryCount = sizeof(entries) / sizeof(entries[0]);")
+    lines.append("")
+
+    with open(output, "w") as f:
+        f.write("\n".join(lines))
+
+    print(f"Wrote {len(entries)} zones ({len(rule_blob)} rules, "
+          f"{name_size + rule_size + 6 * len(entries)} bytes of tables) to {output}")
+
+
+if __name__ == "__main__":
+    main()
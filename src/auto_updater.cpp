@@ -1,8 +1,24 @@
 #include "auto_updater.h"
 #include "led_controller.h"
-#include <Update.h>
+#include "time_manager.h"
+#include "tls_arbiter.h"
+#include "settings_store.h"
 
-AutoUpdater::AutoUpdater() : updateAvailable(false), lastUpdateCheck(0), ledController(nullptr) {
+// Retry delay after a failed check: 1 minute, doubling up to 1 hour
+static const unsigned long CHECK_RETRY_DELAY_MS = 60000;
+static const unsigned long MAX_CHECK_RETRY_DELAY_MS = 60 * 60 * 1000;
+// Without a valid clock the rate limit window is assumed to reset within an hour
+static const unsigned long RATE_LIMIT_FALLBACK_S = 60 * 60;
+// A server asking for a longer pause than a day is not taken literally
+static const unsigned long MAX_RATE_LIMIT_HOLD_S = 24 * 60 * 60;
+// Clocks held back together do not all come back in the same second
+static const unsigned long RATE_LIMIT_SPREAD_MS = 5 * 60 * 1000;
+// Anything earlier means the clock has not been set yet
+static const time_t MIN_VALID_EPOCH = 1700000000;
+
+AutoUpdater::AutoUpdater() : updateAvailable(false), checkBackoff("update", CHECK_RETRY_DELAY_MS, MAX_CHECK_RETRY_DELAY_MS),
+    ledController(nullptr), progressCallback(nullptr), lastReportedPercent(-1), lastCheckHeap(0), peakCheckHeap(0), lastParseMs(0),
+    holdStart(0), holdMs(0), checks(0), notModified(0), releaseFetches(0), rateLimited(0), rateRemaining(-1) {
 }
 
 void AutoUpdater::begin(const char* githubRepo, const char* currentVersion, unsigned long checkInterval, LEDController* ledCtrl) {
@@ -11,6 +27,11 @@ void AutoUpdater::begin(const char* githubRepo, const char* currentVersion, unsi
     updateCheckInterval = checkInterval;
     ledController = ledCtrl;
     
+    // The last release seen; a check only downloads it again when it changed
+    latestVersion = settingsStore.getString("upd.version");
+    downloadUrl = settingsStore.getString("upd.url");
+    checksumUrl = settingsStore.getString("upd.sums");
+    
     Serial.println("Auto-updater initialized:");
     Serial.println("GitHub URL: " + githubUpdateUrl);
     Serial.println("Current Version: " + this->currentVersion);
@@ -26,16 +47,32 @@ void AutoUpdater::checkForUpdates(bool force) {
         return;
     }
     
-    // Check if enough time has passed (unless forced)
-    if (!force && millis() - lastUpdateCheck < updateCheckInterval) {
-        Serial.printf("AUTO UPDATE DEBUG: Update check interval not reached (last check %lu ms ago), skipping\n", 
-                     millis() - lastUpdateCheck);
+    // A rate limit or Retry-After from GitHub holds even forced checks back
+    if (isRateLimited()) {
+        Serial.printf("AUTO UPDATE DEBUG: GitHub asked to wait, next check in %lu s\n",
+                     (holdMs - (millis() - holdStart)) / 1000);
+        return;
+    }
+    
+    // Check if the next check is due (unless forced)
+    if (!force && !checkBackoff.isDue()) {
+        Serial.printf("AUTO UPDATE DEBUG: Next update check in %lu s, skipping\n",
+                     checkBackoff.getTimeUntilDue() / 1000);
         return;
     }
     
     Serial.println("AUTO UPDATE DEBUG: Starting update check...");
     Serial.printf("AUTO UPDATE DEBUG: GitHub URL: %s\n", githubUpdateUrl.c_str());
-    lastUpdateCheck = millis();
+    
+    // Heap before the check, for the peak the handshake and parse add on top
+    size_t freeBefore = ESP.getFreeHeap();
+    size_t minFreeBefore = ESP.getMinFreeHeap();
+    
+    if (!tlsArbiter.beginHandshake("update")) {
+        checkBackoff.recordFailure();
+        Serial.printf("AUTO UPDATE DEBUG: No room for a TLS handshake, retrying in %lu s\n", checkBackoff.getCurrentDelay() / 1000);
+        return;
+    }
     
     WiFiClientSecure client;
     client.setInsecure(); // Skip SSL certificate verification for GitHub API
@@ -44,32 +81,64 @@ void AutoUpdater::checkForUpdates(bool force) {
     bool beginSuccess = http.begin(client, githubUpdateUrl);
     if (!beginSuccess) {
         Serial.println("AUTO UPDATE DEBUG: Failed to begin HTTP client");
+        tlsArbiter.endSession("update");
+        checkBackoff.recordFailure();
         return;
     }
     
     http.addHeader("User-Agent", "qlockthree-ESP32");
     http.setTimeout(15000); // 15 second timeout
+    http.useHTTP10(true);   // No chunked encoding, so the body can be parsed straight from the stream
+    
+    // Only ask for the release if it changed since the one we know
+    String etag = settingsStore.getString("upd.etag");
+    if (etag.length() > 0 && latestVersion.length() > 0) {
+        http.addHeader("If-None-Match", etag);
+    }
     
+    // The Date header doubles as a secondary time source
+    const char* headerKeys[] = {"Date", "ETag", "Retry-After", "X-RateLimit-Remaining", "X-RateLimit-Reset"};
+    http.collectHeaders(headerKeys, 5);
+    
+    bool checked = false;
+    bool install = false;
+    checks++;
     Serial.println("AUTO UPDATE DEBUG: Sending HTTP GET request...");
+    unsigned long requestStart = millis();
     int httpCode = http.GET();
+    tlsArbiter.endHandshake("update", httpCode > 0);
     Serial.printf("AUTO UPDATE DEBUG: HTTP response code: %d\n", httpCode);
+    if (httpCode > 0) {
+        TimeManager::reportHttpDate(http.header("Date"), requestStart);
+        applyRateLimit(http);
+    }
     
-    if (httpCode == HTTP_CODE_OK) {
-        String payload = http.getString();
-        Serial.printf("AUTO UPDATE DEBUG: Payload length: %d bytes\n", payload.length());
+    if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+        checked = true;
+        notModified++;
+        Serial.printf("AUTO UPDATE DEBUG: Release unchanged, latest version still %s\n", latestVersion.c_str());
+    } else if (httpCode == HTTP_CODE_OK) {
+        Serial.printf("AUTO UPDATE DEBUG: Payload length: %d bytes\n", http.getSize());
         
-        if (payload.length() > 100) {
-            Serial.printf("AUTO UPDATE DEBUG: Payload preview: %s...\n", payload.substring(0, 100).c_str());
-        }
+        // Only the version and the asset names and URLs are kept; release
+        // notes and the rest of every asset are skipped while reading
+        JsonDocument filter;
+        filter["tag_name"] = true;
+        filter["assets"][0]["name"] = true;
+        filter["assets"][0]["browser_download_url"] = true;
         
-        // Parse JSON response
         JsonDocument doc;
-        DeserializationError error = deserializeJson(doc, payload);
+        unsigned long parseStart = millis();
+        DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
+        lastParseMs = millis() - parseStart;
+        recordCheckHeap(freeBefore, minFreeBefore);
         
         if (!error) {
             Serial.println("AUTO UPDATE DEBUG: JSON parsed successfully");
             
             if (doc.containsKey("tag_name")) {
+                checked = true;
+                releaseFetches++;
                 latestVersion = doc["tag_name"].as<String>();
                 Serial.printf("AUTO UPDATE DEBUG: Found tag_name: %s\n", latestVersion.c_str());
                 
@@ -79,57 +148,46 @@ void AutoUpdater::checkForUpdates(bool force) {
                     Serial.printf("AUTO UPDATE DEBUG: Removed 'v' prefix, version now: %s\n", latestVersion.c_str());
                 }
                 
-                Serial.print("Latest version: ");
-                Serial.println(latestVersion);
-                Serial.print("Current version: ");
-                Serial.println(currentVersion);
+                // Find download URL for main firmware binary (not bootloader or partitions)
+                JsonArray assets = doc["assets"];
+                Serial.printf("AUTO UPDATE DEBUG: Found %d assets\n", assets.size());
                 
-                // Compare versions
-                String comparison = compareVersions(currentVersion, latestVersion);
-                Serial.printf("AUTO UPDATE DEBUG: Version comparison result: %s\n", comparison.c_str());
-                
-                if (comparison == "outdated") {
-                    updateAvailable = true;
-                    Serial.println("AUTO UPDATE DEBUG: Update available, looking for assets...");
-                    
-                    // Find download URL for main firmware binary (not bootloader or partitions)
-                    JsonArray assets = doc["assets"];
-                    Serial.printf("AUTO UPDATE DEBUG: Found %d assets\n", assets.size());
+                downloadUrl = "";
+                checksumUrl = "";
+                String compressedUrl = "";
+                for (JsonObject asset : assets) {
+                    String name = asset["name"].as<String>();
+                    Serial.printf("AUTO UPDATE DEBUG: Asset: %s\n", name.c_str());
                     
-                    downloadUrl = "";
-                    for (JsonObject asset : assets) {
-                        String name = asset["name"].as<String>();
-                        Serial.printf("AUTO UPDATE DEBUG: Asset: %s\n", name.c_str());
-                        
-                        // Look specifically for the main firmware file, not bootloader or partitions
-                        if (name.startsWith("qlockthree-esp32c3-") && name.endsWith(".bin") && 
-                            name.indexOf("complete") == -1 && name.indexOf("bootloader") == -1 && name.indexOf("partition") == -1) {
-                            downloadUrl = asset["browser_download_url"].as<String>();
-                            Serial.printf("AUTO UPDATE DEBUG: Found firmware binary: %s\n", downloadUrl.c_str());
-                            break;
-                        }
+                    // Look specifically for the main firmware file, not bootloader or partitions
+                    bool firmware = name.startsWith("qlockthree-esp32c3-") && name.indexOf("complete") == -1 &&
+                                    name.indexOf("bootloader") == -1 && name.indexOf("partition") == -1;
+                    if (firmware && name.endsWith(".bin")) {
+                        downloadUrl = asset["browser_download_url"].as<String>();
+                        Serial.printf("AUTO UPDATE DEBUG: Found firmware binary: %s\n", downloadUrl.c_str());
+                    } else if (firmware && name.endsWith(".bin.hs")) {
+                        compressedUrl = asset["browser_download_url"].as<String>();
+                        Serial.printf("AUTO UPDATE DEBUG: Found compressed firmware: %s\n", compressedUrl.c_str());
+                    } else if (name == "checksums.txt") {
+                        checksumUrl = asset["browser_download_url"].as<String>();
                     }
-                    
-                    if (downloadUrl.length() > 0) {
-                        Serial.println("Update available! Download URL: " + downloadUrl);
-                        
-                        // Automatically perform update
-                        performUpdate();
-                    } else {
-                        Serial.println("AUTO UPDATE DEBUG: No suitable firmware file found in assets");
-                        updateAvailable = false;
-                    }
-                    
-                } else {
-                    updateAvailable = false;
-                    Serial.println("Firmware is up to date");
                 }
+                
+                // The compressed image takes about half the download time
+                if (compressedUrl.length() > 0) {
+                    downloadUrl = compressedUrl;
+                }
+                
+                // Remembered with its ETag, so later checks can get a 304
+                settingsStore.setString("upd.etag", http.header("ETag"));
+                settingsStore.setString("upd.version", latestVersion);
+                settingsStore.setString("upd.url", downloadUrl);
+                settingsStore.setString("upd.sums", checksumUrl);
             } else {
                 Serial.println("AUTO UPDATE DEBUG: No 'tag_name' field found in JSON response");
             }
         } else {
             Serial.printf("AUTO UPDATE DEBUG: Failed to parse JSON response: %s\n", error.c_str());
-            Serial.printf("AUTO UPDATE DEBUG: Raw payload: %s\n", payload.c_str());
         }
     } else if (httpCode > 0) {
         Serial.printf("AUTO UPDATE DEBUG: HTTP GET failed with code: %d\n", httpCode);
@@ -142,6 +200,128 @@ void AutoUpdater::checkForUpdates(bool force) {
     }
     
     http.end();
+    client.stop();
+    tlsArbiter.endSession("update");
+    
+    if (checked) {
+        Serial.print("Latest version: ");
+        Serial.println(latestVersion);
+        Serial.print("Current version: ");
+        Serial.println(currentVersion);
+        
+        // Compare versions; a cached release is compared again, the
+        // firmware may have changed since it was fetched
+        String comparison = compareVersions(currentVersion, latestVersion);
+        Serial.printf("AUTO UPDATE DEBUG: Version comparison result: %s\n", comparison.c_str());
+        
+        if (comparison == "outdated") {
+            if (downloadUrl.length() > 0) {
+                updateAvailable = true;
+                Serial.println("Update available! Download URL: " + downloadUrl);
+                
+                // Installed below, once this session is closed
+                install = true;
+            } else {
+                Serial.println("AUTO UPDATE DEBUG: No suitable firmware file found in assets");
+                updateAvailable = false;
+            }
+        } else {
+            updateAvailable = false;
+            Serial.println("Firmware is up to date");
+        }
+    }
+    
+    // The install runs once this session is closed. A download that did not
+    // finish resumes with the next attempt; failed installs in a row back
+    // off like failed checks instead of restarting the interval each time
+    if (install && !performUpdate()) {
+        checkBackoff.recordFailure();
+        Serial.printf("AUTO UPDATE DEBUG: Update not installed (%u in a row), next attempt in %lu s\n",
+                     (unsigned)checkBackoff.getConsecutiveFailures(), checkBackoff.getCurrentDelay() / 1000);
+    } else if (isRateLimited()) {
+        checkBackoff.recordSuccess(holdMs);
+        Serial.printf("AUTO UPDATE DEBUG: Rate limited by GitHub, next check in %lu s\n", holdMs / 1000);
+    } else if (checked) {
+        checkBackoff.recordSuccess(jitteredInterval());
+        Serial.printf("AUTO UPDATE DEBUG: Next check in %lu s\n", checkBackoff.getCurrentDelay() / 1000);
+    } else {
+        checkBackoff.recordFailure();
+        Serial.printf("AUTO UPDATE DEBUG: Check failed, retrying in %lu s\n", checkBackoff.getCurrentDelay() / 1000);
+    }
+}
+
+void AutoUpdater::applyRateLimit(HTTPClient& http) {
+    // Retry-After comes with 403 and 429 answers to too many requests
+    unsigned long waitS = 0;
+    String retryAfter = http.header("Retry-After");
+    if (retryAfter.length() > 0) {
+        waitS = retryAfter.toInt();
+    }
+    
+    // With the quota used up, wait for the window to reset
+    String remaining = http.header("X-RateLimit-Remaining");
+    if (remaining.length() > 0) {
+        rateRemaining = remaining.toInt();
+        if (rateRemaining == 0) {
+            time_t reset = (time_t)http.header("X-RateLimit-Reset").toInt();
+            time_t now = time(nullptr);
+            unsigned long untilReset = (now > MIN_VALID_EPOCH && reset > now) ? (unsigned long)(reset - now) : RATE_LIMIT_FALLBACK_S;
+            if (untilReset > waitS) {
+                waitS = untilReset;
+            }
+        }
+    }
+    
+    if (waitS == 0) {
+        return;
+    }
+    if (waitS > MAX_RATE_LIMIT_HOLD_S) {
+        waitS = MAX_RATE_LIMIT_HOLD_S;
+    }
+    rateLimited++;
+    holdStart = millis();
+    holdMs = waitS * 1000 + random(RATE_LIMIT_SPREAD_MS + 1);
+}
+
+bool AutoUpdater::isRateLimited() const {
+    return holdMs > 0 && millis() - holdStart < holdMs;
+}
+
+unsigned long AutoUpdater::jitteredInterval() const {
+    // Spread by a quarter either way, so clocks that booted together drift apart
+    unsigned long spread = updateCheckInterval / 4;
+    return updateCheckInterval - spread + random(2 * spread + 1);
+}
+
+void AutoUpdater::recordCheckHeap(size_t freeBefore, size_t minFreeBefore) {
+    // The heap low-water mark only moves when the check set a new low;
+    // otherwise the heap still held with the document parsed is the estimate
+    size_t lowest = ESP.getFreeHeap();
+    size_t minFree = ESP.getMinFreeHeap();
+    if (minFree < minFreeBefore && minFree < lowest) {
+        lowest = minFree;
+    }
+    lastCheckHeap = freeBefore > lowest ? freeBefore - lowest : 0;
+    if (lastCheckHeap > peakCheckHeap) {
+        peakCheckHeap = lastCheckHeap;
+    }
+    Serial.printf("AUTO UPDATE DEBUG: Check used %u bytes of heap at peak, parse took %lu ms\n",
+                  (unsigned)lastCheckHeap, lastParseMs);
+}
+
+void AutoUpdater::writeStatusJSON(JsonWriter& json) {
+    json.add("check_heap", (unsigned long)lastCheckHeap);
+    json.add("check_heap_peak", (unsigned long)peakCheckHeap);
+    json.add("parse_ms", lastParseMs);
+    json.add("checks", (unsigned long)checks);
+    json.add("not_modified", (unsigned long)notModified);
+    json.add("fetched", (unsigned long)releaseFetches);
+    json.add("rate_limited", (unsigned long)rateLimited);
+    json.add("rate_remaining", rateRemaining);
+    json.add("hold_s", isRateLimited() ? (holdMs - (millis() - holdStart) + 999) / 1000 : 0UL);
+    json.beginObject("download");
+    firmwareDownload.writeStatusJSON(json);
+    json.endObject();
 }
 
 bool AutoUpdater::performUpdate() {
@@ -150,9 +330,33 @@ bool AutoUpdater::performUpdate() {
         return false;
     }
     
+    if (ledController) {
+        ledController->setUpdateStatusLED(2); // Purple breathing - downloading update
+        ledController->showUpdateMode();
+    }
     return downloadAndInstallUpdate(downloadUrl);
 }
 
+void AutoUpdater::setProgressCallback(UpdateProgressCallback callback) {
+    progressCallback = callback;
+}
+
+void AutoUpdater::reportProgress(UpdateStage stage, size_t written, size_t total) {
+    if (!progressCallback) {
+        return;
+    }
+
+    // Update calls back for every flash block; pass on whole percent steps only
+    if (stage == UpdateStage::DOWNLOADING) {
+        int percent = total > 0 ? (int)((uint64_t)written * 100 / total) : 0;
+        if (percent == lastReportedPercent) {
+            return;
+        }
+        lastReportedPercent = percent;
+    }
+    progressCallback(stage, written, total);
+}
+
 bool AutoUpdater::downloadAndInstallUpdate(String url) {
     if (url.length() == 0) {
         Serial.println("No download URL available");
@@ -161,59 +365,36 @@ bool AutoUpdater::downloadAndInstallUpdate(String url) {
     
     Serial.println("Starting firmware update from: " + url);
     
-    WiFiClientSecure client;
-    client.setInsecure(); // Skip SSL certificate verification for GitHub downloads
-    
-    HTTPClient http;
-    http.begin(client, url);
-    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS); // Handle GitHub redirects
-    http.setUserAgent("qlockthree-ESP32");
-    http.setTimeout(30000); // 30 second timeout
-    
-    int httpCode = http.GET();
-    
-    if (httpCode == HTTP_CODE_OK) {
-        int contentLength = http.getSize();
-        
-        if (contentLength > 0) {
-            bool canBegin = Update.begin(contentLength);
-            
-            if (canBegin) {
-                WiFiClient* client = http.getStreamPtr();
-                
-                Serial.println("Starting update...");
-                size_t written = Update.writeStream(*client);
-                
-                if (written == contentLength) {
-                    Serial.println("Update successful!");
-                } else {
-                    Serial.printf("Update failed. Expected %d bytes, got %d bytes\n", contentLength, written);
-                }
-                
-                if (Update.end()) {
-                    if (Update.isFinished()) {
-                        Serial.println("Update finished. Showing success feedback...");
-                        showUpdateSuccessFeedback();
-                        Serial.println("Restarting...");
-                        ESP.restart();
-                        return true;
-                    } else {
-                        Serial.println("Update not finished");
-                    }
-                } else {
-                    Serial.printf("Update error: %s\n", Update.errorString());
-                }
-            } else {
-                Serial.println("Not enough space for update");
-            }
-        } else {
-            Serial.println("Content length is 0");
+    // The digest published with the release; older releases have none
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    bool verify = checksumUrl.length() > 0;
+    if (verify) {
+        String fileName = url.substring(url.lastIndexOf('/') + 1);
+        if (!FirmwareDownload::fetchChecksum(checksumUrl, fileName, digest)) {
+            Serial.println("Published checksum not available, update postponed");
+            reportProgress(UpdateStage::FAILED, 0, 0);
+            return false;
         }
     } else {
-        Serial.printf("HTTP GET failed with code: %d\n", httpCode);
+        Serial.println("Release publishes no checksums, installing unverified");
     }
     
-    http.end();
+    Serial.println("Starting update...");
+    lastReportedPercent = -1;
+    FirmwareDownload::Result result = firmwareDownload.run(url, verify ? digest : nullptr, [this](size_t done, size_t total) {
+        reportProgress(UpdateStage::DOWNLOADING, done, total);
+    });
+    
+    if (result == FirmwareDownload::Result::INSTALLED) {
+        Serial.println("Update finished. Showing success feedback...");
+        reportProgress(UpdateStage::INSTALLED, firmwareDownload.getWritten(), firmwareDownload.getTotal());
+        showUpdateSuccessFeedback();
+        Serial.println("Restarting...");
+        ESP.restart();
+        return true;
+    }
+    
+    reportProgress(UpdateStage::FAILED, firmwareDownload.getWritten(), firmwareDownload.getTotal());
     return false;
 }
 
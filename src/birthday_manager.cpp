@@ -1,13 +1,12 @@
 #include "birthday_manager.h"
+#include "settings_store.h"
 
 BirthdayManager::BirthdayManager() : displayMode(ALTERNATE) {
 }
 
 void BirthdayManager::begin() {
-    preferences.begin("birthdays", false);
-
     // Load display mode (default to ALTERNATE if not set)
-    displayMode = static_cast<DisplayMode>(preferences.getUChar("mode", ALTERNATE));
+    displayMode = static_cast<DisplayMode>(settingsStore.getUInt("bday.mode", ALTERNATE));
 
     // Load birthdays
     loadBirthdays();
@@ -19,7 +18,7 @@ void BirthdayManager::begin() {
 void BirthdayManager::loadBirthdays() {
     birthdays.clear();
 
-    String datesStr = preferences.getString("dates", "");
+    String datesStr = settingsStore.getString("bday.dates", "");
     if (datesStr.length() == 0) {
         return;
     }
@@ -56,7 +55,7 @@ void BirthdayManager::saveBirthdays() {
         snprintf(buf, sizeof(buf), "%04d", birthdays[i]);
         datesStr += buf;
     }
-    preferences.putString("dates", datesStr);
+    settingsStore.setString("bday.dates", datesStr);
     Serial.printf("Saved birthdays: %s\n", datesStr.c_str());
 }
 
@@ -129,22 +128,26 @@ uint8_t BirthdayManager::getBirthdayCount() const {
     return birthdays.size();
 }
 
-String BirthdayManager::getBirthdaysJSON() const {
-    String json = "{\"mode\":" + String(displayMode) + ",\"dates\":[";
+void BirthdayManager::writeBirthdaysJSON(JsonWriter& json) const {
+    json.beginObject();
+    json.add("mode", (int)displayMode);
+    json.beginArray("dates");
 
     for (size_t i = 0; i < birthdays.size(); i++) {
-        if (i > 0) json += ",";
         uint8_t month, day;
         fromStorageFormat(birthdays[i], month, day);
-        json += "{\"month\":" + String(month) + ",\"day\":" + String(day) + "}";
+        json.beginObject();
+        json.add("month", month);
+        json.add("day", day);
+        json.endObject();
     }
 
-    json += "]}";
-    return json;
+    json.endArray();
+    json.endObject();
 }
 
 void BirthdayManager::save() {
-    preferences.putUChar("mode", static_cast<uint8_t>(displayMode));
+    settingsStore.setUInt("bday.mode", static_cast<uint8_t>(displayMode));
     saveBirthdays();
 }
 
@@ -0,0 +1,37 @@
+#include "checksum_list.h"
+#include <ctype.h>
+
+bool ChecksumList::find(const String& listing, const String& fileName, uint8_t digest[DIGEST_SIZE]) {
+    int lineStart = 0;
+    while (lineStart < (int)listing.length()) {
+        int lineEnd = listing.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            lineEnd = listing.length();
+        }
+        String line = listing.substring(lineStart, lineEnd);
+        line.trim();
+        int nameStart = 2 * DIGEST_SIZE + 1;
+        if ((int)line.length() > nameStart && line[nameStart - 1] == ' ') {
+            if (line[nameStart] == ' ' || line[nameStart] == '*') {
+                nameStart++;
+            }
+            if (line.substring(nameStart) == fileName && parseDigest(line.c_str(), digest)) {
+                return true;
+            }
+        }
+        lineStart = lineEnd + 1;
+    }
+    return false;
+}
+
+bool ChecksumList::parseDigest(const char* hex, uint8_t digest[DIGEST_SIZE]) {
+    for (size_t i = 0; i < DIGEST_SIZE; i++) {
+        char byteHex[3] = {hex[2 * i], hex[2 * i + 1], 0};
+        char* end;
+        digest[i] = (uint8_t)strtoul(byteHex, &end, 16);
+        if (*end != 0 || !isxdigit((unsigned char)byteHex[0])) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -2,32 +2,47 @@
 
 const char* CloudConfig::NAMESPACE = "cloud";
 
-void CloudConfig::begin() {
-    // Just initialize - actual operations open/close as needed
-    Serial.println("CloudConfig initialized");
+// Window the NVS access rate is reported over
+static const unsigned long ACCESS_WINDOW_MS = 60000;
+
+CloudConfig::CloudConfig() :
+    configured(false),
+    nvsAccesses(0),
+    windowAccesses(0),
+    lastMinuteAccesses(0),
+    windowStart(0) {
 }
 
-CloudSettings CloudConfig::load() {
-    CloudSettings settings;
-
-    preferences.begin(NAMESPACE, true); // Read-only
-
-    preferences.getString("mqtt_url", settings.mqttUrl, sizeof(settings.mqttUrl));
-    preferences.getString("mqtt_user", settings.mqttUsername, sizeof(settings.mqttUsername));
-    preferences.getString("mqtt_pass", settings.mqttPassword, sizeof(settings.mqttPassword));
-    preferences.getString("api_url", settings.apiUrl, sizeof(settings.apiUrl));
-    preferences.getString("owner_id", settings.ownerId, sizeof(settings.ownerId));
-    settings.cloudEnabled = preferences.getBool("enabled", false);
-    settings.isPaired = preferences.getBool("paired", false);
+void CloudConfig::begin() {
+    windowStart = millis();
+
+    // The only read; everything after this is served from RAM
+    if (open(true)) {
+        preferences.getString("mqtt_url", settings.mqttUrl, sizeof(settings.mqttUrl));
+        preferences.getString("mqtt_user", settings.mqttUsername, sizeof(settings.mqttUsername));
+        preferences.getString("mqtt_pass", settings.mqttPassword, sizeof(settings.mqttPassword));
+        preferences.getString("api_url", settings.apiUrl, sizeof(settings.apiUrl));
+        preferences.getString("owner_id", settings.ownerId, sizeof(settings.ownerId));
+        settings.cloudEnabled = preferences.getBool("enabled", false);
+        settings.isPaired = preferences.getBool("paired", false);
+        preferences.end();
+    }
+    updateConfigured();
 
-    preferences.end();
+    Serial.printf("CloudConfig initialized (%s)\n", configured ? "configured" : "not configured");
+}
 
+CloudSettings CloudConfig::load() {
     return settings;
 }
 
-void CloudConfig::save(const CloudSettings& settings) {
-    preferences.begin(NAMESPACE, false); // Read-write
+void CloudConfig::save(const CloudSettings& newSettings) {
+    settings = newSettings;
+    updateConfigured();
 
+    if (!open(false)) {
+        return;
+    }
     preferences.putString("mqtt_url", settings.mqttUrl);
     preferences.putString("mqtt_user", settings.mqttUsername);
     preferences.putString("mqtt_pass", settings.mqttPassword);
@@ -35,39 +50,32 @@ void CloudConfig::save(const CloudSettings& settings) {
     preferences.putString("owner_id", settings.ownerId);
     preferences.putBool("enabled", settings.cloudEnabled);
     preferences.putBool("paired", settings.isPaired);
-
     preferences.end();
 
     Serial.println("Cloud settings saved to NVS");
 }
 
 void CloudConfig::clear() {
-    preferences.begin(NAMESPACE, false);
-    preferences.clear();
-    preferences.end();
-
-    Serial.println("Cloud settings cleared");
-}
-
-bool CloudConfig::isConfigured() {
-    preferences.begin(NAMESPACE, true);
-    bool hasUrl = preferences.isKey("mqtt_url") && strlen(preferences.getString("mqtt_url", "").c_str()) > 0;
-    bool hasCredentials = preferences.isKey("mqtt_user") && strlen(preferences.getString("mqtt_user", "").c_str()) > 0;
-    preferences.end();
-
-    return hasUrl && hasCredentials;
-}
+    settings = CloudSettings();
+    updateConfigured();
 
-bool CloudConfig::isPaired() {
-    preferences.begin(NAMESPACE, true);
-    bool paired = preferences.getBool("paired", false);
-    preferences.end();
+    if (open(false)) {
+        preferences.clear();
+        preferences.end();
+    }
 
-    return paired;
+    Serial.println("Cloud settings cleared");
 }
 
 void CloudConfig::setMqttCredentials(const char* url, const char* username, const char* password) {
-    preferences.begin(NAMESPACE, false);
+    strncpy(settings.mqttUrl, url, sizeof(settings.mqttUrl) - 1);
+    strncpy(settings.mqttUsername, username, sizeof(settings.mqttUsername) - 1);
+    strncpy(settings.mqttPassword, password, sizeof(settings.mqttPassword) - 1);
+    updateConfigured();
+
+    if (!open(false)) {
+        return;
+    }
     preferences.putString("mqtt_url", url);
     preferences.putString("mqtt_user", username);
     preferences.putString("mqtt_pass", password);
@@ -75,13 +83,27 @@ void CloudConfig::setMqttCredentials(const char* url, const char* username, cons
 }
 
 void CloudConfig::setApiUrl(const char* url) {
-    preferences.begin(NAMESPACE, false);
+    if (strcmp(settings.apiUrl, url) == 0) {
+        return;
+    }
+    strncpy(settings.apiUrl, url, sizeof(settings.apiUrl) - 1);
+
+    if (!open(false)) {
+        return;
+    }
     preferences.putString("api_url", url);
     preferences.end();
 }
 
 void CloudConfig::setPaired(bool paired, const char* ownerId) {
-    preferences.begin(NAMESPACE, false);
+    settings.isPaired = paired;
+    if (ownerId != nullptr) {
+        strncpy(settings.ownerId, ownerId, sizeof(settings.ownerId) - 1);
+    }
+
+    if (!open(false)) {
+        return;
+    }
     preferences.putBool("paired", paired);
     if (ownerId != nullptr) {
         preferences.putString("owner_id", ownerId);
@@ -90,7 +112,36 @@ void CloudConfig::setPaired(bool paired, const char* ownerId) {
 }
 
 void CloudConfig::setCloudEnabled(bool enabled) {
-    preferences.begin(NAMESPACE, false);
+    if (settings.cloudEnabled == enabled) {
+        return;
+    }
+    settings.cloudEnabled = enabled;
+
+    if (!open(false)) {
+        return;
+    }
     preferences.putBool("enabled", enabled);
     preferences.end();
 }
+
+uint32_t CloudConfig::getNvsAccessesPerMinute() {
+    unsigned long now = millis();
+    if (now - windowStart >= ACCESS_WINDOW_MS) {
+        // A window without any access reads as 0, not as the last busy one
+        lastMinuteAccesses = now - windowStart < 2 * ACCESS_WINDOW_MS ? windowAccesses : 0;
+        windowAccesses = 0;
+        windowStart = now;
+    }
+    return lastMinuteAccesses;
+}
+
+bool CloudConfig::open(bool readOnly) {
+    getNvsAccessesPerMinute(); // Roll the window over before counting
+    nvsAccesses++;
+    windowAccesses++;
+    return preferences.begin(NAMESPACE, readOnly);
+}
+
+void CloudConfig::updateConfigured() {
+    configured = settings.mqttUrl[0] != '\0' && settings.mqttUsername[0] != '\0';
+}
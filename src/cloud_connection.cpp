@@ -0,0 +1,105 @@
+#include "cloud_connection.h"
+
+CloudConnection::CloudConnection(Transport& transport, RetryBackoff& backoff) :
+    transport(transport),
+    backoff(backoff),
+    step(ConnectStep::IDLE),
+    stepStartTime(0) {
+}
+
+void CloudConnection::loop() {
+    unsigned long timeInStep = millis() - stepStartTime;
+
+    switch (step) {
+        case ConnectStep::IDLE:
+            // Without WiFi an attempt can only fail; the GOT_IP event restarts the schedule
+            if (transport.isNetworkUp() && backoff.isDue()) {
+                connect();
+            }
+            return;
+
+        case ConnectStep::WS_CONNECTING:
+            if (transport.pollSocket()) {
+                Serial.printf("WebSocket connected after %lu ms\n", timeInStep);
+                transport.socketOpened();
+                enterStep(ConnectStep::WS_SETTLING);
+            } else if (timeInStep > WS_CONNECT_TIMEOUT_MS) {
+                fail("WebSocket connection timeout");
+            }
+            return;
+
+        case ConnectStep::WS_SETTLING:
+            if (!transport.pollSocket()) {
+                fail("WebSocket dropped before MQTT handshake");
+            } else if (timeInStep >= WS_SETTLE_MS) {
+                transport.sendConnect();
+                enterStep(ConnectStep::MQTT_CONNECTING);
+            }
+            return;
+
+        case ConnectStep::MQTT_CONNECTING:
+            if (transport.pollMqtt()) {
+                Serial.printf("MQTT connected after %lu ms\n", timeInStep);
+                enterStep(ConnectStep::SUBSCRIBING);
+            } else if (!transport.isSocketUp()) {
+                fail("WebSocket dropped during MQTT handshake");
+            } else if (timeInStep > MQTT_CONNECT_TIMEOUT_MS) {
+                fail("MQTT CONNACK timeout");
+            }
+            return;
+
+        case ConnectStep::SUBSCRIBING:
+            if (!transport.subscribe()) {
+                fail("Subscribe failed");
+                return;
+            }
+
+            // We're connected - reset failure counters
+            backoff.recordSuccess();
+            enterStep(ConnectStep::ONLINE);
+            transport.online();
+            return;
+
+        case ConnectStep::ONLINE:
+            if (!transport.pollMqtt()) {
+                Serial.printf("MQTT connection lost, WebSocket %s\n", transport.isSocketUp() ? "still up" : "down");
+                transport.closed("MQTT connection lost", false);
+                enterStep(ConnectStep::IDLE);
+
+                // Everyone lost the broker at once if it restarted, spread the reconnects
+                backoff.reset();
+                return;
+            }
+            transport.serviceOnline();
+            return;
+    }
+}
+
+bool CloudConnection::connect() {
+    // The TLS handshake runs in loop() until the WebSocket is up
+    if (!transport.openSocket()) {
+        fail("Connection could not start");
+        return false;
+    }
+    enterStep(ConnectStep::WS_CONNECTING);
+    return true;
+}
+
+void CloudConnection::disconnect() {
+    transport.closed(nullptr, false);
+    enterStep(ConnectStep::IDLE);
+}
+
+void CloudConnection::enterStep(ConnectStep next) {
+    step = next;
+    stepStartTime = millis();
+}
+
+void CloudConnection::fail(const char* reason) {
+    transport.closed(reason, true);
+    enterStep(ConnectStep::IDLE);
+
+    backoff.recordFailure();
+    Serial.printf("Connection failed: %s (%u in a row), next attempt in %lu s\n", reason,
+                  (unsigned)backoff.getConsecutiveFailures(), backoff.getCurrentDelay() / 1000);
+}
@@ -1,40 +1,51 @@
 #include "cloud_manager.h"
 #include "led_controller.h"
+#include "time_manager.h"
+#include "tls_arbiter.h"
 
 // Pairing timeout: 10 minutes
 static const unsigned long PAIRING_TIMEOUT_MS = 10 * 60 * 1000;
-// Poll interval during pairing: 3 seconds
+// Poll interval during pairing: 3 seconds, up to 1 minute while the backend fails
 static const unsigned long PAIRING_POLL_INTERVAL_MS = 3000;
-// Status publish interval: 30 seconds
-static const unsigned long STATUS_PUBLISH_INTERVAL_MS = 30000;
-// Reconnect interval: 5 seconds
+static const unsigned long PAIRING_POLL_MAX_BACKOFF_MS = 60000;
+// How often the LED state is compared with the shadow; bounds the delta rate
+static const unsigned long SHADOW_SAMPLE_INTERVAL_MS = 1000;
+// Largest encoded status message, what the 512 byte MQTT buffer leaves after topic and header
+static const size_t MAX_PAYLOAD_SIZE = 448;
+// Telemetry heartbeat while nothing changes: 5 minutes
+static const unsigned long HEARTBEAT_INTERVAL_MS = 5 * 60 * 1000;
+// Reconnect delay: 5 seconds, doubling with every failure in a row
 static const unsigned long RECONNECT_INTERVAL_MS = 5000;
-// Long backoff after failures: 10 minutes
-static const unsigned long LONG_BACKOFF_MS = 10 * 60 * 1000;
-// Max consecutive failures before long backoff
-static const int MAX_CONSECUTIVE_FAILURES = 5;
+// Reconnect delay cap: 10 minutes
+static const unsigned long MAX_RECONNECT_BACKOFF_MS = 10 * 60 * 1000;
 
 CloudManager::CloudManager() :
     ledController(nullptr),
     state(CloudState::DISCONNECTED),
-    mqttConnected(false),
-    lastReconnectAttempt(0),
-    lastStatusPublish(0),
-    consecutiveFailures(0),
-    inLongBackoff(false),
+    apiHandshake(false),
+    reconnectBackoff("cloud", RECONNECT_INTERVAL_MS, MAX_RECONNECT_BACKOFF_MS),
+    connection(*this, reconnectBackoff),
+    encoding(PayloadEncoding::JSON),
+    lastPublishSize(0),
+    lastParseUs(0),
+    commandPool(commandPoolBuffer, sizeof(commandPoolBuffer)),
+    lastShadowSample(0),
+    lastHeartbeat(0),
     pairingActive(false),
     pairingCode(""),
     pairingSessionId(""),
     pairingStartTime(0),
-    lastPairingPoll(0),
+    pairingBackoff("pairing", PAIRING_POLL_INTERVAL_MS, PAIRING_POLL_MAX_BACKOFF_MS),
     commandCallback(nullptr) {
     // Allow insecure HTTPS connections (skip certificate verification)
     wifiClient.setInsecure();
+    wifiClient.setHandshakeTimeout(30);  // 30 second handshake timeout
 }
 
-void CloudManager::begin(LEDController* led) {
+void CloudManager::begin(LEDController* led, const char* firmwareVersion) {
     ledController = led;
     config.begin();
+    shadow.begin(firmwareVersion);
 
     Serial.println("CloudManager initialized");
     Serial.printf("Device ID: %s\n", DeviceIdentity::getDeviceId().c_str());
@@ -57,6 +68,12 @@ void CloudManager::setupMqttCallbacks() {
 }
 
 void CloudManager::loop() {
+    // The shadow follows the LEDs also while offline, the LAN connection reports from it
+    if (millis() - lastShadowSample >= SHADOW_SAMPLE_INTERVAL_MS) {
+        lastShadowSample = millis();
+        sampleShadow();
+    }
+
     // Handle pairing flow
     if (pairingActive) {
         // Check timeout
@@ -67,15 +84,13 @@ void CloudManager::loop() {
         }
 
         // Poll for pairing status
-        if (millis() - lastPairingPoll > PAIRING_POLL_INTERVAL_MS) {
-            lastPairingPoll = millis();
+        if (WiFi.status() == WL_CONNECTED && pairingBackoff.isDue()) {
             if (pollPairingStatus()) {
                 // Pairing complete - credentials received
                 pairingActive = false;
-                consecutiveFailures = 0;
-                inLongBackoff = false;
-                lastReconnectAttempt = 0;  // Allow immediate connection attempt
-                state = CloudState::DISCONNECTED; // Will connect on next loop
+                closeApiSession();
+                reconnectBackoff.retryNow();
+                disconnect(); // Will connect on next loop, with the new credentials
             }
         }
         return;
@@ -86,102 +101,65 @@ void CloudManager::loop() {
         return; // Not configured, nothing to do
     }
 
-    // MQTT update - must be called regularly
-    bool wasConnected = mqtt.isConnected();
-    bool wsConnected = wsClient.isConnected();
-    mqtt.update();
-
-    // Debug: check connection states
-    bool wsStillConnected = wsClient.isConnected();
-    if (wasConnected && !wsStillConnected) {
-        Serial.println("WebSocket connection dropped!");
-    }
-    if (wsConnected && !wsStillConnected) {
-        Serial.println("WebSocket was connected before update(), now disconnected!");
-    }
+    connection.loop();
+}
 
-    // Connection management
-    if (!mqtt.isConnected()) {
-        if (wasConnected) {
-            Serial.printf("MQTT connection lost during update() - error: %d\n", mqtt.getLastError());
-        }
-        mqttConnected = false;
-        if (state == CloudState::CONNECTED) {
-            state = CloudState::DISCONNECTED;
-            Serial.println("MQTT disconnected");
-        }
+bool CloudManager::isNetworkUp() {
+    return WiFi.status() == WL_CONNECTED;
+}
 
-        // Determine reconnect interval based on failure count
-        unsigned long reconnectInterval = inLongBackoff ? LONG_BACKOFF_MS : RECONNECT_INTERVAL_MS;
+bool CloudManager::pollSocket() {
+    wsClient.loop();
+    return wsClient.isConnected();
+}
 
-        if (millis() - lastReconnectAttempt > reconnectInterval) {
-            lastReconnectAttempt = millis();
+bool CloudManager::isSocketUp() {
+    return wsClient.isConnected();
+}
 
-            if (inLongBackoff) {
-                Serial.println("Long backoff period ended, attempting reconnect...");
-                inLongBackoff = false;
-                consecutiveFailures = 0;
-            }
+void CloudManager::socketOpened() {
+    tlsArbiter.endHandshake("cloud", true);
+}
 
-            if (!connect()) {
-                consecutiveFailures++;
-                Serial.printf("Connection failed (%d/%d)\n", consecutiveFailures, MAX_CONSECUTIVE_FAILURES);
+bool CloudManager::pollMqtt() {
+    // MQTT update - must be called regularly
+    mqtt.update();
+    return mqtt.isConnected();
+}
 
-                // Red flash for connection error
-                if (ledController) {
-                    ledController->setCloudStatusLED(4);
-                }
+void CloudManager::online() {
+    state = CloudState::CONNECTED;
 
-                if (consecutiveFailures >= MAX_CONSECUTIVE_FAILURES) {
-                    inLongBackoff = true;
-                    Serial.println("Max failures reached - entering 10 minute backoff");
-                }
-            }
-        }
-        return;
+    // Turn off cloud status LED now that we're connected
+    if (ledController) {
+        ledController->setCloudStatusLED(0);
     }
 
-    // We're connected - reset failure counters
-    if (!mqttConnected) {
-        mqttConnected = true;
-        consecutiveFailures = 0;
-        inLongBackoff = false;
-        state = CloudState::CONNECTED;
-
-        // Turn off cloud status LED now that we're connected
-        if (ledController) {
-            ledController->setCloudStatusLED(0);
-        }
-
-        Serial.println("MQTT connected!");
-
-        // Subscribe to command topic with callback
-        String commandTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/command";
-        Serial.printf("Subscribing to topic: %s\n", commandTopic.c_str());
-        bool subResult = mqtt.subscribe(commandTopic, [this](const char* payload, const size_t size) {
-            Serial.println(">>> MQTT CALLBACK INVOKED <<<");
-            Serial.printf("Command received (%d bytes): %s\n", size, payload);
+    // The backend may have missed changes while we were away, and
+    // has to ask for MessagePack again
+    encoding = PayloadEncoding::JSON;
+    publishStatus();
+}
 
-            // Parse command
-            JsonDocument doc;
-            DeserializationError error = deserializeJson(doc, payload, size);
-            if (!error) {
-                JsonObject command = doc.as<JsonObject>();
-                handleCommand(command);
-            } else {
-                Serial.printf("JSON parse error: %s\n", error.c_str());
-            }
-        });
-        Serial.printf("Subscribe result: %s, topic: %s\n", subResult ? "SUCCESS" : "FAILED", commandTopic.c_str());
+void CloudManager::serviceOnline() {
+    publishShadowChanges();
+    if (millis() - lastHeartbeat >= HEARTBEAT_INTERVAL_MS) {
+        publishHeartbeat();
+    }
+}
 
-        // Publish initial status
-        publishStatus();
+void CloudManager::closed(const char* reason, bool failed) {
+    if (reason) {
+        Serial.printf("Cloud connection closed: %s (MQTT error code %d)\n", reason, mqtt.getLastError());
     }
+    mqtt.disconnect();
+    wsClient.disconnect();
+    tlsArbiter.endSession("cloud");
+    state = CloudState::DISCONNECTED;
 
-    // Periodic status publishing
-    if (millis() - lastStatusPublish > STATUS_PUBLISH_INTERVAL_MS) {
-        lastStatusPublish = millis();
-        publishStatus();
+    // Red flash for connection error
+    if (failed && ledController) {
+        ledController->setCloudStatusLED(4);
     }
 }
 
@@ -190,6 +168,14 @@ bool CloudManager::connect() {
         Serial.println("Cloud not configured - cannot connect");
         return false;
     }
+    return connection.connect();
+}
+
+bool CloudManager::openSocket() {
+    if (!tlsArbiter.beginHandshake("cloud")) {
+        Serial.println("No room for a TLS handshake");
+        return false;
+    }
 
     state = CloudState::CONNECTING;
 
@@ -241,61 +227,65 @@ bool CloudManager::connect() {
     // Disconnect any existing connection
     mqtt.disconnect();
     wsClient.disconnect();
-    delay(100);  // Allow clean disconnect
 
-    // Begin SSL WebSocket connection
+    // Begin SSL WebSocket connection, loop() drives the handshake
     // Empty fingerprint should trigger setInsecure() in the library
     Serial.println("Starting WebSocket SSL connection (insecure mode)...");
     wsClient.beginSSL(host.c_str(), port, path.c_str(), "", "mqtt");
     wsClient.setReconnectInterval(2000);
     wsClient.enableHeartbeat(15000, 3000, 2);  // Ping every 15s, timeout 3s, 2 retries
+    return true;
+}
 
-    // Wait for WebSocket to connect (with timeout)
-    Serial.println("Waiting for WebSocket connection...");
-    unsigned long wsStartTime = millis();
-    const unsigned long WS_TIMEOUT = 10000;  // 10 second timeout
-
-    while (!wsClient.isConnected() && (millis() - wsStartTime < WS_TIMEOUT)) {
-        wsClient.loop();
-        delay(100);
-    }
-
-    if (!wsClient.isConnected()) {
-        Serial.println("WebSocket connection timeout");
-        state = CloudState::DISCONNECTED;
-        return false;
-    }
-
-    Serial.println("WebSocket connected, waiting before MQTT handshake...");
-    delay(500);  // Give WebSocket time to stabilize
-
-    // Connect to MQTT broker
+void CloudManager::sendConnect() {
+    CloudSettings settings = config.load();
     String clientId = "qlockthree-" + DeviceIdentity::getDeviceId();
     Serial.printf("Client ID: %s\n", clientId.c_str());
     Serial.printf("Attempting MQTT connect with user: %s\n", settings.mqttUsername);
 
-    if (mqtt.connect(clientId.c_str(), settings.mqttUsername, settings.mqttPassword)) {
-        Serial.println("MQTT connected successfully!");
-        // Don't set mqttConnected here - let loop() handle it after subscribing
-        state = CloudState::CONNECTING;
-        return true;
-    } else {
-        Serial.printf("MQTT connection failed - error code: %d\n", mqtt.getLastError());
-        state = CloudState::DISCONNECTED;
+    // A CONNACK that misses the library's own short wait is still picked up
+    // by update() in MQTT_CONNECTING, so the result only decides the log line
+    if (!mqtt.connect(clientId.c_str(), settings.mqttUsername, settings.mqttPassword)) {
+        Serial.printf("No CONNACK yet (code %d), waiting\n", mqtt.getLastError());
+    }
+}
+
+bool CloudManager::subscribe() {
+    // Subscribe to command topic with callback
+    String commandTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/command";
+    Serial.printf("Subscribing to topic: %s\n", commandTopic.c_str());
+    bool subResult = mqtt.subscribe(commandTopic, [this](const char* payload, const size_t size) {
+        handleMessage(payload, size);
+    });
+    Serial.printf("Subscribe result: %s, topic: %s\n", subResult ? "SUCCESS" : "FAILED", commandTopic.c_str());
+    if (!subResult) {
         return false;
     }
+
+    // Scene frames are binary LEDFrameDecoder frames, decoded straight into
+    // the LEDs without going through a JsonDocument
+    String sceneTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/scene";
+    subResult = mqtt.subscribe(sceneTopic, [this](const char* payload, const size_t size) {
+        if (ledController && !ledController->showScene((const uint8_t*)payload, size)) {
+            Serial.printf("Rejected scene frame of %u bytes\n", (unsigned)size);
+        }
+    });
+    Serial.printf("Subscribe result: %s, topic: %s\n", subResult ? "SUCCESS" : "FAILED", sceneTopic.c_str());
+    return subResult;
 }
 
 void CloudManager::disconnect() {
-    mqtt.disconnect();
-    wsClient.disconnect();
-    mqttConnected = false;
-    state = CloudState::DISCONNECTED;
+    connection.disconnect();
     Serial.println("Disconnected from cloud");
 }
 
+void CloudManager::clearCredentials() {
+    disconnect();
+    config.clear();
+}
+
 bool CloudManager::isConnected() {
-    return mqttConnected && mqtt.isConnected();
+    return connection.isOnline() && mqtt.isConnected();
 }
 
 CloudState CloudManager::getState() {
@@ -318,12 +308,13 @@ bool CloudManager::startPairing(const char* apiUrl) {
     // Register with backend
     if (!registerForPairing()) {
         Serial.println("Failed to register for pairing");
+        closeApiSession();
         return false;
     }
 
     pairingActive = true;
     pairingStartTime = millis();
-    lastPairingPoll = 0;
+    pairingBackoff.retryNow();
     state = CloudState::PAIRING;
 
     // Set purple breathing LED for pairing mode
@@ -338,6 +329,7 @@ bool CloudManager::startPairing(const char* apiUrl) {
 
 void CloudManager::stopPairing() {
     pairingActive = false;
+    closeApiSession();
     pairingCode = "";
     pairingSessionId = "";
     state = config.isConfigured() ? CloudState::DISCONNECTED : CloudState::DISCONNECTED;
@@ -367,12 +359,35 @@ int CloudManager::getPairingTimeRemaining() {
     return (PAIRING_TIMEOUT_MS - elapsed) / 1000;
 }
 
-bool CloudManager::registerForPairing() {
-    HTTPClient http;
-    WiFiClientSecure client;
-    client.setInsecure();  // Skip certificate verification
-    client.setHandshakeTimeout(30);  // 30 second handshake timeout
+bool CloudManager::beginApiRequest(const String& url) {
+    apiHandshake = !wifiClient.connected();
+    if (!apiHandshake) {
+        tlsArbiter.recordReuse();
+    } else if (!tlsArbiter.beginHandshake("api")) {
+        return false;
+    }
+    return apiHttp.begin(wifiClient, url);
+}
 
+void CloudManager::endApiRequest(bool ok) {
+    // Leaves the connection open when the server keeps it alive
+    apiHttp.end();
+    if (apiHandshake) {
+        tlsArbiter.endHandshake("api", ok);
+        apiHandshake = false;
+    }
+    if (!wifiClient.connected()) {
+        tlsArbiter.endSession("api");
+    }
+}
+
+void CloudManager::closeApiSession() {
+    wifiClient.stop();
+    tlsArbiter.endSession("api");
+}
+
+bool CloudManager::registerForPairing() {
+    HTTPClient& http = apiHttp;
     String url = currentApiUrl + "/api/provision/start";
 
     Serial.println("=== PAIRING DEBUG ===");
@@ -380,8 +395,10 @@ bool CloudManager::registerForPairing() {
     Serial.printf("Device ID: %s\n", DeviceIdentity::getDeviceId().c_str());
     Serial.printf("Pairing Code: %s\n", pairingCode.c_str());
 
-    http.begin(client, url);
-    http.setReuse(false);  // Don't reuse connections
+    if (!beginApiRequest(url)) {
+        Serial.println("=== PAIRING FAILED ===");
+        return false;
+    }
     http.addHeader("Content-Type", "application/json");
     http.setTimeout(15000);  // 15 second timeout
 
@@ -394,9 +411,17 @@ bool CloudManager::registerForPairing() {
     serializeJson(doc, body);
     Serial.printf("Request body: %s\n", body.c_str());
 
+    // The Date header doubles as a secondary time source
+    const char* headerKeys[] = {"Date"};
+    http.collectHeaders(headerKeys, 1);
+
     Serial.println("Sending POST request...");
+    unsigned long requestStart = millis();
     int httpCode = http.POST(body);
     Serial.printf("HTTP response code: %d\n", httpCode);
+    if (httpCode > 0) {
+        TimeManager::reportHttpDate(http.header("Date"), requestStart);
+    }
 
     if (httpCode > 0) {
         String response = http.getString();
@@ -416,7 +441,7 @@ bool CloudManager::registerForPairing() {
                     strncpy(settings.mqttUrl, mqttUrl.c_str(), sizeof(settings.mqttUrl) - 1);
                     config.save(settings);
                 }
-                http.end();
+                endApiRequest(true);
                 Serial.println("=== PAIRING SUCCESS ===");
                 return true;
             } else {
@@ -428,16 +453,27 @@ bool CloudManager::registerForPairing() {
     }
 
     Serial.println("=== PAIRING FAILED ===");
-    http.end();
+    endApiRequest(httpCode > 0);
     return false;
 }
 
 bool CloudManager::pollPairingStatus() {
-    HTTPClient http;
+    HTTPClient& http = apiHttp;
     String url = currentApiUrl + "/api/provision/status/" + pairingCode;
 
-    http.begin(wifiClient, url);
+    if (!beginApiRequest(url)) {
+        pairingBackoff.recordFailure();
+        Serial.printf("Pairing poll deferred, next poll in %lu s\n", pairingBackoff.getCurrentDelay() / 1000);
+        return false;
+    }
+    http.setTimeout(5000);  // Registration set a longer one on the shared client
+    const char* headerKeys[] = {"Date"};
+    http.collectHeaders(headerKeys, 1);
+    unsigned long requestStart = millis();
     int httpCode = http.GET();
+    if (httpCode > 0) {
+        TimeManager::reportHttpDate(http.header("Date"), requestStart);
+    }
 
     if (httpCode == 200) {
         String response = http.getString();
@@ -446,6 +482,7 @@ bool CloudManager::pollPairingStatus() {
         DeserializationError error = deserializeJson(doc, response);
 
         if (!error) {
+            pairingBackoff.recordSuccess(PAIRING_POLL_INTERVAL_MS);
             String status = doc["status"].as<String>();
 
             if (status == "claimed") {
@@ -476,16 +513,23 @@ bool CloudManager::pollPairingStatus() {
                     ledController->setCloudStatusLED(3);
                 }
 
-                http.end();
+                endApiRequest(true);
                 return true;
             } else if (status == "expired") {
                 Serial.println("Pairing code expired");
+                endApiRequest(true);
                 stopPairing();
+                return false;
             }
+            endApiRequest(true);
+            return false;
         }
     }
 
-    http.end();
+    // Backend unreachable or confused: poll less often until it answers again
+    pairingBackoff.recordFailure();
+    Serial.printf("Pairing poll failed (HTTP %d), next poll in %lu s\n", httpCode, pairingBackoff.getCurrentDelay() / 1000);
+    endApiRequest(httpCode > 0);
     return false;
 }
 
@@ -497,66 +541,150 @@ void CloudManager::handleCredentialsReceived(const char* mqttUrl, const char* us
     config.setCloudEnabled(true);
 
     pairingActive = false;
-    consecutiveFailures = 0;
-    inLongBackoff = false;
-    lastReconnectAttempt = 0;  // Allow immediate connection attempt
+    reconnectBackoff.retryNow();
     state = CloudState::DISCONNECTED; // Will reconnect with new credentials
 }
 
 void CloudManager::publishStatus() {
     if (!mqtt.isConnected()) return;
 
-    String statusTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/status";
-
-    // Build status JSON
+    sampleShadow();
     JsonDocument doc;
-    doc["deviceId"] = DeviceIdentity::getDeviceId();
+    shadow.writeReported(doc.to<JsonObject>(), true);
+    doc["uptime"] = millis() / 1000;
+    doc["freeHeap"] = ESP.getFreeHeap();
+    doc["rssi"] = WiFi.RSSI();
+    doc["timestamp"] = millis();
+
+    // Offered on every connect, the backend answers with an encoding command
+    JsonArray encodings = doc["encodings"].to<JsonArray>();
+    encodings.add("json");
+    encodings.add("msgpack");
 
+    if (publishDocument(doc)) {
+        lastHeartbeat = millis();
+        Serial.printf("Published full status, shadow version %lu\n", (unsigned long)shadow.getVersion());
+    }
+}
+
+void CloudManager::sampleShadow() {
     // Get actual state from LED controller
-    if (ledController != nullptr) {
-        LEDPattern pattern = ledController->getCurrentPattern();
-        doc["powerState"] = (pattern == LEDPattern::OFF) ? "OFF" : "ON";
-        doc["brightness"] = ledController->getBrightness();
-        CRGB color = ledController->getSolidColor();
-        doc["colorR"] = color.r;
-        doc["colorG"] = color.g;
-        doc["colorB"] = color.b;
-
-        // Convert pattern to string
-        switch (pattern) {
-            case LEDPattern::OFF: doc["pattern"] = "OFF"; break;
-            case LEDPattern::SOLID_COLOR: doc["pattern"] = "SOLID_COLOR"; break;
-            case LEDPattern::RAINBOW: doc["pattern"] = "RAINBOW"; break;
-            case LEDPattern::BREATHING: doc["pattern"] = "BREATHING"; break;
-            case LEDPattern::CLOCK_DISPLAY: doc["pattern"] = "CLOCK_DISPLAY"; break;
-            default: doc["pattern"] = "UNKNOWN"; break;
-        }
-    } else {
-        // Fallback if no LED controller
-        doc["powerState"] = "ON";
-        doc["brightness"] = 128;
-        doc["colorR"] = 255;
-        doc["colorG"] = 220;
-        doc["colorB"] = 180;
-        doc["pattern"] = "CLOCK_DISPLAY";
+    if (ledController == nullptr) {
+        return;
+    }
+    LEDPattern pattern = ledController->getCurrentPattern();
+    shadow.setPower(pattern != LEDPattern::OFF);
+    shadow.setBrightness(ledController->getBrightness());
+    CRGB color = ledController->getSolidColor();
+    shadow.setColor(color.r, color.g, color.b);
+
+    // Convert pattern to string
+    switch (pattern) {
+        case LEDPattern::OFF: shadow.setPattern("OFF"); break;
+        case LEDPattern::SOLID_COLOR: shadow.setPattern("SOLID_COLOR"); break;
+        case LEDPattern::RAINBOW: shadow.setPattern("RAINBOW"); break;
+        case LEDPattern::BREATHING: shadow.setPattern("BREATHING"); break;
+        case LEDPattern::CLOCK_DISPLAY: shadow.setPattern("CLOCK_DISPLAY"); break;
+        case LEDPattern::SCENE: shadow.setPattern("SCENE"); break;
+        default: shadow.setPattern("UNKNOWN"); break;
     }
+}
 
-    doc["firmwareVersion"] = "1.0.0";
+void CloudManager::publishShadowChanges() {
+    if (!shadow.hasChanges()) {
+        return;
+    }
+    JsonDocument doc;
+    shadow.writeReported(doc.to<JsonObject>(), false);
+    if (publishDocument(doc)) {
+        Serial.printf("Published shadow delta, version %lu\n", (unsigned long)shadow.getVersion());
+    }
+}
+
+void CloudManager::publishHeartbeat() {
+    // Telemetry only: the state fields have not changed since the last publish
+    JsonDocument doc;
+    doc["version"] = shadow.getVersion();
     doc["uptime"] = millis() / 1000;
     doc["freeHeap"] = ESP.getFreeHeap();
     doc["rssi"] = WiFi.RSSI();
     doc["timestamp"] = millis();
+    if (publishDocument(doc)) {
+        lastHeartbeat = millis();
+    }
+}
 
-    String payload;
-    serializeJson(doc, payload);
+bool CloudManager::publishDocument(JsonDocument& doc) {
+    // Every message is a part of the same document, merged by the backend
+    String statusTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/status";
+    doc["deviceId"] = DeviceIdentity::getDeviceId();
 
-    mqtt.publish(statusTopic, payload);
-    Serial.printf("Published status to %s\n", statusTopic.c_str());
+    bool msgPack = encoding == PayloadEncoding::MSGPACK;
+    size_t size = msgPack ? measureMsgPack(doc) : measureJson(doc);
+    if (size > MAX_PAYLOAD_SIZE) {
+        Serial.printf("Status message too large (%u bytes), dropped\n", (unsigned)size);
+        return false;
+    }
+
+    char payload[MAX_PAYLOAD_SIZE + 1]; // serializeJson() adds a terminator
+    size = msgPack ? serializeMsgPack(doc, payload, sizeof(payload)) : serializeJson(doc, payload, sizeof(payload));
+    lastPublishSize = size;
+    return mqtt.publish(statusTopic, payload, size);
+}
+
+void CloudManager::handleMessage(const char* payload, size_t size) {
+    unsigned long receivedUs = micros();
+
+    // A MessagePack map starts with 0x80-0x8f, 0xde or 0xdf, JSON with '{' or whitespace
+    uint8_t first = size > 0 ? (uint8_t)payload[0] : 0;
+    bool msgPack = (first & 0xF0) == 0x80 || first == 0xDE || first == 0xDF;
+    Serial.printf("Command received (%d bytes, %s)\n", size, msgPack ? "MessagePack" : "JSON");
+
+    // The previous command's document is gone, its memory can be reused
+    commandPool.reset();
+    JsonDocument doc(&commandPool);
+
+    unsigned long parseStart = micros();
+    DeserializationError error = msgPack ? deserializeMsgPack(doc, payload, size) : deserializeJson(doc, payload, size);
+    lastParseUs = micros() - parseStart;
+    if (error) {
+        Serial.printf("Command parse error: %s\n", error.c_str());
+        return;
+    }
+
+    JsonObject command = doc.as<JsonObject>();
+    handleCommand(command);
+    if (ledController) {
+        ledController->markInput(receivedUs);
+    }
 }
 
 void CloudManager::handleCommand(JsonObject& command) {
     String type = command["type"].as<String>();
 
+    // Versioned commands are desired state: a late one must not undo a newer one
+    if (command["version"].is<uint32_t>()) {
+        uint32_t version = command["version"].as<uint32_t>();
+        if (!shadow.acceptDesired(version)) {
+            Serial.printf("Ignoring stale %s command, version %lu <= %lu\n", type.c_str(),
+                          (unsigned long)version, (unsigned long)shadow.getDesiredVersion());
+            return;
+        }
+    }
+    lastShadowSample = 0; // Report the result with the next loop
+
+    if (type == "desired") {
+        applyDesired(command["state"].as<JsonObject>());
+        return;
+    }
+
+    if (type == "encoding") {
+        String format = command["payload"]["format"].as<String>();
+        encoding = format == "msgpack" ? PayloadEncoding::MSGPACK : PayloadEncoding::JSON;
+        Serial.printf("Status encoding: %s\n", encoding == PayloadEncoding::MSGPACK ? "MessagePack" : "JSON");
+        return;
+    }
+
     CloudCommandType cmdType = CloudCommandType::UNKNOWN;
 
     if (type == "power") {
@@ -571,9 +699,7 @@ void CloudManager::handleCommand(JsonObject& command) {
         cmdType = CloudCommandType::UNPAIR;
         // Handle unpair internally - clear credentials and disconnect
         Serial.println("Received unpair command - clearing credentials");
-        config.clear();
-        disconnect();
-        state = CloudState::DISCONNECTED;
+        clearCredentials();
     }
 
     JsonObject payload = command["payload"].as<JsonObject>();
@@ -583,45 +709,84 @@ void CloudManager::handleCommand(JsonObject& command) {
     }
 }
 
+void CloudManager::applyDesired(JsonObject desired) {
+    if (commandCallback == nullptr) {
+        return;
+    }
+
+    // Same field names as the reported state, dispatched as single commands
+    JsonDocument command;
+    if (desired["brightness"].is<int>()) {
+        command.clear();
+        command["value"] = desired["brightness"];
+        JsonObject payload = command.as<JsonObject>();
+        commandCallback(CloudCommandType::BRIGHTNESS, payload);
+    }
+    if (desired["colorR"].is<int>() || desired["colorG"].is<int>() || desired["colorB"].is<int>()) {
+        command.clear();
+        command["r"] = desired["colorR"];
+        command["g"] = desired["colorG"];
+        command["b"] = desired["colorB"];
+        JsonObject payload = command.as<JsonObject>();
+        commandCallback(CloudCommandType::COLOR, payload);
+    }
+
+    // Powering on selects the clock face, so a pattern wins unless the clock goes off
+    String power = desired["powerState"].as<String>();
+    if (desired["pattern"].is<const char*>() && power != "OFF") {
+        command.clear();
+        command["pattern"] = desired["pattern"];
+        JsonObject payload = command.as<JsonObject>();
+        commandCallback(CloudCommandType::PATTERN, payload);
+    } else if (power.length() > 0) {
+        command.clear();
+        command["state"] = power;
+        JsonObject payload = command.as<JsonObject>();
+        commandCallback(CloudCommandType::POWER, payload);
+    }
+}
+
 void CloudManager::setCommandCallback(CloudCommandCallback callback) {
     commandCallback = callback;
 }
 
-String CloudManager::getStatusJSON() {
-    JsonDocument doc;
-
-    doc["deviceId"] = DeviceIdentity::getDeviceId();
-    doc["state"] = static_cast<int>(state);
+void CloudManager::writeStatusJSON(JsonWriter& json) {
+    json.beginObject();
+    json.add("deviceId", DeviceIdentity::getDeviceId());
+    json.add("state", static_cast<int>(state));
 
     switch (state) {
         case CloudState::DISCONNECTED:
-            doc["stateText"] = "disconnected";
+            json.add("stateText", "disconnected");
             break;
         case CloudState::CONNECTING:
-            doc["stateText"] = "connecting";
+            json.add("stateText", "connecting");
             break;
         case CloudState::CONNECTED:
-            doc["stateText"] = "connected";
+            json.add("stateText", "connected");
             break;
         case CloudState::PAIRING:
-            doc["stateText"] = "pairing";
+            json.add("stateText", "pairing");
             break;
         case CloudState::ERROR:
-            doc["stateText"] = "error";
+            json.add("stateText", "error");
             break;
     }
 
-    doc["connected"] = mqttConnected && mqtt.isConnected();
-    doc["configured"] = config.isConfigured();
-    doc["paired"] = config.isPaired();
-    doc["pairingActive"] = pairingActive;
+    json.add("connected", isConnected());
+    json.add("configured", config.isConfigured());
+    json.add("paired", config.isPaired());
+    json.add("pairingActive", pairingActive);
+    json.add("encoding", encoding == PayloadEncoding::MSGPACK ? "msgpack" : "json");
+    json.add("lastPublishBytes", (unsigned long)lastPublishSize);
+    json.add("lastParseUs", lastParseUs);
+    json.add("commandPoolPeak", (unsigned long)commandPool.getPeakUsed());
+    json.add("nvsAccessesPerMinute", (unsigned long)config.getNvsAccessesPerMinute());
+    json.add("nvsAccesses", (unsigned long)config.getNvsAccesses());
 
     if (pairingActive) {
-        doc["pairingCode"] = pairingCode;
-        doc["pairingTimeRemaining"] = getPairingTimeRemaining();
+        json.add("pairingCode", pairingCode);
+        json.add("pairingTimeRemaining", getPairingTimeRemaining());
     }
-
-    String output;
-    serializeJson(doc, output);
-    return output;
+    json.endObject();
 }
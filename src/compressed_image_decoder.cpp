@@ -0,0 +1,137 @@
+#include "compressed_image_decoder.h"
+#include <new>
+
+// Written by scripts/compress_firmware.py in front of every image
+static const uint8_t MAGIC[4] = {'Q', 'H', 'S', '1'};
+// Shorter lookaheads cannot pay for a back-reference
+static const uint8_t MIN_LOOKAHEAD_BITS = 3;
+
+CompressedImageDecoder::CompressedImageDecoder() :
+    headerLength(0),
+    windowBits(0),
+    lookaheadBits(0),
+    window(nullptr),
+    windowMask(0),
+    windowPos(0),
+    imageSize(0),
+    decoded(0),
+    bitBuffer(0),
+    bitCount(0),
+    field(Field::TAG),
+    distance(0),
+    outputLength(0) {
+}
+
+CompressedImageDecoder::~CompressedImageDecoder() {
+    delete[] window;
+}
+
+void CompressedImageDecoder::reset() {
+    delete[] window;
+    window = nullptr;
+    headerLength = 0;
+    windowPos = 0;
+    imageSize = 0;
+    decoded = 0;
+    bitBuffer = 0;
+    bitCount = 0;
+    field = Field::TAG;
+    outputLength = 0;
+}
+
+bool CompressedImageDecoder::feed(const uint8_t* data, size_t length, const Sink& sink) {
+    size_t i = 0;
+    while (!hasHeader() && i < length) {
+        header[headerLength++] = data[i++];
+        if (headerLength == HEADER_SIZE && !parseHeader()) {
+            return false;
+        }
+    }
+
+    for (; i < length; i++) {
+        // Only padding bits of the last byte may follow the image
+        if (decoded == imageSize) {
+            return false;
+        }
+        bitBuffer = (bitBuffer << 8) | data[i];
+        bitCount += 8;
+
+        while (decoded < imageSize) {
+            uint8_t needed = field == Field::TAG ? 1 :
+                             field == Field::LITERAL ? 8 :
+                             field == Field::INDEX ? windowBits : lookaheadBits;
+            if (bitCount < needed) {
+                break;
+            }
+            bitCount -= needed;
+            uint16_t bits = (bitBuffer >> bitCount) & ((1u << needed) - 1);
+
+            switch (field) {
+                case Field::TAG:
+                    field = bits ? Field::LITERAL : Field::INDEX;
+                    break;
+                case Field::LITERAL:
+                    if (!emit((uint8_t)bits, sink)) {
+                        return false;
+                    }
+                    field = Field::TAG;
+                    break;
+                case Field::INDEX:
+                    distance = bits + 1;
+                    field = Field::COUNT;
+                    break;
+                case Field::COUNT:
+                    // Byte by byte, a reference may overlap what it produces
+                    for (uint16_t count = bits + 1; count > 0 && decoded < imageSize; count--) {
+                        if (!emit(window[(windowPos - distance) & windowMask], sink)) {
+                            return false;
+                        }
+                    }
+                    field = Field::TAG;
+                    break;
+            }
+        }
+    }
+    return flush(sink);
+}
+
+bool CompressedImageDecoder::parseHeader() {
+    if (memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        Serial.println("Compressed image: unknown format");
+        return false;
+    }
+    windowBits = header[4];
+    lookaheadBits = header[5];
+    imageSize = (size_t)header[8] | ((size_t)header[9] << 8) | ((size_t)header[10] << 16) | ((size_t)header[11] << 24);
+    if (windowBits > MAX_WINDOW_BITS || lookaheadBits < MIN_LOOKAHEAD_BITS || lookaheadBits >= windowBits || imageSize == 0) {
+        Serial.printf("Compressed image: unsupported window %u/%u bits or size %u\n",
+                      windowBits, lookaheadBits, (unsigned)imageSize);
+        return false;
+    }
+
+    // Zeroed like the encoder's window before the first byte
+    window = new (std::nothrow) uint8_t[1u << windowBits]();
+    if (!window) {
+        Serial.println("Compressed image: no memory for the window");
+        return false;
+    }
+    windowMask = (1u << windowBits) - 1;
+    return true;
+}
+
+bool CompressedImageDecoder::emit(uint8_t value, const Sink& sink) {
+    window[windowPos] = value;
+    windowPos = (windowPos + 1) & windowMask;
+    decoded++;
+    output[outputLength++] = value;
+    return outputLength < OUTPUT_SIZE || flush(sink);
+}
+
+bool CompressedImageDecoder::flush(const Sink& sink) {
+    if (outputLength == 0) {
+        return true;
+    }
+    size_t length = outputLength;
+    outputLength = 0;
+    return sink(output, length);
+}
@@ -0,0 +1,105 @@
+#include "device_shadow.h"
+#include "settings_store.h"
+
+DeviceShadow::DeviceShadow() :
+    power(false),
+    brightness(0),
+    colorR(0),
+    colorG(0),
+    colorB(0),
+    pattern(""),
+    firmwareVersion(""),
+    changed(ALL_FIELDS),
+    version(0),
+    desiredVersion(0),
+    revision(0) {
+}
+
+void DeviceShadow::begin(const char* firmware) {
+    firmwareVersion = firmware;
+    version = settingsStore.getUInt("shadow.version", 0);
+    desiredVersion = settingsStore.getUInt("shadow.desired", 0);
+    changed = ALL_FIELDS;
+    Serial.printf("Device shadow at version %lu, desired %lu\n", (unsigned long)version, (unsigned long)desiredVersion);
+}
+
+void DeviceShadow::setPower(bool on) {
+    if (power != on) {
+        power = on;
+        markChanged(POWER);
+    }
+}
+
+void DeviceShadow::setBrightness(uint8_t value) {
+    if (brightness != value) {
+        brightness = value;
+        markChanged(BRIGHTNESS);
+    }
+}
+
+void DeviceShadow::setColor(uint8_t r, uint8_t g, uint8_t b) {
+    if (colorR != r || colorG != g || colorB != b) {
+        colorR = r;
+        colorG = g;
+        colorB = b;
+        markChanged(COLOR);
+    }
+}
+
+void DeviceShadow::setPattern(const char* name) {
+    if (strcmp(pattern, name) != 0) {
+        pattern = name;
+        markChanged(PATTERN);
+    }
+}
+
+bool DeviceShadow::writeReported(JsonObject doc, bool full) {
+    uint8_t fields = full ? (uint8_t)ALL_FIELDS : changed;
+    if (fields == 0) {
+        return false;
+    }
+
+    // A new version for every publish that carries a change; the settings
+    // store coalesces the writes
+    if (changed != 0) {
+        version++;
+        settingsStore.setUInt("shadow.version", version);
+    }
+    changed = 0;
+
+    doc["version"] = version;
+    if (full) {
+        doc["full"] = true;
+    }
+    if (fields & POWER) {
+        doc["powerState"] = power ? "ON" : "OFF";
+    }
+    if (fields & BRIGHTNESS) {
+        doc["brightness"] = brightness;
+    }
+    if (fields & COLOR) {
+        doc["colorR"] = colorR;
+        doc["colorG"] = colorG;
+        doc["colorB"] = colorB;
+    }
+    if (fields & PATTERN) {
+        doc["pattern"] = pattern;
+    }
+    if (fields & FIRMWARE) {
+        doc["firmwareVersion"] = firmwareVersion;
+    }
+    if (fields & DESIRED_VERSION) {
+        doc["desiredVersion"] = desiredVersion;
+    }
+    return true;
+}
+
+bool DeviceShadow::acceptDesired(uint32_t newVersion) {
+    if (newVersion <= desiredVersion) {
+        return false;
+    }
+    desiredVersion = newVersion;
+    settingsStore.setUInt("shadow.desired", desiredVersion);
+    markChanged(DESIRED_VERSION);
+    return true;
+}
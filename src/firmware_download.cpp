@@ -0,0 +1,288 @@
+#include "firmware_download.h"
+#include "tls_arbiter.h"
+#include <WiFiClientSecure.h>
+#include <HTTPClient.h>
+#include <Update.h>
+
+// Bytes read from the connection at a time; the OTA writer buffers a
+// whole flash sector on its own
+static const size_t CHUNK_SIZE = 1024;
+// Requests one run() makes before leaving the rest to the next run()
+static const int MAX_ATTEMPTS_PER_RUN = 8;
+// Pause before a dropped download asks for the rest
+static const unsigned long RESUME_DELAY_MS = 2000;
+// No data for this long counts as a dropped connection
+static const unsigned long STALL_TIMEOUT_MS = 15000;
+// Connect and header timeout of every request
+static const uint16_t HTTP_TIMEOUT_MS = 30000;
+// A sha256sum listing for a handful of files
+static const int MAX_CHECKSUMS_SIZE = 4096;
+
+FirmwareDownload::FirmwareDownload() :
+    url(""),
+    active(false),
+    compressed(false),
+    written(0),
+    total(0),
+    requests(0),
+    resumes(0),
+    restarts(0),
+    digestMismatches(0),
+    lastVerified(false) {
+    mbedtls_sha256_init(&sha);
+}
+
+FirmwareDownload::~FirmwareDownload() {
+    mbedtls_sha256_free(&sha);
+}
+
+FirmwareDownload::Result FirmwareDownload::run(const String& newUrl, const uint8_t* expectedDigest, ProgressHandler progress) {
+    if (active && url == newUrl && written > 0) {
+        Serial.printf("Firmware download: resuming at %u of %u bytes\n", (unsigned)written, (unsigned)total);
+    } else {
+        start(newUrl);
+    }
+
+    for (int attempt = 1; ; attempt++) {
+        Transfer result = transfer(progress);
+        if (result == Transfer::COMPLETE) {
+            break;
+        }
+        if (result == Transfer::ERROR) {
+            abort();
+            return Result::FAILED;
+        }
+        if (attempt >= MAX_ATTEMPTS_PER_RUN) {
+            Serial.printf("Firmware download: interrupted at %u of %u bytes, resuming later\n",
+                          (unsigned)written, (unsigned)total);
+            return Result::INTERRUPTED;
+        }
+        delay(RESUME_DELAY_MS);
+    }
+
+    uint8_t digest[DIGEST_SIZE];
+    mbedtls_sha256_finish(&sha, digest);
+    lastVerified = false;
+    if (expectedDigest) {
+        if (memcmp(digest, expectedDigest, DIGEST_SIZE) != 0) {
+            digestMismatches++;
+            Serial.println("Firmware download: SHA-256 does not match the published checksum, discarding");
+            abort();
+            return Result::FAILED;
+        }
+        lastVerified = true;
+    }
+
+    if (compressed && !decoder.isComplete()) {
+        Serial.printf("Firmware download: compressed image ended after %u of %u bytes\n",
+                      (unsigned)decoder.getDecoded(), (unsigned)decoder.getImageSize());
+        abort();
+        return Result::FAILED;
+    }
+
+    active = false;
+    decoder.reset();
+    if (!Update.end()) {
+        Serial.printf("Firmware download: install failed: %s\n", Update.errorString());
+        Update.abort();
+        return Result::FAILED;
+    }
+    Serial.printf("Firmware download: %u bytes installed, %s\n", (unsigned)written,
+                  lastVerified ? "SHA-256 verified" : "no checksum published");
+    return Result::INSTALLED;
+}
+
+void FirmwareDownload::abort() {
+    if (active) {
+        Update.abort();
+    }
+    active = false;
+    written = 0;
+    total = 0;
+    decoder.reset();
+}
+
+void FirmwareDownload::start(const String& newUrl) {
+    abort();
+    url = newUrl;
+    compressed = newUrl.endsWith(".hs");
+    mbedtls_sha256_free(&sha);
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+}
+
+FirmwareDownload::Transfer FirmwareDownload::transfer(ProgressHandler& progress) {
+    if (!tlsArbiter.beginHandshake("download")) {
+        return Transfer::LOST;
+    }
+
+    WiFiClientSecure client;
+    client.setInsecure(); // Skip SSL certificate verification for GitHub downloads
+
+    HTTPClient http;
+    http.begin(client, url);
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS); // Handle GitHub redirects
+    http.setUserAgent("qlockthree-ESP32");
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    http.useHTTP10(true);   // Plain body, no chunked encoding
+    if (written > 0) {
+        http.addHeader("Range", "bytes=" + String((unsigned long)written) + "-");
+        resumes++;
+    }
+    const char* headerKeys[] = {"Content-Range"};
+    http.collectHeaders(headerKeys, 1);
+
+    requests++;
+    int httpCode = http.GET();
+    tlsArbiter.endHandshake("download", httpCode > 0);
+
+    Transfer result = Transfer::ERROR;
+    if (httpCode == HTTP_CODE_PARTIAL_CONTENT && written > 0) {
+        // The rest must start where the partition stops, of the same image
+        unsigned long first = 0, last = 0, size = 0;
+        String range = http.header("Content-Range");
+        if (sscanf(range.c_str(), "bytes %lu-%lu/%lu", &first, &last, &size) == 3 &&
+            first == written && size == total) {
+            result = receive(*http.getStreamPtr(), progress);
+        } else {
+            Serial.printf("Firmware download: unexpected range '%s'\n", range.c_str());
+        }
+    } else if (httpCode == HTTP_CODE_OK) {
+        if (written > 0) {
+            // Range not supported after all: take the whole image again
+            restarts++;
+            Serial.println("Firmware download: server ignored the range, starting over");
+            start(url);
+        }
+        // A compressed image opens the partition once its header tells the size
+        int contentLength = http.getSize();
+        if (contentLength <= 0) {
+            Serial.println("Content length is 0");
+        } else if (!compressed && !Update.begin(contentLength)) {
+            Serial.println("Not enough space for update");
+        } else {
+            active = true;
+            total = contentLength;
+            result = receive(*http.getStreamPtr(), progress);
+        }
+    } else if (httpCode > 0) {
+        Serial.printf("HTTP GET failed with code: %d\n", httpCode);
+    } else {
+        Serial.printf("Firmware download: request failed: %s\n", http.errorToString(httpCode).c_str());
+        result = Transfer::LOST;
+    }
+
+    http.end();
+    client.stop();
+    tlsArbiter.endSession("download");
+    return result;
+}
+
+FirmwareDownload::Transfer FirmwareDownload::receive(WiFiClient& stream, ProgressHandler& progress) {
+    uint8_t buffer[CHUNK_SIZE];
+    unsigned long lastData = millis();
+
+    while (written < total) {
+        size_t available = stream.available();
+        if (available == 0) {
+            if (!stream.connected() || millis() - lastData >= STALL_TIMEOUT_MS) {
+                Serial.printf("Firmware download: connection lost at %u of %u bytes\n", (unsigned)written, (unsigned)total);
+                return Transfer::LOST;
+            }
+            delay(1);
+            continue;
+        }
+
+        size_t wanted = available < CHUNK_SIZE ? available : CHUNK_SIZE;
+        if (wanted > total - written) {
+            wanted = total - written;
+        }
+        int received = stream.read(buffer, wanted);
+        if (received <= 0) {
+            continue;
+        }
+
+        mbedtls_sha256_update(&sha, buffer, received);
+        if (!writeImage(buffer, received)) {
+            return Transfer::ERROR;
+        }
+        written += received;
+        lastData = millis();
+        if (progress) {
+            progress(written, total);
+        }
+    }
+    return Transfer::COMPLETE;
+}
+
+bool FirmwareDownload::writeImage(uint8_t* data, size_t length) {
+    if (!compressed) {
+        if (Update.write(data, length) != length) {
+            Serial.printf("Firmware download: flash write failed: %s\n", Update.errorString());
+            return false;
+        }
+        return true;
+    }
+
+    bool ok = decoder.feed(data, length, [this](const uint8_t* image, size_t imageLength) {
+        if (!Update.isRunning() && !Update.begin(decoder.getImageSize())) {
+            Serial.println("Not enough space for update");
+            return false;
+        }
+        if (Update.write((uint8_t*)image, imageLength) != imageLength) {
+            Serial.printf("Firmware download: flash write failed: %s\n", Update.errorString());
+            return false;
+        }
+        return true;
+    });
+    if (!ok && !Update.hasError()) {
+        Serial.println("Firmware download: invalid compressed image");
+    }
+    return ok;
+}
+
+bool FirmwareDownload::fetchChecksum(const String& sumsUrl, const String& fileName, uint8_t digest[DIGEST_SIZE]) {
+    if (!tlsArbiter.beginHandshake("download")) {
+        return false;
+    }
+
+    WiFiClientSecure client;
+    client.setInsecure();
+
+    HTTPClient http;
+    http.begin(client, sumsUrl);
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+    http.setUserAgent("qlockthree-ESP32");
+    http.setTimeout(HTTP_TIMEOUT_MS);
+
+    int httpCode = http.GET();
+    tlsArbiter.endHandshake("download", httpCode > 0);
+
+    bool found = false;
+    if (httpCode == HTTP_CODE_OK && http.getSize() <= MAX_CHECKSUMS_SIZE) {
+        found = ChecksumList::find(http.getString(), fileName, digest);
+        if (!found) {
+            Serial.printf("Firmware download: no checksum for %s\n", fileName.c_str());
+        }
+    } else {
+        Serial.printf("Firmware download: checksum list failed with code: %d\n", httpCode);
+    }
+
+    http.end();
+    client.stop();
+    tlsArbiter.endSession("download");
+    return found;
+}
+
+void FirmwareDownload::writeStatusJSON(JsonWriter& json) {
+    json.add("written", (unsigned long)written);
+    json.add("total", (unsigned long)total);
+    json.add("compressed", compressed);
+    json.add("decoded", (unsigned long)decoder.getDecoded());
+    json.add("resumable", active && written > 0);
+    json.add("requests", (unsigned long)requests);
+    json.add("resumes", (unsigned long)resumes);
+    json.add("restarts", (unsigned long)restarts);
+    json.add("digest_mismatches", (unsigned long)digestMismatches);
+    json.add("verified", lastVerified);
+}
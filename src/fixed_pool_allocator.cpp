@@ -0,0 +1,71 @@
+#include "fixed_pool_allocator.h"
+
+// Every block starts with its size, so reallocate() knows what to copy
+static const size_t BLOCK_HEADER_SIZE = sizeof(size_t);
+static const size_t ALIGNMENT = sizeof(void*);
+
+static size_t alignUp(size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+FixedPoolAllocator::FixedPoolAllocator(uint8_t* buffer, size_t size) :
+    buffer(buffer),
+    capacity(size),
+    used(0),
+    peakUsed(0),
+    lastBlock(0) {
+}
+
+void* FixedPoolAllocator::allocate(size_t size) {
+    size_t blockSize = BLOCK_HEADER_SIZE + alignUp(size);
+    if (used + blockSize > capacity) {
+        return nullptr;
+    }
+    lastBlock = used;
+    memcpy(buffer + used, &size, BLOCK_HEADER_SIZE);
+    used += blockSize;
+    if (used > peakUsed) {
+        peakUsed = used;
+    }
+    return buffer + lastBlock + BLOCK_HEADER_SIZE;
+}
+
+void FixedPoolAllocator::deallocate(void* pointer) {
+    // The newest block is given back, everything else waits for reset()
+    if (pointer && (uint8_t*)pointer == buffer + lastBlock + BLOCK_HEADER_SIZE) {
+        used = lastBlock;
+    }
+}
+
+void* FixedPoolAllocator::reallocate(void* pointer, size_t newSize) {
+    if (!pointer) {
+        return allocate(newSize);
+    }
+
+    uint8_t* block = (uint8_t*)pointer - BLOCK_HEADER_SIZE;
+    size_t oldSize;
+    memcpy(&oldSize, block, BLOCK_HEADER_SIZE);
+
+    // The newest block grows or shrinks in place
+    if (block == buffer + lastBlock) {
+        size_t end = lastBlock + BLOCK_HEADER_SIZE + alignUp(newSize);
+        if (end > capacity) {
+            return nullptr;
+        }
+        memcpy(block, &newSize, BLOCK_HEADER_SIZE);
+        used = end;
+        if (used > peakUsed) {
+            peakUsed = used;
+        }
+        return pointer;
+    }
+
+    if (newSize <= oldSize) {
+        return pointer;
+    }
+    void* moved = allocate(newSize);
+    if (moved) {
+        memcpy(moved, pointer, oldSize);
+    }
+    return moved;
+}
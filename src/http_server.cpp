@@ -0,0 +1,845 @@
+#include "http_server.h"
+#include <lwip/sockets.h>
+#include <errno.h>
+
+// Partial requests are dropped after this long without new data
+static const unsigned long REQUEST_TIMEOUT_MS = 5000;
+// Idle keep-alive connections are closed after this long
+static const unsigned long KEEP_ALIVE_TIMEOUT_MS = 10000;
+static const uint16_t MAX_KEEP_ALIVE_REQUESTS = 100;
+// With all slots taken, a keep-alive connection idle this long makes room for a new client
+static const unsigned long IDLE_EVICT_MS = 1000;
+// Responses the client stops taking are dropped after this long
+static const unsigned long SEND_TIMEOUT_MS = 5000;
+// Most response output kept for a slow client, beyond the response buffer
+static const size_t MAX_QUEUED_BODY = 16384;
+static const int LISTEN_BACKLOG = 4;
+// Comment line sent on idle event streams so dead clients get noticed
+static const unsigned long EVENT_PING_INTERVAL_MS = 15000;
+// EventSource reconnect delay requested from the browser
+static const char* EVENT_STREAM_PREAMBLE = "retry: 3000\n\n";
+// Marks that the handler did not call setContentLength()
+static const size_t CONTENT_LENGTH_NOT_SET = CONTENT_LENGTH_UNKNOWN - 1;
+
+HttpServer::HttpServer(int port) :
+    port(port),
+    listenFd(-1),
+    routeCount(0),
+    lastEventPing(0),
+    current(nullptr),
+    pendingContentLength(CONTENT_LENGTH_NOT_SET),
+    pendingActionConnection(nullptr) {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        connections[i].fd = -1;
+        connections[i].state = State::FREE;
+        connections[i].heapBody = nullptr;
+        connections[i].heapCapacity = 0;
+    }
+}
+
+HttpServer::~HttpServer() {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        closeConnection(connections[i]);
+    }
+    if (listenFd >= 0) {
+        lwip_close(listenFd);
+    }
+}
+
+void HttpServer::begin() {
+    listenFd = lwip_socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        Serial.println("HTTP server: socket() failed");
+        return;
+    }
+
+    int enable = 1;
+    lwip_setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (lwip_bind(listenFd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        lwip_listen(listenFd, LISTEN_BACKLOG) != 0) {
+        Serial.printf("HTTP server: cannot listen on port %d (errno %d)\n", port, errno);
+        lwip_close(listenFd);
+        listenFd = -1;
+        return;
+    }
+
+    lwip_fcntl(listenFd, F_SETFL, lwip_fcntl(listenFd, F_GETFL, 0) | O_NONBLOCK);
+    Serial.printf("HTTP server listening on port %d (%d connections)\n", port, MAX_CONNECTIONS);
+}
+
+void HttpServer::handleClient() {
+    if (listenFd < 0) {
+        return;
+    }
+
+    acceptConnections();
+
+    if (millis() - lastEventPing >= EVENT_PING_INTERVAL_MS) {
+        lastEventPing = millis();
+        for (int i = 0; i < MAX_CONNECTIONS; i++) {
+            if (connections[i].state == State::STREAMING) {
+                queueEvent(connections[i], ": ping", 6, "", 0);
+            }
+        }
+    }
+
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        Connection& conn = connections[i];
+        if (conn.state == State::READING) {
+            readRequest(conn);
+        }
+        if (conn.state == State::WRITING) {
+            writeResponse(conn);
+        }
+        if (conn.state == State::STREAMING) {
+            serviceStream(conn);
+        }
+
+        // Idle keep-alive connections get longer than half-received requests
+        if (conn.state == State::READING) {
+            unsigned long timeout = conn.requestLength == 0 ? KEEP_ALIVE_TIMEOUT_MS : REQUEST_TIMEOUT_MS;
+            if (millis() - conn.lastActivity > timeout) {
+                closeConnection(conn);
+            }
+        } else if (conn.state == State::WRITING && millis() - conn.lastActivity > SEND_TIMEOUT_MS) {
+            Serial.println("HTTP server: client too slow, response dropped");
+            closeConnection(conn);
+        }
+    }
+}
+
+void HttpServer::on(const String& uri, THandlerFunction handler) {
+    on(uri, HTTP_ANY, handler);
+}
+
+void HttpServer::on(const String& uri, HTTPMethod method, THandlerFunction handler) {
+    if (routeCount >= MAX_ROUTES) {
+        Serial.printf("HTTP server: route table full, %s not registered\n", uri.c_str());
+        return;
+    }
+    routes[routeCount].uri = uri;
+    routes[routeCount].method = method;
+    routes[routeCount].handler = handler;
+    routeCount++;
+}
+
+void HttpServer::onNotFound(THandlerFunction handler) {
+    notFoundHandler = handler;
+}
+
+bool HttpServer::hasArg(const String& name) {
+    if (!current) {
+        return false;
+    }
+    return findArg(current->request + current->queryStart, current->queryLength, name, nullptr) ||
+           findArg(current->request + current->headerLength, current->contentLength, name, nullptr);
+}
+
+String HttpServer::arg(const String& name) {
+    String value;
+    if (current) {
+        if (!findArg(current->request + current->queryStart, current->queryLength, name, &value)) {
+            findArg(current->request + current->headerLength, current->contentLength, name, &value);
+        }
+    }
+    return value;
+}
+
+const uint8_t* HttpServer::body() const {
+    if (!current) {
+        return nullptr;
+    }
+    return (const uint8_t*)current->request + current->headerLength;
+}
+
+size_t HttpServer::bodyLength() const {
+    return current ? current->contentLength : 0;
+}
+
+String HttpServer::header(const String& name) {
+    if (!current) {
+        return String();
+    }
+
+    // Header lines start after the request line and end before the blank line
+    const char* line = (const char*)memchr(current->request, '\n', current->headerLength);
+    const char* end = current->request + current->headerLength - 2;
+    size_t nameLength = name.length();
+    while (line && ++line < end) {
+        const char* lineEnd = (const char*)memchr(line, '\r', end - line);
+        if (!lineEnd) {
+            lineEnd = end;
+        }
+        if ((size_t)(lineEnd - line) > nameLength && line[nameLength] == ':' &&
+            strncasecmp(line, name.c_str(), nameLength) == 0) {
+            const char* value = line + nameLength + 1;
+            while (value < lineEnd && *value == ' ') {
+                value++;
+            }
+            String result;
+            result.concat(value, lineEnd - value);
+            return result;
+        }
+        line = (const char*)memchr(line, '\n', end - line);
+    }
+    return String();
+}
+
+void HttpServer::sendHeader(const String& name, const String& value) {
+    pendingHeaders += name;
+    pendingHeaders += ": ";
+    pendingHeaders += value;
+    pendingHeaders += "\r\n";
+}
+
+void HttpServer::setContentLength(size_t length) {
+    pendingContentLength = length;
+}
+
+void HttpServer::send(int code, const char* contentType, const String& content) {
+    send(code, contentType, content.c_str());
+}
+
+void HttpServer::send(int code, const char* contentType, const char* content) {
+    send(code, contentType, content, content ? strlen(content) : 0);
+}
+
+void HttpServer::send(int code, const char* contentType, const char* content, size_t length) {
+    writeHead(code, contentType, pendingContentLength != CONTENT_LENGTH_NOT_SET ? pendingContentLength : length);
+    if (!current || length == 0) {
+        return;
+    }
+
+    if (current->chunked) {
+        sendContent(content, length);
+    } else {
+        appendResponse(*current, content, length);
+    }
+}
+
+void HttpServer::send(int code, const String& contentType, const String& content) {
+    send(code, contentType.c_str(), content);
+}
+
+void HttpServer::send_P(int code, const char* contentType, const char* content, size_t length) {
+    writeHead(code, contentType, length);
+    if (current) {
+        // Written straight from flash without copying; RAM would be gone once the handler returns
+        current->flashBody = content;
+        current->bodyLength = length;
+    }
+}
+
+void HttpServer::sendContent(const char* content, size_t length) {
+    if (!current || !current->responseStarted) {
+        return;
+    }
+
+    if (!current->chunked) {
+        appendResponse(*current, content, length);
+        return;
+    }
+
+    if (length == 0) {
+        appendResponse(*current, "0\r\n\r\n", 5);
+        current->chunked = false; // Terminated
+        return;
+    }
+
+    char chunkHeader[12];
+    int headerLength = snprintf(chunkHeader, sizeof(chunkHeader), "%x\r\n", (unsigned)length);
+    appendResponse(*current, chunkHeader, headerLength);
+    appendResponse(*current, content, length);
+    appendResponse(*current, "\r\n", 2);
+}
+
+void HttpServer::sendContent(const String& content) {
+    sendContent(content.c_str(), content.length());
+}
+
+void HttpServer::afterResponse(THandlerFunction action) {
+    if (!current) {
+        action();
+        return;
+    }
+    pendingAction = action;
+    pendingActionConnection = current;
+}
+
+void HttpServer::beginEventStream(uint8_t channels) {
+    if (!current || current->responseStarted || channels == 0) {
+        return;
+    }
+
+    // Make room: a dropped stream's page reconnects by itself
+    if (getEventStreamCount() >= MAX_EVENT_STREAMS) {
+        Connection* oldest = nullptr;
+        for (int i = 0; i < MAX_CONNECTIONS; i++) {
+            Connection& conn = connections[i];
+            if (conn.state == State::STREAMING &&
+                (!oldest || millis() - conn.streamStart > millis() - oldest->streamStart)) {
+                oldest = &conn;
+            }
+        }
+        if (oldest) {
+            Serial.println("HTTP server: too many event streams, closing the oldest");
+            closeConnection(*oldest);
+        }
+    }
+
+    // The body runs until the connection closes, no length or chunking
+    current->eventChannels = channels;
+    current->streamStart = millis();
+    current->keepAlive = false;
+    sendHeader("Cache-Control", "no-cache");
+    writeHead(200, "text/event-stream", CONTENT_LENGTH_UNKNOWN);
+    appendResponse(*current, EVENT_STREAM_PREAMBLE, strlen(EVENT_STREAM_PREAMBLE));
+}
+
+int HttpServer::getEventStreamCount(uint8_t channels) const {
+    int count = 0;
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (connections[i].state == State::STREAMING && (connections[i].eventChannels & channels)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void HttpServer::sendEvent(const char* event, const char* data, size_t length, uint8_t channel) {
+    char head[48];
+    int headLength = snprintf(head, sizeof(head), "event: %s\ndata: ", event);
+    if (headLength <= 0 || headLength >= (int)sizeof(head)) {
+        return;
+    }
+
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (connections[i].state == State::STREAMING && (connections[i].eventChannels & channel)) {
+            queueEvent(connections[i], head, headLength, data, length);
+        }
+    }
+}
+
+void HttpServer::flushEventStreams() {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (connections[i].state == State::STREAMING) {
+            drainResponse(connections[i]);
+        }
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        Connection* slot = nullptr;
+        for (int i = 0; i < MAX_CONNECTIONS && !slot; i++) {
+            if (connections[i].state == State::FREE) {
+                slot = &connections[i];
+            }
+        }
+
+        if (!slot) {
+            // All busy: make room by dropping the longest idle keep-alive connection
+            for (int i = 0; i < MAX_CONNECTIONS; i++) {
+                Connection& conn = connections[i];
+                if (conn.state == State::READING && conn.requestLength == 0 &&
+                    millis() - conn.lastActivity >= IDLE_EVICT_MS &&
+                    (!slot || conn.lastActivity < slot->lastActivity)) {
+                    slot = &conn;
+                }
+            }
+            if (!slot) {
+                return; // Everyone is busy, new clients wait in the backlog
+            }
+
+            // Only evict if somebody is actually waiting
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(listenFd, &readable);
+            struct timeval noWait = {0, 0};
+            if (lwip_select(listenFd + 1, &readable, nullptr, nullptr, &noWait) <= 0) {
+                return;
+            }
+            closeConnection(*slot);
+        }
+
+        int fd = lwip_accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            return; // EAGAIN: nobody waiting
+        }
+
+        lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int enable = 1;
+        lwip_setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        slot->fd = fd;
+        slot->state = State::READING;
+        slot->lastActivity = millis();
+        slot->requestsServed = 0;
+        slot->requestLength = 0;
+        slot->headerLength = 0;
+        resetResponse(*slot);
+    }
+}
+
+void HttpServer::readRequest(Connection& conn) {
+    size_t space = REQUEST_BUFFER_SIZE - 1 - conn.requestLength;
+    if (space > 0) {
+        int received = lwip_recv(conn.fd, conn.request + conn.requestLength, space, MSG_DONTWAIT);
+        if (received == 0) {
+            closeConnection(conn); // Client closed
+            return;
+        }
+        if (received < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeConnection(conn);
+            }
+            // No new data, but a pipelined request may already be buffered
+        } else {
+            conn.requestLength += received;
+            conn.lastActivity = millis();
+        }
+    }
+    if (conn.requestLength == 0) {
+        return;
+    }
+
+    if (conn.headerLength == 0 && !parseRequestHead(conn)) {
+        return;
+    }
+
+    if (conn.requestLength >= conn.headerLength + conn.contentLength) {
+        dispatch(conn);
+    }
+}
+
+bool HttpServer::parseRequestHead(Connection& conn) {
+    conn.request[conn.requestLength] = '\0';
+    char* headEnd = strstr(conn.request, "\r\n\r\n");
+    if (!headEnd) {
+        if (conn.requestLength >= REQUEST_BUFFER_SIZE - 1) {
+            sendError(conn, 431);
+        }
+        return false;
+    }
+    conn.headerLength = headEnd + 4 - conn.request;
+
+    // Request line: METHOD /path?query HTTP/1.x
+    const char* line = conn.request;
+    const char* space = strchr(line, ' ');
+    const char* lineEnd = strstr(line, "\r\n");
+    if (!space || space > lineEnd) {
+        sendError(conn, 400);
+        return false;
+    }
+
+    size_t methodLength = space - line;
+    if (methodLength == 3 && strncmp(line, "GET", 3) == 0) {
+        conn.method = HTTP_GET;
+    } else if (methodLength == 4 && strncmp(line, "POST", 4) == 0) {
+        conn.method = HTTP_POST;
+    } else if (methodLength == 4 && strncmp(line, "HEAD", 4) == 0) {
+        conn.method = HTTP_HEAD;
+    } else if (methodLength == 3 && strncmp(line, "PUT", 3) == 0) {
+        conn.method = HTTP_PUT;
+    } else if (methodLength == 6 && strncmp(line, "DELETE", 6) == 0) {
+        conn.method = HTTP_DELETE;
+    } else if (methodLength == 7 && strncmp(line, "OPTIONS", 7) == 0) {
+        conn.method = HTTP_OPTIONS;
+    } else {
+        sendError(conn, 400);
+        return false;
+    }
+
+    const char* path = space + 1;
+    const char* pathEnd = path;
+    while (pathEnd < lineEnd && *pathEnd != ' ' && *pathEnd != '?') {
+        pathEnd++;
+    }
+    const char* query = pathEnd;
+    const char* queryEnd = pathEnd;
+    if (*pathEnd == '?') {
+        query = pathEnd + 1;
+        queryEnd = query;
+        while (queryEnd < lineEnd && *queryEnd != ' ') {
+            queryEnd++;
+        }
+    }
+    conn.pathStart = path - conn.request;
+    conn.pathLength = pathEnd - path;
+    conn.queryStart = query - conn.request;
+    conn.queryLength = queryEnd - query;
+
+    // HTTP/1.1 keeps the connection unless told otherwise, 1.0 only when asked
+    bool http11 = lineEnd - line >= 8 && strncmp(lineEnd - 8, "HTTP/1.1", 8) == 0;
+    current = &conn;
+    String connection = header("Connection");
+    String contentLength = header("Content-Length");
+    current = nullptr;
+
+    if (http11) {
+        conn.keepAlive = !connection.equalsIgnoreCase("close");
+    } else {
+        conn.keepAlive = connection.equalsIgnoreCase("keep-alive");
+    }
+
+    conn.contentLength = contentLength.length() > 0 ? strtoul(contentLength.c_str(), nullptr, 10) : 0;
+    if (conn.contentLength > REQUEST_BUFFER_SIZE - 1 - conn.headerLength) {
+        sendError(conn, 413);
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::dispatch(Connection& conn) {
+    if (conn.requestsServed + 1 >= MAX_KEEP_ALIVE_REQUESTS) {
+        conn.keepAlive = false; // Announce the close in this response
+    }
+    current = &conn;
+    pendingHeaders = "";
+    pendingContentLength = CONTENT_LENGTH_NOT_SET;
+
+    const char* path = conn.request + conn.pathStart;
+    THandlerFunction* handler = nullptr;
+    for (int i = 0; i < routeCount && !handler; i++) {
+        Route& route = routes[i];
+        if (route.uri.length() == conn.pathLength && memcmp(route.uri.c_str(), path, conn.pathLength) == 0 &&
+            (route.method == HTTP_ANY || route.method == conn.method)) {
+            handler = &route.handler;
+        }
+    }
+
+    if (handler) {
+        (*handler)();
+    } else if (notFoundHandler) {
+        notFoundHandler();
+    } else {
+        send(404, "text/plain", "Not found");
+    }
+
+    if (!conn.responseStarted) {
+        send(500, "text/plain", "No response");
+    }
+    if (conn.chunked && !conn.failed) {
+        // Handler forgot the final empty chunk
+        sendContent("", 0);
+    }
+
+    current = nullptr;
+    conn.requestsServed++;
+    if (conn.failed) {
+        closeConnection(conn);
+    } else {
+        conn.state = State::WRITING;
+        conn.lastActivity = millis(); // The send timeout starts now, not when the request arrived
+    }
+}
+
+void HttpServer::writeResponse(Connection& conn) {
+    // Buffered head and small body first, then the large body
+    while (conn.responseSent < conn.responseLength) {
+        int sent = sendSome(conn, conn.response + conn.responseSent, conn.responseLength - conn.responseSent);
+        if (sent <= 0) {
+            return;
+        }
+        conn.responseSent += sent;
+    }
+
+    const char* body = conn.flashBody ? conn.flashBody : conn.heapBody;
+    while (conn.bodySent < conn.bodyLength) {
+        int sent = sendSome(conn, body + conn.bodySent, conn.bodyLength - conn.bodySent);
+        if (sent <= 0) {
+            return;
+        }
+        conn.bodySent += sent;
+    }
+
+    finishResponse(conn);
+}
+
+void HttpServer::finishResponse(Connection& conn) {
+    if (conn.eventChannels) {
+        conn.state = State::STREAMING;
+        conn.responseLength = 0;
+        conn.responseSent = 0;
+        return;
+    }
+
+    // Actions like a restart follow the last response on this connection
+    if (pendingActionConnection == &conn) {
+        closeConnection(conn);
+        return;
+    }
+
+    if (!conn.keepAlive) {
+        closeConnection(conn);
+        return;
+    }
+
+    // Keep whatever the client already pipelined behind this request
+    size_t consumed = conn.headerLength + conn.contentLength;
+    conn.requestLength -= consumed;
+    memmove(conn.request, conn.request + consumed, conn.requestLength);
+    conn.headerLength = 0;
+    conn.state = State::READING;
+    conn.lastActivity = millis();
+    resetResponse(conn);
+}
+
+void HttpServer::closeConnection(Connection& conn) {
+    if (conn.fd >= 0) {
+        lwip_close(conn.fd);
+        conn.fd = -1;
+    }
+    conn.state = State::FREE;
+    free(conn.heapBody);
+    conn.heapBody = nullptr;
+    conn.heapCapacity = 0;
+
+    // The response is sent (or will never be)
+    if (pendingActionConnection == &conn && current != &conn) {
+        THandlerFunction action = pendingAction;
+        pendingAction = nullptr;
+        pendingActionConnection = nullptr;
+        action();
+    }
+}
+
+void HttpServer::resetResponse(Connection& conn) {
+    conn.responseLength = 0;
+    conn.responseSent = 0;
+    free(conn.heapBody);
+    conn.heapBody = nullptr;
+    conn.heapCapacity = 0;
+    conn.flashBody = nullptr;
+    conn.bodyLength = 0;
+    conn.bodySent = 0;
+    conn.responseStarted = false;
+    conn.chunked = false;
+    conn.failed = false;
+    conn.eventChannels = 0;
+}
+
+void HttpServer::sendError(Connection& conn, int code) {
+    // Malformed or oversized request: answer and close, the rest of the stream is unusable
+    conn.keepAlive = false;
+    conn.headerLength = conn.requestLength;
+    conn.contentLength = 0;
+    current = &conn;
+    pendingHeaders = "";
+    pendingContentLength = CONTENT_LENGTH_NOT_SET;
+    send(code, "text/plain", statusText(code));
+    current = nullptr;
+    conn.state = State::WRITING;
+}
+
+void HttpServer::writeHead(int code, const char* contentType, size_t contentLength) {
+    if (!current) {
+        return;
+    }
+    if (current->responseStarted) {
+        Serial.println("HTTP server: handler sent a second response, ignored");
+        return;
+    }
+    current->responseStarted = true;
+    current->chunked = contentLength == CONTENT_LENGTH_UNKNOWN && !current->eventChannels;
+
+    char head[160];
+    int length = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nConnection: %s\r\n",
+                          code, statusText(code), current->keepAlive ? "keep-alive" : "close");
+    appendResponse(*current, head, length);
+
+    if (code != 304 && code != 204) {
+        if (current->chunked) {
+            length = snprintf(head, sizeof(head), "Transfer-Encoding: chunked\r\n");
+            appendResponse(*current, head, length);
+        } else if (contentLength != CONTENT_LENGTH_UNKNOWN) {
+            length = snprintf(head, sizeof(head), "Content-Length: %u\r\n", (unsigned)contentLength);
+            appendResponse(*current, head, length);
+        }
+        if (contentType) {
+            length = snprintf(head, sizeof(head), "Content-Type: %s\r\n", contentType);
+            appendResponse(*current, head, length);
+        }
+    }
+
+    appendResponse(*current, pendingHeaders.c_str(), pendingHeaders.length());
+    appendResponse(*current, "\r\n", 2);
+    pendingHeaders = "";
+}
+
+void HttpServer::serviceStream(Connection& conn) {
+    // Clients never send anything on a stream; only watch for the close
+    char discard[64];
+    int received = lwip_recv(conn.fd, discard, sizeof(discard), MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        closeConnection(conn);
+        return;
+    }
+    drainResponse(conn);
+}
+
+bool HttpServer::drainResponse(Connection& conn) {
+    while (conn.responseSent < conn.responseLength) {
+        int sent = sendSome(conn, conn.response + conn.responseSent, conn.responseLength - conn.responseSent);
+        if (sent < 0) {
+            conn.failed = true;
+        }
+        if (sent <= 0) {
+            break;
+        }
+        conn.responseSent += sent;
+    }
+    if (conn.state == State::FREE || conn.failed) {
+        return false;
+    }
+
+    // Move the unsent rest to the front so new events find room
+    conn.responseLength -= conn.responseSent;
+    memmove(conn.response, conn.response + conn.responseSent, conn.responseLength);
+    conn.responseSent = 0;
+    return true;
+}
+
+void HttpServer::queueEvent(Connection& conn, const char* head, size_t headLength, const char* data, size_t length) {
+    size_t needed = headLength + length + 2;
+    if (needed > RESPONSE_BUFFER_SIZE - conn.responseLength) {
+        if (!drainResponse(conn)) {
+            return;
+        }
+        if (needed > RESPONSE_BUFFER_SIZE - conn.responseLength) {
+            // Stale events are worse than a reconnect, which brings a fresh snapshot
+            Serial.println("HTTP server: event stream client too slow, closing");
+            closeConnection(conn);
+            return;
+        }
+    }
+    appendResponse(conn, head, headLength);
+    appendResponse(conn, data, length);
+    appendResponse(conn, "\n\n", 2);
+}
+
+void HttpServer::appendResponse(Connection& conn, const char* data, size_t length) {
+    if (conn.failed || length == 0) {
+        return;
+    }
+
+    // Once output went past the buffer, the rest queues behind it to keep the order
+    if (conn.bodyLength == 0) {
+        if (length > RESPONSE_BUFFER_SIZE - conn.responseLength) {
+            drainResponse(conn); // Whatever the socket takes right now, never waits
+            if (conn.failed) {
+                return;
+            }
+        }
+        if (length <= RESPONSE_BUFFER_SIZE - conn.responseLength) {
+            memcpy(conn.response + conn.responseLength, data, length);
+            conn.responseLength += length;
+            return;
+        }
+    }
+
+    if (conn.flashBody) {
+        Serial.println("HTTP server: output after send_P() ignored");
+        return;
+    }
+
+    // The client is slower than the handler: writeResponse() sends the rest from the poll loop
+    size_t needed = conn.bodyLength + length;
+    if (needed > conn.heapCapacity) {
+        size_t capacity = conn.heapCapacity ? conn.heapCapacity * 2 : RESPONSE_BUFFER_SIZE;
+        if (capacity < needed) {
+            capacity = needed;
+        }
+        char* grown = needed <= MAX_QUEUED_BODY ? (char*)realloc(conn.heapBody, capacity) : nullptr;
+        if (!grown) {
+            Serial.printf("HTTP server: cannot queue %u bytes for a slow client, response dropped\n", (unsigned)needed);
+            conn.failed = true;
+            return;
+        }
+        conn.heapBody = grown;
+        conn.heapCapacity = capacity;
+    }
+    memcpy(conn.heapBody + conn.bodyLength, data, length);
+    conn.bodyLength = needed;
+}
+
+int HttpServer::sendSome(Connection& conn, const char* data, size_t length) {
+    int sent = lwip_send(conn.fd, data, length, MSG_DONTWAIT);
+    if (sent >= 0) {
+        if (sent > 0) {
+            conn.lastActivity = millis();
+        }
+        return sent;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return 0;
+    }
+
+    // Client went away; dispatch() closes if a handler is still writing
+    if (current != &conn) {
+        closeConnection(conn);
+    }
+    return -1;
+}
+
+bool HttpServer::findArg(const char* params, size_t length, const String& name, String* value) {
+    const char* end = params + length;
+    const char* pair = params;
+    while (pair < end) {
+        const char* pairEnd = (const char*)memchr(pair, '&', end - pair);
+        if (!pairEnd) {
+            pairEnd = end;
+        }
+        const char* equals = (const char*)memchr(pair, '=', pairEnd - pair);
+        const char* keyEnd = equals ? equals : pairEnd;
+
+        if (urlDecode(pair, keyEnd - pair) == name) {
+            if (value) {
+                *value = equals ? urlDecode(equals + 1, pairEnd - equals - 1) : String();
+            }
+            return true;
+        }
+        pair = pairEnd + 1;
+    }
+    return false;
+}
+
+String HttpServer::urlDecode(const char* text, size_t length) {
+    String decoded;
+    decoded.reserve(length);
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%' && i + 2 < length && isxdigit((unsigned char)text[i + 1]) &&
+                   isxdigit((unsigned char)text[i + 2])) {
+            char hex[3] = {text[i + 1], text[i + 2], '\0'};
+            c = (char)strtol(hex, nullptr, 16);
+            i += 2;
+        }
+        decoded += c;
+    }
+    return decoded;
+}
+
+const char* HttpServer::statusText(int code) {
+    switch (code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
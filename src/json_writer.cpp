@@ -0,0 +1,202 @@
+#include "json_writer.h"
+#include <math.h>
+
+JsonWriter::JsonWriter(char* buffer, size_t size, FlushCallback flush, void* context) :
+    buffer(buffer),
+    capacity(size > 0 ? size - 1 : 0), // Keep room for the terminator used by c_str()
+    used(0),
+    flushCallback(flush),
+    flushContext(context),
+    memberMask(0),
+    depth(0),
+    overflowed(false) {
+}
+
+void JsonWriter::beginObject(const char* key) {
+    writeKey(key);
+    open('{');
+}
+
+void JsonWriter::endObject() {
+    close('}');
+}
+
+void JsonWriter::beginArray(const char* key) {
+    writeKey(key);
+    open('[');
+}
+
+void JsonWriter::endArray() {
+    close(']');
+}
+
+void JsonWriter::add(const char* key, const char* value) {
+    writeKey(key);
+    if (!value) {
+        write("null", 4);
+        return;
+    }
+    write('"');
+    writeEscaped(value);
+    write('"');
+}
+
+void JsonWriter::add(const char* key, bool value) {
+    writeKey(key);
+    if (value) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+}
+
+void JsonWriter::add(const char* key, int value) {
+    add(key, (long)value);
+}
+
+void JsonWriter::add(const char* key, unsigned int value) {
+    add(key, (unsigned long)value);
+}
+
+void JsonWriter::add(const char* key, long value) {
+    char number[12];
+    int length = snprintf(number, sizeof(number), "%ld", value);
+    writeKey(key);
+    write(number, length);
+}
+
+void JsonWriter::add(const char* key, unsigned long value) {
+    char number[12];
+    int length = snprintf(number, sizeof(number), "%lu", value);
+    writeKey(key);
+    write(number, length);
+}
+
+void JsonWriter::add(const char* key, long long value) {
+    char number[22];
+    int length = snprintf(number, sizeof(number), "%lld", value);
+    writeKey(key);
+    write(number, length);
+}
+
+void JsonWriter::add(const char* key, double value, int decimals) {
+    writeKey(key);
+    if (isnan(value) || isinf(value)) {
+        write("null", 4); // Not representable in JSON
+        return;
+    }
+    char number[32];
+    int length = snprintf(number, sizeof(number), "%.*f", decimals, value);
+    write(number, length);
+}
+
+void JsonWriter::addNull(const char* key) {
+    writeKey(key);
+    write("null", 4);
+}
+
+void JsonWriter::addRaw(const char* key, const char* json) {
+    writeKey(key);
+    write(json);
+}
+
+void JsonWriter::flush() {
+    if (flushCallback && used > 0) {
+        flushCallback(flushContext, buffer, used);
+        used = 0;
+    }
+}
+
+const char* JsonWriter::c_str() {
+    buffer[used] = '\0';
+    return buffer;
+}
+
+void JsonWriter::writeKey(const char* key) {
+    // Comma before every member except the first of its object/array
+    if (depth > 0) {
+        uint32_t bit = 1UL << (depth - 1);
+        if (memberMask & bit) {
+            write(',');
+        }
+        memberMask |= bit;
+    }
+
+    if (key) {
+        write('"');
+        writeEscaped(key);
+        write("\":", 2);
+    }
+}
+
+void JsonWriter::writeEscaped(const char* text) {
+    const char* run = text;
+    for (const char* p = text; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+
+        // Copy the unescaped run in one go, then the escape sequence
+        write(run, p - run);
+        run = p + 1;
+        switch (c) {
+            case '"': write("\\\"", 2); break;
+            case '\\': write("\\\\", 2); break;
+            case '\n': write("\\n", 2); break;
+            case '\r': write("\\r", 2); break;
+            case '\t': write("\\t", 2); break;
+            default: {
+                char escape[7];
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                write(escape, 6);
+                break;
+            }
+        }
+    }
+    write(run, strlen(run));
+}
+
+void JsonWriter::write(const char* data, size_t length) {
+    if (capacity == 0) {
+        if (length > 0) overflowed = true;
+        return;
+    }
+    
+    while (length > 0) {
+        size_t space = capacity - used;
+        if (space == 0) {
+            if (!flushCallback) {
+                overflowed = true;
+                return;
+            }
+            flush();
+            space = capacity;
+        }
+
+        size_t chunk = length < space ? length : space;
+        memcpy(buffer + used, data, chunk);
+        used += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+void JsonWriter::write(char c) {
+    write(&c, 1);
+}
+
+void JsonWriter::open(char bracket) {
+    write(bracket);
+    if (depth < MAX_DEPTH) {
+        depth++;
+        memberMask &= ~(1UL << (depth - 1));
+    }
+}
+
+void JsonWriter::close(char bracket) {
+    if (depth > 0) {
+        depth--;
+    }
+    write(bracket);
+}
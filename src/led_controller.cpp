@@ -1,4 +1,6 @@
 #include "led_controller.h"
+#include "settings_store.h"
+#include "led_frame_decoder.h"
 
 LEDController::LEDController() :
     leds(nullptr),
@@ -27,21 +29,33 @@ LEDController::LEDController() :
     statusLEDsEnabled(true),
     birthdayManager(nullptr),
     birthdayAlternateTimer(0),
-    showBirthdayNow(false) {
+    showBirthdayNow(false),
+    brightnessPending(false),
+    colorPending(false),
+    brightnessRequests(0),
+    brightnessApplied(0),
+    colorRequests(0),
+    colorApplied(0),
+    sceneFrames(0),
+    sceneRejected(0),
+    inputMarkUs(0),
+    inputMarked(false),
+    frameMarkUs(0),
+    frameMarked(false),
+    lastInputLatencyUs(0),
+    maxInputLatencyUs(0),
+    inputLatencySamples(0) {
 }
 
 void LEDController::begin(int pin, int numLedsCount, int brightnessValue) {
-    // Initialize preferences
-    preferences.begin("led_config", false);
-    
     // Load saved settings or use defaults
-    dataPin = preferences.getInt("data_pin", pin);
-    numLeds = preferences.getInt("num_leds", numLedsCount);
-    brightness = preferences.getUChar("brightness", brightnessValue);
-    speed = preferences.getUChar("speed", 50);
+    dataPin = settingsStore.getInt("led.pin", pin);
+    numLeds = settingsStore.getInt("led.count", numLedsCount);
+    brightness = settingsStore.getUInt("led.bright", brightnessValue);
+    speed = settingsStore.getUInt("led.speed", 50);
     
     // Load saved color (default to neutral warm white)
-    uint32_t savedColor = preferences.getUInt("solid_color", 0xFFDCB4);  // RGB(255, 220, 180)
+    uint32_t savedColor = settingsStore.getUInt("led.color", 0xFFDCB4);  // RGB(255, 220, 180)
     solidColor = CRGB(
         (savedColor >> 16) & 0xFF,  // Red
         (savedColor >> 8) & 0xFF,   // Green
@@ -118,6 +132,13 @@ void LEDController::begin(int pin, int numLedsCount, int brightnessValue) {
 
 void LEDController::update() {
     unsigned long now = millis();
+    // A command marked before this point has been applied by the time the frame is shown
+    if (inputMarked) {
+        frameMarkUs = inputMarkUs;
+        frameMarked = true;
+        inputMarked = false;
+    }
+    applyPendingInput();
     
     // Update animation based on speed setting (higher speed = faster animation)
     if (now - lastUpdate < (255 - speed) / 4) {
@@ -126,7 +147,7 @@ void LEDController::update() {
         if (currentPattern != LEDPattern::STARTUP_ANIMATION) {
             updateStatusLEDs();
         }
-        FastLED.show();
+        showFrame();
         return;
     }
     lastUpdate = now;
@@ -164,9 +185,30 @@ void LEDController::update() {
         case LEDPattern::STARTUP_ANIMATION:
             updateStartupAnimation();
             break;
+
+        case LEDPattern::SCENE:
+            // Frame stays as uploaded by showScene()
+            break;
     }
     
+    showFrame();
+}
+
+void LEDController::showFrame() {
     FastLED.show();
+    if (frameMarked) {
+        frameMarked = false;
+        lastInputLatencyUs = micros() - frameMarkUs;
+        if (lastInputLatencyUs > maxInputLatencyUs) {
+            maxInputLatencyUs = lastInputLatencyUs;
+        }
+        inputLatencySamples++;
+    }
+}
+
+void LEDController::markInput(unsigned long receivedUs) {
+    inputMarkUs = receivedUs;
+    inputMarked = true;
 }
 
 void LEDController::setPattern(LEDPattern pattern) {
@@ -216,6 +258,10 @@ void LEDController::setPattern(LEDPattern pattern) {
                 FastLED.setBrightness(10);
                 Serial.println("DEBUG: Pattern STARTUP_ANIMATION - starting rainbow sweep at brightness 10");
                 break;
+
+            case LEDPattern::SCENE:
+                // Keeps whatever is shown until showScene() uploads a frame
+                break;
         }
         FastLED.show();
         Serial.println("DEBUG: FastLED.show() called after pattern change");
@@ -223,23 +269,49 @@ void LEDController::setPattern(LEDPattern pattern) {
 }
 
 void LEDController::setSolidColor(CRGB color) {
-    Serial.printf("DEBUG: setSolidColor called with RGB(%d, %d, %d)\n", color.r, color.g, color.b);
+    colorRequests++;
     solidColor = color;
-    Serial.printf("DEBUG: Current pattern is: %d\n", (int)currentPattern);
-    
-    if (currentPattern == LEDPattern::SOLID_COLOR) {
-        fill(color);
-        FastLED.show();
-        Serial.println("DEBUG: Applied solid color and updated FastLED");
-    } else {
-        Serial.printf("DEBUG: Color saved but not applied (pattern is %d, not SOLID_COLOR)\n", (int)currentPattern);
+    colorPending = true;
+
+    // Without the LED task nobody else would apply it
+    if (!taskRunning) {
+        applyPendingInput();
     }
 }
 
 void LEDController::setBrightness(uint8_t brightnessValue) {
+    brightnessRequests++;
     brightness = brightnessValue;
-    FastLED.setBrightness(brightness);
-    FastLED.show();
+    brightnessPending = true;
+
+    if (!taskRunning) {
+        applyPendingInput();
+    }
+}
+
+void LEDController::applyPendingInput() {
+    // Flag first, value second: a request landing in between is applied now
+    // or with the next frame, never lost
+    if (brightnessPending) {
+        brightnessPending = false;
+        brightnessApplied++;
+        // The startup animation runs dimmed and restores the brightness itself
+        if (currentPattern != LEDPattern::STARTUP_ANIMATION) {
+            FastLED.setBrightness(brightness);
+        }
+    }
+
+    if (colorPending) {
+        colorPending = false;
+        colorApplied++;
+        if (currentPattern == LEDPattern::SOLID_COLOR) {
+            fill(solidColor);
+        }
+    }
+
+    if (!taskRunning) {
+        FastLED.show();
+    }
 }
 
 void LEDController::setSpeed(uint8_t speedValue) {
@@ -366,6 +438,36 @@ void LEDController::showStartupAnimation() {
     setPattern(LEDPattern::STARTUP_ANIMATION);
 }
 
+bool LEDController::showScene(const uint8_t* data, size_t length) {
+    // Validate outside the mutex so a bad upload never stalls a frame
+    if (!LEDFrameDecoder::isValid(data, length, numLeds)) {
+        sceneRejected++;
+        return false;
+    }
+
+    if (taskRunning && ledMutex != nullptr) {
+        if (xSemaphoreTake(ledMutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+            sceneRejected++;
+            return false;
+        }
+    }
+
+    // Straight into the frame buffer; the next LED task frame shows it
+    LEDFrameDecoder::decode(data, length, leds, numLeds);
+    if (currentPattern == LEDPattern::STARTUP_ANIMATION) {
+        FastLED.setBrightness(brightness);
+    }
+    currentPattern = LEDPattern::SCENE;
+    sceneFrames++;
+
+    if (taskRunning && ledMutex != nullptr) {
+        xSemaphoreGive(ledMutex);
+    } else {
+        FastLED.show();
+    }
+    return true;
+}
+
 void LEDController::showError() {
     // Flashing red pattern
     fill(CRGB::Red);
@@ -553,27 +655,20 @@ void LEDController::ledTaskLoop() {
 
 // Configuration management functions
 void LEDController::loadSettings() {
-    if (!preferences.begin("led_config", true)) {
-        Serial.println("Failed to open LED preferences");
-        return;
-    }
-    
     // Load all settings
-    int newDataPin = preferences.getInt("data_pin", dataPin);
-    int newNumLeds = preferences.getInt("num_leds", numLeds);
-    uint8_t newBrightness = preferences.getUChar("brightness", brightness);
-    uint8_t newSpeed = preferences.getUChar("speed", speed);
+    int newDataPin = settingsStore.getInt("led.pin", dataPin);
+    int newNumLeds = settingsStore.getInt("led.count", numLeds);
+    uint8_t newBrightness = settingsStore.getUInt("led.bright", brightness);
+    uint8_t newSpeed = settingsStore.getUInt("led.speed", speed);
     
     // Load saved color (default to neutral warm white)
-    uint32_t savedColor = preferences.getUInt("solid_color", 0xFFDCB4);  // RGB(255, 220, 180)
+    uint32_t savedColor = settingsStore.getUInt("led.color", 0xFFDCB4);  // RGB(255, 220, 180)
     CRGB newSolidColor = CRGB(
         (savedColor >> 16) & 0xFF,  // Red
         (savedColor >> 8) & 0xFF,   // Green
         savedColor & 0xFF           // Blue
     );
     
-    preferences.end();
-    
     // Apply loaded settings
     setDataPin(newDataPin);
     setNumLeds(newNumLeds);
@@ -581,31 +676,21 @@ void LEDController::loadSettings() {
     setSpeed(newSpeed);
     setSolidColor(newSolidColor);
     
-    Serial.println("LED settings loaded from NVS");
+    Serial.println("LED settings loaded");
 }
 
 void LEDController::saveSettings() {
-    preferences.end(); // Ensure any previous session is closed
-    if (!preferences.begin("led_config", false)) {
-        Serial.println("Failed to open LED preferences for writing");
-        return;
-    }
-    
-    // Save all current settings
-    preferences.putInt("data_pin", dataPin);
-    preferences.putInt("num_leds", numLeds);
-    preferences.putUChar("brightness", brightness);
-    preferences.putUChar("speed", speed);
+    // Unchanged values are skipped by the store, changed ones committed in one batch
+    settingsStore.setInt("led.pin", dataPin);
+    settingsStore.setInt("led.count", numLeds);
+    settingsStore.setUInt("led.bright", brightness);
+    settingsStore.setUInt("led.speed", speed);
     
     // Save color as 32-bit value
     uint32_t colorValue = ((uint32_t)solidColor.r << 16) | 
                          ((uint32_t)solidColor.g << 8) | 
                          (uint32_t)solidColor.b;
-    preferences.putUInt("solid_color", colorValue);
-    
-    preferences.end();
-    
-    Serial.println("LED settings saved to NVS");
+    settingsStore.setUInt("led.color", colorValue);
 }
 
 void LEDController::setNumLeds(int count) {
@@ -0,0 +1,91 @@
+#include "led_frame_decoder.h"
+
+static CRGB expandRGB565(uint16_t color) {
+    uint8_t r = (color >> 11) & 0x1F;
+    uint8_t g = (color >> 5) & 0x3F;
+    uint8_t b = color & 0x1F;
+    return CRGB((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2));
+}
+
+bool LEDFrameDecoder::decode(const uint8_t* data, size_t length, CRGB* leds, int count) {
+    if (!walk(data, length, nullptr, count)) {
+        return false;
+    }
+    return walk(data, length, leds, count);
+}
+
+bool LEDFrameDecoder::walk(const uint8_t* data, size_t length, CRGB* leds, int count) {
+    if (!data || length < HEADER_SIZE) {
+        return false;
+    }
+    uint8_t format = data[0] & ~FLAG_RLE;
+    bool rle = (data[0] & FLAG_RLE) != 0;
+    int pixels = data[1] | (data[2] << 8);
+    if (pixels > count || (format != RGB565 && format != PALETTE)) {
+        return false;
+    }
+
+    size_t pos = HEADER_SIZE;
+    const uint8_t* palette = nullptr;
+    uint8_t paletteSize = 0;
+    if (format == PALETTE) {
+        if (pos >= length || data[pos] == 0) {
+            return false;
+        }
+        paletteSize = data[pos++];
+        if (pos + 3 * (size_t)paletteSize > length) {
+            return false;
+        }
+        palette = data + pos;
+        pos += 3 * paletteSize;
+    }
+
+    // Bytes per color value: an RGB565 word or a palette index
+    size_t valueSize = format == RGB565 ? 2 : 1;
+    int written = 0;
+    while (written < pixels) {
+        uint8_t run = 1;
+        if (rle) {
+            if (pos >= length || data[pos] == 0) {
+                return false;
+            }
+            run = data[pos++];
+            if (written + run > pixels) {
+                return false;
+            }
+        }
+        if (pos + valueSize > length) {
+            return false;
+        }
+
+        CRGB color;
+        if (format == RGB565) {
+            color = expandRGB565(data[pos] | (data[pos + 1] << 8));
+        } else {
+            uint8_t index = data[pos];
+            if (index >= paletteSize) {
+                return false;
+            }
+            color = CRGB(palette[3 * index], palette[3 * index + 1], palette[3 * index + 2]);
+        }
+        pos += valueSize;
+
+        if (leds) {
+            for (uint8_t i = 0; i < run; i++) {
+                leds[written + i] = color;
+            }
+        }
+        written += run;
+    }
+
+    // Trailing bytes mean the sender and we disagree about the format
+    if (pos != length) {
+        return false;
+    }
+    if (leds) {
+        for (int i = pixels; i < count; i++) {
+            leds[i] = CRGB(0, 0, 0);
+        }
+    }
+    return true;
+}
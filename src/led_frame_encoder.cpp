@@ -0,0 +1,151 @@
+#include "led_frame_encoder.h"
+
+// Bytes in front of every changed run: start (u16) and length (u8)
+static const size_t RUN_HEADER_SIZE = 3;
+static const uint8_t MAX_RUN_LENGTH = 255;
+
+LEDFrameEncoder::LEDFrameEncoder() :
+    previous(nullptr),
+    output(nullptr),
+    capacity(0),
+    keyframePending(true) {
+}
+
+LEDFrameEncoder::~LEDFrameEncoder() {
+    delete[] previous;
+    delete[] output;
+}
+
+size_t LEDFrameEncoder::encodeNext(const CRGB* leds, int count) {
+    if (!leds || count <= 0 || count > 0xFFFF) {
+        return 0;
+    }
+    if (count != capacity) {
+        allocate(count);
+        keyframePending = true;
+    }
+
+    if (keyframePending) {
+        for (int i = 0; i < count; i++) {
+            previous[i] = leds[i];
+        }
+        keyframePending = false;
+        return encodeKeyframe(count);
+    }
+
+    // A delta bigger than a full frame is replaced by a keyframe; the
+    // reference frame is complete by then either way
+    size_t limit = maxEncodedSize(count);
+    size_t length = encodeDelta(leds, count, limit);
+    if (length > limit) {
+        return encodeKeyframe(count);
+    }
+    return length > HEADER_SIZE ? length : 0;
+}
+
+void LEDFrameEncoder::allocate(int count) {
+    delete[] previous;
+    delete[] output;
+    previous = new CRGB[count];
+    output = new uint8_t[maxEncodedSize(count)];
+    capacity = count;
+}
+
+size_t LEDFrameEncoder::encodeDelta(const CRGB* leds, int count, size_t limit) {
+    output[0] = DELTA;
+    output[1] = count & 0xFF;
+    output[2] = count >> 8;
+    size_t length = HEADER_SIZE;
+    size_t runHeader = 0;   // Offset of the open run's header, 0 if none
+    uint8_t runLength = 0;
+
+    for (int i = 0; i < count; i++) {
+        CRGB pixel = leds[i];
+        if (pixel == previous[i]) {
+            runHeader = 0;
+            continue;
+        }
+        previous[i] = pixel;
+
+        if (length > limit) {
+            continue; // Only catching up the reference frame now
+        }
+        if (runHeader == 0 || runLength == MAX_RUN_LENGTH) {
+            if (length + RUN_HEADER_SIZE + 3 > limit) {
+                length = limit + 1;
+                continue;
+            }
+            runHeader = length;
+            runLength = 0;
+            output[length++] = i & 0xFF;
+            output[length++] = i >> 8;
+            output[length++] = 0;
+        } else if (length + 3 > limit) {
+            length = limit + 1;
+            continue;
+        }
+
+        output[length++] = pixel.r;
+        output[length++] = pixel.g;
+        output[length++] = pixel.b;
+        output[runHeader + 2] = ++runLength;
+    }
+    return length;
+}
+
+size_t LEDFrameEncoder::encodeKeyframe(int count) {
+    // Collect the palette; more colors than fit means a plain RGB frame
+    CRGB palette[MAX_PALETTE_SIZE];
+    int paletteSize = 0;
+    for (int i = 0; i < count && paletteSize <= MAX_PALETTE_SIZE; i++) {
+        int p = 0;
+        while (p < paletteSize && palette[p] != previous[i]) {
+            p++;
+        }
+        if (p == paletteSize) {
+            if (paletteSize < MAX_PALETTE_SIZE) {
+                palette[p] = previous[i];
+            }
+            paletteSize++;
+        }
+    }
+
+    output[1] = count & 0xFF;
+    output[2] = count >> 8;
+    size_t length = HEADER_SIZE;
+
+    // Tiny frames are smaller as RGB than with a palette in front
+    size_t paletteLength = HEADER_SIZE + 1 + 3 * paletteSize + (count + 1) / 2;
+    if (paletteSize > MAX_PALETTE_SIZE || paletteLength >= maxEncodedSize(count)) {
+        output[0] = KEY_RGB;
+        for (int i = 0; i < count; i++) {
+            output[length++] = previous[i].r;
+            output[length++] = previous[i].g;
+            output[length++] = previous[i].b;
+        }
+        return length;
+    }
+
+    output[0] = KEY_PALETTE;
+    output[length++] = paletteSize;
+    for (int p = 0; p < paletteSize; p++) {
+        output[length++] = palette[p].r;
+        output[length++] = palette[p].g;
+        output[length++] = palette[p].b;
+    }
+    for (int i = 0; i < count; i++) {
+        uint8_t index = 0;
+        while (palette[index] != previous[i]) {
+            index++;
+        }
+        if (i % 2 == 0) {
+            output[length] = index;
+        } else {
+            output[length++] |= index << 4;
+        }
+    }
+    if (count % 2 != 0) {
+        length++;
+    }
+    return length;
+}
@@ -1,4 +1,5 @@
 #include "led_mapping_manager.h"
+#include "settings_store.h"
 #include "../mappings/45.h"
 #include "../mappings/45bw.h"
 
@@ -41,11 +42,10 @@ LEDMappingManager::LEDMappingManager() :
 }
 
 void LEDMappingManager::begin() {
-    preferences.begin("led_mapping", false);
     loadSavedMapping();
 
     // Load saved rotation
-    rotationDegrees = preferences.getUShort("rotation", 0);
+    rotationDegrees = settingsStore.getUInt("map.rotation", 0);
     // Validate rotation value
     if (rotationDegrees != 0 && rotationDegrees != 90 && rotationDegrees != 180 && rotationDegrees != 270) {
         rotationDegrees = 0;
@@ -367,15 +367,15 @@ MappingType LEDMappingManager::getCurrentMappingType() const {
 
 // Mapping management
 void LEDMappingManager::saveCurrentMapping() {
-    preferences.putUChar("mapping_type", (uint8_t)currentMappingType);
+    settingsStore.setUInt("map.type", (uint8_t)currentMappingType);
     if (currentMappingId) {
-        preferences.putString("mapping_id", currentMappingId);
+        settingsStore.setString("map.id", currentMappingId);
     }
     Serial.printf("Saved mapping: %s\n", getCurrentMappingName());
 }
 
 void LEDMappingManager::loadSavedMapping() {
-    uint8_t savedType = preferences.getUChar("mapping_type", (uint8_t)MappingType::MAPPING_45_GERMAN);
+    uint8_t savedType = settingsStore.getUInt("map.type", (uint8_t)MappingType::MAPPING_45_GERMAN);
     MappingType type = (MappingType)savedType;
     
     if (isValidMapping(type)) {
@@ -393,25 +393,99 @@ bool LEDMappingManager::isValidMapping(MappingType type) const {
 }
 
 // JSON generators for web interface
-String LEDMappingManager::getMappingInfoJSON() const {
-    String json = "{";
-    json += "\"name\":\"" + String(getCurrentMappingName()) + "\",";
-    json += "\"id\":\"" + String(getCurrentMappingId()) + "\",";
-    json += "\"description\":\"" + String(getCurrentMappingDescription()) + "\",";
-    json += "\"led_count\":" + String(getCurrentMappingLEDCount()) + ",";
-    json += "\"type\":" + String((int)getCurrentMappingType());
-    json += "}";
-    return json;
-}
-
-String LEDMappingManager::getAvailableMappingsJSON() const {
-    String json = "[";
-    json += "{\"name\":\"45cm German\",\"id\":\"45\",\"type\":0,\"led_count\":125,\"status\":\"active\"}";
-    json += ",{\"name\":\"45cm Swabian (BW)\",\"id\":\"45bw\",\"type\":1,\"led_count\":125,\"status\":\"active\"}";
+void LEDMappingManager::writeMappingInfoJSON(JsonWriter& json) const {
+    json.beginObject();
+    json.add("name", getCurrentMappingName());
+    json.add("id", getCurrentMappingId());
+    json.add("description", getCurrentMappingDescription());
+    json.add("led_count", getCurrentMappingLEDCount());
+    json.add("type", (int)getCurrentMappingType());
+    json.endObject();
+}
+
+void LEDMappingManager::writeAvailableMappingsJSON(JsonWriter& json) const {
+    json.beginArray();
+    json.addRaw(nullptr, "{\"name\":\"45cm German\",\"id\":\"45\",\"type\":0,\"led_count\":125,\"status\":\"active\"}");
+    json.addRaw(nullptr, "{\"name\":\"45cm Swabian (BW)\",\"id\":\"45bw\",\"type\":1,\"led_count\":125,\"status\":\"active\"}");
     // Uncomment when 110-LED mapping is implemented:
-    // json += ",{\"name\":\"110-LED German\",\"id\":\"110\",\"type\":2,\"led_count\":110,\"status\":\"coming_soon\"}";
-    json += "]";
-    return json;
+    // json.addRaw(nullptr, "{\"name\":\"110-LED German\",\"id\":\"110\",\"type\":2,\"led_count\":110,\"status\":\"coming_soon\"}");
+    json.endArray();
+}
+
+void LEDMappingManager::writeLayoutJSON(JsonWriter& json) const {
+    json.beginObject();
+    json.add("rows", 11);
+    json.add("cols", 11);
+
+    // Cells row by row as seen on the faceplate, rotation already applied
+    json.beginArray("cells");
+    for (int8_t row = 0; row < 11; row++) {
+        for (int8_t col = 0; col < 11; col++) {
+            json.add(nullptr, (int)transformLedIndex(coordsToIndex(row, col)));
+        }
+    }
+    json.endArray();
+
+    // Minute dots: top-left, top-right, bottom-right, bottom-left
+    json.beginArray("corners");
+    json.add(nullptr, (int)transformLedIndex(coordsToIndex(-1, -1)));
+    json.add(nullptr, (int)transformLedIndex(coordsToIndex(-1, 11)));
+    json.add(nullptr, (int)transformLedIndex(coordsToIndex(11, 11)));
+    json.add(nullptr, (int)transformLedIndex(coordsToIndex(11, -1)));
+    json.endArray();
+
+    json.beginArray("words");
+    writeWordsJSON(json, baseWords, baseWordsCount);
+    writeWordsJSON(json, hourWords, hourWordsCount);
+    writeWordsJSON(json, minuteWords, minuteWordsCount);
+    writeWordsJSON(json, connectorWords, connectorWordsCount);
+    switch (currentMappingType) {
+        case MappingType::MAPPING_45_GERMAN:
+            writeWordsJSON(json, Mapping45::WEEKDAY_WORDS, 7);
+            writeWordsJSON(json, Mapping45::SPECIAL_WORDS, 2);
+            break;
+        case MappingType::MAPPING_45BW_GERMAN:
+            writeWordsJSON(json, Mapping45BW::WEEKDAY_WORDS, 7);
+            writeWordsJSON(json, Mapping45BW::SPECIAL_WORDS, 2);
+            break;
+        default:
+            break;
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void LEDMappingManager::writeWordsJSON(JsonWriter& json, const WordMapping* words, uint8_t count) const {
+    if (!words) return;
+
+    for (uint8_t w = 0; w < count; w++) {
+        // Cell numbers (row * 11 + col) in reading order: every other strip
+        // row runs right to left, so sort what the LED range covers
+        uint8_t cells[11];
+        uint8_t cellCount = 0;
+        for (uint8_t i = 0; i < words[w].length && cellCount < sizeof(cells); i++) {
+            int8_t row, col;
+            indexToCoords(words[w].start_led + i, row, col);
+            if (row < 0 || row > 10 || col < 0 || col > 10) continue;
+
+            uint8_t cell = row * 11 + col;
+            uint8_t pos = cellCount++;
+            while (pos > 0 && cells[pos - 1] > cell) {
+                cells[pos] = cells[pos - 1];
+                pos--;
+            }
+            cells[pos] = cell;
+        }
+
+        json.beginObject();
+        json.add("word", words[w].word);
+        json.beginArray("cells");
+        for (uint8_t i = 0; i < cellCount; i++) {
+            json.add(nullptr, (int)cells[i]);
+        }
+        json.endArray();
+        json.endObject();
+    }
 }
 
 // Status LED and startup sequence configuration
@@ -543,7 +617,7 @@ void LEDMappingManager::setRotationDegrees(uint16_t degrees) {
 }
 
 void LEDMappingManager::saveRotation() {
-    preferences.putUShort("rotation", rotationDegrees);
+    settingsStore.setUInt("map.rotation", rotationDegrees);
     Serial.printf("Saved rotation: %d degrees\n", rotationDegrees);
 }
 
@@ -0,0 +1,32 @@
+#include "light_command.h"
+#include <string.h>
+
+DeserializationError LightCommand::translate(const char* payload, size_t size, bool poweredOn,
+                                             JsonDocument& command) {
+    JsonDocument light;
+    DeserializationError error = deserializeJson(light, payload, size);
+    if (error) {
+        return error;
+    }
+
+    command.clear();
+    command["type"] = "desired";
+    JsonObject desired = command["state"].to<JsonObject>();
+    if (light["brightness"].is<int>()) {
+        desired["brightness"] = light["brightness"];
+    }
+    if (light["color"].is<JsonObject>()) {
+        desired["colorR"] = light["color"]["r"];
+        desired["colorG"] = light["color"]["g"];
+        desired["colorB"] = light["color"]["b"];
+    }
+    if (light["effect"].is<const char*>()) {
+        desired["pattern"] = light["effect"];
+    }
+
+    const char* state = light["state"] | "";
+    if (strcmp(state, "OFF") == 0 || (strcmp(state, "ON") == 0 && !poweredOn)) {
+        desired["powerState"] = state;
+    }
+    return DeserializationError::Ok;
+}
@@ -0,0 +1,331 @@
+#include "local_mqtt_manager.h"
+#include "cloud_manager.h"
+#include "led_controller.h"
+#include "device_identity.h"
+#include "light_command.h"
+#include "settings_store.h"
+#include "tls_arbiter.h"
+
+// Default broker port without and with TLS
+static const uint16_t DEFAULT_PORT = 1883;
+static const uint16_t DEFAULT_TLS_PORT = 8883;
+// TCP connect wait; a broker in the same network answers or refuses at once
+static const int32_t TCP_CONNECT_TIMEOUT_MS = 2000;
+// TLS handshake wait after that, in seconds; the client's default is 120
+static const unsigned long TLS_HANDSHAKE_TIMEOUT_S = 2;
+// CONNACK wait after the CONNECT packet
+static const unsigned long MQTT_CONNECT_TIMEOUT_MS = 5000;
+// Reconnect delay: 2 seconds, doubling with every failure in a row, up to 5 minutes
+static const unsigned long RECONNECT_INTERVAL_MS = 2000;
+static const unsigned long MAX_RECONNECT_BACKOFF_MS = 5 * 60 * 1000;
+// Largest message, what the 512 byte MQTT buffer leaves after topic and header
+static const size_t MAX_PAYLOAD_SIZE = 448;
+// Home Assistant discovery prefix
+static const char* DISCOVERY_PREFIX = "homeassistant";
+// Patterns offered as Home Assistant effects, same names as the cloud's pattern command
+static const char* EFFECTS[] = { "CLOCK_DISPLAY", "RAINBOW", "BREATHING", "SOLID_COLOR" };
+
+LocalMqttManager::LocalMqttManager() :
+    ledController(nullptr),
+    cloudManager(nullptr),
+    firmwareVersion(""),
+    enabled(false),
+    port(DEFAULT_PORT),
+    tls(false),
+    step(LocalMqttStep::IDLE),
+    stepStartTime(0),
+    reconnectBackoff("lan", RECONNECT_INTERVAL_MS, MAX_RECONNECT_BACKOFF_MS),
+    lastConnectMs(0),
+    commands(0),
+    statePublishes(0),
+    publishedRevision(0),
+    statePending(false) {
+    // Same trust model as the cloud connection: encrypted, certificate not checked
+    tlsClient.setInsecure();
+    tlsClient.setHandshakeTimeout(TLS_HANDSHAKE_TIMEOUT_S);
+}
+
+void LocalMqttManager::begin(LEDController* led, CloudManager* cloud, const char* firmware) {
+    ledController = led;
+    cloudManager = cloud;
+    firmwareVersion = firmware;
+    baseTopic = "qlockthree/" + DeviceIdentity::getDeviceId() + "/lan";
+
+    enabled = settingsStore.getBool("lan.enabled", false);
+    host = settingsStore.getString("lan.host");
+    tls = settingsStore.getBool("lan.tls", false);
+    port = settingsStore.getUInt("lan.port", tls ? DEFAULT_TLS_PORT : DEFAULT_PORT);
+    username = settingsStore.getString("lan.user");
+    password = settingsStore.getString("lan.pass");
+
+    // connect() picks the transport, disconnect() needs one from the start
+    mqtt.begin(tcpClient);
+
+    if (enabled && host.length() > 0) {
+        Serial.printf("LAN MQTT broker: %s:%u (%s)\n", host.c_str(), port, tls ? "TLS" : "TCP");
+    } else {
+        Serial.println("LAN MQTT disabled");
+    }
+}
+
+void LocalMqttManager::configure(bool enable, const String& newHost, uint16_t newPort, bool useTls,
+                                 const String& newUsername, const String& newPassword) {
+    enabled = enable;
+    host = newHost;
+    tls = useTls;
+    port = newPort > 0 ? newPort : (tls ? DEFAULT_TLS_PORT : DEFAULT_PORT);
+    username = newUsername;
+    password = newPassword;
+
+    settingsStore.setBool("lan.enabled", enabled);
+    settingsStore.setString("lan.host", host);
+    settingsStore.setBool("lan.tls", tls);
+    settingsStore.setUInt("lan.port", port);
+    settingsStore.setString("lan.user", username);
+    settingsStore.setString("lan.pass", password);
+
+    // The next loop connects with the new settings
+    disconnect();
+    reconnectBackoff.retryNow();
+}
+
+void LocalMqttManager::loop() {
+    if (!enabled || host.length() == 0) {
+        if (step != LocalMqttStep::IDLE) {
+            disconnect();
+        }
+        return;
+    }
+
+    unsigned long timeInStep = millis() - stepStartTime;
+
+    switch (step) {
+        case LocalMqttStep::IDLE:
+            // Without WiFi an attempt can only fail; the GOT_IP event restarts the schedule
+            if (WiFi.status() == WL_CONNECTED && reconnectBackoff.isDue()) {
+                connect();
+            }
+            return;
+
+        case LocalMqttStep::MQTT_CONNECTING:
+            mqtt.update();
+            if (mqtt.isConnected()) {
+                Serial.printf("LAN MQTT connected after %lu ms\n", lastConnectMs + timeInStep);
+                if (!subscribeTopics()) {
+                    connectionFailed("Subscribe failed");
+                    return;
+                }
+                reconnectBackoff.recordSuccess();
+                enterStep(LocalMqttStep::ONLINE);
+
+                publishDiscovery();
+                mqtt.publish(baseTopic + "/availability", String("online"), true, 0);
+                statePending = true;
+            } else if (timeInStep > MQTT_CONNECT_TIMEOUT_MS) {
+                connectionFailed("MQTT connection timeout");
+            }
+            return;
+
+        case LocalMqttStep::ONLINE:
+            mqtt.update();
+            if (!mqtt.isConnected()) {
+                Serial.printf("LAN MQTT connection lost - error: %d\n", mqtt.getLastError());
+                disconnect();
+                // Everyone lost the broker at once if it restarted, spread the reconnects
+                reconnectBackoff.reset();
+                return;
+            }
+
+            if (statePending || cloudManager->getShadow().getRevision() != publishedRevision) {
+                publishState();
+            }
+            return;
+    }
+}
+
+void LocalMqttManager::enterStep(LocalMqttStep next) {
+    step = next;
+    stepStartTime = millis();
+}
+
+void LocalMqttManager::connect() {
+    Serial.printf("Connecting to LAN MQTT broker %s:%u (%s)...\n", host.c_str(), port, tls ? "TLS" : "TCP");
+
+    if (tls && !tlsArbiter.beginHandshake("lan")) {
+        connectionFailed("No room for a TLS handshake");
+        return;
+    }
+
+    // The only blocking part: TCP connect and TLS handshake, 2 s each at most
+    unsigned long connectStart = millis();
+    bool connected = tls ? tlsClient.connect(host.c_str(), port, TCP_CONNECT_TIMEOUT_MS)
+                         : tcpClient.connect(host.c_str(), port, TCP_CONNECT_TIMEOUT_MS);
+    lastConnectMs = millis() - connectStart;
+    if (tls) {
+        tlsArbiter.endHandshake("lan", connected);
+    }
+    if (!connected) {
+        connectionFailed(tls ? "TLS connection failed" : "TCP connection failed");
+        return;
+    }
+    if (!tls) {
+        tcpClient.setNoDelay(true); // Small command and state packets, no Nagle delay
+    }
+
+    // A CONNACK that misses the library's own short wait is still picked up
+    // by update() in MQTT_CONNECTING
+    String clientId = "qlockthree-" + DeviceIdentity::getDeviceId();
+    if (tls) {
+        mqtt.begin(tlsClient);
+    } else {
+        mqtt.begin(tcpClient);
+    }
+    mqtt.setWill(baseTopic + "/availability", "offline", true, 0);
+    if (!mqtt.connect(clientId, username, password)) {
+        Serial.printf("No CONNACK yet (code %d), waiting\n", mqtt.getLastError());
+    }
+    enterStep(LocalMqttStep::MQTT_CONNECTING);
+}
+
+void LocalMqttManager::disconnect() {
+    mqtt.disconnect();
+    tcpClient.stop();
+    tlsClient.stop();
+    tlsArbiter.endSession("lan");
+    enterStep(LocalMqttStep::IDLE);
+}
+
+bool LocalMqttManager::isConnected() {
+    return step == LocalMqttStep::ONLINE && mqtt.isConnected();
+}
+
+bool LocalMqttManager::subscribeTopics() {
+    bool result = mqtt.subscribe(baseTopic + "/set", [this](const char* payload, const size_t size) {
+        handleLightCommand(payload, size);
+    });
+
+    // Same handler as the cloud's command topic
+    result = result && mqtt.subscribe(baseTopic + "/command", [this](const char* payload, const size_t size) {
+        commands++;
+        cloudManager->handleMessage(payload, size);
+    });
+
+    result = result && mqtt.subscribe(baseTopic + "/scene", [this](const char* payload, const size_t size) {
+        commands++;
+        if (ledController && !ledController->showScene((const uint8_t*)payload, size)) {
+            Serial.printf("Rejected scene frame of %u bytes\n", (unsigned)size);
+        }
+    });
+
+    Serial.printf("LAN MQTT subscribe result: %s, topics: %s/#\n", result ? "SUCCESS" : "FAILED", baseTopic.c_str());
+    return result;
+}
+
+void LocalMqttManager::connectionFailed(const char* reason) {
+    disconnect();
+    reconnectBackoff.recordFailure();
+    Serial.printf("LAN MQTT connection failed: %s (%u in a row), next attempt in %lu s\n", reason,
+                  (unsigned)reconnectBackoff.getConsecutiveFailures(), reconnectBackoff.getCurrentDelay() / 1000);
+}
+
+void LocalMqttManager::publishDiscovery() {
+    // Abbreviated keys keep the message within the MQTT buffer
+    String nodeId = "qlockthree_" + DeviceIdentity::getDeviceId();
+    JsonDocument doc;
+    doc["~"] = baseTopic;
+    doc["name"] = nullptr; // The device name is the entity name
+    doc["uniq_id"] = nodeId;
+    doc["schema"] = "json";
+    doc["cmd_t"] = "~/set";
+    doc["stat_t"] = "~/state";
+    doc["avty_t"] = "~/availability";
+    doc["brightness"] = true;
+    doc["sup_clrm"].add("rgb");
+    doc["effect"] = true;
+    JsonArray effects = doc["fx_list"].to<JsonArray>();
+    for (const char* effect : EFFECTS) {
+        effects.add(effect);
+    }
+    JsonObject device = doc["dev"].to<JsonObject>();
+    device["ids"].add(nodeId);
+    device["name"] = "qlockthree";
+    device["mf"] = "craftycram";
+    device["sw"] = firmwareVersion;
+
+    String topic = String(DISCOVERY_PREFIX) + "/light/" + nodeId + "/config";
+    if (!publishDocument(topic, doc)) {
+        Serial.println("LAN MQTT discovery not published");
+    }
+}
+
+void LocalMqttManager::publishState() {
+    const DeviceShadow& shadow = cloudManager->getShadow();
+    JsonDocument doc;
+    doc["state"] = shadow.getPower() ? "ON" : "OFF";
+    doc["brightness"] = shadow.getBrightness();
+    doc["color_mode"] = "rgb";
+    JsonObject color = doc["color"].to<JsonObject>();
+    color["r"] = shadow.getColorR();
+    color["g"] = shadow.getColorG();
+    color["b"] = shadow.getColorB();
+    // Only patterns Home Assistant can select, a scene or the off state has none
+    for (const char* effect : EFFECTS) {
+        if (strcmp(effect, shadow.getPattern()) == 0) {
+            doc["effect"] = effect;
+        }
+    }
+
+    if (publishDocument(baseTopic + "/state", doc)) {
+        publishedRevision = shadow.getRevision();
+        statePending = false;
+        statePublishes++;
+    }
+}
+
+void LocalMqttManager::handleLightCommand(const char* payload, size_t size) {
+    unsigned long receivedUs = micros();
+    commands++;
+
+    bool poweredOn = ledController && ledController->getCurrentPattern() != LEDPattern::OFF;
+    JsonDocument command;
+    DeserializationError error = LightCommand::translate(payload, size, poweredOn, command);
+    if (error) {
+        Serial.printf("LAN light command parse error: %s\n", error.c_str());
+        return;
+    }
+
+    JsonObject commandObject = command.as<JsonObject>();
+    cloudManager->handleCommand(commandObject);
+    if (ledController) {
+        ledController->markInput(receivedUs);
+    }
+}
+
+bool LocalMqttManager::publishDocument(const String& topic, JsonDocument& doc) {
+    size_t size = measureJson(doc);
+    if (size > MAX_PAYLOAD_SIZE) {
+        Serial.printf("LAN MQTT message too large (%u bytes), dropped\n", (unsigned)size);
+        return false;
+    }
+
+    char payload[MAX_PAYLOAD_SIZE + 1]; // serializeJson() adds a terminator
+    size = serializeJson(doc, payload, sizeof(payload));
+    return mqtt.publish(topic, payload, size, true, 0);
+}
+
+void LocalMqttManager::writeStatusJSON(JsonWriter& json) {
+    json.beginObject();
+    json.add("enabled", enabled);
+    json.add("host", host);
+    json.add("port", (unsigned int)port);
+    json.add("tls", tls);
+    json.add("connected", isConnected());
+    json.add("lastConnectMs", lastConnectMs);
+    json.add("commands", (unsigned long)commands);
+    json.add("statePublishes", (unsigned long)statePublishes);
+    if (ledController) {
+        json.add("lastLatencyUs", (unsigned long)ledController->getLastInputLatencyUs());
+        json.add("maxLatencyUs", (unsigned long)ledController->getMaxInputLatencyUs());
+    }
+    json.endObject();
+}
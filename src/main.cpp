@@ -9,7 +9,10 @@
 #include "time_manager.h"
 #include "birthday_manager.h"
 #include "cloud_manager.h"
+#include "local_mqtt_manager.h"
 #include "device_identity.h"
+#include "settings_store.h"
+#include "retry_backoff.h"
 
 // Create module instances
 WiFiManagerHelper wifiManager;
@@ -20,13 +23,102 @@ LEDController ledController;
 TimeManager timeManager;
 BirthdayManager birthdayManager;
 CloudManager cloudManager;
+LocalMqttManager localMqtt;
+
+// Non-blocking NTP error flash state (started from onTimeSyncResult)
+bool errorFlashInProgress = false;
+unsigned long errorFlashStart = 0;
 
 // Debug mode state (resets on reboot)
 bool debugModeEnabled = false;
 int debugHour = 12;
 int debugMinute = 0;
 
+// Render the current (or debug) time on the word clock, including birthday modes
+void renderClock() {
+    int hours, minutes, weekday;
+    uint8_t month, day;
+
+    if (debugModeEnabled) {
+        // Use debug time override
+        hours = debugHour;
+        minutes = debugMinute;
+        weekday = 0;  // Fixed weekday in debug mode
+        month = 1;    // Fixed month in debug mode
+        day = 1;      // Fixed day in debug mode
+    } else {
+        // Use real time (local time cached until the next minute edge)
+        struct tm currentTime = timeManager.getDisplayTime();
+        hours = currentTime.tm_hour;
+        minutes = currentTime.tm_min;
+        weekday = currentTime.tm_wday;  // 0=Sunday, 1=Monday, ..., 6=Saturday
+        month = currentTime.tm_mon + 1;  // tm_mon is 0-11, we need 1-12
+        day = currentTime.tm_mday;
+    }
+
+    // Show time on qlockthree LEDs WITH weekday (and birthday if applicable)
+    if (ledController.getCurrentPattern() == LEDPattern::CLOCK_DISPLAY) {
+        bool isBirthday = birthdayManager.isBirthday(month, day);
+
+        if (isBirthday) {
+            BirthdayManager::DisplayMode mode = birthdayManager.getDisplayMode();
+
+            switch (mode) {
+                case BirthdayManager::DisplayMode::REPLACE:
+                    // Show only HAPPY BIRTHDAY instead of time
+                    ledController.showBirthdayOnly();
+                    break;
+
+                case BirthdayManager::DisplayMode::ALTERNATE:
+                    // Alternate between time and birthday every 3 seconds
+                    if (ledController.shouldShowBirthdayInAlternateMode()) {
+                        ledController.showBirthdayOnly();
+                    } else {
+                        ledController.showTime(hours, minutes, weekday);
+                    }
+                    break;
+
+                case BirthdayManager::DisplayMode::OVERLAY:
+                    // Show both time and HAPPY BIRTHDAY
+                    ledController.showBirthdayOverlay(hours, minutes, weekday);
+                    break;
+            }
+        } else {
+            // No birthday today - show normal time
+            ledController.showTime(hours, minutes, weekday);
+        }
+    }
+}
+
+// Called by TimeManager::loop() when a background NTP sync finishes or times out
+void onTimeSyncResult(bool success) {
+    if (success) {
+        Serial.println("NTP sync successful!");
+        ledController.setTimeOTAStatusLED(0); // Turn off status LED
+    } else if (!errorFlashInProgress) {
+        Serial.println("NTP sync failed - starting error flash sequence");
+        // Start non-blocking error flash sequence
+        errorFlashInProgress = true;
+        errorFlashStart = millis();
+        ledController.setStatusLEDsEnabled(false); // Disable status LED system
+    }
+}
+
+// Called by AutoUpdater while it downloads - the web UI shows the progress live
+void onUpdateProgress(UpdateStage stage, size_t written, size_t total) {
+    webServer.publishUpdateProgress(stage, written, total);
+}
+
+// Runs in the WiFi event task: network retries start over instead of
+// waiting out a backoff that grew while WiFi was down
+void onWiFiGotIP(arduino_event_id_t event, arduino_event_info_t info) {
+    RetryBackoff::resetAll();
+}
+
 void setup() {
+    // Settings come first, every module reads its configuration from them
+    settingsStore.begin();
+    
     // Initialize LED Controller FIRST to ensure threading starts immediately
     // LED count will be set by the mapping manager during initialization
     ledController.begin(LED_DATA_PIN, 125, LED_BRIGHTNESS); // Default count, will be updated by mapping
@@ -43,6 +135,9 @@ void setup() {
     Serial.printf("Chip model: %s\n", ESP.getChipModel());
     Serial.printf("CPU frequency: %d MHz\n", ESP.getCpuFreqMHz());
     
+    // Restore the last-known time so the clock face can come up before NTP
+    timeManager.restoreLastKnownTime();
+    
     // Show beautiful startup animation (rainbow sweep for 1 second)
     Serial.println("Starting rainbow startup animation...");
     ledController.showStartupAnimation();
@@ -50,10 +145,19 @@ void setup() {
     // Animation complete, wait 500ms before turning off
     delay(2000);
     
-    // Turn off LEDs after startup animation
-    Serial.println("Turning off LEDs, continuing setup...");
-    ledController.setPattern(LEDPattern::OFF);
+    if (timeManager.isTimeProvisional()) {
+        // Show the restored time right away - NTP reconciles it once WiFi is up
+        Serial.println("Showing provisional time, continuing setup...");
+        ledController.setPattern(LEDPattern::CLOCK_DISPLAY);
+        renderClock();
+    } else {
+        // Turn off LEDs after startup animation
+        Serial.println("Turning off LEDs, continuing setup...");
+        ledController.setPattern(LEDPattern::OFF);
+    }
     
+    WiFi.onEvent(onWiFiGotIP, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+
     // Initialize WiFi Manager and start connection (non-blocking)
     wifiManager.begin(AP_SSID, AP_PASSWORD, WIFI_TIMEOUT);
     
@@ -74,28 +178,11 @@ void setup() {
         ledController.setTimeOTAStatusLED(4); // NTP syncing - orange breathing
         
         // Initialize Time Manager
+        timeManager.setSyncCallback(onTimeSyncResult);
         timeManager.begin();
         
-        // Check if initial time sync failed and provide visual feedback
-        if (!timeManager.isTimeSynced()) {
-            Serial.println("Initial NTP sync failed - showing error indication");
-            // Flash red 3 times to indicate initial sync failure
-            ledController.setStatusLEDsEnabled(false);
-            int statusLED = ledController.getMappingManager()->getSystemStatusLED();
-            for (int i = 0; i < 3; i++) {
-                ledController.setPixel(statusLED, CRGB::Red);
-                FastLED.show();
-                delay(400);
-                ledController.setPixel(statusLED, CRGB::Black);
-                FastLED.show();
-                delay(400);
-            }
-            ledController.setStatusLEDsEnabled(true);
-            ledController.setTimeOTAStatusLED(4); // Keep orange breathing for retry
-            Serial.println("NTP sync will retry every 30 seconds in main loop");
-        } else {
-            ledController.setTimeOTAStatusLED(0); // Turn off if sync succeeded
-        }
+        // Sync runs in the background - onTimeSyncResult() updates the status LED
+        Serial.println("NTP sync started in background");
         
         // Initialize OTA Manager with LED controller for progress feedback
         otaManager.begin(OTA_HOSTNAME, nullptr, &ledController);
@@ -103,13 +190,14 @@ void setup() {
         
         // Initialize Auto Updater with LED controller for feedback
         autoUpdater.begin("craftycram/qlockthree", CURRENT_VERSION, UPDATE_CHECK_INTERVAL, &ledController);
+        autoUpdater.setProgressCallback(onUpdateProgress);
         
         // Initialize Birthday Manager
         birthdayManager.begin();
         ledController.setBirthdayManager(&birthdayManager);
 
         // Initialize Cloud Manager
-        cloudManager.begin(&ledController);
+        cloudManager.begin(&ledController, CURRENT_VERSION);
 
         // Register cloud command callback
         cloudManager.setCommandCallback([](CloudCommandType type, JsonObject& payload) {
@@ -162,11 +250,15 @@ void setup() {
             }
         });
 
+        // Optional LAN broker, shares the cloud's command handler and shadow
+        localMqtt.begin(&ledController, &cloudManager, CURRENT_VERSION);
+
         // Initialize Web Server with TimeManager and debug state
         webServer.begin(&wifiManager, &autoUpdater, &ledController, &timeManager,
                         &debugModeEnabled, &debugHour, &debugMinute);
         webServer.setBirthdayManager(&birthdayManager);
         webServer.setCloudManager(&cloudManager);
+        webServer.setLocalMqttManager(&localMqtt);
         
         // Initial update check (show update mode during check)
         if (autoUpdater.isUpdateAvailable()) {
@@ -176,7 +268,10 @@ void setup() {
         autoUpdater.checkForUpdates();
         
         // Keep LEDs off until time is synced - clock display will start when time is synced
-        ledController.setPattern(LEDPattern::OFF);
+        // (a provisionally restored time stays on screen meanwhile)
+        if (!timeManager.isTimeSynced() && !timeManager.isTimeProvisional()) {
+            ledController.setPattern(LEDPattern::OFF);
+        }
         
         Serial.println("Setup complete!");
         Serial.print("IP address: ");
@@ -190,16 +285,19 @@ void setup() {
     } else {
         Serial.println("WiFi configuration mode active - connect to " + String(AP_SSID));
     }
+
+    // Every module has read its settings by now
+    settingsStore.checkCapacity();
 }
 
 void loop() {
     // Declare static variables at the top of function
     static unsigned long lastTimeUpdate = 0;
     static bool clockStarted = false;
-    static bool ntpSyncInProgress = false;
-    static bool errorFlashInProgress = false;
-    static unsigned long errorFlashStart = 0;
-    static int errorFlashCount = 0;
+    
+    // Background NTP results and time checkpoints - also while offline
+    timeManager.loop();
+    settingsStore.loop();
     
     // Handle WiFi Manager (captive portal) - check both config mode and WiFi mode
     bool configModeActive = wifiManager.isConfigModeActive();
@@ -255,6 +353,7 @@ void loop() {
     otaManager.handle();
     webServer.handleClient();
     cloudManager.loop();
+    localMqtt.loop();
     
     // Check for updates ONLY AFTER time sync is complete
     static unsigned long lastUpdateCheck = 0;
@@ -266,8 +365,9 @@ void loop() {
         Serial.println("Time synced - starting initial update check...");
         ledController.setUpdateStatusLED(1); // Blue breathing - checking for updates
         
-        // Force the update check (ignore interval for initial check)
-        autoUpdater.checkForUpdates(true);
+        // Runs unless the check from setup() already succeeded; forcing it
+        // would cost a second TLS handshake seconds after the first
+        autoUpdater.checkForUpdates();
         
         // Get version information after check
         String latestVersion = autoUpdater.getLatestVersion();
@@ -280,22 +380,11 @@ void loop() {
             Serial.printf("Latest Version: %s\n", latestVersion.c_str());
             
             if (autoUpdater.isUpdateAvailable()) {
-                Serial.println("Update Status: UPDATE AVAILABLE!");
-                ledController.setUpdateStatusLED(2); // Purple breathing - downloading update
-                
-                // Show update mode during update process
-                ledController.showUpdateMode();
-                
-                // Perform the update
-                bool updateSuccess = autoUpdater.performUpdate();
-                
-                if (updateSuccess) {
-                    ledController.setUpdateStatusLED(3); // Green flashing - update success
-                    Serial.println("Update completed successfully - device will restart");
-                } else {
-                    ledController.setUpdateStatusLED(4); // Red flashing - update error
-                    Serial.println("Update failed - continuing with current version");
-                }
+                // The check installs by itself and restarts on success; still
+                // available means the install failed, and the updater's own
+                // backoff schedules the next attempt
+                Serial.println("Update Status: UPDATE AVAILABLE, not installed yet");
+                ledController.setUpdateStatusLED(4); // Red flashing - update error
             } else {
                 Serial.println("Update Status: Already up to date");
                 ledController.setUpdateStatusLED(0); // Turn off update LED
@@ -334,22 +423,11 @@ void loop() {
             Serial.printf("Latest Version: %s\n", latestVersion.c_str());
             
             if (autoUpdater.isUpdateAvailable()) {
-                Serial.println("Update Status: UPDATE AVAILABLE!");
-                ledController.setUpdateStatusLED(2); // Purple breathing - downloading update
-                
-                // Show update mode during update process
-                ledController.showUpdateMode();
-                
-                // Perform the update
-                bool updateSuccess = autoUpdater.performUpdate();
-                
-                if (updateSuccess) {
-                    ledController.setUpdateStatusLED(3); // Green flashing - update success
-                    Serial.println("Update completed successfully - device will restart");
-                } else {
-                    ledController.setUpdateStatusLED(4); // Red flashing - update error
-                    Serial.println("Update failed - continuing with current version");
-                }
+                // The check installs by itself and restarts on success; still
+                // available means the install failed, and the updater's own
+                // backoff schedules the next attempt
+                Serial.println("Update Status: UPDATE AVAILABLE, not installed yet");
+                ledController.setUpdateStatusLED(4); // Red flashing - update error
             } else {
                 Serial.println("Update Status: Already up to date");
                 ledController.setUpdateStatusLED(0); // Turn off update LED
@@ -371,18 +449,24 @@ void loop() {
         lastTimeUpdate = millis();
         
         // Manage NTP status LED based on sync state
-        if (!timeManager.isTimeSynced() && !ntpSyncInProgress) {
+        if (!timeManager.isTimeSynced() && !timeManager.isSyncInProgress()) {
             // Time not synced and no sync in progress - show orange breathing
             ledController.setTimeOTAStatusLED(4); // Orange breathing for NTP sync needed
         }
         
-        // Only start clock display when time is actually synced AND valid
+        // Only start clock display when time is synced (or provisionally restored) AND valid
         time_t currentTimeSeconds = time(nullptr);
         bool hasValidTime = currentTimeSeconds > 1000000000L; // Valid timestamp
+        bool clockTimeAvailable = timeManager.isTimeSynced() || timeManager.isTimeProvisional();
         
-        if (timeManager.isTimeSynced() && hasValidTime && !clockStarted) {
-            Serial.println("Time synced - starting clock display");
-            ledController.setTimeOTAStatusLED(0); // Turn off NTP sync indicator
+        if (clockTimeAvailable && hasValidTime && !clockStarted) {
+            if (timeManager.isTimeSynced()) {
+                Serial.println("Time synced - starting clock display");
+                ledController.setTimeOTAStatusLED(0); // Turn off NTP sync indicator
+            } else {
+                // Provisional: orange NTP indicator keeps breathing until NTP confirms the time
+                Serial.println("Provisional time - starting clock display");
+            }
             ledController.setPattern(LEDPattern::CLOCK_DISPLAY);
             clockStarted = true;
         } else if (!hasValidTime && clockStarted) {
@@ -393,59 +477,8 @@ void loop() {
         }
         
         // Get accurate time from TimeManager (only if valid) or use debug time
-        if (timeManager.isTimeSynced() && hasValidTime) {
-            int hours, minutes, weekday;
-            uint8_t month, day;
-
-            if (debugModeEnabled) {
-                // Use debug time override
-                hours = debugHour;
-                minutes = debugMinute;
-                weekday = 0;  // Fixed weekday in debug mode
-                month = 1;    // Fixed month in debug mode
-                day = 1;      // Fixed day in debug mode
-            } else {
-                // Use real time
-                struct tm currentTime = timeManager.getCurrentTime();
-                hours = currentTime.tm_hour;
-                minutes = currentTime.tm_min;
-                weekday = currentTime.tm_wday;  // 0=Sunday, 1=Monday, ..., 6=Saturday
-                month = currentTime.tm_mon + 1;  // tm_mon is 0-11, we need 1-12
-                day = currentTime.tm_mday;
-            }
-
-            // Show time on qlockthree LEDs WITH weekday (and birthday if applicable)
-            if (ledController.getCurrentPattern() == LEDPattern::CLOCK_DISPLAY) {
-                bool isBirthday = birthdayManager.isBirthday(month, day);
-
-                if (isBirthday) {
-                    BirthdayManager::DisplayMode mode = birthdayManager.getDisplayMode();
-
-                    switch (mode) {
-                        case BirthdayManager::DisplayMode::REPLACE:
-                            // Show only HAPPY BIRTHDAY instead of time
-                            ledController.showBirthdayOnly();
-                            break;
-
-                        case BirthdayManager::DisplayMode::ALTERNATE:
-                            // Alternate between time and birthday every 3 seconds
-                            if (ledController.shouldShowBirthdayInAlternateMode()) {
-                                ledController.showBirthdayOnly();
-                            } else {
-                                ledController.showTime(hours, minutes, weekday);
-                            }
-                            break;
-
-                        case BirthdayManager::DisplayMode::OVERLAY:
-                            // Show both time and HAPPY BIRTHDAY
-                            ledController.showBirthdayOverlay(hours, minutes, weekday);
-                            break;
-                    }
-                } else {
-                    // No birthday today - show normal time
-                    ledController.showTime(hours, minutes, weekday);
-                }
-            }
+        if (clockTimeAvailable && hasValidTime) {
+            renderClock();
         }
         
         // Debug: Print current pattern
@@ -456,32 +489,24 @@ void loop() {
         }
     }
     
-    // Periodic time sync check with proper LED feedback
+    // Flip the words exactly at the local minute boundary instead of the 1 s tick phase
+    if (clockStarted && timeManager.pollMinuteEdge()) {
+        renderClock();
+        timeManager.recordMinuteFlip();
+    }
+    
+    // Periodic time sync retry - results arrive via onTimeSyncResult()
     static unsigned long lastSyncCheck = 0;
-    if (!timeManager.isTimeSynced() && (millis() - lastSyncCheck > 30000)) { // Every 30 seconds if not synced
+    if (!timeManager.isTimeSynced() && !timeManager.isSyncInProgress() &&
+        (millis() - lastSyncCheck > 30000)) { // Every 30 seconds if not synced
         lastSyncCheck = millis();
-        ntpSyncInProgress = true;
         
         Serial.println("Attempting time synchronization...");
         
         // Show visual feedback DURING sync attempt - orange breathing (handled by thread)
         ledController.setTimeOTAStatusLED(4); // Orange breathing during sync
         
-        bool syncSuccess = timeManager.syncTime();
-        
-        if (syncSuccess) {
-            Serial.println("NTP sync successful!");
-            ledController.setTimeOTAStatusLED(0); // Turn off status LED
-            ntpSyncInProgress = false;
-        } else {
-            Serial.println("NTP sync failed - starting error flash sequence");
-            // Start non-blocking error flash sequence
-            errorFlashInProgress = true;
-            errorFlashStart = millis();
-            errorFlashCount = 0;
-            ledController.setStatusLEDsEnabled(false); // Disable status LED system
-            ntpSyncInProgress = false;
-        }
+        timeManager.syncTime();
     }
     
     // Handle non-blocking error flash sequence
@@ -537,5 +562,12 @@ void loop() {
     // - Special animations
     
     // Small delay to prevent watchdog issues
-    delay(10);
+    // Sleep at most 10 ms, but wake right at an upcoming minute edge
+    unsigned long untilEdgeUs = clockStarted ? timeManager.getMicrosUntilMinuteEdge() : 10000;
+    if (untilEdgeUs < 10000) {
+        delay(untilEdgeUs / 1000);
+        delayMicroseconds(untilEdgeUs % 1000);
+    } else {
+        delay(10);
+    }
 }
@@ -0,0 +1,102 @@
+#include "retry_backoff.h"
+
+RetryBackoff* RetryBackoff::first = nullptr;
+volatile uint32_t RetryBackoff::generation = 0;
+
+RetryBackoff::RetryBackoff(const char* name, unsigned long baseDelayMs, unsigned long maxDelayMs) :
+    name(name),
+    baseDelay(baseDelayMs),
+    maxDelay(maxDelayMs),
+    lastScheduled(0),
+    currentDelay(0),
+    consecutiveFailures(0),
+    attempts(0),
+    failures(0),
+    wifiResets(0),
+    seenGeneration(0),
+    next(first) {
+    // Instances are globals or members of globals, they are never removed
+    first = this;
+}
+
+bool RetryBackoff::isDue() {
+    checkWiFiReset();
+    return millis() - lastScheduled >= currentDelay;
+}
+
+unsigned long RetryBackoff::getTimeUntilDue() {
+    checkWiFiReset();
+    unsigned long elapsed = millis() - lastScheduled;
+    return elapsed >= currentDelay ? 0 : currentDelay - elapsed;
+}
+
+void RetryBackoff::recordSuccess(unsigned long nextAttemptMs) {
+    attempts++;
+    consecutiveFailures = 0;
+    lastScheduled = millis();
+    currentDelay = nextAttemptMs;
+}
+
+void RetryBackoff::recordFailure() {
+    attempts++;
+    failures++;
+
+    // base * 2^(failures - 1), without overflowing on long outages
+    unsigned long delayMs = baseDelay;
+    for (uint32_t i = 0; i < consecutiveFailures && delayMs < maxDelay; i++) {
+        delayMs *= 2;
+    }
+    if (delayMs > maxDelay) {
+        delayMs = maxDelay;
+    }
+    consecutiveFailures++;
+    schedule(delayMs / 2 + random(delayMs / 2 + 1));
+}
+
+void RetryBackoff::reset() {
+    consecutiveFailures = 0;
+    schedule(random(baseDelay + 1));
+}
+
+void RetryBackoff::retryNow() {
+    consecutiveFailures = 0;
+    schedule(0);
+}
+
+void RetryBackoff::writeStatusJSON(JsonWriter& json) {
+    json.add("attempts", (unsigned long)attempts);
+    json.add("failures", (unsigned long)failures);
+    json.add("consecutive", (unsigned long)consecutiveFailures);
+    json.add("delay_ms", currentDelay);
+    // Whole seconds, so status pushes follow the countdown only once a second
+    json.add("next_in_s", (getTimeUntilDue() + 999) / 1000);
+    json.add("wifi_resets", (unsigned long)wifiResets);
+}
+
+void RetryBackoff::resetAll() {
+    generation = generation + 1;
+}
+
+void RetryBackoff::writeAllJSON(JsonWriter& json) {
+    for (RetryBackoff* backoff = first; backoff; backoff = backoff->next) {
+        json.beginObject(backoff->name);
+        backoff->writeStatusJSON(json);
+        json.endObject();
+    }
+}
+
+void RetryBackoff::schedule(unsigned long delayMs) {
+    lastScheduled = millis();
+    currentDelay = delayMs;
+}
+
+void RetryBackoff::checkWiFiReset() {
+    // resetAll() runs in the WiFi event task, so it only bumps a counter
+    uint32_t current = generation;
+    if (current == seenGeneration) {
+        return;
+    }
+    seenGeneration = current;
+    wifiResets++;
+    reset();
+}
@@ -0,0 +1,365 @@
+#include "settings_store.h"
+#include <esp_system.h>
+
+// The single NVS namespace all settings live in
+static const char* NAMESPACE = "settings";
+// Set once the old per-module namespaces have been moved over
+static const char* SCHEMA_KEY = "schema";
+static const uint8_t SCHEMA_VERSION = 1;
+// Changes are committed once nothing changed for this long...
+static const unsigned long COMMIT_DELAY_MS = 2000;
+// ...but never later than this after the first uncommitted change
+static const unsigned long MAX_COMMIT_DELAY_MS = 10000;
+
+// Where values lived before the store existed, and how they were typed
+enum class LegacyType : uint8_t { U8, U16, I32, U32, I64, STR };
+
+struct LegacyKey {
+    const char* space;
+    const char* oldKey;
+    const char* newKey;
+    LegacyType type;
+};
+
+static const LegacyKey LEGACY_KEYS[] = {
+    {"led_config", "data_pin", "led.pin", LegacyType::I32},
+    {"led_config", "num_leds", "led.count", LegacyType::I32},
+    {"led_config", "brightness", "led.bright", LegacyType::U8},
+    {"led_config", "speed", "led.speed", LegacyType::U8},
+    {"led_config", "solid_color", "led.color", LegacyType::U32},
+    {"led_mapping", "mapping_type", "map.type", LegacyType::U8},
+    {"led_mapping", "mapping_id", "map.id", LegacyType::STR},
+    {"led_mapping", "rotation", "map.rotation", LegacyType::U16},
+    {"time_manager", "timezone", "time.tz", LegacyType::STR},
+    {"time_manager", "tz_name", "time.tz_name", LegacyType::STR},
+    {"time_manager", "ntp_server1", "time.ntp1", LegacyType::STR},
+    {"time_manager", "ntp_server2", "time.ntp2", LegacyType::STR},
+    {"time_manager", "ntp_server3", "time.ntp3", LegacyType::STR},
+    {"time_manager", "last_epoch_us", "time.last_us", LegacyType::I64},
+    {"time_manager", "last_unc_ms", "time.last_unc", LegacyType::U32},
+    {"birthdays", "mode", "bday.mode", LegacyType::U8},
+    {"birthdays", "dates", "bday.dates", LegacyType::STR},
+    {"qlockthree", "wifi_ssid", "wifi.ssid", LegacyType::STR},
+    {"qlockthree", "wifi_password", "wifi.password", LegacyType::STR},
+};
+
+SettingsStore settingsStore;
+SettingsStore* SettingsStore::instance = nullptr;
+
+SettingsStore::SettingsStore() :
+    opened(false),
+    entryCount(0),
+    version(0),
+    committedVersion(0),
+    firstChangeTime(0),
+    lastChangeTime(0),
+    setCalls(0),
+    unchangedSets(0),
+    nvsReads(0),
+    nvsWrites(0),
+    commits(0),
+    refusedKeys(0) {
+}
+
+void SettingsStore::begin() {
+    if (opened) {
+        return;
+    }
+    opened = preferences.begin(NAMESPACE, false);
+    if (!opened) {
+        Serial.println("Settings: failed to open NVS, changes will not persist");
+        return;
+    }
+
+    if (!preferences.isKey(SCHEMA_KEY)) {
+        migrateLegacyNamespaces();
+        preferences.putUChar(SCHEMA_KEY, SCHEMA_VERSION);
+    }
+
+    instance = this;
+    esp_register_shutdown_handler(shutdownHandler);
+    Serial.printf("Settings store ready, %u free NVS entries\n", (unsigned)preferences.freeEntries());
+}
+
+void SettingsStore::checkCapacity() {
+    Serial.printf("Settings: %d of %d entries in use\n", entryCount, MAX_ENTRIES);
+    if (refusedKeys > 0) {
+        Serial.printf("Settings: %lu keys did not fit, raise SettingsStore::MAX_ENTRIES\n",
+                      (unsigned long)refusedKeys);
+        abort();
+    }
+}
+
+void SettingsStore::loop() {
+    if (!hasPendingChanges()) {
+        return;
+    }
+    unsigned long now = millis();
+    if (now - lastChangeTime >= COMMIT_DELAY_MS || now - firstChangeTime >= MAX_COMMIT_DELAY_MS) {
+        commit();
+    }
+}
+
+void SettingsStore::flush() {
+    if (hasPendingChanges()) {
+        commit();
+    }
+}
+
+int32_t SettingsStore::getInt(const char* key, int32_t defaultValue) {
+    Entry* entry = find(key, Type::INT);
+    return entry && entry->present ? (int32_t)entry->number : defaultValue;
+}
+
+uint32_t SettingsStore::getUInt(const char* key, uint32_t defaultValue) {
+    Entry* entry = find(key, Type::UINT);
+    return entry && entry->present ? (uint32_t)entry->number : defaultValue;
+}
+
+int64_t SettingsStore::getLong64(const char* key, int64_t defaultValue) {
+    Entry* entry = find(key, Type::LONG64);
+    return entry && entry->present ? entry->number : defaultValue;
+}
+
+String SettingsStore::getString(const char* key, const char* defaultValue) {
+    Entry* entry = find(key, Type::STRING);
+    return entry && entry->present ? entry->text : String(defaultValue);
+}
+
+bool SettingsStore::isKey(const char* key) {
+    for (int i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].key, key) == 0) {
+            return entries[i].present;
+        }
+    }
+    if (!opened) {
+        return false;
+    }
+    nvsReads++;
+    return preferences.isKey(key);
+}
+
+void SettingsStore::setInt(const char* key, int32_t value) {
+    setNumber(key, Type::INT, value);
+}
+
+void SettingsStore::setUInt(const char* key, uint32_t value) {
+    setNumber(key, Type::UINT, value);
+}
+
+void SettingsStore::setLong64(const char* key, int64_t value) {
+    setNumber(key, Type::LONG64, value);
+}
+
+void SettingsStore::setString(const char* key, const String& value) {
+    setCalls++;
+    Entry* entry = find(key, Type::STRING);
+    if (!entry) {
+        return;
+    }
+    if (entry->present && entry->text == value) {
+        unchangedSets++;
+        return;
+    }
+    entry->text = value;
+    entry->present = true;
+    markChanged(*entry);
+}
+
+void SettingsStore::remove(const char* key) {
+    setCalls++;
+    for (int i = 0; i < entryCount; i++) {
+        Entry& entry = entries[i];
+        if (strcmp(entry.key, key) != 0) {
+            continue;
+        }
+        if (!entry.present) {
+            unchangedSets++;
+            return;
+        }
+        entry.present = false;
+        entry.number = 0;
+        entry.text = String();
+        markChanged(entry);
+        return;
+    }
+
+    // Never read: only NVS can have it
+    if (opened && preferences.isKey(key)) {
+        preferences.remove(key);
+        nvsWrites++;
+    } else {
+        unchangedSets++;
+    }
+}
+
+void SettingsStore::clear() {
+    if (opened) {
+        preferences.clear();
+        preferences.putUChar(SCHEMA_KEY, SCHEMA_VERSION);
+    }
+    for (int i = 0; i < entryCount; i++) {
+        entries[i].text = String();
+    }
+    entryCount = 0;
+    version++;
+    committedVersion = version;
+    Serial.println("Settings cleared");
+}
+
+void SettingsStore::writeStatusJSON(JsonWriter& json) {
+    json.add("version", (unsigned long)version);
+    json.add("pending", hasPendingChanges());
+    json.add("entries", entryCount);
+    json.add("capacity", MAX_ENTRIES);
+    json.add("set_calls", (unsigned long)setCalls);
+    json.add("unchanged", (unsigned long)unchangedSets);
+    json.add("nvs_writes", (unsigned long)nvsWrites);
+    json.add("nvs_reads", (unsigned long)nvsReads);
+    json.add("writes_saved", (unsigned long)(setCalls > nvsWrites ? setCalls - nvsWrites : 0));
+    json.add("commits", (unsigned long)commits);
+}
+
+SettingsStore::Entry* SettingsStore::find(const char* key, Type type) {
+    for (int i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].key, key) == 0) {
+            if (entries[i].type != type) {
+                Serial.printf("Settings: %s used with two different types\n", key);
+                return nullptr;
+            }
+            return &entries[i];
+        }
+    }
+
+    if (strlen(key) >= sizeof(entries[0].key)) {
+        Serial.printf("Settings: key %s is longer than 15 characters\n", key);
+        return nullptr;
+    }
+    if (entryCount >= MAX_ENTRIES) {
+        refusedKeys++;
+        Serial.printf("Settings: ERROR no room for %s, all %d entries taken - it will not be saved\n",
+                      key, MAX_ENTRIES);
+        return nullptr;
+    }
+
+    // First access: cache what NVS has
+    Entry& entry = entries[entryCount++];
+    strcpy(entry.key, key);
+    entry.type = type;
+    entry.dirty = false;
+    entry.number = 0;
+    entry.text = String();
+    entry.present = false;
+    if (opened) {
+        nvsReads++;
+        entry.present = preferences.isKey(key);
+    }
+    if (entry.present) {
+        switch (type) {
+            case Type::INT: entry.number = preferences.getInt(key, 0); break;
+            case Type::UINT: entry.number = preferences.getUInt(key, 0); break;
+            case Type::LONG64: entry.number = preferences.getLong64(key, 0); break;
+            case Type::STRING: entry.text = preferences.getString(key, ""); break;
+        }
+    }
+    return &entry;
+}
+
+void SettingsStore::setNumber(const char* key, Type type, int64_t value) {
+    setCalls++;
+    Entry* entry = find(key, type);
+    if (!entry) {
+        return;
+    }
+    if (entry->present && entry->number == value) {
+        unchangedSets++;
+        return;
+    }
+    entry->number = value;
+    entry->present = true;
+    markChanged(*entry);
+}
+
+void SettingsStore::markChanged(Entry& entry) {
+    if (!hasPendingChanges()) {
+        firstChangeTime = millis();
+    }
+    lastChangeTime = millis();
+    entry.dirty = true;
+    version++;
+}
+
+void SettingsStore::commit() {
+    int written = 0;
+    for (int i = 0; i < entryCount; i++) {
+        Entry& entry = entries[i];
+        if (!entry.dirty) {
+            continue;
+        }
+        entry.dirty = false;
+        if (!opened) {
+            continue;
+        }
+
+        if (!entry.present) {
+            preferences.remove(entry.key);
+        } else {
+            switch (entry.type) {
+                case Type::INT: preferences.putInt(entry.key, (int32_t)entry.number); break;
+                case Type::UINT: preferences.putUInt(entry.key, (uint32_t)entry.number); break;
+                case Type::LONG64: preferences.putLong64(entry.key, entry.number); break;
+                case Type::STRING: preferences.putString(entry.key, entry.text); break;
+            }
+        }
+        written++;
+    }
+
+    nvsWrites += written;
+    commits++;
+    committedVersion = version;
+    Serial.printf("Settings: committed %d values (%lu of %lu writes saved so far)\n", written,
+                  (unsigned long)(setCalls - nvsWrites), (unsigned long)setCalls);
+}
+
+void SettingsStore::migrateLegacyNamespaces() {
+    Preferences legacy;
+    const char* openSpace = nullptr;
+    int moved = 0;
+
+    for (size_t i = 0; i < sizeof(LEGACY_KEYS) / sizeof(LEGACY_KEYS[0]); i++) {
+        const LegacyKey& key = LEGACY_KEYS[i];
+        if (!openSpace || strcmp(openSpace, key.space) != 0) {
+            if (openSpace) {
+                legacy.clear();
+                legacy.end();
+            }
+            openSpace = key.space;
+            legacy.begin(openSpace, false);
+        }
+        if (!legacy.isKey(key.oldKey)) {
+            continue;
+        }
+
+        switch (key.type) {
+            case LegacyType::U8: preferences.putUInt(key.newKey, legacy.getUChar(key.oldKey, 0)); break;
+            case LegacyType::U16: preferences.putUInt(key.newKey, legacy.getUShort(key.oldKey, 0)); break;
+            case LegacyType::I32: preferences.putInt(key.newKey, legacy.getInt(key.oldKey, 0)); break;
+            case LegacyType::U32: preferences.putUInt(key.newKey, legacy.getUInt(key.oldKey, 0)); break;
+            case LegacyType::I64: preferences.putLong64(key.newKey, legacy.getLong64(key.oldKey, 0)); break;
+            case LegacyType::STR: preferences.putString(key.newKey, legacy.getString(key.oldKey, "")); break;
+        }
+        moved++;
+    }
+    if (openSpace) {
+        legacy.clear();
+        legacy.end();
+    }
+
+    Serial.printf("Settings: moved %d values from the old namespaces\n", moved);
+}
+
+void SettingsStore::shutdownHandler() {
+    if (instance) {
+        instance->flush();
+    }
+}
@@ -1,4 +1,68 @@
 #include "time_manager.h"
+#include "timezone_database.h"
+#include <esp_attr.h>
+#include <esp_system.h>
+#include "settings_store.h"
+#include <sys/time.h>
+#include <stddef.h>
+#include <limits.h>
+#include <math.h>
+#include <esp_timer.h>
+
+// Last-known time snapshot magic ("QLKT")
+static const uint32_t RTC_SNAPSHOT_MAGIC = 0x514C4B54;
+// Crystal drift assumed when aging a time estimate (parts per million)
+static const unsigned long CLOCK_DRIFT_PPM = 50;
+// Time spent in the ROM bootloader before millis() starts counting
+static const unsigned long BOOT_OVERHEAD_MS = 500;
+// RTC checkpoint interval - bounds the time lost on a watchdog reset
+static const unsigned long CHECKPOINT_INTERVAL_MS = 1000;
+// Largest error bound at which the clock face is still shown provisionally
+static const unsigned long PROVISIONAL_MAX_UNCERTAINTY_MS = 120000;
+// Largest error bound at which the time still counts as synced
+static const unsigned long SYNCED_MAX_UNCERTAINTY_MS = 1000;
+// Only share our clock with peers while its error bound is at most this
+static const unsigned long PEER_SHARE_MAX_UNCERTAINTY_MS = 250;
+// Drift is only measured between syncs at least this precise
+static const unsigned long DRIFT_MAX_SAMPLE_ERROR_MS = 50;
+// Adaptive resync interval: keep accumulated drift below this error
+static const float TARGET_DRIFT_ERROR_MS = 250.0f;
+static const unsigned long MIN_SYNC_INTERVAL_MS = 15UL * 60 * 1000;     // 15 minutes
+static const unsigned long MAX_SYNC_INTERVAL_MS = 24UL * 60 * 60 * 1000; // 24 hours
+// Drift estimation: shortest useful span, smoothing factor and safety margin
+static const unsigned long MIN_DRIFT_SPAN_MS = 10UL * 60 * 1000;
+static const float DRIFT_SMOOTHING = 0.3f;
+static const float DRIFT_MARGIN_PPM = 2.0f;
+
+// Snapshot kept in RTC memory, which survives everything except power-on/brownout resets
+struct RtcTimeSnapshot {
+    int64_t epochUs;          // UTC wall clock at the checkpoint
+    uint32_t uncertaintyMs;   // Error bound at the checkpoint
+    uint32_t cleanShutdown;   // 1 if written by the shutdown handler
+    uint32_t magic;
+    uint32_t checksum;
+};
+
+static RTC_NOINIT_ATTR RtcTimeSnapshot rtcSnapshot;
+
+static uint32_t snapshotChecksum(const RtcTimeSnapshot& snapshot) {
+    // FNV-1a over everything except the checksum itself
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&snapshot);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(RtcTimeSnapshot, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static int64_t currentEpochUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+TimeManager* TimeManager::instance = nullptr;
+
 
 // Common timezone definitions
 const TimeManager::TimezoneInfo TimeManager::timezones[] = {
@@ -27,11 +91,32 @@ TimeManager::TimeManager() :
     currentTimezone("CET-1CEST,M3.5.0,M10.5.0/3"),
     ntpServer1("pool.ntp.org"),
     ntpServer2("time.nist.gov"),
-    ntpServer3("de.pool.ntp.org") {
+    ntpServer3("de.pool.ntp.org"),
+    hasTimeEstimate(false),
+    timeRestored(false),
+    estimateBaseMillis(0),
+    estimateBaseUncertaintyMs(0),
+    lastSyncCorrectionMs(0),
+    lastCheckpoint(0),
+    referenceEpochUs(0),
+    referenceTimerUs(0),
+    referenceErrorMs(0),
+    driftPpm(0.0f),
+    driftKnown(false),
+    syncCount(0),
+    syncCallback(nullptr),
+    nextMinuteEdgeUs(0),
+    pendingFlipEdgeUs(0),
+    lastFlipLatencyUs(0),
+    maxFlipLatencyUs(0),
+    minuteFlipCount(0) {
+    instance = this;
+    
+    // Save the last-known time on every controlled restart (OTA, reboot endpoint, updater)
+    esp_register_shutdown_handler(shutdownHandler);
 }
 
 void TimeManager::begin() {
-    preferences.begin("time_manager", false);
     loadSettings();
     
     Serial.println("Time Manager initialized");
@@ -47,8 +132,13 @@ void TimeManager::begin() {
 }
 
 void TimeManager::configureTimezone() {
+    // libc still gets TZ for strftime() and friends; conversions use the cached rules
     setenv("TZ", currentTimezone.c_str(), 1);
     tzset();
+    if (!tzRules.parse(currentTimezone.c_str())) {
+        Serial.println("Timezone rules not parseable - falling back to localtime_r");
+    }
+    nextMinuteEdgeUs = 0; // Local minutes moved - reschedule the display
     Serial.printf("Timezone configured: %s\n", currentTimezone.c_str());
 }
 
@@ -58,65 +148,356 @@ bool TimeManager::syncTime() {
         return false;
     }
     
-    Serial.println("Synchronizing time via NTP...");
+    if (timeSources.isRoundActive()) {
+        return true;
+    }
     
-    // First configure timezone
-    configureTimezone();
+    // Non-blocking: all sources are queried at once, loop() collects the replies
+    String servers[] = {ntpServer1, ntpServer2, ntpServer3};
+    if (!timeSources.startRound(servers, 3)) {
+        return false;
+    }
     
-    // Configure NTP with timezone awareness
-    configTime(0, 0, ntpServer1.c_str(), ntpServer2.c_str(), ntpServer3.c_str());
+    Serial.println("Time sync requested");
+    return true;
+}
+
+void TimeManager::loop() {
+    // Answer peers only with time that came from a real sync
+    bool shareTime = timeSynced && getTimeUncertaintyMs() <= PEER_SHARE_MAX_UNCERTAINTY_MS;
+    timeSources.loop(shareTime, shareTime ? getTimeUncertaintyMs() : 0);
     
-    // Wait for time sync (up to 10 seconds)
-    int attempts = 0;
-    while (time(nullptr) < 1000000000L && attempts < 100) {
-        delay(100);
-        attempts++;
+    TimeEstimate estimate;
+    switch (timeSources.pollRound(estimate)) {
+        case TimeSourceManager::RoundResult::SUCCESS:
+            applyTimeEstimate(estimate);
+            break;
+            
+        case TimeSourceManager::RoundResult::FAILED:
+            Serial.println("Failed to synchronize time");
+            if (syncCallback) {
+                syncCallback(false);
+            }
+            break;
+            
+        case TimeSourceManager::RoundResult::NONE:
+            break;
     }
     
-    time_t now = time(nullptr);
-    if (now > 1000000000L) {
-        timeSynced = true;
-        lastSyncTime = millis();
-        
-        // Ensure timezone is applied after sync
-        configureTimezone();
-        
-        struct tm* timeinfo = localtime(&now);
-        Serial.printf("Time synchronized: %04d-%02d-%02d %02d:%02d:%02d (DST: %s)\n", 
-                     timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-                     timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
-                     timeinfo->tm_isdst ? "Yes" : "No");
+    // Scheduled resync once synced - the interval adapts to the measured drift
+    if (timeSynced && !timeSources.isRoundActive() && WiFi.status() == WL_CONNECTED &&
+        millis() - lastSyncTime >= syncInterval) {
+        syncTime();
+    }
+    
+    checkpointTime();
+}
+
+void TimeManager::setSyncCallback(TimeSyncCallback callback) {
+    syncCallback = callback;
+}
+
+bool TimeManager::isSyncInProgress() {
+    return timeSources.isRoundActive();
+}
+
+void TimeManager::reportHttpDate(const String& dateHeader, unsigned long requestStartMs) {
+    if (instance && dateHeader.length() > 0) {
+        instance->timeSources.addHttpDate(dateHeader.c_str(), requestStartMs);
+    }
+}
+
+void TimeManager::applyTimeEstimate(const TimeEstimate& estimate) {
+    // Step the system clock by the selected offset
+    int64_t timerUs = esp_timer_get_time();
+    int64_t correctedUs = currentEpochUs() + estimate.offsetUs;
+    struct timeval tv;
+    tv.tv_sec = correctedUs / 1000000LL;
+    tv.tv_usec = correctedUs % 1000000LL;
+    settimeofday(&tv, nullptr);
+    timeSources.applyClockStep(estimate.offsetUs);
+    
+    unsigned long errorMs = (unsigned long)(estimate.errorUs / 1000);
+    if (errorMs < 1) errorMs = 1;
+    handleSyncResult(correctedUs, timerUs, errorMs);
+}
+
+void TimeManager::handleSyncResult(int64_t syncedUs, int64_t timerUs, unsigned long errorMs) {
+    if (hasTimeEstimate) {
+        // Offset between the sources and where our own clock would have been
+        int64_t spanUs = timerUs - referenceTimerUs;
+        int64_t offsetUs = syncedUs - (referenceEpochUs + spanUs);
+        lastSyncCorrectionMs = (long)(offsetUs / 1000);
         
-        // Print UTC time for comparison
-        struct tm* utc_tm = gmtime(&now);
-        Serial.printf("UTC Time: %04d-%02d-%02d %02d:%02d:%02d\n", 
-                     utc_tm->tm_year + 1900, utc_tm->tm_mon + 1, utc_tm->tm_mday,
-                     utc_tm->tm_hour, utc_tm->tm_min, utc_tm->tm_sec);
+        // Only precise sync-to-sync spans long enough to resolve a few ppm say anything about drift
+        bool preciseSpan = errorMs <= DRIFT_MAX_SAMPLE_ERROR_MS && referenceErrorMs <= DRIFT_MAX_SAMPLE_ERROR_MS;
+        if (!timeRestored && preciseSpan && spanUs >= (int64_t)MIN_DRIFT_SPAN_MS * 1000LL) {
+            float sample = (float)offsetUs * 1000000.0f / (float)spanUs;
+            driftPpm = driftKnown ? driftPpm + DRIFT_SMOOTHING * (sample - driftPpm) : sample;
+            driftKnown = true;
+        }
         
-        saveSettings();
-        return true;
-    } else {
-        Serial.println("Failed to synchronize time");
-        timeSynced = false; // Explicitly set to false on failure
-        return false;
+        Serial.printf("%s time corrected by %ld ms (bound was %lu ms), drift %.1f ppm\n",
+                     timeRestored ? "Restored" : "Previous", lastSyncCorrectionMs,
+                     getTimeUncertaintyMs(), driftKnown ? driftPpm : 0.0f);
+    }
+    
+    referenceEpochUs = syncedUs;
+    referenceTimerUs = timerUs;
+    referenceErrorMs = errorMs;
+    nextMinuteEdgeUs = 0; // Clock was stepped - reschedule the display
+    
+    timeSynced = true;
+    lastSyncTime = millis();
+    syncCount++;
+    
+    hasTimeEstimate = true;
+    timeRestored = false;
+    estimateBaseMillis = millis();
+    estimateBaseUncertaintyMs = errorMs;
+    persistTime(false, false);
+    
+    adaptSyncInterval();
+    
+    time_t now = (time_t)(syncedUs / 1000000LL);
+    struct tm timeinfo;
+    toLocalTime(now, timeinfo);
+    Serial.printf("Time synchronized: %04d-%02d-%02d %02d:%02d:%02d (DST: %s, +/- %lu ms)\n", 
+                 timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+                 timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
+                 timeinfo.tm_isdst ? "Yes" : "No", errorMs);
+    
+    if (syncCallback) {
+        syncCallback(true);
+    }
+}
+
+void TimeManager::adaptSyncInterval() {
+    if (!driftKnown) {
+        return;
+    }
+    
+    // Resync just often enough to keep accumulated drift under the target error
+    float driftBound = fabsf(driftPpm) + DRIFT_MARGIN_PPM;
+    unsigned long interval = (unsigned long)(TARGET_DRIFT_ERROR_MS * 1000000.0f / driftBound);
+    interval = constrain(interval, MIN_SYNC_INTERVAL_MS, MAX_SYNC_INTERVAL_MS);
+    
+    if (interval != syncInterval) {
+        syncInterval = interval;
+        Serial.printf("NTP resync interval adapted to %lu s\n", syncInterval / 1000);
     }
 }
 
 bool TimeManager::isTimeSynced() {
-    return timeSynced && (millis() - lastSyncTime < syncInterval);
+    // Synced until the accumulated drift could exceed the bound, not after a fixed interval
+    return timeSynced && getTimeUncertaintyMs() <= SYNCED_MAX_UNCERTAINTY_MS;
 }
 
 unsigned long TimeManager::getLastSyncTime() {
     return lastSyncTime;
 }
 
+void TimeManager::restoreLastKnownTime() {
+    loadSettings();
+    configureTimezone();
+    
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool rtcValid = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT &&
+                    rtcSnapshot.magic == RTC_SNAPSHOT_MAGIC &&
+                    rtcSnapshot.checksum == snapshotChecksum(rtcSnapshot);
+    
+    // Everything since the snapshot was taken: ROM boot plus our own uptime
+    int64_t gapUs = (int64_t)(BOOT_OVERHEAD_MS + millis()) * 1000LL;
+    int64_t estimateUs;
+    unsigned long uncertaintyMs;
+    const char* source;
+    
+    if (rtcValid) {
+        estimateUs = rtcSnapshot.epochUs + gapUs;
+        uncertaintyMs = rtcSnapshot.uncertaintyMs + BOOT_OVERHEAD_MS +
+                        (rtcSnapshot.cleanShutdown ? 0 : CHECKPOINT_INTERVAL_MS);
+        source = "RTC memory";
+    } else if (reason == ESP_RST_SW && settingsStore.isKey("time.last_us")) {
+        // Only a controlled restart writes NVS on the way down, so the gap is known
+        estimateUs = settingsStore.getLong64("time.last_us", 0) + gapUs;
+        uncertaintyMs = settingsStore.getUInt("time.last_unc", PROVISIONAL_MAX_UNCERTAINTY_MS) + BOOT_OVERHEAD_MS;
+        source = "NVS";
+    } else {
+        Serial.printf("No last-known time to restore (reset reason %d)\n", reason);
+        return;
+    }
+    
+    // The system clock itself may have survived the soft reset - prefer it when consistent
+    int64_t systemUs = currentEpochUs();
+    int64_t differenceMs = (systemUs - estimateUs) / 1000;
+    if (systemUs > 1000000000LL * 1000000LL && llabs(differenceMs) <= (int64_t)uncertaintyMs) {
+        source = "system clock";
+    } else {
+        struct timeval tv;
+        tv.tv_sec = estimateUs / 1000000LL;
+        tv.tv_usec = estimateUs % 1000000LL;
+        settimeofday(&tv, nullptr);
+    }
+    
+    referenceEpochUs = currentEpochUs();
+    referenceTimerUs = esp_timer_get_time();
+    nextMinuteEdgeUs = 0; // Clock may have been stepped - reschedule the display
+    
+    hasTimeEstimate = true;
+    timeRestored = true;
+    estimateBaseMillis = millis();
+    estimateBaseUncertaintyMs = uncertaintyMs;
+    
+    struct tm timeinfo = getCurrentTime();
+    Serial.printf("Restored last-known time from %s: %02d:%02d:%02d (+/- %lu ms)\n",
+                 source, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, uncertaintyMs);
+}
+
+void TimeManager::checkpointTime() {
+    if (millis() - lastCheckpoint < CHECKPOINT_INTERVAL_MS) {
+        return;
+    }
+    lastCheckpoint = millis();
+    persistTime(false, false);
+}
+
+bool TimeManager::isTimeProvisional() {
+    return hasTimeEstimate && !isTimeSynced() && time(nullptr) > 1000000000L &&
+           getTimeUncertaintyMs() <= PROVISIONAL_MAX_UNCERTAINTY_MS;
+}
+
+unsigned long TimeManager::getTimeUncertaintyMs() {
+    if (!hasTimeEstimate) {
+        return ULONG_MAX;
+    }
+    // Age the bound by the measured drift once known, the crystal tolerance before that
+    float driftBound = driftKnown ? fabsf(driftPpm) + DRIFT_MARGIN_PPM : (float)CLOCK_DRIFT_PPM;
+    unsigned long age = millis() - estimateBaseMillis;
+    return estimateBaseUncertaintyMs + (unsigned long)(age * driftBound / 1000000.0f);
+}
+
+void TimeManager::persistTime(bool toNVS, bool cleanShutdown) {
+    if (!hasTimeEstimate) {
+        return;
+    }
+    
+    // RTC memory is plain RAM - cheap enough to refresh every checkpoint
+    rtcSnapshot.epochUs = currentEpochUs();
+    rtcSnapshot.uncertaintyMs = getTimeUncertaintyMs();
+    rtcSnapshot.cleanShutdown = cleanShutdown ? 1 : 0;
+    rtcSnapshot.magic = RTC_SNAPSHOT_MAGIC;
+    rtcSnapshot.checksum = snapshotChecksum(rtcSnapshot);
+    
+    // NVS only on the way down to spare flash
+    if (toNVS) {
+        settingsStore.setLong64("time.last_us", rtcSnapshot.epochUs);
+        settingsStore.setUInt("time.last_unc", rtcSnapshot.uncertaintyMs);
+        settingsStore.flush();
+    }
+}
+
+void TimeManager::shutdownHandler() {
+    if (instance) {
+        instance->persistTime(true, true);
+        Serial.println("Last-known time saved for restart");
+    }
+}
+
 struct tm TimeManager::getCurrentTime() {
     time_t now = time(nullptr);
     struct tm timeinfo;
-    localtime_r(&now, &timeinfo);
+    toLocalTime(now, timeinfo);
     return timeinfo;
 }
 
+void TimeManager::toLocalTime(time_t utc, struct tm& out) {
+    // Cached DST transitions make this an add and a compare
+    if (!tzRules.toLocal(utc, out)) {
+        localtime_r(&utc, &out);
+    }
+}
+
+bool TimeManager::pollMinuteEdge() {
+    int64_t nowUs = currentEpochUs();
+    
+    if (nextMinuteEdgeUs == 0) {
+        // First call or the clock/timezone changed - show the current minute right away
+        refreshDisplayTime(nowUs);
+        return true;
+    }
+    
+    if (nowUs < nextMinuteEdgeUs) {
+        return false;
+    }
+    
+    pendingFlipEdgeUs = nextMinuteEdgeUs;
+    refreshDisplayTime(nowUs);
+    return true;
+}
+
+void TimeManager::recordMinuteFlip() {
+    if (pendingFlipEdgeUs == 0) {
+        return;
+    }
+    
+    // Latency of the rendered flip against the true minute boundary
+    lastFlipLatencyUs = (long)(currentEpochUs() - pendingFlipEdgeUs);
+    if (lastFlipLatencyUs > maxFlipLatencyUs) {
+        maxFlipLatencyUs = lastFlipLatencyUs;
+    }
+    minuteFlipCount++;
+    pendingFlipEdgeUs = 0;
+}
+
+struct tm TimeManager::getDisplayTime() {
+    if (nextMinuteEdgeUs == 0) {
+        refreshDisplayTime(currentEpochUs());
+    }
+    return displayTime;
+}
+
+unsigned long TimeManager::getMicrosUntilMinuteEdge() {
+    if (nextMinuteEdgeUs == 0) {
+        return 0;
+    }
+    int64_t remainingUs = nextMinuteEdgeUs - currentEpochUs();
+    if (remainingUs <= 0) {
+        return 0;
+    }
+    return remainingUs > (int64_t)ULONG_MAX ? ULONG_MAX : (unsigned long)remainingUs;
+}
+
+void TimeManager::refreshDisplayTime(int64_t nowUs) {
+    time_t now = (time_t)(nowUs / 1000000LL);
+    toLocalTime(now, displayTime);
+    nextMinuteEdgeUs = (int64_t)findNextMinuteEdge(now, displayTime) * 1000000LL;
+}
+
+time_t TimeManager::findNextMinuteEdge(time_t now, const struct tm& local) {
+    time_t edge = now + (60 - local.tm_sec);
+    
+    // A DST switch inside this minute (POSIX rules allow h:m:s transition times)
+    // changes the local minute earlier - find the exact second of the switch
+    struct tm probe;
+    toLocalTime(edge, probe);
+    if (probe.tm_isdst != local.tm_isdst) {
+        time_t before = now;
+        time_t after = edge;
+        while (after - before > 1) {
+            time_t mid = before + (after - before) / 2;
+            toLocalTime(mid, probe);
+            if (probe.tm_isdst == local.tm_isdst) {
+                before = mid;
+            } else {
+                after = mid;
+            }
+        }
+        edge = after;
+    }
+    
+    return edge;
+}
+
 String TimeManager::getFormattedTime(const char* format) {
     struct tm timeinfo = getCurrentTime();
     char buffer[64];
@@ -136,43 +517,71 @@ String TimeManager::getTimezoneString() {
 }
 
 void TimeManager::setTimezone(const char* timezone) {
-    currentTimezone = String(timezone);
-    configureTimezone();
-    saveSettings();
-    Serial.printf("Timezone changed to: %s\n", timezone);
+    applyTimezone(timezone, "");
+}
+
+void TimeManager::applyTimezone(const char* timezone, const char* name) {
+    if (currentTimezone == timezone && currentTimezoneName == name) {
+        return;
+    }
     
-    // Force re-sync to apply new timezone immediately
-    if (WiFi.status() == WL_CONNECTED) {
-        syncTime();
+    // Local time is derived from UTC, so a new zone applies without a resync
+    if (currentTimezone != timezone) {
+        currentTimezone = String(timezone);
+        configureTimezone();
     }
+    currentTimezoneName = String(name);
+    saveSettings();
+    Serial.printf("Timezone changed to: %s %s\n", name, timezone);
 }
 
 bool TimeManager::setTimezoneByName(const char* timezoneName) {
+    // Short names from the legacy table first, they keep their existing meaning
     for (int i = 0; i < timezoneCount; i++) {
         if (strcmp(timezones[i].name, timezoneName) == 0) {
-            setTimezone(timezones[i].posixString);
+            applyTimezone(timezones[i].posixString, timezones[i].name);
             return true;
         }
     }
+    
+    // Then the full IANA table in flash
+    unsigned long lookupStart = micros();
+    const char* rule = TimezoneDatabase::findRule(timezoneName);
+    unsigned long lookupUs = micros() - lookupStart;
+    if (rule) {
+        Serial.printf("Timezone %s found in %lu us\n", timezoneName, lookupUs);
+        applyTimezone(rule, timezoneName);
+        return true;
+    }
+    
     Serial.printf("Unknown timezone: %s\n", timezoneName);
     return false;
 }
 
-String TimeManager::getAvailableTimezones() {
-    String json = "[";
+String TimeManager::getTimezoneName() {
+    return currentTimezoneName;
+}
+
+void TimeManager::writeAvailableTimezonesJSON(JsonWriter& json) {
+    json.beginArray();
     for (int i = 0; i < timezoneCount; i++) {
-        if (i > 0) json += ",";
-        json += "{";
-        json += "\"name\":\"" + String(timezones[i].name) + "\",";
-        json += "\"display\":\"" + String(timezones[i].displayName) + "\",";
-        json += "\"posix\":\"" + String(timezones[i].posixString) + "\"";
-        json += "}";
+        json.beginObject();
+        json.add("name", timezones[i].name);
+        json.add("display", timezones[i].displayName);
+        json.add("posix", timezones[i].posixString);
+        json.endObject();
     }
-    json += "]";
-    return json;
+    json.endArray();
 }
 
 void TimeManager::setNTPServers(const char* primary, const char* secondary, const char* tertiary) {
+    bool changed = ntpServer1 != primary ||
+                   (secondary && ntpServer2 != secondary) ||
+                   (tertiary && ntpServer3 != tertiary);
+    if (!changed) {
+        return;
+    }
+    
     ntpServer1 = String(primary);
     if (secondary) ntpServer2 = String(secondary);
     if (tertiary) ntpServer3 = String(tertiary);
@@ -182,56 +591,89 @@ void TimeManager::setNTPServers(const char* primary, const char* secondary, cons
 }
 
 void TimeManager::saveSettings() {
-    preferences.putString("timezone", currentTimezone);
-    preferences.putString("ntp_server1", ntpServer1);
-    preferences.putString("ntp_server2", ntpServer2);
-    preferences.putString("ntp_server3", ntpServer3);
-    preferences.putULong("last_sync", lastSyncTime);
-    preferences.putBool("time_synced", timeSynced);
+    settingsStore.setString("time.tz", currentTimezone);
+    settingsStore.setString("time.tz_name", currentTimezoneName);
+    settingsStore.setString("time.ntp1", ntpServer1);
+    settingsStore.setString("time.ntp2", ntpServer2);
+    settingsStore.setString("time.ntp3", ntpServer3);
     
     Serial.println("Time settings saved");
 }
 
 void TimeManager::loadSettings() {
-    currentTimezone = preferences.getString("timezone", "CET-1CEST,M3.5.0,M10.5.0/3");
-    ntpServer1 = preferences.getString("ntp_server1", "pool.ntp.org");
-    ntpServer2 = preferences.getString("ntp_server2", "time.nist.gov");
-    ntpServer3 = preferences.getString("ntp_server3", "de.pool.ntp.org");
-    lastSyncTime = preferences.getULong("last_sync", 0);
-    timeSynced = preferences.getBool("time_synced", false);
+    currentTimezone = settingsStore.getString("time.tz", "CET-1CEST,M3.5.0,M10.5.0/3");
+    currentTimezoneName = settingsStore.getString("time.tz_name", "");
+    ntpServer1 = settingsStore.getString("time.ntp1", "pool.ntp.org");
+    ntpServer2 = settingsStore.getString("time.ntp2", "time.nist.gov");
+    ntpServer3 = settingsStore.getString("time.ntp3", "de.pool.ntp.org");
     
     Serial.println("Time settings loaded");
 }
 
-String TimeManager::getStatusJSON() {
+void TimeManager::writeStatusJSON(JsonWriter& json) {
     struct tm timeinfo = getCurrentTime();
+    char formatted[16];
     
-    String json = "{";
-    json += "\"current_time\":\"" + getFormattedTime("%H:%M:%S") + "\",";
-    json += "\"current_date\":\"" + getFormattedDate("%Y-%m-%d") + "\",";
-    json += "\"timezone\":\"" + currentTimezone + "\",";
-    json += "\"ntp_servers\":[";
-    json += "\"" + ntpServer1 + "\",";
-    json += "\"" + ntpServer2 + "\",";
-    json += "\"" + ntpServer3 + "\"";
-    json += "],";
-    json += "\"ntp_server\":\"" + ntpServer1 + "\",";
-    json += "\"day\":" + String(timeinfo.tm_mday) + ",";
-    json += "\"month\":" + String(timeinfo.tm_mon + 1) + ",";
-    json += "\"year\":" + String(timeinfo.tm_year + 1900) + ",";
-    json += "\"synced\":" + String(timeSynced ? "true" : "false") + ",";
-    json += "\"time_synced\":" + String(timeSynced ? "true" : "false") + ",";
-    json += "\"last_sync\":" + String(lastSyncTime) + ",";
-    json += "\"sync_age\":" + String(millis() - lastSyncTime) + ",";
-    json += "\"is_dst\":" + String(isDST() ? "true" : "false") + ",";
-    json += "\"timezone_offset\":" + String(getTimezoneOffset()) + ",";
-    json += "\"weekday\":" + String(timeinfo.tm_wday) + ",";
-    json += "\"hour\":" + String(timeinfo.tm_hour) + ",";
-    json += "\"minute\":" + String(timeinfo.tm_min) + ",";
-    json += "\"second\":" + String(timeinfo.tm_sec);
-    json += "}";
-    
-    return json;
+    json.beginObject();
+    strftime(formatted, sizeof(formatted), "%H:%M:%S", &timeinfo);
+    json.add("current_time", formatted);
+    strftime(formatted, sizeof(formatted), "%Y-%m-%d", &timeinfo);
+    json.add("current_date", formatted);
+    json.add("timezone", currentTimezone);
+    json.add("timezone_name", currentTimezoneName);
+    json.beginArray("ntp_servers");
+    json.add(nullptr, ntpServer1);
+    json.add(nullptr, ntpServer2);
+    json.add(nullptr, ntpServer3);
+    json.endArray();
+    json.add("ntp_server", ntpServer1);
+    json.add("day", timeinfo.tm_mday);
+    json.add("month", timeinfo.tm_mon + 1);
+    json.add("year", timeinfo.tm_year + 1900);
+    json.add("synced", timeSynced);
+    json.add("time_synced", timeSynced);
+    json.add("provisional", isTimeProvisional());
+    json.add("uncertainty_ms", hasTimeEstimate ? getTimeUncertaintyMs() : 0UL);
+    json.add("last_correction_ms", lastSyncCorrectionMs);
+    json.add("drift_ppm", driftKnown ? driftPpm : 0.0f);
+    json.add("drift_known", driftKnown);
+    json.add("sync_interval", syncInterval);
+    json.add("sync_count", syncCount);
+    json.add("flip_latency_us", lastFlipLatencyUs);
+    json.add("flip_latency_max_us", maxFlipLatencyUs);
+    json.add("minute_flips", minuteFlipCount);
+    json.add("sync_in_progress", timeSources.isRoundActive());
+    json.add("sync_error_ms", referenceErrorMs);
+    json.beginArray("sources");
+    timeSources.writeSourcesJSON(json);
+    json.endArray();
+    json.add("last_sync", lastSyncTime);
+    json.add("sync_age", millis() - lastSyncTime);
+    json.add("is_dst", timeinfo.tm_isdst > 0);
+    json.add("timezone_offset", getTimezoneOffset());
+    json.add("weekday", timeinfo.tm_wday);
+    json.add("hour", timeinfo.tm_hour);
+    json.add("minute", timeinfo.tm_min);
+    json.add("second", timeinfo.tm_sec);
+    json.endObject();
+}
+
+void TimeManager::writeClockJSON(JsonWriter& json) {
+    struct tm timeinfo = getCurrentTime();
+    
+    json.beginObject();
+    json.add("year", timeinfo.tm_year + 1900);
+    json.add("month", timeinfo.tm_mon + 1);
+    json.add("day", timeinfo.tm_mday);
+    json.add("hour", timeinfo.tm_hour);
+    json.add("minute", timeinfo.tm_min);
+    json.add("second", timeinfo.tm_sec);
+    json.add("synced", timeSynced);
+    json.add("sync_in_progress", timeSources.isRoundActive());
+    json.add("timezone", currentTimezone);
+    json.add("timezone_name", currentTimezoneName);
+    json.add("ntp_server", ntpServer1);
+    json.endObject();
 }
 
 bool TimeManager::isDST() {
@@ -241,6 +683,11 @@ bool TimeManager::isDST() {
 
 int TimeManager::getTimezoneOffset() {
     time_t now = time(nullptr);
+    
+    if (tzRules.isValid()) {
+        return (int)(tzRules.getUtcOffset(now) / 3600);
+    }
+    
     struct tm* utc_tm = gmtime(&now);
     struct tm* local_tm = localtime(&now);
     
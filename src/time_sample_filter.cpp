@@ -0,0 +1,279 @@
+#include "time_sample_filter.h"
+#include "timezone_rules.h"
+#include <string.h>
+#include <stdio.h>
+
+// Seconds between the NTP era 0 epoch (1900) and the Unix epoch (1970)
+static const int64_t NTP_UNIX_OFFSET_S = 2208988800LL;
+// Local oscillator tolerance used to age samples between measurements
+static const int64_t SAMPLE_DRIFT_PPM = 50;
+// Samples older than this no longer take part in selection
+static const int64_t MAX_SAMPLE_AGE_US = 15LL * 60 * 1000000;
+
+TimeSampleFilter::TimeSampleFilter() : sampleCount(0) {
+}
+
+void TimeSampleFilter::addSample(const TimeSample& sample) {
+    int slot = -1;
+    for (int i = 0; i < sampleCount; i++) {
+        if (samples[i].type == sample.type && samples[i].sourceId == sample.sourceId) {
+            slot = i;
+            break;
+        }
+    }
+
+    if (slot < 0) {
+        if (sampleCount < MAX_SAMPLES) {
+            slot = sampleCount++;
+        } else {
+            // Full - replace the oldest measurement
+            slot = 0;
+            for (int i = 1; i < sampleCount; i++) {
+                if (samples[i].takenAtUs < samples[slot].takenAtUs) {
+                    slot = i;
+                }
+            }
+        }
+    }
+
+    samples[slot] = sample;
+    samples[slot].selected = false;
+}
+
+bool TimeSampleFilter::select(int64_t nowUs, TimeEstimate& estimate) {
+    expire(nowUs);
+
+    estimate.offsetUs = 0;
+    estimate.errorUs = 0;
+    estimate.sourcesUsed = 0;
+    estimate.sourcesTotal = sampleCount;
+    if (sampleCount == 0) {
+        return false;
+    }
+
+    // Interval endpoints: +1 where an interval opens, -1 where it closes
+    struct Endpoint {
+        int64_t value;
+        int type;
+    };
+    Endpoint endpoints[MAX_SAMPLES * 2];
+    int endpointCount = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        int64_t error = agedError(samples[i], nowUs);
+        endpoints[endpointCount++] = {samples[i].offsetUs - error, +1};
+        endpoints[endpointCount++] = {samples[i].offsetUs + error, -1};
+        samples[i].selected = false;
+    }
+
+    // Sort by value, openings before closings so touching intervals overlap
+    for (int i = 1; i < endpointCount; i++) {
+        Endpoint key = endpoints[i];
+        int j = i - 1;
+        while (j >= 0 && (endpoints[j].value > key.value ||
+                          (endpoints[j].value == key.value && endpoints[j].type < key.type))) {
+            endpoints[j + 1] = endpoints[j];
+            j--;
+        }
+        endpoints[j + 1] = key;
+    }
+
+    // Marzullo: region covered by the largest number of intervals
+    int count = 0;
+    int bestCount = 0;
+    int64_t regionLow = 0;
+    int64_t regionHigh = 0;
+    for (int i = 0; i < endpointCount; i++) {
+        count += endpoints[i].type;
+        if (count > bestCount) {
+            bestCount = count;
+            regionLow = endpoints[i].value;
+            regionHigh = endpoints[i + 1].value; // A closing endpoint always follows
+        }
+    }
+
+    // The agreeing group has to be a majority, otherwise nobody can be trusted
+    if (bestCount * 2 <= sampleCount) {
+        return false;
+    }
+
+    // Quality weighted median of the truechimers (sources covering the region)
+    int chosen[MAX_SAMPLES];
+    int chosenCount = 0;
+    double totalWeight = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        int64_t error = agedError(samples[i], nowUs);
+        if (samples[i].offsetUs - error <= regionLow && samples[i].offsetUs + error >= regionHigh) {
+            // Insert sorted by offset
+            int j = chosenCount++;
+            while (j > 0 && samples[chosen[j - 1]].offsetUs > samples[i].offsetUs) {
+                chosen[j] = chosen[j - 1];
+                j--;
+            }
+            chosen[j] = i;
+            totalWeight += 1.0 / (double)(error + 1);
+            samples[i].selected = true;
+        }
+    }
+
+    int64_t offset = samples[chosen[0]].offsetUs;
+    double cumulative = 0;
+    for (int i = 0; i < chosenCount; i++) {
+        cumulative += 1.0 / (double)(agedError(samples[chosen[i]], nowUs) + 1);
+        if (cumulative * 2 >= totalWeight) {
+            offset = samples[chosen[i]].offsetUs;
+            break;
+        }
+    }
+
+    // The true offset is inside the region - keep the estimate there as well
+    if (offset < regionLow) offset = regionLow;
+    if (offset > regionHigh) offset = regionHigh;
+
+    estimate.offsetUs = offset;
+    estimate.errorUs = (offset - regionLow) > (regionHigh - offset) ? offset - regionLow : regionHigh - offset;
+    estimate.sourcesUsed = chosenCount;
+    return true;
+}
+
+void TimeSampleFilter::applyClockStep(int64_t stepUs) {
+    for (int i = 0; i < sampleCount; i++) {
+        samples[i].offsetUs -= stepUs;
+    }
+}
+
+void TimeSampleFilter::clear() {
+    sampleCount = 0;
+}
+
+void TimeSampleFilter::expire(int64_t nowUs) {
+    int kept = 0;
+    for (int i = 0; i < sampleCount; i++) {
+        if (nowUs - samples[i].takenAtUs <= MAX_SAMPLE_AGE_US) {
+            samples[kept++] = samples[i];
+        }
+    }
+    sampleCount = kept;
+}
+
+int64_t TimeSampleFilter::agedError(const TimeSample& sample, int64_t nowUs) {
+    int64_t age = nowUs - sample.takenAtUs;
+    if (age < 0) age = 0;
+    return sample.errorUs + age * SAMPLE_DRIFT_PPM / 1000000LL;
+}
+
+void TimeSampleFilter::buildNtpRequest(uint8_t* packet, int64_t transmitEpochUs) {
+    memset(packet, 0, NTP_PACKET_SIZE);
+    packet[0] = 0x23; // LI 0, version 4, mode 3 (client)
+
+    // The server echoes this as originate timestamp, which identifies the reply
+    epochUsToNtp(transmitEpochUs, packet + 40);
+}
+
+bool TimeSampleFilter::parseNtpResponse(const uint8_t* packet, size_t length, int64_t originateEpochUs,
+                                        int64_t receiveEpochUs, TimeSample& sample) {
+    if (length < NTP_PACKET_SIZE) {
+        return false;
+    }
+
+    uint8_t leap = packet[0] >> 6;
+    uint8_t mode = packet[0] & 0x07;
+    uint8_t stratum = packet[1];
+    if (mode != 4 || leap == 3 || stratum == 0 || stratum > 15) {
+        return false; // Not a server reply, unsynchronized or kiss-o'-death
+    }
+
+    uint8_t expected[8];
+    epochUsToNtp(originateEpochUs, expected);
+    if (memcmp(packet + 24, expected, sizeof(expected)) != 0) {
+        return false; // Stale or spoofed reply
+    }
+
+    static const uint8_t zero[8] = {0};
+    if (memcmp(packet + 32, zero, 8) == 0 || memcmp(packet + 40, zero, 8) == 0) {
+        return false;
+    }
+
+    int64_t t1 = originateEpochUs;
+    int64_t t2 = ntpToEpochUs(packet + 32);
+    int64_t t3 = ntpToEpochUs(packet + 40);
+    int64_t t4 = receiveEpochUs;
+
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0) delay = 0;
+
+    // Root delay and dispersion (16.16 seconds) bound the server's own error
+    uint32_t rootDelay = ((uint32_t)packet[4] << 24) | ((uint32_t)packet[5] << 16) | ((uint32_t)packet[6] << 8) | packet[7];
+    uint32_t rootDispersion = ((uint32_t)packet[8] << 24) | ((uint32_t)packet[9] << 16) | ((uint32_t)packet[10] << 8) | packet[11];
+
+    sample.type = TimeSourceType::NTP;
+    sample.offsetUs = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.delayUs = delay;
+    sample.errorUs = delay / 2 + ((int64_t)rootDelay * 1000000LL >> 17) + ((int64_t)rootDispersion * 1000000LL >> 16);
+    sample.selected = false;
+    return true;
+}
+
+bool TimeSampleFilter::parseHttpDate(const char* header, int64_t* epochSeconds) {
+    static const char* const months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (!header) {
+        return false;
+    }
+
+    int day, year, hour, minute, second;
+    char monthName[4] = {0};
+    if (sscanf(header, "%*3s, %d %3s %d %d:%d:%d", &day, monthName, &year, &hour, &minute, &second) != 6) {
+        return false;
+    }
+
+    int month = 0;
+    for (int i = 0; i < 12; i++) {
+        if (strcmp(monthName, months[i]) == 0) {
+            month = i + 1;
+            break;
+        }
+    }
+    if (month == 0 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+
+    *epochSeconds = TimezoneRules::daysFromCivil(year, month, day) * 86400LL +
+                    hour * 3600LL + minute * 60LL + second;
+    return true;
+}
+
+int64_t TimeSampleFilter::ntpToEpochUs(const uint8_t* timestamp) {
+    uint32_t seconds = ((uint32_t)timestamp[0] << 24) | ((uint32_t)timestamp[1] << 16) |
+                       ((uint32_t)timestamp[2] << 8) | timestamp[3];
+    uint32_t fraction = ((uint32_t)timestamp[4] << 24) | ((uint32_t)timestamp[5] << 16) |
+                        ((uint32_t)timestamp[6] << 8) | timestamp[7];
+
+    // Era 1 starts in 2036; values below 2^31 are taken to be in it
+    int64_t ntpSeconds = seconds;
+    if (seconds < 0x80000000UL) {
+        ntpSeconds += 0x100000000LL;
+    }
+
+    return (ntpSeconds - NTP_UNIX_OFFSET_S) * 1000000LL + (((uint64_t)fraction * 1000000ULL) >> 32);
+}
+
+void TimeSampleFilter::epochUsToNtp(int64_t epochUs, uint8_t* timestamp) {
+    int64_t seconds = epochUs / 1000000LL;
+    int64_t micros = epochUs % 1000000LL;
+    if (micros < 0) {
+        micros += 1000000LL;
+        seconds--;
+    }
+
+    uint32_t ntpSeconds = (uint32_t)(seconds + NTP_UNIX_OFFSET_S);
+    uint32_t fraction = (uint32_t)(((uint64_t)micros << 32) / 1000000ULL);
+
+    timestamp[0] = ntpSeconds >> 24;
+    timestamp[1] = ntpSeconds >> 16;
+    timestamp[2] = ntpSeconds >> 8;
+    timestamp[3] = ntpSeconds;
+    timestamp[4] = fraction >> 24;
+    timestamp[5] = fraction >> 16;
+    timestamp[6] = fraction >> 8;
+    timestamp[7] = fraction;
+}
@@ -0,0 +1,386 @@
+#include "time_source_manager.h"
+#include <sys/time.h>
+#include <esp_timer.h>
+#include <lwip/dns.h>
+#include <lwip/priv/tcpip_priv.h>
+
+// Standard NTP server port and our local port for queries
+static const uint16_t NTP_PORT = 123;
+static const uint16_t NTP_LOCAL_PORT = 12300;
+// UDP port qlockthrees use to exchange their clocks
+static const uint16_t PEER_PORT = 4124;
+static const uint8_t PEER_PROTOCOL_VERSION = 1;
+static const uint8_t PEER_QUERY = 1;
+static const uint8_t PEER_RESPONSE = 2;
+// Peers get this long to answer once all NTP servers have replied
+static const unsigned long PEER_WINDOW_MS = 500;
+// A round ends this long after the last query even if some servers never answered
+static const unsigned long ROUND_TIMEOUT_MS = 2000;
+// Servers whose name is not resolved by then sit this round out
+static const unsigned long LOOKUP_TIMEOUT_MS = 5000;
+// Lookup results written by the DNS callback
+static const uint8_t LOOKUP_PENDING = 0;
+static const uint8_t LOOKUP_FOUND = 1;
+static const uint8_t LOOKUP_FAILED = 2;
+// HTTP Date headers only have one second resolution
+static const int64_t HTTP_DATE_RESOLUTION_US = 1000000LL;
+
+// dns_gethostbyname() has to be called in the lwIP task; it only starts the
+// lookup there and reports through the callback
+struct DnsLookupCall {
+    struct tcpip_api_call_data call;
+    const char* name;
+    ip_addr_t address;
+    dns_found_callback found;
+    void* arg;
+    err_t result;
+};
+
+static err_t startDnsLookup(struct tcpip_api_call_data* data) {
+    DnsLookupCall* lookup = (DnsLookupCall*)data;
+    lookup->result = dns_gethostbyname(lookup->name, &lookup->address, lookup->found, lookup->arg);
+    return ERR_OK;
+}
+
+TimeSourceManager* TimeSourceManager::instance = nullptr;
+
+TimeSourceManager::TimeSourceManager() :
+    socketsOpen(false),
+    queryCount(0),
+    roundId(0),
+    lastQueryTime(0),
+    peerQueryEpochUs(0),
+    roundActive(false),
+    roundComplete(false),
+    roundStartTime(0) {
+    instance = this;
+}
+
+bool TimeSourceManager::startRound(const String* servers, int count) {
+    if (roundActive || WiFi.status() != WL_CONNECTED) {
+        return false;
+    }
+    openSockets();
+
+    roundId++;
+    roundActive = true;
+    roundComplete = false;
+    roundStartTime = millis();
+    lastQueryTime = roundStartTime;
+
+    // Names are looked up in the background; addresses already in lwIP's
+    // cache (or given as numbers) are queried right away
+    queryCount = 0;
+    for (int i = 0; i < count && queryCount < MAX_NTP_SERVERS; i++) {
+        if (servers[i].length() == 0) {
+            continue;
+        }
+        NtpQuery& query = queries[queryCount];
+        query.server = servers[i];
+        query.state = QueryState::RESOLVING;
+        startLookup(queryCount++);
+    }
+    sendResolvedQueries();
+
+    sendPeerQuery();
+
+    Serial.printf("Time round started: %d NTP servers, peers asked\n", queryCount);
+    return true;
+}
+
+void TimeSourceManager::loop(bool shareTime, unsigned long localErrorMs) {
+    if (WiFi.status() != WL_CONNECTED) {
+        if (socketsOpen) {
+            // Nothing can arrive without the link; the round ends with what it has
+            closeSockets();
+            if (roundActive) {
+                roundComplete = true;
+            }
+        }
+        return;
+    }
+    openSockets();
+
+    sendResolvedQueries();
+    receiveNtp();
+    receivePeers(shareTime, localErrorMs);
+
+    if (roundActive && !roundComplete) {
+        unsigned long elapsed = millis() - roundStartTime;
+        bool resolving = false;
+        bool waiting = false;
+        for (int i = 0; i < queryCount; i++) {
+            if (queries[i].state == QueryState::RESOLVING) {
+                if (elapsed >= LOOKUP_TIMEOUT_MS) {
+                    Serial.printf("NTP server %s: no DNS reply, skipped this round\n", queries[i].server.c_str());
+                    queries[i].state = QueryState::FAILED;
+                } else {
+                    resolving = true;
+                }
+            } else if (queries[i].state == QueryState::SENT) {
+                waiting = true;
+            }
+        }
+
+        if (!resolving && ((!waiting && elapsed >= PEER_WINDOW_MS) ||
+                           millis() - lastQueryTime >= ROUND_TIMEOUT_MS)) {
+            roundComplete = true;
+        }
+    }
+}
+
+TimeSourceManager::RoundResult TimeSourceManager::pollRound(TimeEstimate& estimate) {
+    if (!roundActive || !roundComplete) {
+        return RoundResult::NONE;
+    }
+    roundActive = false;
+    roundComplete = false;
+
+    if (!filter.select(esp_timer_get_time(), estimate)) {
+        Serial.printf("Time round failed: %d samples, no majority agreement\n", filter.getSampleCount());
+        return RoundResult::FAILED;
+    }
+
+    Serial.printf("Time round: offset %lld ms +/- %lld ms from %d of %d sources\n",
+                 estimate.offsetUs / 1000, estimate.errorUs / 1000,
+                 estimate.sourcesUsed, estimate.sourcesTotal);
+    return RoundResult::SUCCESS;
+}
+
+void TimeSourceManager::addHttpDate(const char* dateHeader, unsigned long requestStartMs) {
+    int64_t dateSeconds;
+    if (!dateHeader || !TimeSampleFilter::parseHttpDate(dateHeader, &dateSeconds)) {
+        return;
+    }
+
+    // The server stamped the response somewhere between our request and now,
+    // truncated to the second: true time now is in [date, date + 1 s + rtt]
+    int64_t rttUs = (int64_t)(millis() - requestStartMs) * 1000LL;
+    int64_t halfWidthUs = (HTTP_DATE_RESOLUTION_US + rttUs) / 2;
+
+    TimeSample sample;
+    sample.type = TimeSourceType::HTTP_DATE;
+    sample.sourceId = 0;
+    sample.offsetUs = dateSeconds * 1000000LL + halfWidthUs - epochNowUs();
+    sample.errorUs = halfWidthUs;
+    sample.delayUs = rttUs;
+    sample.takenAtUs = esp_timer_get_time();
+    filter.addSample(sample);
+}
+
+void TimeSourceManager::applyClockStep(int64_t stepUs) {
+    filter.applyClockStep(stepUs);
+}
+
+void TimeSourceManager::writeSourcesJSON(JsonWriter& json) {
+    int64_t now = esp_timer_get_time();
+    char address[16];
+    for (int i = 0; i < filter.getSampleCount(); i++) {
+        const TimeSample& sample = filter.getSample(i);
+        snprintf(address, sizeof(address), "%u.%u.%u.%u",
+                 (unsigned)(sample.sourceId & 0xFF), (unsigned)((sample.sourceId >> 8) & 0xFF),
+                 (unsigned)((sample.sourceId >> 16) & 0xFF), (unsigned)(sample.sourceId >> 24));
+        
+        json.beginObject();
+        json.add("type", typeName(sample.type));
+        json.add("address", address);
+        json.add("offset_ms", (long)(sample.offsetUs / 1000));
+        json.add("error_ms", (long)(sample.errorUs / 1000));
+        json.add("delay_ms", (long)(sample.delayUs / 1000));
+        json.add("age_s", (long)((now - sample.takenAtUs) / 1000000LL));
+        json.add("selected", sample.selected);
+        json.endObject();
+    }
+}
+
+void TimeSourceManager::openSockets() {
+    if (socketsOpen) {
+        return;
+    }
+    ntpUdp.begin(NTP_LOCAL_PORT);
+    peerUdp.begin(PEER_PORT);
+    socketsOpen = true;
+}
+
+void TimeSourceManager::closeSockets() {
+    ntpUdp.stop();
+    peerUdp.stop();
+    socketsOpen = false;
+}
+
+void TimeSourceManager::startLookup(int index) {
+    Lookup& lookup = lookups[index];
+    lookup.status = LOOKUP_PENDING;
+
+    DnsLookupCall call;
+    call.name = queries[index].server.c_str();
+    call.found = onDnsFound;
+    call.arg = (void*)(uintptr_t)(roundId * MAX_NTP_SERVERS + index);
+    call.result = ERR_ARG;
+    tcpip_api_call(startDnsLookup, &call.call);
+
+    if (call.result == ERR_OK) {
+        lookup.address = ip4_addr_get_u32(ip_2_ip4(&call.address));
+        lookup.status = LOOKUP_FOUND;
+    } else if (call.result != ERR_INPROGRESS) {
+        lookup.status = LOOKUP_FAILED;
+    }
+}
+
+void TimeSourceManager::onDnsFound(const char* name, const ip_addr_t* address, void* arg) {
+    // Runs in the lwIP task; loop() only looks at the status
+    uint32_t tag = (uint32_t)(uintptr_t)arg;
+    if (!instance || tag / MAX_NTP_SERVERS != instance->roundId) {
+        return;
+    }
+    Lookup& lookup = instance->lookups[tag % MAX_NTP_SERVERS];
+    if (address && IP_IS_V4(address)) {
+        lookup.address = ip4_addr_get_u32(ip_2_ip4(address));
+        lookup.status = LOOKUP_FOUND;
+    } else {
+        lookup.status = LOOKUP_FAILED;
+    }
+}
+
+void TimeSourceManager::sendResolvedQueries() {
+    for (int i = 0; i < queryCount; i++) {
+        NtpQuery& query = queries[i];
+        if (query.state != QueryState::RESOLVING || lookups[i].status == LOOKUP_PENDING) {
+            continue;
+        }
+        if (lookups[i].status == LOOKUP_FAILED) {
+            Serial.printf("NTP server %s could not be resolved\n", query.server.c_str());
+            query.state = QueryState::FAILED;
+            continue;
+        }
+
+        // Two names for the same server would just count it twice
+        IPAddress address(lookups[i].address);
+        bool duplicate = false;
+        for (int q = 0; q < queryCount; q++) {
+            if (q != i && (queries[q].state == QueryState::SENT || queries[q].state == QueryState::ANSWERED) &&
+                queries[q].address == address) {
+                duplicate = true;
+            }
+        }
+        if (duplicate) {
+            query.state = QueryState::FAILED;
+            continue;
+        }
+
+        uint8_t packet[TimeSampleFilter::NTP_PACKET_SIZE];
+        query.address = address;
+        query.transmitEpochUs = epochNowUs();
+        TimeSampleFilter::buildNtpRequest(packet, query.transmitEpochUs);
+
+        ntpUdp.beginPacket(address, NTP_PORT);
+        ntpUdp.write(packet, sizeof(packet));
+        ntpUdp.endPacket();
+        query.state = QueryState::SENT;
+        lastQueryTime = millis();
+    }
+}
+
+void TimeSourceManager::receiveNtp() {
+    while (ntpUdp.parsePacket() > 0) {
+        // Stamp arrival first - everything after adds to the measured delay
+        int64_t receiveEpochUs = epochNowUs();
+        int64_t receivedAt = esp_timer_get_time();
+
+        uint8_t packet[TimeSampleFilter::NTP_PACKET_SIZE];
+        int length = ntpUdp.read(packet, sizeof(packet));
+        IPAddress from = ntpUdp.remoteIP();
+        if (length <= 0) {
+            continue;
+        }
+
+        for (int i = 0; i < queryCount; i++) {
+            NtpQuery& query = queries[i];
+            if (query.state != QueryState::SENT || !(query.address == from)) {
+                continue;
+            }
+
+            TimeSample sample;
+            if (TimeSampleFilter::parseNtpResponse(packet, length, query.transmitEpochUs,
+                                                   receiveEpochUs, sample)) {
+                sample.sourceId = (uint32_t)from;
+                sample.takenAtUs = receivedAt;
+                filter.addSample(sample);
+                query.state = QueryState::ANSWERED;
+                Serial.printf("NTP %s: offset %lld ms, delay %lld ms\n", from.toString().c_str(),
+                             sample.offsetUs / 1000, sample.delayUs / 1000);
+            }
+            break;
+        }
+    }
+}
+
+void TimeSourceManager::receivePeers(bool shareTime, unsigned long localErrorMs) {
+    while (peerUdp.parsePacket() > 0) {
+        int64_t receiveEpochUs = epochNowUs();
+        int64_t receivedAt = esp_timer_get_time();
+
+        PeerPacket packet;
+        int length = peerUdp.read((uint8_t*)&packet, sizeof(packet));
+        IPAddress from = peerUdp.remoteIP();
+        uint16_t fromPort = peerUdp.remotePort();
+
+        if (length != (int)sizeof(packet) || memcmp(packet.magic, "QLKT", 4) != 0 ||
+            packet.version != PEER_PROTOCOL_VERSION || from == WiFi.localIP()) {
+            continue;
+        }
+
+        if (packet.type == PEER_QUERY && shareTime) {
+            PeerPacket response = packet;
+            response.type = PEER_RESPONSE;
+            response.peerErrorUs = (int64_t)localErrorMs * 1000LL;
+            response.peerEpochUs = epochNowUs();
+            peerUdp.beginPacket(from, fromPort);
+            peerUdp.write((const uint8_t*)&response, sizeof(response));
+            peerUdp.endPacket();
+        } else if (packet.type == PEER_RESPONSE && roundActive && packet.originateUs == peerQueryEpochUs) {
+            int64_t rttUs = receiveEpochUs - peerQueryEpochUs;
+            if (rttUs < 0) rttUs = 0;
+
+            TimeSample sample;
+            sample.type = TimeSourceType::PEER;
+            sample.sourceId = (uint32_t)from;
+            sample.offsetUs = packet.peerEpochUs - (peerQueryEpochUs + rttUs / 2);
+            sample.errorUs = rttUs / 2 + packet.peerErrorUs;
+            sample.delayUs = rttUs;
+            sample.takenAtUs = receivedAt;
+            filter.addSample(sample);
+            Serial.printf("Peer %s: offset %lld ms +/- %lld ms\n", from.toString().c_str(),
+                         sample.offsetUs / 1000, sample.errorUs / 1000);
+        }
+    }
+}
+
+void TimeSourceManager::sendPeerQuery() {
+    PeerPacket packet;
+    memset(&packet, 0, sizeof(packet));
+    memcpy(packet.magic, "QLKT", 4);
+    packet.version = PEER_PROTOCOL_VERSION;
+    packet.type = PEER_QUERY;
+    peerQueryEpochUs = epochNowUs();
+    packet.originateUs = peerQueryEpochUs;
+
+    peerUdp.beginPacket(WiFi.broadcastIP(), PEER_PORT);
+    peerUdp.write((const uint8_t*)&packet, sizeof(packet));
+    peerUdp.endPacket();
+}
+
+int64_t TimeSourceManager::epochNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+const char* TimeSourceManager::typeName(TimeSourceType type) {
+    switch (type) {
+        case TimeSourceType::NTP: return "ntp";
+        case TimeSourceType::PEER: return "peer";
+        case TimeSourceType::HTTP_DATE: return "http";
+    }
+    return "unknown";
+}
@@ -0,0 +1,1328 @@
+// Generated by scripts/generate_timezones.py - do not edit by hand.
+// Source: IANA tzdata 2025b, 597 zones, 94 distinct rules
+
+#include "timezone_database.h"
+
+const char TimezoneDatabase::version[] = "2025b";
+
+const char* const TimezoneDatabase::regions[] = {
+    "",
+    "Africa",
+    "America",
+    "Antarctica",
+    "Arctic",
+    "Asia",
+    "Atlantic",
+    "Australia",
+    "Brazil",
+    "Canada",
+    "Chile",
+    "Etc",
+    "Europe",
+    "Indian",
+    "Mexico",
+    "Pacific",
+    "US",
+};
+
+// Zone names without their region prefix, NUL separated
+const char TimezoneDatabase::names[] =
+    "Abidjan\0"
+    "Accra\0"
+    "Addis_Ababa\0"
+    "Algiers\0"
+    "Asmara\0"
+    "Asmera\0"
+    "Bamako\0"
+    "Bangui\0"
+    "Banjul\0"
+    "Bissau\0"
+    "Blantyre\0"
+    "Brazzaville\0"
+    "Bujumbura\0"
+    "Cairo\0"
+    "Casablanca\0"
+    "Ceuta\0"
+    "Conakry\0"
+    "Dakar\0"
+    "Dar_es_Salaam\0"
+    "Djibouti\0"
+    "Douala\0"
+    "El_Aaiun\0"
+    "Freetown\0"
+    "Gaborone\0"
+    "Harare\0"
+    "Johannesburg\0"
+    "Juba\0"
+    "Kampala\0"
+    "Khartoum\0"
+    "Kigali\0"
+    "Kinshasa\0"
+    "Lagos\0"
+    "Libreville\0"
+    "Lome\0"
+    "Luanda\0"
+    "Lubumbashi\0"
+    "Lusaka\0"
+    "Malabo\0"
+    "Maputo\0"
+    "Maseru\0"
+    "Mbabane\0"
+    "Mogadishu\0"
+    "Monrovia\0"
+    "Nairobi\0"
+    "Ndjamena\0"
+    "Niamey\0"
+    "Nouakchott\0"
+    "Ouagadougou\0"
+    "Porto-Novo\0"
+    "Sao_Tome\0"
+    "Timbuktu\0"
+    "Tripoli\0"
+    "Tunis\0"
+    "Windhoek\0"
+    "Adak\0"
+    "Anchorage\0"
+    "Anguilla\0"
+    "Antigua\0"
+    "Araguaina\0"
+    "Argentina/Buenos_Aires\0"
+    "Argentina/Catamarca\0"
+    "Argentina/ComodRivadavia\0"
+    "Argentina/Cordoba\0"
+    "Argentina/Jujuy\0"
+    "Argentina/La_Rioja\0"
+    "Argentina/Mendoza\0"
+    "Argentina/Rio_Gallegos\0"
+    "Argentina/Salta\0"
+    "Argentina/San_Juan\0"
+    "Argentina/San_Luis\0"
+    "Argentina/Tucuman\0"
+    "Argentina/Ushuaia\0"
+    "Aruba\0"
+    "Asuncion\0"
+    "Atikokan\0"
+    "Atka\0"
+    "Bahia\0"
+    "Bahia_Banderas\0"
+    "Barbados\0"
+    "Belem\0"
+    "Belize\0"
+    "Blanc-Sablon\0"
+    "Boa_Vista\0"
+    "Bogota\0"
+    "Boise\0"
+    "Buenos_Aires\0"
+    "Cambridge_Bay\0"
+    "Campo_Grande\0"
+    "Cancun\0"
+    "Caracas\0"
+    "Catamarca\0"
+    "Cayenne\0"
+    "Cayman\0"
+    "Chicago\0"
+    "Chihuahua\0"
+    "Ciudad_Juarez\0"
+    "Coral_Harbour\0"
+    "Cordoba\0"
+    "Costa_Rica\0"
+    "Coyhaique\0"
+    "Creston\0"
+    "Cuiaba\0"
+    "Curacao\0"
+    "Danmarkshavn\0"
+    "Dawson\0"
+    "Dawson_Creek\0"
+    "Denver\0"
+    "Detroit\0"
+    "Dominica\0"
+    "Edmonton\0"
+    "Eirunepe\0"
+    "El_Salvador\0"
+    "Ensenada\0"
+    "Fort_Nelson\0"
+    "Fort_Wayne\0"
+    "Fortaleza\0"
+    "Glace_Bay\0"
+    "Godthab\0"
+    "Goose_Bay\0"
+    "Grand_Turk\0"
+    "Grenada\0"
+    "Guadeloupe\0"
+    "Guatemala\0"
+    "Guayaquil\0"
+    "Guyana\0"
+    "Halifax\0"
+    "Havana\0"
+    "Hermosillo\0"
+    "Indiana/Indianapolis\0"
+    "Indiana/Knox\0"
+    "Indiana/Marengo\0"
+    "Indiana/Petersburg\0"
+    "Indiana/Tell_City\0"
+    "Indiana/Vevay\0"
+    "Indiana/Vincennes\0"
+    "Indiana/Winamac\0"
+    "Indianapolis\0"
+    "Inuvik\0"
+    "Iqaluit\0"
+    "Jamaica\0"
+    "Jujuy\0"
+    "Juneau\0"
+    "Kentucky/Louisville\0"
+    "Kentucky/Monticello\0"
+    "Knox_IN\0"
+    "Kralendijk\0"
+    "La_Paz\0"
+    "Lima\0"
+    "Los_Angeles\0"
+    "Louisville\0"
+    "Lower_Princes\0"
+    "Maceio\0"
+    "Managua\0"
+    "Manaus\0"
+    "Marigot\0"
+    "Martinique\0"
+    "Matamoros\0"
+    "Mazatlan\0"
+    "Mendoza\0"
+    "Menominee\0"
+    "Merida\0"
+    "Metlakatla\0"
+    "Mexico_City\0"
+    "Miquelon\0"
+    "Moncton\0"
+    "Monterrey\0"
+    "Montevideo\0"
+    "Montreal\0"
+    "Montserrat\0"
+    "Nassau\0"
+    "New_York\0"
+    "Nipigon\0"
+    "Nome\0"
+    "Noronha\0"
+    "North_Dakota/Beulah\0"
+    "North_Dakota/Center\0"
+    "North_Dakota/New_Salem\0"
+    "Nuuk\0"
+    "Ojinaga\0"
+    "Panama\0"
+    "Pangnirtung\0"
+    "Paramaribo\0"
+    "Phoenix\0"
+    "Port-au-Prince\0"
+    "Port_of_Spain\0"
+    "Porto_Acre\0"
+    "Porto_Velho\0"
+    "Puerto_Rico\0"
+    "Punta_Arenas\0"
+    "Rainy_River\0"
+    "Rankin_Inlet\0"
+    "Recife\0"
+    "Regina\0"
+    "Resolute\0"
+    "Rio_Branco\0"
+    "Rosario\0"
+    "Santa_Isabel\0"
+    "Santarem\0"
+    "Santiago\0"
+    "Santo_Domingo\0"
+    "Sao_Paulo\0"
+    "Scoresbysund\0"
+    "Shiprock\0"
+    "Sitka\0"
+    "St_Barthelemy\0"
+    "St_Johns\0"
+    "St_Kitts\0"
+    "St_Lucia\0"
+    "St_Thomas\0"
+    "St_Vincent\0"
+    "Swift_Current\0"
+    "Tegucigalpa\0"
+    "Thule\0"
+    "Thunder_Bay\0"
+    "Tijuana\0"
+    "Toronto\0"
+    "Tortola\0"
+    "Vancouver\0"
+    "Virgin\0"
+    "Whitehorse\0"
+    "Winnipeg\0"
+    "Yakutat\0"
+    "Yellowknife\0"
+    "Casey\0"
+    "Davis\0"
+    "DumontDUrville\0"
+    "Macquarie\0"
+    "Mawson\0"
+    "McMurdo\0"
+    "Palmer\0"
+    "Rothera\0"
+    "South_Pole\0"
+    "Syowa\0"
+    "Troll\0"
+    "Vostok\0"
+    "Longyearbyen\0"
+    "Aden\0"
+    "Almaty\0"
+    "Amman\0"
+    "Anadyr\0"
+    "Aqtau\0"
+    "Aqtobe\0"
+    "Ashgabat\0"
+    "Ashkhabad\0"
+    "Atyrau\0"
+    "Baghdad\0"
+    "Bahrain\0"
+    "Baku\0"
+    "Bangkok\0"
+    "Barnaul\0"
+    "Beirut\0"
+    "Bishkek\0"
+    "Brunei\0"
+    "Calcutta\0"
+    "Chita\0"
+    "Choibalsan\0"
+    "Chongqing\0"
+    "Chungking\0"
+    "Colombo\0"
+    "Dacca\0"
+    "Damascus\0"
+    "Dhaka\0"
+    "Dili\0"
+    "Dubai\0"
+    "Dushanbe\0"
+    "Famagusta\0"
+    "Gaza\0"
+    "Harbin\0"
+    "Hebron\0"
+    "Ho_Chi_Minh\0"
+    "Hong_Kong\0"
+    "Hovd\0"
+    "Irkutsk\0"
+    "Istanbul\0"
+    "Jakarta\0"
+    "Jayapura\0"
+    "Jerusalem\0"
+    "Kabul\0"
+    "Kamchatka\0"
+    "Karachi\0"
+    "Kashgar\0"
+    "Kathmandu\0"
+    "Katmandu\0"
+    "Khandyga\0"
+    "Kolkata\0"
+    "Krasnoyarsk\0"
+    "Kuala_Lumpur\0"
+    "Kuching\0"
+    "Kuwait\0"
+    "Macao\0"
+    "Macau\0"
+    "Magadan\0"
+    "Makassar\0"
+    "Manila\0"
+    "Muscat\0"
+    "Nicosia\0"
+    "Novokuznetsk\0"
+    "Novosibirsk\0"
+    "Omsk\0"
+    "Oral\0"
+    "Phnom_Penh\0"
+    "Pontianak\0"
+    "Pyongyang\0"
+    "Qatar\0"
+    "Qostanay\0"
+    "Qyzylorda\0"
+    "Rangoon\0"
+    "Riyadh\0"
+    "Saigon\0"
+    "Sakhalin\0"
+    "Samarkand\0"
+    "Seoul\0"
+    "Shanghai\0"
+    "Singapore\0"
+    "Srednekolymsk\0"
+    "Taipei\0"
+    "Tashkent\0"
+    "Tbilisi\0"
+    "Tehran\0"
+    "Tel_Aviv\0"
+    "Thimbu\0"
+    "Thimphu\0"
+    "Tokyo\0"
+    "Tomsk\0"
+    "Ujung_Pandang\0"
+    "Ulaanbaatar\0"
+    "Ulan_Bator\0"
+    "Urumqi\0"
+    "Ust-Nera\0"
+    "Vientiane\0"
+    "Vladivostok\0"
+    "Yakutsk\0"
+    "Yangon\0"
+    "Yekaterinburg\0"
+    "Yerevan\0"
+    "Azores\0"
+    "Bermuda\0"
+    "Canary\0"
+    "Cape_Verde\0"
+    "Faeroe\0"
+    "Faroe\0"
+    "Jan_Mayen\0"
+    "Madeira\0"
+    "Reykjavik\0"
+    "South_Georgia\0"
+    "St_Helena\0"
+    "Stanley\0"
+    "ACT\0"
+    "Adelaide\0"
+    "Brisbane\0"
+    "Broken_Hill\0"
+    "Canberra\0"
+    "Currie\0"
+    "Darwin\0"
+    "Eucla\0"
+    "Hobart\0"
+    "LHI\0"
+    "Lindeman\0"
+    "Lord_Howe\0"
+    "Melbourne\0"
+    "NSW\0"
+    "North\0"
+    "Perth\0"
+    "Queensland\0"
+    "South\0"
+    "Sydney\0"
+    "Tasmania\0"
+    "Victoria\0"
+    "West\0"
+    "Yancowinna\0"
+    "Acre\0"
+    "DeNoronha\0"
+    "East\0"
+    "West\0"
+    "CET\0"
+    "CST6CDT\0"
+    "Atlantic\0"
+    "Central\0"
+    "Eastern\0"
+    "Mountain\0"
+    "Newfoundland\0"
+    "Pacific\0"
+    "Saskatchewan\0"
+    "Yukon\0"
+    "Continental\0"
+    "EasterIsland\0"
+    "Cuba\0"
+    "EET\0"
+    "EST\0"
+    "EST5EDT\0"
+    "Egypt\0"
+    "Eire\0"
+    "GMT\0"
+    "GMT+0\0"
+    "GMT+1\0"
+    "GMT+10\0"
+    "GMT+11\0"
+    "GMT+12\0"
+    "GMT+2\0"
+    "GMT+3\0"
+    "GMT+4\0"
+    "GMT+5\0"
+    "GMT+6\0"
+    "GMT+7\0"
+    "GMT+8\0"
+    "GMT+9\0"
+    "GMT-0\0"
+    "GMT-1\0"
+    "GMT-10\0"
+    "GMT-11\0"
+    "GMT-12\0"
+    "GMT-13\0"
+    "GMT-14\0"
+    "GMT-2\0"
+    "GMT-3\0"
+    "GMT-4\0"
+    "GMT-5\0"
+    "GMT-6\0"
+    "GMT-7\0"
+    "GMT-8\0"
+    "GMT-9\0"
+    "GMT0\0"
+    "Greenwich\0"
+    "UCT\0"
+    "UTC\0"
+    "Universal\0"
+    "Zulu\0"
+    "Amsterdam\0"
+    "Andorra\0"
+    "Astrakhan\0"
+    "Athens\0"
+    "Belfast\0"
+    "Belgrade\0"
+    "Berlin\0"
+    "Bratislava\0"
+    "Brussels\0"
+    "Bucharest\0"
+    "Budapest\0"
+    "Busingen\0"
+    "Chisinau\0"
+    "Copenhagen\0"
+    "Dublin\0"
+    "Gibraltar\0"
+    "Guernsey\0"
+    "Helsinki\0"
+    "Isle_of_Man\0"
+    "Istanbul\0"
+    "Jersey\0"
+    "Kaliningrad\0"
+    "Kiev\0"
+    "Kirov\0"
+    "Kyiv\0"
+    "Lisbon\0"
+    "Ljubljana\0"
+    "London\0"
+    "Luxembourg\0"
+    "Madrid\0"
+    "Malta\0"
+    "Mariehamn\0"
+    "Minsk\0"
+    "Monaco\0"
+    "Moscow\0"
+    "Nicosia\0"
+    "Oslo\0"
+    "Paris\0"
+    "Podgorica\0"
+    "Prague\0"
+    "Riga\0"
+    "Rome\0"
+    "Samara\0"
+    "San_Marino\0"
+    "Sarajevo\0"
+    "Saratov\0"
+    "Simferopol\0"
+    "Skopje\0"
+    "Sofia\0"
+    "Stockholm\0"
+    "Tallinn\0"
+    "Tirane\0"
+    "Tiraspol\0"
+    "Ulyanovsk\0"
+    "Uzhgorod\0"
+    "Vaduz\0"
+    "Vatican\0"
+    "Vienna\0"
+    "Vilnius\0"
+    "Volgograd\0"
+    "Warsaw\0"
+    "Zagreb\0"
+    "Zaporozhye\0"
+    "Zurich\0"
+    "GB\0"
+    "GB-Eire\0"
+    "GMT\0"
+    "GMT+0\0"
+    "GMT-0\0"
+    "GMT0\0"
+    "Greenwich\0"
+    "HST\0"
+    "Hongkong\0"
+    "Iceland\0"
+    "Antananarivo\0"
+    "Chagos\0"
+    "Christmas\0"
+    "Cocos\0"
+    "Comoro\0"
+    "Kerguelen\0"
+    "Mahe\0"
+    "Maldives\0"
+    "Mauritius\0"
+    "Mayotte\0"
+    "Reunion\0"
+    "Iran\0"
+    "Israel\0"
+    "Jamaica\0"
+    "Japan\0"
+    "Kwajalein\0"
+    "Libya\0"
+    "MET\0"
+    "MST\0"
+    "MST7MDT\0"
+    "BajaNorte\0"
+    "BajaSur\0"
+    "General\0"
+    "NZ\0"
+    "NZ-CHAT\0"
+    "Navajo\0"
+    "PRC\0"
+    "PST8PDT\0"
+    "Apia\0"
+    "Auckland\0"
+    "Bougainville\0"
+    "Chatham\0"
+    "Chuuk\0"
+    "Easter\0"
+    "Efate\0"
+    "Enderbury\0"
+    "Fakaofo\0"
+    "Fiji\0"
+    "Funafuti\0"
+    "Galapagos\0"
+    "Gambier\0"
+    "Guadalcanal\0"
+    "Guam\0"
+    "Honolulu\0"
+    "Johnston\0"
+    "Kanton\0"
+    "Kiritimati\0"
+    "Kosrae\0"
+    "Kwajalein\0"
+    "Majuro\0"
+    "Marquesas\0"
+    "Midway\0"
+    "Nauru\0"
+    "Niue\0"
+    "Norfolk\0"
+    "Noumea\0"
+    "Pago_Pago\0"
+    "Palau\0"
+    "Pitcairn\0"
+    "Pohnpei\0"
+    "Ponape\0"
+    "Port_Moresby\0"
+    "Rarotonga\0"
+    "Saipan\0"
+    "Samoa\0"
+    "Tahiti\0"
+    "Tarawa\0"
+    "Tongatapu\0"
+    "Truk\0"
+    "Wake\0"
+    "Wallis\0"
+    "Yap\0"
+    "Poland\0"
+    "Portugal\0"
+    "ROC\0"
+    "ROK\0"
+    "Singapore\0"
+    "Turkey\0"
+    "UCT\0"
+    "Alaska\0"
+    "Aleutian\0"
+    "Arizona\0"
+    "Central\0"
+    "East-Indiana\0"
+    "Eastern\0"
+    "Hawaii\0"
+    "Indiana-Starke\0"
+    "Michigan\0"
+    "Mountain\0"
+    "Pacific\0"
+    "Samoa\0"
+    "UTC\0"
+    "Universal\0"
+    "W-SU\0"
+    "WET\0"
+    "Zulu\0"
+    ;
+
+// Deduplicated POSIX TZ rules, NUL separated
+const char TimezoneDatabase::rules[] =
+    "GMT0\0"
+    "EAT-3\0"
+    "CET-1\0"
+    "WAT-1\0"
+    "CAT-2\0"
+    "EET-2EEST,M4.5.5/0,M10.5.4/24\0"
+    "<+01>-1\0"
+    "CET-1CEST,M3.5.0,M10.5.0/3\0"
+    "SAST-2\0"
+    "EET-2\0"
+    "HST10HDT,M3.2.0,M11.1.0\0"
+    "AKST9AKDT,M3.2.0,M11.1.0\0"
+    "AST4\0"
+    "<-03>3\0"
+    "EST5\0"
+    "CST6\0"
+    "<-04>4\0"
+    "<-05>5\0"
+    "MST7MDT,M3.2.0,M11.1.0\0"
+    "CST6CDT,M3.2.0,M11.1.0\0"
+    "MST7\0"
+    "EST5EDT,M3.2.0,M11.1.0\0"
+    "PST8PDT,M3.2.0,M11.1.0\0"
+    "AST4ADT,M3.2.0,M11.1.0\0"
+    "<-02>2<-01>,M3.5.0/-1,M10.5.0/0\0"
+    "CST5CDT,M3.2.0/0,M11.1.0/1\0"
+    "<-03>3<-02>,M3.2.0,M11.1.0\0"
+    "<-02>2\0"
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24\0"
+    "NST3:30NDT,M3.2.0,M11.1.0\0"
+    "<+08>-8\0"
+    "<+07>-7\0"
+    "<+10>-10\0"
+    "AEST-10AEDT,M10.1.0,M4.1.0/3\0"
+    "<+05>-5\0"
+    "NZST-12NZDT,M9.5.0,M4.1.0/3\0"
+    "<+03>-3\0"
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\0"
+    "<+12>-12\0"
+    "<+04>-4\0"
+    "EET-2EEST,M3.5.0/0,M10.5.0/0\0"
+    "<+06>-6\0"
+    "IST-5:30\0"
+    "<+09>-9\0"
+    "CST-8\0"
+    "<+0530>-5:30\0"
+    "EET-2EEST,M3.5.0/3,M10.5.0/4\0"
+    "EET-2EEST,M3.4.4/50,M10.4.4/50\0"
+    "HKT-8\0"
+    "WIB-7\0"
+    "WIT-9\0"
+    "IST-2IDT,M3.4.4/26,M10.5.0\0"
+    "<+0430>-4:30\0"
+    "PKT-5\0"
+    "<+0545>-5:45\0"
+    "<+11>-11\0"
+    "WITA-8\0"
+    "PST-8\0"
+    "KST-9\0"
+    "<+0630>-6:30\0"
+    "<+0330>-3:30\0"
+    "JST-9\0"
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1\0"
+    "WET0WEST,M3.5.0/1,M10.5.0\0"
+    "<-01>1\0"
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3\0"
+    "AEST-10\0"
+    "ACST-9:30\0"
+    "<+0845>-8:45\0"
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\0"
+    "AWST-8\0"
+    "<-06>6<-05>,M9.1.6/22,M4.1.6/22\0"
+    "IST-1GMT0,M10.5.0,M3.5.0/1\0"
+    "<-10>10\0"
+    "<-11>11\0"
+    "<-12>12\0"
+    "<-06>6\0"
+    "<-07>7\0"
+    "<-08>8\0"
+    "<-09>9\0"
+    "<+13>-13\0"
+    "<+14>-14\0"
+    "<+02>-2\0"
+    "UTC0\0"
+    "GMT0BST,M3.5.0/1,M10.5.0\0"
+    "EET-2EEST,M3.5.0,M10.5.0/3\0"
+    "MSK-3\0"
+    "HST10\0"
+    "MET-1MEST,M3.5.0,M10.5.0/3\0"
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\0"
+    "ChST-10\0"
+    "<-0930>9:30\0"
+    "SST11\0"
+    "<+11>-11<+12>,M10.1.0,M4.1.0/3\0"
+    ;
+
+// Sorted by full zone name: {name offset, rule offset, region}
+const TimezoneDatabase::Entry TimezoneDatabase::entries[] = {
+    {0, 0, 1}, // Africa/Abidjan
+    {8, 0, 1}, // Africa/Accra
+    {14, 5, 1}, // Africa/Addis_Ababa
+    {26, 11, 1}, // Africa/Algiers
+    {34, 5, 1}, // Africa/Asmara
+    {41, 5, 1}, // Africa/Asmera
+    {48, 0, 1}, // Africa/Bamako
+    {55, 17, 1}, // Africa/Bangui
+    {62, 0, 1}, // Africa/Banjul
+    {69, 0, 1}, // Africa/Bissau
+    {76, 23, 1}, // Africa/Blantyre
+    {85, 17, 1}, // Africa/Brazzaville
+    {97, 23, 1}, // Africa/Bujumbura
+    {107, 29, 1}, // Africa/Cairo
+    {113, 59, 1}, // Africa/Casablanca
+    {124, 67, 1}, // Africa/Ceuta
+    {130, 0, 1}, // Africa/Conakry
+    {138, 0, 1}, // Africa/Dakar
+    {144, 5, 1}, // Africa/Dar_es_Salaam
+    {158, 5, 1}, // Africa/Djibouti
+    {167, 17, 1}, // Africa/Douala
+    {174, 59, 1}, // Africa/El_Aaiun
+    {183, 0, 1}, // Africa/Freetown
+    {192, 23, 1}, // Africa/Gaborone
+    {201, 23, 1}, // Africa/Harare
+    {208, 94, 1}, // Africa/Johannesburg
+    {221, 23, 1}, // Africa/Juba
+    {226, 5, 1}, // Africa/Kampala
+    {234, 23, 1}, // Africa/Khartoum
+    {243, 23, 1}, // Africa/Kigali
+    {250, 17, 1}, // Africa/Kinshasa
+    {259, 17, 1}, // Africa/Lagos
+    {265, 17, 1}, // Africa/Libreville
+    {276, 0, 1}, // Africa/Lome
+    {281, 17, 1}, // Africa/Luanda
+    {288, 23, 1}, // Africa/Lubumbashi
+    {299, 23, 1}, // Africa/Lusaka
+    {306, 17, 1}, // Africa/Malabo
+    {313, 23, 1}, // Africa/Maputo
+    {320, 94, 1}, // Africa/Maseru
+    {327, 94, 1}, // Africa/Mbabane
+    {335, 5, 1}, // Africa/Mogadishu
+    {345, 0, 1}, // Africa/Monrovia
+    {354, 5, 1}, // Africa/Nairobi
+    {362, 17, 1}, // Africa/Ndjamena
+    {371, 17, 1}, // Africa/Niamey
+    {378, 0, 1}, // Africa/Nouakchott
+    {389, 0, 1}, // Africa/Ouagadougou
+    {401, 17, 1}, // Africa/Porto-Novo
+    {412, 0, 1}, // Africa/Sao_Tome
+    {421, 0, 1}, // Africa/Timbuktu
+    {430, 101, 1}, // Africa/Tripoli
+    {438, 11, 1}, // Africa/Tunis
+    {444, 23, 1}, // Africa/Windhoek
+    {453, 107, 2}, // America/Adak
+    {458, 131, 2}, // America/Anchorage
+    {468, 156, 2}, // America/Anguilla
+    {477, 156, 2}, // America/Antigua
+    {485, 161, 2}, // America/Araguaina
+    {495, 161, 2}, // America/Argentina/Buenos_Aires
+    {518, 161, 2}, // America/Argentina/Catamarca
+    {538, 161, 2}, // America/Argentina/ComodRivadavia
+    {563, 161, 2}, // America/Argentina/Cordoba
+    {581, 161, 2}, // America/Argentina/Jujuy
+    {597, 161, 2}, // America/Argentina/La_Rioja
+    {616, 161, 2}, // America/Argentina/Mendoza
+    {634, 161, 2}, // America/Argentina/Rio_Gallegos
+    {657, 161, 2}, // America/Argentina/Salta
+    {673, 161, 2}, // America/Argentina/San_Juan
+    {692, 161, 2}, // America/Argentina/San_Luis
+    {711, 161, 2}, // America/Argentina/Tucuman
+    {729, 161, 2}, // America/Argentina/Ushuaia
+    {747, 156, 2}, // America/Aruba
+    {753, 161, 2}, // America/Asuncion
+    {762, 168, 2}, // America/Atikokan
+    {771, 107, 2}, // America/Atka
+    {776, 161, 2}, // America/Bahia
+    {782, 173, 2}, // America/Bahia_Banderas
+    {797, 156, 2}, // America/Barbados
+    {806, 161, 2}, // America/Belem
+    {812, 173, 2}, // America/Belize
+    {819, 156, 2}, // America/Blanc-Sablon
+    {832, 178, 2}, // America/Boa_Vista
+    {842, 185, 2}, // America/Bogota
+    {849, 192, 2}, // America/Boise
+    {855, 161, 2}, // America/Buenos_Aires
+    {868, 192, 2}, // America/Cambridge_Bay
+    {882, 178, 2}, // America/Campo_Grande
+    {895, 168, 2}, // America/Cancun
+    {902, 178, 2}, // America/Caracas
+    {910, 161, 2}, // America/Catamarca
+    {920, 161, 2}, // America/Cayenne
+    {928, 168, 2}, // America/Cayman
+    {935, 215, 2}, // America/Chicago
+    {943, 173, 2}, // America/Chihuahua
+    {953, 192, 2}, // America/Ciudad_Juarez
+    {967, 168, 2}, // America/Coral_Harbour
+    {981, 161, 2}, // America/Cordoba
+    {989, 173, 2}, // America/Costa_Rica
+    {1000, 161, 2}, // America/Coyhaique
+    {1010, 238, 2}, // America/Creston
+    {1018, 178, 2}, // America/Cuiaba
+    {1025, 156, 2}, // America/Curacao
+    {1033, 0, 2}, // America/Danmarkshavn
+    {1046, 238, 2}, // America/Dawson
+    {1053, 238, 2}, // America/Dawson_Creek
+    {1066, 192, 2}, // America/Denver
+    {1073, 243, 2}, // America/Detroit
+    {1081, 156, 2}, // America/Dominica
+    {1090, 192, 2}, // America/Edmonton
+    {1099, 185, 2}, // America/Eirunepe
+    {1108, 173, 2}, // America/El_Salvador
+    {1120, 266, 2}, // America/Ensenada
+    {1129, 238, 2}, // America/Fort_Nelson
+    {1141, 243, 2}, // America/Fort_Wayne
+    {1152, 161, 2}, // America/Fortaleza
+    {1162, 289, 2}, // America/Glace_Bay
+    {1172, 312, 2}, // America/Godthab
+    {1180, 289, 2}, // America/Goose_Bay
+    {1190, 243, 2}, // America/Grand_Turk
+    {1201, 156, 2}, // America/Grenada
+    {1209, 156, 2}, // America/Guadeloupe
+    {1220, 173, 2}, // America/Guatemala
+    {1230, 185, 2}, // America/Guayaquil
+    {1240, 178, 2}, // America/Guyana
+    {1247, 289, 2}, // America/Halifax
+    {1255, 344, 2}, // America/Havana
+    {1262, 238, 2}, // America/Hermosillo
+    {1273, 243, 2}, // America/Indiana/Indianapolis
+    {1294, 215, 2}, // America/Indiana/Knox
+    {1307, 243, 2}, // America/Indiana/Marengo
+    {1323, 243, 2}, // America/Indiana/Petersburg
+    {1342, 215, 2}, // America/Indiana/Tell_City
+    {1360, 243, 2}, // America/Indiana/Vevay
+    {1374, 243, 2}, // America/Indiana/Vincennes
+    {1392, 243, 2}, // America/Indiana/Winamac
+    {1408, 243, 2}, // America/Indianapolis
+    {1421, 192, 2}, // America/Inuvik
+    {1428, 243, 2}, // America/Iqaluit
+    {1436, 168, 2}, // America/Jamaica
+    {1444, 161, 2}, // America/Jujuy
+    {1450, 131, 2}, // America/Juneau
+    {1457, 243, 2}, // America/Kentucky/Louisville
+    {1477, 243, 2}, // America/Kentucky/Monticello
+    {1497, 215, 2}, // America/Knox_IN
+    {1505, 156, 2}, // America/Kralendijk
+    {1516, 178, 2}, // America/La_Paz
+    {1523, 185, 2}, // America/Lima
+    {1528, 266, 2}, // America/Los_Angeles
+    {1540, 243, 2}, // America/Louisville
+    {1551, 156, 2}, // America/Lower_Princes
+    {1565, 161, 2}, // America/Maceio
+    {1572, 173, 2}, // America/Managua
+    {1580, 178, 2}, // America/Manaus
+    {1587, 156, 2}, // America/Marigot
+    {1595, 156, 2}, // America/Martinique
+    {1606, 215, 2}, // America/Matamoros
+    {1616, 238, 2}, // America/Mazatlan
+    {1625, 161, 2}, // America/Mendoza
+    {1633, 215, 2}, // America/Menominee
+    {1643, 173, 2}, // America/Merida
+    {1650, 131, 2}, // America/Metlakatla
+    {1661, 173, 2}, // America/Mexico_City
+    {1673, 371, 2}, // America/Miquelon
+    {1682, 289, 2}, // America/Moncton
+    {1690, 173, 2}, // America/Monterrey
+    {1700, 161, 2}, // America/Montevideo
+    {1711, 243, 2}, // America/Montreal
+    {1720, 156, 2}, // America/Montserrat
+    {1731, 243, 2}, // America/Nassau
+    {1738, 243, 2}, // America/New_York
+    {1747, 243, 2}, // America/Nipigon
+    {1755, 131, 2}, // America/Nome
+    {1760, 398, 2}, // America/Noronha
+    {1768, 215, 2}, // America/North_Dakota/Beulah
+    {1788, 215, 2}, // America/North_Dakota/Center
+    {1808, 215, 2}, // America/North_Dakota/New_Salem
+    {1831, 312, 2}, // America/Nuuk
+    {1836, 215, 2}, // America/Ojinaga
+    {1844, 168, 2}, // America/Panama
+    {1851, 243, 2}, // America/Pangnirtung
+    {1863, 161, 2}, // America/Paramaribo
+    {1874, 238, 2}, // America/Phoenix
+    {1882, 243, 2}, // America/Port-au-Prince
+    {1897, 156, 2}, // America/Port_of_Spain
+    {1911, 185, 2}, // America/Porto_Acre
+    {1922, 178, 2}, // America/Porto_Velho
+    {1934, 156, 2}, // America/Puerto_Rico
+    {1946, 161, 2}, // America/Punta_Arenas
+    {1959, 215, 2}, // America/Rainy_River
+    {1971, 215, 2}, // America/Rankin_Inlet
+    {1984, 161, 2}, // America/Recife
+    {1991, 173, 2}, // America/Regina
+    {1998, 215, 2}, // America/Resolute
+    {2007, 185, 2}, // America/Rio_Branco
+    {2018, 161, 2}, // America/Rosario
+    {2026, 266, 2}, // America/Santa_Isabel
+    {2039, 161, 2}, // America/Santarem
+    {2048, 405, 2}, // America/Santiago
+    {2057, 156, 2}, // America/Santo_Domingo
+    {2071, 161, 2}, // America/Sao_Paulo
+    {2081, 312, 2}, // America/Scoresbysund
+    {2094, 192, 2}, // America/Shiprock
+    {2103, 131, 2}, // America/Sitka
+    {2109, 156, 2}, // America/St_Barthelemy
+    {2123, 437, 2}, // America/St_Johns
+    {2132, 156, 2}, // America/St_Kitts
+    {2141, 156, 2}, // America/St_Lucia
+    {2150, 156, 2}, // America/St_Thomas
+    {2160, 156, 2}, // America/St_Vincent
+    {2171, 173, 2}, // America/Swift_Current
+    {2185, 173, 2}, // America/Tegucigalpa
+    {2197, 289, 2}, // America/Thule
+    {2203, 243, 2}, // America/Thunder_Bay
+    {2215, 266, 2}, // America/Tijuana
+    {2223, 243, 2}, // America/Toronto
+    {2231, 156, 2}, // America/Tortola
+    {2239, 266, 2}, // America/Vancouver
+    {2249, 156, 2}, // America/Virgin
+    {2256, 238, 2}, // America/Whitehorse
+    {2267, 215, 2}, // America/Winnipeg
+    {2276, 131, 2}, // America/Yakutat
+    {2284, 192, 2}, // America/Yellowknife
+    {2296, 463, 3}, // Antarctica/Casey
+    {2302, 471, 3}, // Antarctica/Davis
+    {2308, 479, 3}, // Antarctica/DumontDUrville
+    {2323, 488, 3}, // Antarctica/Macquarie
+    {2333, 517, 3}, // Antarctica/Mawson
+    {2340, 525, 3}, // Antarctica/McMurdo
+    {2348, 161, 3}, // Antarctica/Palmer
+    {2355, 161, 3}, // Antarctica/Rothera
+    {2363, 525, 3}, // Antarctica/South_Pole
+    {2374, 553, 3}, // Antarctica/Syowa
+    {2380, 561, 3}, // Antarctica/Troll
+    {2386, 517, 3}, // Antarctica/Vostok
+    {2393, 67, 4}, // Arctic/Longyearbyen
+    {2406, 553, 5}, // Asia/Aden
+    {2411, 517, 5}, // Asia/Almaty
+    {2418, 553, 5}, // Asia/Amman
+    {2424, 594, 5}, // Asia/Anadyr
+    {2431, 517, 5}, // Asia/Aqtau
+    {2437, 517, 5}, // Asia/Aqtobe
+    {2444, 517, 5}, // Asia/Ashgabat
+    {2453, 517, 5}, // Asia/Ashkhabad
+    {2463, 517, 5}, // Asia/Atyrau
+    {2470, 553, 5}, // Asia/Baghdad
+    {2478, 553, 5}, // Asia/Bahrain
+    {2486, 603, 5}, // Asia/Baku
+    {2491, 471, 5}, // Asia/Bangkok
+    {2499, 471, 5}, // Asia/Barnaul
+    {2507, 611, 5}, // Asia/Beirut
+    {2514, 640, 5}, // Asia/Bishkek
+    {2522, 463, 5}, // Asia/Brunei
+    {2529, 648, 5}, // Asia/Calcutta
+    {2538, 657, 5}, // Asia/Chita
+    {2544, 463, 5}, // Asia/Choibalsan
+    {2555, 665, 5}, // Asia/Chongqing
+    {2565, 665, 5}, // Asia/Chungking
+    {2575, 671, 5}, // Asia/Colombo
+    {2583, 640, 5}, // Asia/Dacca
+    {2589, 553, 5}, // Asia/Damascus
+    {2598, 640, 5}, // Asia/Dhaka
+    {2604, 657, 5}, // Asia/Dili
+    {2609, 603, 5}, // Asia/Dubai
+    {2615, 517, 5}, // Asia/Dushanbe
+    {2624, 684, 5}, // Asia/Famagusta
+    {2634, 713, 5}, // Asia/Gaza
+    {2639, 665, 5}, // Asia/Harbin
+    {2646, 713, 5}, // Asia/Hebron
+    {2653, 471, 5}, // Asia/Ho_Chi_Minh
+    {2665, 744, 5}, // Asia/Hong_Kong
+    {2675, 471, 5}, // Asia/Hovd
+    {2680, 463, 5}, // Asia/Irkutsk
+    {2688, 553, 5}, // Asia/Istanbul
+    {2697, 750, 5}, // Asia/Jakarta
+    {2705, 756, 5}, // Asia/Jayapura
+    {2714, 762, 5}, // Asia/Jerusalem
+    {2724, 789, 5}, // Asia/Kabul
+    {2730, 594, 5}, // Asia/Kamchatka
+    {2740, 802, 5}, // Asia/Karachi
+    {2748, 640, 5}, // Asia/Kashgar
+    {2756, 808, 5}, // Asia/Kathmandu
+    {2766, 808, 5}, // Asia/Katmandu
+    {2775, 657, 5}, // Asia/Khandyga
+    {2784, 648, 5}, // Asia/Kolkata
+    {2792, 471, 5}, // Asia/Krasnoyarsk
+    {2804, 463, 5}, // Asia/Kuala_Lumpur
+    {2817, 463, 5}, // Asia/Kuching
+    {2825, 553, 5}, // Asia/Kuwait
+    {2832, 665, 5}, // Asia/Macao
+    {2838, 665, 5}, // Asia/Macau
+    {2844, 821, 5}, // Asia/Magadan
+    {2852, 830, 5}, // Asia/Makassar
+    {2861, 837, 5}, // Asia/Manila
+    {2868, 603, 5}, // Asia/Muscat
+    {2875, 684, 5}, // Asia/Nicosia
+    {2883, 471, 5}, // Asia/Novokuznetsk
+    {2896, 471, 5}, // Asia/Novosibirsk
+    {2908, 640, 5}, // Asia/Omsk
+    {2913, 517, 5}, // Asia/Oral
+    {2918, 471, 5}, // Asia/Phnom_Penh
+    {2929, 750, 5}, // Asia/Pontianak
+    {2939, 843, 5}, // Asia/Pyongyang
+    {2949, 553, 5}, // Asia/Qatar
+    {2955, 517, 5}, // Asia/Qostanay
+    {2964, 517, 5}, // Asia/Qyzylorda
+    {2974, 849, 5}, // Asia/Rangoon
+    {2982, 553, 5}, // Asia/Riyadh
+    {2989, 471, 5}, // Asia/Saigon
+    {2996, 821, 5}, // Asia/Sakhalin
+    {3005, 517, 5}, // Asia/Samarkand
+    {3015, 843, 5}, // Asia/Seoul
+    {3021, 665, 5}, // Asia/Shanghai
+    {3030, 463, 5}, // Asia/Singapore
+    {3040, 821, 5}, // Asia/Srednekolymsk
+    {3054, 665, 5}, // Asia/Taipei
+    {3061, 517, 5}, // Asia/Tashkent
+    {3070, 603, 5}, // Asia/Tbilisi
+    {3078, 862, 5}, // Asia/Tehran
+    {3085, 762, 5}, // Asia/Tel_Aviv
+    {3094, 640, 5}, // Asia/Thimbu
+    {3101, 640, 5}, // Asia/Thimphu
+    {3109, 875, 5}, // Asia/Tokyo
+    {3115, 471, 5}, // Asia/Tomsk
+    {3121, 830, 5}, // Asia/Ujung_Pandang
+    {3135, 463, 5}, // Asia/Ulaanbaatar
+    {3147, 463, 5}, // Asia/Ulan_Bator
+    {3158, 640, 5}, // Asia/Urumqi
+    {3165, 479, 5}, // Asia/Ust-Nera
+    {3174, 471, 5}, // Asia/Vientiane
+    {3184, 479, 5}, // Asia/Vladivostok
+    {3196, 657, 5}, // Asia/Yakutsk
+    {3204, 849, 5}, // Asia/Yangon
+    {3211, 517, 5}, // Asia/Yekaterinburg
+    {3225, 603, 5}, // Asia/Yerevan
+    {3233, 881, 6}, // Atlantic/Azores
+    {3240, 289, 6}, // Atlantic/Bermuda
+    {3248, 912, 6}, // Atlantic/Canary
+    {3255, 938, 6}, // Atlantic/Cape_Verde
+    {3266, 912, 6}, // Atlantic/Faeroe
+    {3273, 912, 6}, // Atlantic/Faroe
+    {3279, 67, 6}, // Atlantic/Jan_Mayen
+    {3289, 912, 6}, // Atlantic/Madeira
+    {3297, 0, 6}, // Atlantic/Reykjavik
+    {3307, 398, 6}, // Atlantic/South_Georgia
+    {3321, 0, 6}, // Atlantic/St_Helena
+    {3331, 161, 6}, // Atlantic/Stanley
+    {3339, 488, 7}, // Australia/ACT
+    {3343, 945, 7}, // Australia/Adelaide
+    {3352, 976, 7}, // Australia/Brisbane
+    {3361, 945, 7}, // Australia/Broken_Hill
+    {3373, 488, 7}, // Australia/Canberra
+    {3382, 488, 7}, // Australia/Currie
+    {3389, 984, 7}, // Australia/Darwin
+    {3396, 994, 7}, // Australia/Eucla
+    {3402, 488, 7}, // Australia/Hobart
+    {3409, 1007, 7}, // Australia/LHI
+    {3413, 976, 7}, // Australia/Lindeman
+    {3422, 1007, 7}, // Australia/Lord_Howe
+    {3432, 488, 7}, // Australia/Melbourne
+    {3442, 488, 7}, // Australia/NSW
+    {3446, 984, 7}, // Australia/North
+    {3452, 1044, 7}, // Australia/Perth
+    {3458, 976, 7}, // Australia/Queensland
+    {3469, 945, 7}, // Australia/South
+    {3475, 488, 7}, // Australia/Sydney
+    {3482, 488, 7}, // Australia/Tasmania
+    {3491, 488, 7}, // Australia/Victoria
+    {3500, 1044, 7}, // Australia/West
+    {3505, 945, 7}, // Australia/Yancowinna
+    {3516, 185, 8}, // Brazil/Acre
+    {3521, 398, 8}, // Brazil/DeNoronha
+    {3531, 161, 8}, // Brazil/East
+    {3536, 178, 8}, // Brazil/West
+    {3541, 67, 0}, // CET
+    {3545, 215, 0}, // CST6CDT
+    {3553, 289, 9}, // Canada/Atlantic
+    {3562, 215, 9}, // Canada/Central
+    {3570, 243, 9}, // Canada/Eastern
+    {3578, 192, 9}, // Canada/Mountain
+    {3587, 437, 9}, // Canada/Newfoundland
+    {3600, 266, 9}, // Canada/Pacific
+    {3608, 173, 9}, // Canada/Saskatchewan
+    {3621, 238, 9}, // Canada/Yukon
+    {3627, 405, 10}, // Chile/Continental
+    {3639, 1051, 10}, // Chile/EasterIsland
+    {3652, 344, 0}, // Cuba
+    {3657, 684, 0}, // EET
+    {3661, 168, 0}, // EST
+    {3665, 243, 0}, // EST5EDT
+    {3673, 29, 0}, // Egypt
+    {3679, 1083, 0}, // Eire
+    {3684, 0, 11}, // Etc/GMT
+    {3688, 0, 11}, // Etc/GMT+0
+    {3694, 938, 11}, // Etc/GMT+1
+    {3700, 1110, 11}, // Etc/GMT+10
+    {3707, 1118, 11}, // Etc/GMT+11
+    {3714, 1126, 11}, // Etc/GMT+12
+    {3721, 398, 11}, // Etc/GMT+2
+    {3727, 161, 11}, // Etc/GMT+3
+    {3733, 178, 11}, // Etc/GMT+4
+    {3739, 185, 11}, // Etc/GMT+5
+    {3745, 1134, 11}, // Etc/GMT+6
+    {3751, 1141, 11}, // Etc/GMT+7
+    {3757, 1148, 11}, // Etc/GMT+8
+    {3763, 1155, 11}, // Etc/GMT+9
+    {3769, 0, 11}, // Etc/GMT-0
+    {3775, 59, 11}, // Etc/GMT-1
+    {3781, 479, 11}, // Etc/GMT-10
+    {3788, 821, 11}, // Etc/GMT-11
+    {3795, 594, 11}, // Etc/GMT-12
+    {3802, 1162, 11}, // Etc/GMT-13
+    {3809, 1171, 11}, // Etc/GMT-14
+    {3816, 1180, 11}, // Etc/GMT-2
+    {3822, 553, 11}, // Etc/GMT-3
+    {3828, 603, 11}, // Etc/GMT-4
+    {3834, 517, 11}, // Etc/GMT-5
+    {3840, 640, 11}, // Etc/GMT-6
+    {3846, 471, 11}, // Etc/GMT-7
+    {3852, 463, 11}, // Etc/GMT-8
+    {3858, 657, 11}, // Etc/GMT-9
+    {3864, 0, 11}, // Etc/GMT0
+    {3869, 0, 11}, // Etc/Greenwich
+    {3879, 1188, 11}, // Etc/UCT
+    {3883, 1188, 11}, // Etc/UTC
+    {3887, 1188, 11}, // Etc/Universal
+    {3897, 1188, 11}, // Etc/Zulu
+    {3902, 67, 12}, // Europe/Amsterdam
+    {3912, 67, 12}, // Europe/Andorra
+    {3920, 603, 12}, // Europe/Astrakhan
+    {3930, 684, 12}, // Europe/Athens
+    {3937, 1193, 12}, // Europe/Belfast
+    {3945, 67, 12}, // Europe/Belgrade
+    {3954, 67, 12}, // Europe/Berlin
+    {3961, 67, 12}, // Europe/Bratislava
+    {3972, 67, 12}, // Europe/Brussels
+    {3981, 684, 12}, // Europe/Bucharest
+    {3991, 67, 12}, // Europe/Budapest
+    {4000, 67, 12}, // Europe/Busingen
+    {4009, 1218, 12}, // Europe/Chisinau
+    {4018, 67, 12}, // Europe/Copenhagen
+    {4029, 1083, 12}, // Europe/Dublin
+    {4036, 67, 12}, // Europe/Gibraltar
+    {4046, 1193, 12}, // Europe/Guernsey
+    {4055, 684, 12}, // Europe/Helsinki
+    {4064, 1193, 12}, // Europe/Isle_of_Man
+    {4076, 553, 12}, // Europe/Istanbul
+    {4085, 1193, 12}, // Europe/Jersey
+    {4092, 101, 12}, // Europe/Kaliningrad
+    {4104, 684, 12}, // Europe/Kiev
+    {4109, 1245, 12}, // Europe/Kirov
+    {4115, 684, 12}, // Europe/Kyiv
+    {4120, 912, 12}, // Europe/Lisbon
+    {4127, 67, 12}, // Europe/Ljubljana
+    {4137, 1193, 12}, // Europe/London
+    {4144, 67, 12}, // Europe/Luxembourg
+    {4155, 67, 12}, // Europe/Madrid
+    {4162, 67, 12}, // Europe/Malta
+    {4168, 684, 12}, // Europe/Mariehamn
+    {4178, 553, 12}, // Europe/Minsk
+    {4184, 67, 12}, // Europe/Monaco
+    {4191, 1245, 12}, // Europe/Moscow
+    {4198, 684, 12}, // Europe/Nicosia
+    {4206, 67, 12}, // Europe/Oslo
+    {4211, 67, 12}, // Europe/Paris
+    {4217, 67, 12}, // Europe/Podgorica
+    {4227, 67, 12}, // Europe/Prague
+    {4234, 684, 12}, // Europe/Riga
+    {4239, 67, 12}, // Europe/Rome
+    {4244, 603, 12}, // Europe/Samara
+    {4251, 67, 12}, // Europe/San_Marino
+    {4262, 67, 12}, // Europe/Sarajevo
+    {4271, 603, 12}, // Europe/Saratov
+    {4279, 1245, 12}, // Europe/Simferopol
+    {4290, 67, 12}, // Europe/Skopje
+    {4297, 684, 12}, // Europe/Sofia
+    {4303, 67, 12}, // Europe/Stockholm
+    {4313, 684, 12}, // Europe/Tallinn
+    {4321, 67, 12}, // Europe/Tirane
+    {4328, 1218, 12}, // Europe/Tiraspol
+    {4337, 603, 12}, // Europe/Ulyanovsk
+    {4347, 684, 12}, // Europe/Uzhgorod
+    {4356, 67, 12}, // Europe/Vaduz
+    {4362, 67, 12}, // Europe/Vatican
+    {4370, 67, 12}, // Europe/Vienna
+    {4377, 684, 12}, // Europe/Vilnius
+    {4385, 1245, 12}, // Europe/Volgograd
+    {4395, 67, 12}, // Europe/Warsaw
+    {4402, 67, 12}, // Europe/Zagreb
+    {4409, 684, 12}, // Europe/Zaporozhye
+    {4420, 67, 12}, // Europe/Zurich
+    {4427, 1193, 0}, // GB
+    {4430, 1193, 0}, // GB-Eire
+    {4438, 0, 0}, // GMT
+    {4442, 0, 0}, // GMT+0
+    {4448, 0, 0}, // GMT-0
+    {4454, 0, 0}, // GMT0
+    {4459, 0, 0}, // Greenwich
+    {4469, 1251, 0}, // HST
+    {4473, 744, 0}, // Hongkong
+    {4482, 0, 0}, // Iceland
+    {4490, 5, 13}, // Indian/Antananarivo
+    {4503, 640, 13}, // Indian/Chagos
+    {4510, 471, 13}, // Indian/Christmas
+    {4520, 849, 13}, // Indian/Cocos
+    {4526, 5, 13}, // Indian/Comoro
+    {4533, 517, 13}, // Indian/Kerguelen
+    {4543, 603, 13}, // Indian/Mahe
+    {4548, 517, 13}, // Indian/Maldives
+    {4557, 603, 13}, // Indian/Mauritius
+    {4567, 5, 13}, // Indian/Mayotte
+    {4575, 603, 13}, // Indian/Reunion
+    {4583, 862, 0}, // Iran
+    {4588, 762, 0}, // Israel
+    {4595, 168, 0}, // Jamaica
+    {4603, 875, 0}, // Japan
+    {4609, 594, 0}, // Kwajalein
+    {4619, 101, 0}, // Libya
+    {4625, 1257, 0}, // MET
+    {4629, 238, 0}, // MST
+    {4633, 192, 0}, // MST7MDT
+    {4641, 266, 14}, // Mexico/BajaNorte
+    {4651, 238, 14}, // Mexico/BajaSur
+    {4659, 173, 14}, // Mexico/General
+    {4667, 525, 0}, // NZ
+    {4670, 1284, 0}, // NZ-CHAT
+    {4678, 192, 0}, // Navajo
+    {4685, 665, 0}, // PRC
+    {4689, 266, 0}, // PST8PDT
+    {4697, 1162, 15}, // Pacific/Apia
+    {4702, 525, 15}, // Pacific/Auckland
+    {4711, 821, 15}, // Pacific/Bougainville
+    {4724, 1284, 15}, // Pacific/Chatham
+    {4732, 479, 15}, // Pacific/Chuuk
+    {4738, 1051, 15}, // Pacific/Easter
+    {4745, 821, 15}, // Pacific/Efate
+    {4751, 1162, 15}, // Pacific/Enderbury
+    {4761, 1162, 15}, // Pacific/Fakaofo
+    {4769, 594, 15}, // Pacific/Fiji
+    {4774, 594, 15}, // Pacific/Funafuti
+    {4783, 1134, 15}, // Pacific/Galapagos
+    {4793, 1155, 15}, // Pacific/Gambier
+    {4801, 821, 15}, // Pacific/Guadalcanal
+    {4813, 1329, 15}, // Pacific/Guam
+    {4818, 1251, 15}, // Pacific/Honolulu
+    {4827, 1251, 15}, // Pacific/Johnston
+    {4836, 1162, 15}, // Pacific/Kanton
+    {4843, 1171, 15}, // Pacific/Kiritimati
+    {4854, 821, 15}, // Pacific/Kosrae
+    {4861, 594, 15}, // Pacific/Kwajalein
+    {4871, 594, 15}, // Pacific/Majuro
+    {4878, 1337, 15}, // Pacific/Marquesas
+    {4888, 1349, 15}, // Pacific/Midway
+    {4895, 594, 15}, // Pacific/Nauru
+    {4901, 1118, 15}, // Pacific/Niue
+    {4906, 1355, 15}, // Pacific/Norfolk
+    {4914, 821, 15}, // Pacific/Noumea
+    {4921, 1349, 15}, // Pacific/Pago_Pago
+    {4931, 657, 15}, // Pacific/Palau
+    {4937, 1148, 15}, // Pacific/Pitcairn
+    {4946, 821, 15}, // Pacific/Pohnpei
+    {4954, 821, 15}, // Pacific/Ponape
+    {4961, 479, 15}, // Pacific/Port_Moresby
+    {4974, 1110, 15}, // Pacific/Rarotonga
+    {4984, 1329, 15}, // Pacific/Saipan
+    {4991, 1349, 15}, // Pacific/Samoa
+    {4997, 1110, 15}, // Pacific/Tahiti
+    {5004, 594, 15}, // Pacific/Tarawa
+    {5011, 1162, 15}, // Pacific/Tongatapu
+    {5021, 479, 15}, // Pacific/Truk
+    {5026, 594, 15}, // Pacific/Wake
+    {5031, 594, 15}, // Pacific/Wallis
+    {5038, 479, 15}, // Pacific/Yap
+    {5042, 67, 0}, // Poland
+    {5049, 912, 0}, // Portugal
+    {5058, 665, 0}, // ROC
+    {5062, 843, 0}, // ROK
+    {5066, 463, 0}, // Singapore
+    {5076, 553, 0}, // Turkey
+    {5083, 1188, 0}, // UCT
+    {5087, 131, 16}, // US/Alaska
+    {5094, 107, 16}, // US/Aleutian
+    {5103, 238, 16}, // US/Arizona
+    {5111, 215, 16}, // US/Central
+    {5119, 243, 16}, // US/East-Indiana
+    {5132, 243, 16}, // US/Eastern
+    {5140, 1251, 16}, // US/Hawaii
+    {5147, 215, 16}, // US/Indiana-Starke
+    {5162, 243, 16}, // US/Michigan
+    {5171, 192, 16}, // US/Mountain
+    {5180, 266, 16}, // US/Pacific
+    {5188, 1349, 16}, // US/Samoa
+    {5194, 1188, 0}, // UTC
+    {5198, 1188, 0}, // Universal
+    {5208, 1245, 0}, // W-SU
+    {5213, 912, 0}, // WET
+    {5217, 1188, 0}, // Zulu
+};
+
+const int TimezoneDatabase::entryCount = sizeof(entries) / sizeof(entries[0]);
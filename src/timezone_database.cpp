@@ -0,0 +1,72 @@
+#include "timezone_database.h"
+#include <string.h>
+#include <stdio.h>
+
+// Tables live in timezone_data.cpp (generated by scripts/generate_timezones.py)
+
+const char* TimezoneDatabase::findRule(const char* name) {
+    if (!name) {
+        return nullptr;
+    }
+
+    int low = 0;
+    int high = entryCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int cmp = compareName(name, entries[mid]);
+        if (cmp == 0) {
+            return rules + entries[mid].rule;
+        }
+        if (cmp < 0) {
+            high = mid - 1;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return nullptr;
+}
+
+size_t TimezoneDatabase::getName(int index, char* buffer, size_t size) {
+    if (index < 0 || index >= entryCount || size == 0) {
+        return 0;
+    }
+
+    const Entry& entry = entries[index];
+    const char* region = regions[entry.region];
+    int written;
+    if (region[0]) {
+        written = snprintf(buffer, size, "%s/%s", region, names + entry.name);
+    } else {
+        written = snprintf(buffer, size, "%s", names + entry.name);
+    }
+    return written < 0 ? 0 : ((size_t)written < size ? (size_t)written : size - 1);
+}
+
+const char* TimezoneDatabase::getRule(int index) {
+    if (index < 0 || index >= entryCount) {
+        return nullptr;
+    }
+    return rules + entries[index].rule;
+}
+
+int TimezoneDatabase::compareName(const char* name, const Entry& entry) {
+    // Compare against "region/name" without building the full string
+    const unsigned char* a = (const unsigned char*)name;
+    const unsigned char* region = (const unsigned char*)regions[entry.region];
+
+    if (*region) {
+        while (*region && *a == *region) {
+            a++;
+            region++;
+        }
+        if (*region) {
+            return (int)*a - (int)*region;
+        }
+        if (*a != '/') {
+            return (int)*a - (int)'/';
+        }
+        a++;
+    }
+
+    return strcmp((const char*)a, names + entry.name);
+}
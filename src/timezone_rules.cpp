@@ -0,0 +1,271 @@
+#include "timezone_rules.h"
+#include <stdlib.h>
+#include <ctype.h>
+
+// Day of week of 1970-01-01 (Thursday)
+static const int EPOCH_WEEKDAY = 4;
+static const long SECONDS_PER_DAY = 86400L;
+// newlib keeps tzname fields to 10 characters
+static const int MAX_NAME_LENGTH = 10;
+
+static const int monthLengths[2][12] = {
+    {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31},
+    {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31}
+};
+
+TimezoneRules::TimezoneRules() :
+    valid(false),
+    hasDst(false),
+    stdOffset(0),
+    dstOffset(0),
+    cachedYear(-1),
+    yearStart(0),
+    nextYearStart(0),
+    dstStart(0),
+    dstEnd(0),
+    northern(true) {
+}
+
+bool TimezoneRules::parse(const char* posix) {
+    valid = false;
+    cachedYear = -1;
+    if (!posix) {
+        return false;
+    }
+
+    const char* p = posix;
+    if (*p == ':') p++; // Implementation-specific prefix, ignored like newlib
+
+    // Standard time name and offset (mandatory)
+    p = parseName(p);
+    if (!p) return false;
+    p = parseOffset(p, &stdOffset);
+    if (!p) return false;
+
+    // Optional DST name - without it the zone is fixed
+    const char* afterName = parseName(p);
+    if (!afterName) {
+        hasDst = false;
+        dstOffset = stdOffset;
+        valid = true;
+        return true;
+    }
+    p = afterName;
+
+    // DST offset defaults to one hour ahead of standard time
+    const char* afterOffset = parseOffset(p, &dstOffset);
+    if (afterOffset) {
+        p = afterOffset;
+    } else {
+        dstOffset = stdOffset - 3600;
+    }
+
+    // Start and end rules (US rules when omitted, as in newlib)
+    for (int i = 0; i < 2; i++) {
+        if (*p == ',') p++;
+        p = parseRule(p, &rules[i], i == 1);
+        if (!p) return false;
+    }
+
+    hasDst = stdOffset != dstOffset;
+    valid = true;
+    return true;
+}
+
+long TimezoneRules::getUtcOffset(time_t utc, bool* isDst) {
+    bool dst = false;
+    if (valid && hasDst) {
+        if (utc < yearStart || utc >= nextYearStart || cachedYear < 0) {
+            cacheYear(utc);
+        }
+        if (cachedYear >= 1970) {
+            dst = northern ? (utc >= dstStart && utc < dstEnd)
+                           : (utc >= dstStart || utc < dstEnd);
+        }
+    }
+    if (isDst) *isDst = dst;
+    return -(dst ? dstOffset : stdOffset);
+}
+
+bool TimezoneRules::toLocal(time_t utc, struct tm& out) {
+    if (!valid) {
+        return false;
+    }
+
+    bool dst;
+    time_t local = utc + getUtcOffset(utc, &dst);
+    gmtime_r(&local, &out);
+
+    // newlib reports an unknown DST state for years it can't compute rules for
+    if (hasDst && cachedYear < 1970) {
+        out.tm_isdst = -1;
+    } else {
+        out.tm_isdst = dst ? 1 : 0;
+    }
+    return true;
+}
+
+void TimezoneRules::cacheYear(time_t utc) {
+    // The rules are evaluated for the UTC year of the instant, like newlib does
+    struct tm utcTime;
+    gmtime_r(&utc, &utcTime);
+    int year = utcTime.tm_year + 1900;
+
+    cachedYear = year;
+    yearStart = (time_t)(daysFromCivil(year, 1, 1) * SECONDS_PER_DAY);
+    nextYearStart = (time_t)(daysFromCivil(year + 1, 1, 1) * SECONDS_PER_DAY);
+    if (year < 1970) {
+        return;
+    }
+
+    dstStart = transitionTime(year, rules[0], stdOffset);
+    dstEnd = transitionTime(year, rules[1], dstOffset);
+    northern = dstStart < dstEnd;
+}
+
+time_t TimezoneRules::transitionTime(int year, const Rule& rule, long offset) {
+    bool leap = isLeapYear(year);
+    int64_t days = daysFromCivil(year, 1, 1);
+
+    if (rule.type == 'J') {
+        // Day 1-365, February 29th is never counted
+        days += rule.day - 1 + ((leap && rule.day >= 60) ? 1 : 0);
+    } else if (rule.type == 'D') {
+        days += rule.day;
+    } else {
+        const int* lengths = monthLengths[leap ? 1 : 0];
+        for (int m = 1; m < rule.month; m++) {
+            days += lengths[m - 1];
+        }
+        int firstWeekday = (int)((EPOCH_WEEKDAY + days) % 7);
+        int weekdayDiff = rule.day - firstWeekday;
+        if (weekdayDiff < 0) weekdayDiff += 7;
+        int monthDay = (rule.week - 1) * 7 + weekdayDiff;
+        while (monthDay >= lengths[rule.month - 1]) {
+            monthDay -= 7; // Week 5 means the last such weekday
+        }
+        days += monthDay;
+    }
+
+    // Transition times are given in the local time in effect before the switch
+    return (time_t)(days * SECONDS_PER_DAY + rule.seconds + offset);
+}
+
+const char* TimezoneRules::parseName(const char* p) {
+    int length = 0;
+    if (*p == '<') {
+        // Quoted form allows signs and digits, e.g. <+0530>
+        p++;
+        while (isalnum((unsigned char)p[length]) || p[length] == '+' || p[length] == '-') {
+            length++;
+        }
+        if (length == 0 || length > MAX_NAME_LENGTH || p[length] != '>') {
+            return nullptr;
+        }
+        return p + length + 1;
+    }
+
+    while (isalpha((unsigned char)p[length])) {
+        length++;
+    }
+    if (length == 0 || length > MAX_NAME_LENGTH) {
+        return nullptr;
+    }
+    return p + length;
+}
+
+const char* TimezoneRules::parseOffset(const char* p, long* seconds) {
+    int sign = 1;
+    if (*p == '-') {
+        sign = -1;
+        p++;
+    } else if (*p == '+') {
+        p++;
+    }
+
+    if (!isdigit((unsigned char)*p)) {
+        return nullptr;
+    }
+
+    char* end;
+    long hours = strtol(p, &end, 10);
+    long minutes = 0;
+    long secs = 0;
+    p = end;
+    if (*p == ':' && isdigit((unsigned char)p[1])) {
+        minutes = strtol(p + 1, &end, 10);
+        p = end;
+        if (*p == ':' && isdigit((unsigned char)p[1])) {
+            secs = strtol(p + 1, &end, 10);
+            p = end;
+        }
+    }
+
+    *seconds = sign * (hours * 3600 + minutes * 60 + secs);
+    return p;
+}
+
+const char* TimezoneRules::parseRule(const char* p, Rule* rule, bool end) {
+    char* next;
+    if (*p == 'M') {
+        rule->type = 'M';
+        rule->month = strtol(p + 1, &next, 10);
+        if (next == p + 1 || *next != '.') return nullptr;
+        p = next + 1;
+        rule->week = strtol(p, &next, 10);
+        if (next == p || *next != '.') return nullptr;
+        p = next + 1;
+        rule->day = strtol(p, &next, 10);
+        if (next == p) return nullptr;
+        p = next;
+        if (rule->month < 1 || rule->month > 12 || rule->week < 1 || rule->week > 5 ||
+            rule->day < 0 || rule->day > 6) {
+            return nullptr;
+        }
+    } else {
+        rule->type = 'D';
+        if (*p == 'J') {
+            rule->type = 'J';
+            p++;
+        }
+        long day = strtol(p, &next, 10);
+        if (next == p) {
+            // No rule given - default to US rules (2nd Sunday March / 1st Sunday November)
+            rule->type = 'M';
+            rule->month = end ? 11 : 3;
+            rule->week = end ? 1 : 2;
+            rule->day = 0;
+        } else {
+            rule->day = (int)day;
+            rule->week = 0;
+            rule->month = 0;
+        }
+        p = next;
+    }
+
+    // Time of day defaults to 02:00:00 local
+    rule->seconds = 2 * 3600;
+    if (*p == '/') {
+        long seconds;
+        const char* afterTime = parseOffset(p + 1, &seconds);
+        if (afterTime) {
+            rule->seconds = seconds;
+            p = afterTime;
+        }
+    }
+    return p;
+}
+
+int64_t TimezoneRules::daysFromCivil(int year, int month, int day) {
+    // Days since 1970-01-01 in the proleptic Gregorian calendar
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool TimezoneRules::isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
@@ -0,0 +1,134 @@
+#include "tls_arbiter.h"
+
+// Free heap a handshake needs: mbedTLS record buffers, key exchange and
+// certificate chain peak at about 40 KB on the ESP32-C3
+static const size_t MIN_FREE_HEAP = 48 * 1024;
+// The 16 KB input record buffer is one allocation
+static const size_t MIN_LARGEST_BLOCK = 20 * 1024;
+// A handshake not ended after this long was abandoned by its owner; the
+// longest configured handshake and HTTP timeouts are 30 seconds
+static const unsigned long HANDSHAKE_TIMEOUT_MS = 35000;
+
+TlsArbiter tlsArbiter;
+
+TlsArbiter::TlsArbiter() :
+    sessionCount(0),
+    handshakeOwner(nullptr),
+    handshakeStart(0),
+    freeBefore(0),
+    minFreeBefore(0),
+    peakHeap(0),
+    lastHandshakeHeap(0),
+    handshakes(0),
+    failed(0),
+    reused(0),
+    refusedBusy(0),
+    refusedHeap(0) {
+}
+
+bool TlsArbiter::beginHandshake(const char* owner) {
+    if (handshakeOwner && strcmp(handshakeOwner, owner) != 0) {
+        if (millis() - handshakeStart < HANDSHAKE_TIMEOUT_MS) {
+            refusedBusy++;
+            Serial.printf("TLS handshake for %s deferred, %s is handshaking\n", owner, handshakeOwner);
+            return false;
+        }
+        Serial.printf("TLS handshake of %s was never ended, releasing it\n", handshakeOwner);
+        failed++;
+        releaseHandshake();
+    }
+
+    size_t freeHeap = ESP.getFreeHeap();
+    size_t largestBlock = ESP.getMaxAllocHeap();
+    if (freeHeap < MIN_FREE_HEAP || largestBlock < MIN_LARGEST_BLOCK) {
+        refusedHeap++;
+        Serial.printf("TLS handshake for %s refused: %u bytes free, largest block %u, %d sessions open\n",
+                      owner, (unsigned)freeHeap, (unsigned)largestBlock, sessionCount);
+        return false;
+    }
+
+    handshakeOwner = owner;
+    handshakeStart = millis();
+    freeBefore = freeHeap;
+    minFreeBefore = ESP.getMinFreeHeap();
+    handshakes++;
+    return true;
+}
+
+void TlsArbiter::endHandshake(const char* owner, bool connected) {
+    if (!handshakeOwner || strcmp(handshakeOwner, owner) != 0) {
+        return;
+    }
+
+    // The heap low-water mark only moves when the handshake set a new low;
+    // otherwise what the session still holds is the best estimate
+    size_t freeNow = ESP.getFreeHeap();
+    size_t lowest = freeNow;
+    size_t minFree = ESP.getMinFreeHeap();
+    if (minFree < minFreeBefore && minFree < lowest) {
+        lowest = minFree;
+    }
+    lastHandshakeHeap = freeBefore > lowest ? freeBefore - lowest : 0;
+    size_t held = freeBefore > freeNow ? freeBefore - freeNow : 0;
+
+    size_t total = sessionHeap() + lastHandshakeHeap;
+    if (total > peakHeap) {
+        peakHeap = total;
+    }
+
+    releaseHandshake();
+    if (connected) {
+        // A reconnect replaces the owner's old session
+        endSession(owner);
+        if (sessionCount < MAX_SESSIONS) {
+            sessions[sessionCount].owner = owner;
+            sessions[sessionCount].heap = held;
+            sessionCount++;
+        }
+    } else {
+        failed++;
+    }
+
+    Serial.printf("TLS handshake for %s %s after %lu ms: %u bytes peak, %u held\n", owner,
+                  connected ? "done" : "failed", millis() - handshakeStart,
+                  (unsigned)lastHandshakeHeap, (unsigned)(connected ? held : 0));
+}
+
+void TlsArbiter::endSession(const char* owner) {
+    if (handshakeOwner && strcmp(handshakeOwner, owner) == 0) {
+        failed++;
+        releaseHandshake();
+    }
+
+    for (int i = 0; i < sessionCount; i++) {
+        if (strcmp(sessions[i].owner, owner) == 0) {
+            sessions[i] = sessions[--sessionCount];
+            return;
+        }
+    }
+}
+
+void TlsArbiter::writeStatusJSON(JsonWriter& json) {
+    json.add("open", sessionCount);
+    json.add("handshaking", handshakeOwner ? handshakeOwner : "");
+    json.add("heap_in_use", (unsigned long)sessionHeap());
+    json.add("peak_heap", (unsigned long)peakHeap);
+    json.add("last_handshake_heap", (unsigned long)lastHandshakeHeap);
+    json.add("handshakes", (unsigned long)handshakes);
+    json.add("failed", (unsigned long)failed);
+    json.add("reused", (unsigned long)reused);
+    json.add("refused_busy", (unsigned long)refusedBusy);
+    json.add("refused_heap", (unsigned long)refusedHeap);
+}
+
+size_t TlsArbiter::sessionHeap() const {
+    size_t total = 0;
+    for (int i = 0; i < sessionCount; i++) {
+        total += sessions[i].heap;
+    }
+    return total;
+}
+
+void TlsArbiter::releaseHandshake() {
+    handshakeOwner = nullptr;
+}
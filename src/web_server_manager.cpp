@@ -5,12 +5,106 @@
 #include "time_manager.h"
 #include "birthday_manager.h"
 #include "cloud_manager.h"
+#include "local_mqtt_manager.h"
+#include "timezone_database.h"
 #include "config.h"
 #include "web/web_assets.h"
+#include "settings_store.h"
+#include "retry_backoff.h"
+#include "tls_arbiter.h"
 #include <WiFi.h>
+#include <mbedtls/base64.h>
+
+// Versioned CSS/JS (?v=<hash>) never change; pages are revalidated via ETag
+static const char* CACHE_CONTROL_IMMUTABLE = "public, max-age=31536000, immutable";
+static const char* CACHE_CONTROL_REVALIDATE = "no-cache";
+
+// Time for the last response to leave before restarting
+static const unsigned long RESTART_GRACE_MS = 100;
+
+// How often state is compared against what subscribers last got
+static const unsigned long EVENT_CHECK_INTERVAL_MS = 100;
+// Stack buffer for one event; the largest is the dev status, and with the
+// event name it has to fit the HTTP server's response buffer
+static const size_t EVENT_BUFFER_SIZE = 960;
+
+// LED mirror frames go only to streams that asked for them
+static const uint8_t EVENT_CHANNEL_FRAMES = 0x02;
+// At most 5 frames per second, and only when something changed
+static const unsigned long FRAME_INTERVAL_MS = 200;
+// Base64 frame plus quotes, has to fit a stream's response buffer
+static const size_t FRAME_EVENT_SIZE = 768;
+
+// Stack buffer for JSON responses: small replies go out in one piece,
+// larger ones are streamed as HTTP chunks of this size
+static const size_t JSON_CHUNK_SIZE = 768;
+
+namespace {
+struct JsonStreamState {
+    HttpServer* server;
+    int code;
+    bool streaming;
+};
+
+void restartDevice() {
+    delay(RESTART_GRACE_MS); // Let lwIP put the queued response on the air
+    ESP.restart();
+}
+
+void flushJsonChunk(void* context, const char* data, size_t length) {
+    JsonStreamState* stream = static_cast<JsonStreamState*>(context);
+    if (!stream->streaming) {
+        stream->server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+        stream->server->send(stream->code, "application/json", "");
+        stream->streaming = true;
+    }
+    stream->server->sendContent(data, length);
+}
+}
+
+template <typename BodyWriter>
+void WebServerManager::sendJSON(int code, BodyWriter writeBody) {
+    char buffer[JSON_CHUNK_SIZE];
+    JsonStreamState stream = {&server, code, false};
+    JsonWriter json(buffer, sizeof(buffer), flushJsonChunk, &stream);
+    
+    writeBody(json);
+    
+    if (stream.streaming) {
+        json.flush();
+        server.sendContent(""); // Terminate chunked response
+    } else {
+        // Copied: the buffer is gone once the handler returns
+        server.send(code, "application/json", json.c_str(), json.length());
+    }
+}
+
+template <typename BodyWriter>
+void WebServerManager::publishIfChanged(EventTopic topic, const char* event, BodyWriter writeBody) {
+    char buffer[EVENT_BUFFER_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeBody(json);
+    if (json.hasOverflowed()) {
+        Serial.printf("Event %s does not fit into %u bytes\n", event, (unsigned)sizeof(buffer));
+        return;
+    }
+
+    // FNV-1a over the serialized state - unchanged state is not sent again
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < json.length(); i++) {
+        hash = (hash ^ (uint8_t)buffer[i]) * 16777619UL;
+    }
+    if (hash == eventHashes[topic]) {
+        return;
+    }
+    eventHashes[topic] = hash;
+    server.sendEvent(event, json.c_str(), json.length());
+}
 
 WebServerManager::WebServerManager(int port) : server(port), wifiManagerHelper(nullptr), autoUpdater(nullptr), ledController(nullptr), timeManager(nullptr),
-    birthdayManager(nullptr), cloudManager(nullptr), debugModeEnabled(nullptr), debugHour(nullptr), debugMinute(nullptr) {
+    birthdayManager(nullptr), cloudManager(nullptr), localMqttManager(nullptr), debugModeEnabled(nullptr), debugHour(nullptr), debugMinute(nullptr), lastEventCheck(0),
+    lastFramePublish(0) {
+    memset(eventHashes, 0, sizeof(eventHashes));
 }
 
 void WebServerManager::begin(WiFiManagerHelper* wifiHelper, AutoUpdater* updater, LEDController* ledCtrl, TimeManager* timeMgr,
@@ -33,22 +127,109 @@ void WebServerManager::begin(WiFiManagerHelper* wifiHelper, AutoUpdater* updater
 
 void WebServerManager::handleClient() {
     server.handleClient();
+    publishStateEvents();
+    publishFrame();
+}
+
+void WebServerManager::publishUpdateProgress(UpdateStage stage, size_t written, size_t total) {
+    char buffer[EVENT_BUFFER_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    switch (stage) {
+        case UpdateStage::DOWNLOADING: json.add("stage", "downloading"); break;
+        case UpdateStage::INSTALLED: json.add("stage", "installed"); break;
+        case UpdateStage::FAILED: json.add("stage", "failed"); break;
+    }
+    json.add("written", (unsigned long)written);
+    json.add("total", (unsigned long)total);
+    json.add("percent", total > 0 ? (int)((uint64_t)written * 100 / total) : 0);
+    json.endObject();
+
+    server.sendEvent("update_progress", json.c_str(), json.length());
+    server.flushEventStreams();
+}
+
+void WebServerManager::handleEvents() {
+    uint8_t channels = HttpServer::EVENT_CHANNEL_DEFAULT;
+    if (server.hasArg("frames")) {
+        channels |= EVENT_CHANNEL_FRAMES;
+        frameEncoder.reset(); // Viewers joining need a keyframe
+    }
+    server.beginEventStream(channels);
+
+    // New subscriber needs the full state: resend every topic once
+    memset(eventHashes, 0, sizeof(eventHashes));
+    lastEventCheck = 0;
+}
+
+void WebServerManager::publishStateEvents() {
+    if (server.getEventStreamCount() == 0 || millis() - lastEventCheck < EVENT_CHECK_INTERVAL_MS) {
+        return;
+    }
+    lastEventCheck = millis();
+
+    if (ledController) {
+        publishIfChanged(EVENT_LED, "led", [this](JsonWriter& json) { writeLEDStatusJSON(json); });
+    }
+    if (timeManager) {
+        publishIfChanged(EVENT_TIME, "time", [this](JsonWriter& json) { timeManager->writeClockJSON(json); });
+    }
+    publishIfChanged(EVENT_DEV, "dev", [this](JsonWriter& json) { writeDevStatusJSON(json); });
+    if (cloudManager) {
+        publishIfChanged(EVENT_CLOUD, "cloud", [this](JsonWriter& json) { cloudManager->writeStatusJSON(json); });
+    }
+    if (autoUpdater) {
+        publishIfChanged(EVENT_UPDATE, "update", [this](JsonWriter& json) {
+            json.beginObject();
+            json.add("current_version", CURRENT_VERSION);
+            json.add("latest_version", autoUpdater->getLatestVersion());
+            json.add("update_available", autoUpdater->isUpdateAvailable());
+            json.beginObject("check");
+            autoUpdater->writeStatusJSON(json);
+            json.endObject();
+            json.endObject();
+        });
+    }
+}
+
+void WebServerManager::publishFrame() {
+    if (!ledController || server.getEventStreamCount(EVENT_CHANNEL_FRAMES) == 0 ||
+        millis() - lastFramePublish < FRAME_INTERVAL_MS) {
+        return;
+    }
+    lastFramePublish = millis();
+
+    size_t length = frameEncoder.encodeNext(ledController->getFrameBuffer(), ledController->getNumLeds());
+    if (length == 0) {
+        return;
+    }
+
+    // Sent as a JSON string so the page parses every event the same way
+    char event[FRAME_EVENT_SIZE];
+    size_t encoded = 0;
+    if ((length + 2) / 3 * 4 + 3 > sizeof(event) ||
+        mbedtls_base64_encode((unsigned char*)event + 1, sizeof(event) - 2, &encoded,
+                              frameEncoder.getData(), length) != 0) {
+        // Too many LEDs for one event: retry with a fresh keyframe, which may be palette sized
+        frameEncoder.reset();
+        return;
+    }
+    event[0] = '"';
+    event[encoded + 1] = '"';
+    server.sendEvent("frame", event, encoded + 2, EVENT_CHANNEL_FRAMES);
 }
 
 void WebServerManager::setupRoutes() {
-    // Static asset routes
-    server.on("/css/common.css", [this]() {
-        server.send_P(200, "text/css", (const char*)common_css_start, ASSET_SIZE(common_css));
-    });
-    server.on("/css/dark.css", [this]() {
-        server.send_P(200, "text/css", (const char*)dark_css_start, ASSET_SIZE(dark_css));
-    });
-    server.on("/js/api.js", [this]() {
-        server.send_P(200, "application/javascript", (const char*)api_js_start, ASSET_SIZE(api_js));
-    });
-    server.on("/js/utils.js", [this]() {
-        server.send_P(200, "application/javascript", (const char*)utils_js_start, ASSET_SIZE(utils_js));
-    });
+    // Static asset routes (pages are served by their own handlers)
+    for (size_t i = 0; i < WEB_ASSET_COUNT; i++) {
+        const WebAsset* asset = &WEB_ASSETS[i];
+        if (asset->immutable) {
+            server.on(String("/") + asset->path, [this, asset]() { sendAsset(asset); });
+        }
+    }
+
+    // Server-Sent Events push channel for the pages
+    server.on("/events", HTTP_GET, [this]() { handleEvents(); });
 
     // Root page with status information
     server.on("/", [this]() { handleRoot(); });
@@ -71,6 +252,7 @@ void WebServerManager::setupRoutes() {
     server.on("/time/sync", HTTP_POST, [this]() { handleTimeSync(); });
     server.on("/time/timezone", HTTP_POST, [this]() { handleSetTimezone(); });
     server.on("/time/ntp", HTTP_POST, [this]() { handleSetNTP(); });
+    server.on("/time/zones", [this]() { handleTimeZones(); });
     
     // LED configuration endpoints
     server.on("/led", [this]() { handleLEDConfig(); });
@@ -80,6 +262,9 @@ void WebServerManager::setupRoutes() {
     server.on("/led/mapping", [this]() { handleLEDMapping(); });
     server.on("/led/mapping/set", HTTP_POST, [this]() { handleSetLEDMapping(); });
     server.on("/led/rotation/set", HTTP_POST, [this]() { handleSetRotation(); });
+    server.on("/led/frame", HTTP_GET, [this]() { handleLEDFrame(); });
+    server.on("/led/frame", HTTP_POST, [this]() { handleLEDFramePost(); });
+    server.on("/led/layout", HTTP_GET, [this]() { handleLEDLayout(); });
     
     // ENHANCED: Add color configuration support
     server.on("/led/config", HTTP_POST, [this]() { 
@@ -93,7 +278,6 @@ void WebServerManager::setupRoutes() {
             int brightness = server.arg("brightness").toInt();
             if (brightness >= 0 && brightness <= 255) {
                 ledController->setBrightness(brightness);
-                ledController->saveSettings();
             }
         }
         
@@ -101,7 +285,6 @@ void WebServerManager::setupRoutes() {
             int speed = server.arg("speed").toInt();
             if (speed >= 0 && speed <= 255) {
                 ledController->setSpeed(speed);
-                ledController->saveSettings();
             }
         }
         
@@ -123,7 +306,6 @@ void WebServerManager::setupRoutes() {
             if (r >= 0 && r <= 255 && g >= 0 && g <= 255 && b >= 0 && b <= 255) {
                 CRGB color = CRGB(r, g, b);
                 ledController->setSolidColor(color);
-                ledController->saveSettings();
                 Serial.printf("Color changed to RGB(%d, %d, %d)\n", r, g, b);
             } else {
                 Serial.printf("DEBUG: Invalid color values - R:%d, G:%d, B:%d\n", r, g, b);
@@ -135,10 +317,8 @@ void WebServerManager::setupRoutes() {
             if (server.hasArg("color_b")) Serial.printf("DEBUG: Has color_b: %s\n", server.arg("color_b").c_str());
         }
         
-        // Save settings after any change
-        if (server.hasArg("save")) {
-            ledController->saveSettings();
-        }
+        // One save for all changes; the store commits them together once the slider drag settles
+        ledController->saveSettings();
 
         server.send(200, "text/plain", "LED settings updated");
     });
@@ -164,26 +344,58 @@ void WebServerManager::setupRoutes() {
     server.on("/cloud/pair/start", HTTP_POST, [this]() { handleCloudPairStart(); });
     server.on("/cloud/pair/stop", HTTP_POST, [this]() { handleCloudPairStop(); });
     server.on("/cloud/disconnect", HTTP_POST, [this]() { handleCloudDisconnect(); });
+    server.on("/lan/status", [this]() { handleLocalMqttStatus(); });
+    server.on("/lan/config", HTTP_POST, [this]() { handleLocalMqttConfig(); });
+}
+
+void WebServerManager::sendAsset(const char* path) {
+    for (size_t i = 0; i < WEB_ASSET_COUNT; i++) {
+        if (strcmp(WEB_ASSETS[i].path, path) == 0) {
+            sendAsset(&WEB_ASSETS[i]);
+            return;
+        }
+    }
+    Serial.printf("Web asset missing: %s\n", path);
+    server.send(404, "text/plain", "Not found");
+}
+
+void WebServerManager::sendAsset(const WebAsset* asset) {
+    server.sendHeader("ETag", asset->etag);
+    server.sendHeader("Cache-Control", asset->immutable ? CACHE_CONTROL_IMMUTABLE : CACHE_CONTROL_REVALIDATE);
+    
+    // Browser already has this exact content
+    if (server.header("If-None-Match") == asset->etag) {
+        server.send(304);
+        return;
+    }
+    
+    // Only the compressed bytes are in flash - every browser accepts gzip
+    server.sendHeader("Content-Encoding", "gzip");
+    server.send_P(200, asset->contentType, (const char*)asset->data, asset->length);
 }
 
 void WebServerManager::handleRoot() {
-    server.send_P(200, "text/html", (const char*)index_html_start, ASSET_SIZE(index_html));
+    sendAsset("pages/index.html");
 }
 
 void WebServerManager::handleStatus() {
-    server.send(200, "application/json", getStatusJSON());
+    sendJSON(200, [this](JsonWriter& json) { writeStatusJSON(json); });
 }
 
 void WebServerManager::handleCheckUpdate() {
     if (autoUpdater) {
         autoUpdater->checkForUpdates();
-        String json = "{";
-        json += "\"current_version\":\"" + String(CURRENT_VERSION) + "\",";
-        json += "\"latest_version\":\"" + autoUpdater->getLatestVersion() + "\",";
-        json += "\"update_available\":" + String(autoUpdater->isUpdateAvailable() ? "true" : "false") + ",";
-        json += "\"download_url\":\"" + autoUpdater->getDownloadUrl() + "\"";
-        json += "}";
-        server.send(200, "application/json", json);
+        sendJSON(200, [this](JsonWriter& json) {
+            json.beginObject();
+            json.add("current_version", CURRENT_VERSION);
+            json.add("latest_version", autoUpdater->getLatestVersion());
+            json.add("update_available", autoUpdater->isUpdateAvailable());
+            json.add("download_url", autoUpdater->getDownloadUrl());
+            json.beginObject("check");
+            autoUpdater->writeStatusJSON(json);
+            json.endObject();
+            json.endObject();
+        });
     } else {
         server.send(500, "application/json", "{\"error\":\"Auto updater not available\"}");
     }
@@ -192,8 +404,7 @@ void WebServerManager::handleCheckUpdate() {
 void WebServerManager::handleManualUpdate() {
     if (autoUpdater && autoUpdater->isUpdateAvailable()) {
         server.send(200, "text/plain", "Starting update...");
-        delay(1000);
-        autoUpdater->performUpdate();
+        server.afterResponse([this]() { autoUpdater->performUpdate(); });
     } else {
         server.send(400, "text/plain", "No update available");
     }
@@ -202,60 +413,78 @@ void WebServerManager::handleManualUpdate() {
 void WebServerManager::handleWiFiReset() {
     if (wifiManagerHelper) {
         server.send(200, "text/plain", "WiFi settings cleared. Device will restart and enter configuration mode.");
-        delay(1000);
-        wifiManagerHelper->resetWiFi();
+        server.afterResponse([this]() { wifiManagerHelper->resetWiFi(); });
     } else {
         server.send(500, "text/plain", "WiFi manager not available");
     }
 }
 
-String WebServerManager::getStatusJSON() {
-    String json = "{";
-    json += "\"hostname\":\"" + String(OTA_HOSTNAME) + "\",";
-    json += "\"ip\":\"" + WiFi.localIP().toString() + "\",";
-    json += "\"ssid\":\"" + WiFi.SSID() + "\",";
-    json += "\"rssi\":" + String(WiFi.RSSI()) + ",";
-    json += "\"uptime\":" + String(millis()) + ",";
-    json += "\"free_heap\":" + String(ESP.getFreeHeap()) + ",";
-    json += "\"chip_model\":\"" + String(ESP.getChipModel()) + "\",";
-    json += "\"sdk_version\":\"" + String(ESP.getSdkVersion()) + "\",";
-    json += "\"current_version\":\"" + String(CURRENT_VERSION) + "\",";
+void WebServerManager::writeStatusJSON(JsonWriter& json) {
+    json.beginObject();
+    json.add("hostname", OTA_HOSTNAME);
+    json.add("ip", WiFi.localIP().toString());
+    json.add("ssid", WiFi.SSID());
+    json.add("rssi", WiFi.RSSI());
+    json.add("uptime", millis());
+    json.add("free_heap", ESP.getFreeHeap());
+    json.add("chip_model", ESP.getChipModel());
+    json.add("sdk_version", ESP.getSdkVersion());
+    json.add("current_version", CURRENT_VERSION);
     
     if (autoUpdater) {
-        json += "\"latest_version\":\"" + autoUpdater->getLatestVersion() + "\",";
-        json += "\"update_available\":" + String(autoUpdater->isUpdateAvailable() ? "true" : "false");
+        json.add("latest_version", autoUpdater->getLatestVersion());
+        json.add("update_available", autoUpdater->isUpdateAvailable());
     } else {
-        json += "\"latest_version\":\"\",";
-        json += "\"update_available\":false";
+        json.add("latest_version", "");
+        json.add("update_available", false);
     }
     
-    json += "}";
-    return json;
+    json.endObject();
 }
 
 // Time configuration handlers
 void WebServerManager::handleTimeConfig() {
-    server.send_P(200, "text/html", (const char*)time_html_start, ASSET_SIZE(time_html));
+    sendAsset("pages/time.html");
 }
 
 void WebServerManager::handleTimeStatus() {
     if (timeManager) {
-        server.send(200, "application/json", timeManager->getStatusJSON());
+        sendJSON(200, [this](JsonWriter& json) { timeManager->writeStatusJSON(json); });
     } else {
         server.send(500, "application/json", "{\"error\":\"Time manager not available\"}");
     }
 }
 
+void WebServerManager::handleTimeZones() {
+    // The whole IANA table goes out in chunks instead of one big String
+    sendJSON(200, [](JsonWriter& json) {
+        char name[64];
+        json.beginObject();
+        json.add("version", TimezoneDatabase::getVersion());
+        json.beginArray("zones");
+        for (int i = 0; i < TimezoneDatabase::count(); i++) {
+            TimezoneDatabase::getName(i, name, sizeof(name));
+            json.beginObject();
+            json.add("name", name);
+            json.add("posix", TimezoneDatabase::getRule(i));
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    });
+}
+
 void WebServerManager::handleTimeSync() {
     if (!timeManager) {
         server.send(500, "text/plain", "Time manager not available");
         return;
     }
     
+    // Sync completes in the background; poll /time/status for the result
     if (timeManager->syncTime()) {
-        server.send(200, "text/plain", "Time synchronized successfully");
+        server.send(200, "text/plain", "Time sync started");
     } else {
-        server.send(500, "text/plain", "Failed to synchronize time");
+        server.send(500, "text/plain", "Failed to start time sync (WiFi not connected)");
     }
 }
 
@@ -302,21 +531,13 @@ void WebServerManager::handleSetNTP() {
     }
 }
 
-String WebServerManager::getTimeStatusJSON() {
-    if (timeManager) {
-        return timeManager->getStatusJSON();
-    } else {
-        return "{\"error\":\"Time manager not available\"}";
-    }
-}
-
 // ENHANCED LED configuration handlers
 void WebServerManager::handleLEDStatus() {
-    server.send(200, "application/json", getLEDStatusJSON());
+    sendJSON(200, [this](JsonWriter& json) { writeLEDStatusJSON(json); });
 }
 
 void WebServerManager::handleLEDConfig() {
-    server.send_P(200, "text/html", (const char*)led_html_start, ASSET_SIZE(led_html));
+    sendAsset("pages/led.html");
 }
 
 void WebServerManager::handleLEDTest() {
@@ -361,42 +582,108 @@ void WebServerManager::handleLEDPattern() {
     server.send(200, "text/plain", "Pattern set to " + action);
 }
 
-String WebServerManager::getLEDStatusJSON() {
-    String json = "{";
+void WebServerManager::writeLEDStatusJSON(JsonWriter& json) {
+    json.beginObject();
 
     if (ledController) {
-        json += "\"num_leds\":" + String(ledController->getNumLeds()) + ",";
-        json += "\"brightness\":" + String(ledController->getBrightness()) + ",";
-        json += "\"speed\":" + String(ledController->getSpeed()) + ",";
-        json += "\"data_pin\":" + String(ledController->getDataPin()) + ",";
+        json.add("num_leds", ledController->getNumLeds());
+        json.add("brightness", ledController->getBrightness());
+        json.add("speed", ledController->getSpeed());
+        json.add("data_pin", ledController->getDataPin());
 
         // Add mapping type and rotation
         LEDMappingManager* mappingManager = ledController->getMappingManager();
         if (mappingManager) {
-            json += "\"mapping_type\":" + String((int)mappingManager->getCurrentMappingType()) + ",";
-            json += "\"rotation\":" + String(mappingManager->getRotationDegrees()) + ",";
+            json.add("mapping_type", (int)mappingManager->getCurrentMappingType());
+            json.add("rotation", mappingManager->getRotationDegrees());
         }
 
         CRGB color = ledController->getSolidColor();
-        json += "\"color\":{";
-        json += "\"r\":" + String(color.r) + ",";
-        json += "\"g\":" + String(color.g) + ",";
-        json += "\"b\":" + String(color.b);
-        json += "},";
-
-        int pattern = (int)ledController->getCurrentPattern();
-        json += "\"pattern\":" + String(pattern);
+        json.beginObject("color");
+        json.add("r", color.r);
+        json.add("g", color.g);
+        json.add("b", color.b);
+        json.endObject();
+
+        json.add("pattern", (int)ledController->getCurrentPattern());
+
+        // Set calls folded into a later one before reaching the LEDs
+        uint32_t requests = ledController->getBrightnessRequests() + ledController->getColorRequests();
+        uint32_t applied = ledController->getBrightnessApplied() + ledController->getColorApplied();
+        json.beginObject("input");
+        json.add("brightness_requests", (unsigned long)ledController->getBrightnessRequests());
+        json.add("brightness_applied", (unsigned long)ledController->getBrightnessApplied());
+        json.add("color_requests", (unsigned long)ledController->getColorRequests());
+        json.add("color_applied", (unsigned long)ledController->getColorApplied());
+        json.add("coalesced", (unsigned long)(requests - applied));
+        json.add("scene_frames", (unsigned long)ledController->getSceneFrames());
+        json.add("scene_rejected", (unsigned long)ledController->getSceneRejected());
+        json.add("latency_us", (unsigned long)ledController->getLastInputLatencyUs());
+        json.add("latency_max_us", (unsigned long)ledController->getMaxInputLatencyUs());
+        json.endObject();
     } else {
-        json += "\"error\":\"LED controller not available\"";
+        json.add("error", "LED controller not available");
     }
     
-    json += "}";
-    return json;
+    json.endObject();
 }
 
 // LED mapping handlers
 void WebServerManager::handleLEDMapping() {
-    server.send_P(200, "text/html", (const char*)led_mapping_html_start, ASSET_SIZE(led_mapping_html));
+    sendAsset("pages/led-mapping.html");
+}
+
+void WebServerManager::handleLEDFrame() {
+    if (!ledController) {
+        server.send(500, "text/plain", "LED controller not available");
+        return;
+    }
+
+    // KEY_RGB frame read straight from the frame buffer, a few pixels at a time
+    const CRGB* leds = ledController->getFrameBuffer();
+    int count = ledController->getNumLeds();
+    uint8_t chunk[96];
+    chunk[0] = LEDFrameEncoder::KEY_RGB;
+    chunk[1] = count & 0xFF;
+    chunk[2] = count >> 8;
+    size_t used = LEDFrameEncoder::HEADER_SIZE;
+
+    server.sendHeader("Cache-Control", "no-store");
+    server.setContentLength(LEDFrameEncoder::maxEncodedSize(count));
+    server.send(200, "application/octet-stream", "");
+    for (int i = 0; i < count; i++) {
+        CRGB pixel = leds[i];
+        chunk[used++] = pixel.r;
+        chunk[used++] = pixel.g;
+        chunk[used++] = pixel.b;
+        if (used + 3 > sizeof(chunk)) {
+            server.sendContent((const char*)chunk, used);
+            used = 0;
+        }
+    }
+    server.sendContent((const char*)chunk, used);
+}
+
+void WebServerManager::handleLEDFramePost() {
+    if (!ledController) {
+        server.send(500, "text/plain", "LED controller not available");
+        return;
+    }
+
+    // Binary LEDFrameDecoder frame as the request body
+    if (!ledController->showScene(server.body(), server.bodyLength())) {
+        server.send(400, "text/plain", "Invalid frame");
+        return;
+    }
+    server.send(200, "text/plain", "Scene shown");
+}
+
+void WebServerManager::handleLEDLayout() {
+    if (!ledController) {
+        server.send(500, "text/plain", "LED controller not available");
+        return;
+    }
+    sendJSON(200, [this](JsonWriter& json) { ledController->getMappingManager()->writeLayoutJSON(json); });
 }
 
 void WebServerManager::handleSetLEDMapping() {
@@ -462,11 +749,11 @@ void WebServerManager::handleSetRotation() {
 
 // Debug mode handlers
 void WebServerManager::handleDevPage() {
-    server.send_P(200, "text/html", (const char*)dev_html_start, ASSET_SIZE(dev_html));
+    sendAsset("pages/dev.html");
 }
 
 void WebServerManager::handleDevStatus() {
-    server.send(200, "application/json", getDevStatusJSON());
+    sendJSON(200, [this](JsonWriter& json) { writeDevStatusJSON(json); });
 }
 
 void WebServerManager::handleDevSet() {
@@ -506,36 +793,16 @@ void WebServerManager::handleDevToggle() {
 void WebServerManager::handleReboot() {
     Serial.println("Reboot requested via web interface");
     server.send(200, "text/plain", "Rebooting...");
-    delay(500);
-    ESP.restart();
+    server.afterResponse(restartDevice);
 }
 
 void WebServerManager::handleFactoryReset() {
     Serial.println("Factory reset requested via web interface");
 
-    // Clear all preference namespaces
-    Preferences prefs;
-
-    prefs.begin("led_mapping", false);
-    prefs.clear();
-    prefs.end();
-
-    prefs.begin("led_config", false);
-    prefs.clear();
-    prefs.end();
-
-    prefs.begin("time_manager", false);
-    prefs.clear();
-    prefs.end();
-
-    prefs.begin("qlockthree", false);
-    prefs.clear();
-    prefs.end();
-
-    prefs.begin("birthdays", false);
-    prefs.clear();
-    prefs.end();
+    // Clear all stored settings
+    settingsStore.clear();
 
+    Preferences prefs;
     prefs.begin("cloud", false);
     prefs.clear();
     prefs.end();
@@ -545,32 +812,43 @@ void WebServerManager::handleFactoryReset() {
 
     Serial.println("All settings cleared (including cloud and WiFi)");
     server.send(200, "text/plain", "Factory reset complete. Rebooting...");
-    delay(500);
-    ESP.restart();
+    server.afterResponse(restartDevice);
 }
 
-String WebServerManager::getDevStatusJSON() {
-    String json = "{";
-    json += "\"enabled\":" + String(debugModeEnabled && *debugModeEnabled ? "true" : "false") + ",";
-    json += "\"hour\":" + String(debugHour ? *debugHour : 0) + ",";
-    json += "\"minute\":" + String(debugMinute ? *debugMinute : 0) + ",";
+void WebServerManager::writeDevStatusJSON(JsonWriter& json) {
+    json.beginObject();
+    json.add("enabled", debugModeEnabled && *debugModeEnabled);
+    json.add("hour", debugHour ? *debugHour : 0);
+    json.add("minute", debugMinute ? *debugMinute : 0);
 
     // Get real time
     if (timeManager) {
         struct tm currentTime = timeManager->getCurrentTime();
-        json += "\"realHour\":" + String(currentTime.tm_hour) + ",";
-        json += "\"realMinute\":" + String(currentTime.tm_min);
+        json.add("realHour", currentTime.tm_hour);
+        json.add("realMinute", currentTime.tm_min);
     } else {
-        json += "\"realHour\":0,\"realMinute\":0";
+        json.add("realHour", 0);
+        json.add("realMinute", 0);
     }
 
-    json += "}";
-    return json;
+    json.beginObject("settings");
+    settingsStore.writeStatusJSON(json);
+    json.endObject();
+
+    json.beginObject("retries");
+    RetryBackoff::writeAllJSON(json);
+    json.endObject();
+
+    json.beginObject("tls");
+    tlsArbiter.writeStatusJSON(json);
+    json.endObject();
+
+    json.endObject();
 }
 
 // Birthday handlers
 void WebServerManager::handleBirthdayPage() {
-    server.send_P(200, "text/html", (const char*)birthdays_html_start, ASSET_SIZE(birthdays_html));
+    sendAsset("pages/birthdays.html");
 }
 
 void WebServerManager::handleBirthdayList() {
@@ -578,7 +856,7 @@ void WebServerManager::handleBirthdayList() {
         server.send(500, "application/json", "{\"error\":\"Birthday manager not available\"}");
         return;
     }
-    server.send(200, "application/json", birthdayManager->getBirthdaysJSON());
+    sendJSON(200, [this](JsonWriter& json) { birthdayManager->writeBirthdaysJSON(json); });
 }
 
 void WebServerManager::handleBirthdayAdd() {
@@ -645,7 +923,7 @@ void WebServerManager::handleBirthdayMode() {
 
 // Cloud handlers
 void WebServerManager::handleCloudPage() {
-    server.send_P(200, "text/html", (const char*)cloud_html_start, ASSET_SIZE(cloud_html));
+    sendAsset("pages/cloud.html");
 }
 
 void WebServerManager::handleCloudStatus() {
@@ -653,7 +931,7 @@ void WebServerManager::handleCloudStatus() {
         server.send(500, "application/json", "{\"error\":\"Cloud manager not available\"}");
         return;
     }
-    server.send(200, "application/json", cloudManager->getStatusJSON());
+    sendJSON(200, [this](JsonWriter& json) { cloudManager->writeStatusJSON(json); });
 }
 
 void WebServerManager::handleCloudPairStart() {
@@ -686,12 +964,34 @@ void WebServerManager::handleCloudDisconnect() {
         return;
     }
 
-    cloudManager->disconnect();
+    cloudManager->clearCredentials();
+
+    server.send(200, "application/json", "{\"success\":true}");
+}
+
+// LAN MQTT handlers
+void WebServerManager::handleLocalMqttStatus() {
+    if (!localMqttManager) {
+        server.send(500, "application/json", "{\"error\":\"LAN MQTT not available\"}");
+        return;
+    }
+    sendJSON(200, [this](JsonWriter& json) { localMqttManager->writeStatusJSON(json); });
+}
 
-    // Clear cloud settings
-    CloudConfig config;
-    config.begin();
-    config.clear();
+void WebServerManager::handleLocalMqttConfig() {
+    if (!localMqttManager) {
+        server.send(500, "application/json", "{\"success\":false,\"error\":\"LAN MQTT not available\"}");
+        return;
+    }
 
+    // Port 0 selects the default for the transport
+    bool enabled = server.arg("enabled") == "true";
+    String host = server.arg("host");
+    if (enabled && host.length() == 0) {
+        server.send(400, "application/json", "{\"success\":false,\"error\":\"Broker host is required\"}");
+        return;
+    }
+    localMqttManager->configure(enabled, host, server.arg("port").toInt(), server.arg("tls") == "true",
+                                server.arg("username"), server.arg("password"));
     server.send(200, "application/json", "{\"success\":true}");
 }
@@ -1,5 +1,6 @@
 #include "wifi_manager_helper.h"
 #include "config.h"
+#include "settings_store.h"
 #include <ESPmDNS.h>
 #include "esp_heap_caps.h"
 #include "esp_system.h"
@@ -16,11 +17,6 @@ WiFiManagerHelper::WiFiManagerHelper() : configModeActive(false), wifiTimeout(30
         Serial.println("WARNING: Device recovered from crash/watchdog reset");
         Serial.printf("Reset reason: %d\n", resetReason);
         crashRecoveryMode = true;
-        
-        // Clear any potentially corrupted WiFi settings
-        preferences.begin("qlockthree", false);
-        preferences.remove("wifi_portal_params");
-        Serial.println("Cleared potentially corrupted WiFi portal parameters");
     } else {
         crashRecoveryMode = false;
     }
@@ -28,7 +24,6 @@ WiFiManagerHelper::WiFiManagerHelper() : configModeActive(false), wifiTimeout(30
 
 void WiFiManagerHelper::begin(const char* apSSID, const char* apPassword, unsigned long timeout) {
     wifiTimeout = timeout;
-    preferences.begin("qlockthree", false);
     
     // Print memory info for debugging
     printMemoryInfo("WiFiManager::begin");
@@ -42,8 +37,8 @@ void WiFiManagerHelper::begin(const char* apSSID, const char* apPassword, unsign
 }
 
 void WiFiManagerHelper::loadWiFiConfig() {
-    savedSSID = preferences.getString("wifi_ssid", "");
-    savedPassword = preferences.getString("wifi_password", "");
+    savedSSID = settingsStore.getString("wifi.ssid", "");
+    savedPassword = settingsStore.getString("wifi.password", "");
     
     Serial.println("Loaded WiFi config:");
     Serial.println("SSID: " + savedSSID);
@@ -51,8 +46,9 @@ void WiFiManagerHelper::loadWiFiConfig() {
 }
 
 void WiFiManagerHelper::saveWiFiConfig(String ssid, String password) {
-    preferences.putString("wifi_ssid", ssid);
-    preferences.putString("wifi_password", password);
+    settingsStore.setString("wifi.ssid", ssid);
+    settingsStore.setString("wifi.password", password);
+    settingsStore.flush(); // Credentials must survive an immediate restart
     savedSSID = ssid;
     savedPassword = password;
     Serial.println("WiFi config saved to NVS");
@@ -164,8 +160,8 @@ void WiFiManagerHelper::resetWiFi() {
     Serial.println("WiFi reset requested");
     
     // Clear saved WiFi credentials
-    preferences.remove("wifi_ssid");
-    preferences.remove("wifi_password");
+    settingsStore.remove("wifi.ssid");
+    settingsStore.remove("wifi.password");
     savedSSID = "";
     savedPassword = "";
     
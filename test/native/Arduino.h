@@ -0,0 +1,138 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Just enough of the Arduino core for the platform independent sources to
+// build and run on the host (pio test -e native). Serial goes to stdout;
+// millis() is a virtual clock that only tests move, so timing checks do not
+// depend on how fast or how loaded the host is.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+#define F(text) (text)
+
+class String {
+public:
+    String(const char* text = "") : text(text ? text : "") {}
+    String(const std::string& text) : text(text) {}
+    String(char c) : text(1, c) {}
+    String(int value) : text(std::to_string(value)) {}
+    String(unsigned int value) : text(std::to_string(value)) {}
+    String(long value) : text(std::to_string(value)) {}
+    String(unsigned long value) : text(std::to_string(value)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.length(); }
+    bool isEmpty() const { return text.empty(); }
+    void reserve(unsigned int size) { text.reserve(size); }
+    char operator[](unsigned int index) const { return index < text.length() ? text[index] : 0; }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    bool concat(const char* data, unsigned int length) { text.append(data, length); return true; }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == other; }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator!=(const char* other) const { return text != other; }
+    bool equalsIgnoreCase(const String& other) const { return strcasecmp(c_str(), other.c_str()) == 0; }
+    bool startsWith(const String& prefix) const { return text.compare(0, prefix.text.length(), prefix.text) == 0; }
+    bool endsWith(const String& suffix) const {
+        return text.length() >= suffix.text.length() &&
+               text.compare(text.length() - suffix.text.length(), suffix.text.length(), suffix.text) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return position(text.find(c, from)); }
+    int indexOf(const String& other, unsigned int from = 0) const { return position(text.find(other.text, from)); }
+    int lastIndexOf(char c) const { return position(text.rfind(c)); }
+    String substring(unsigned int from) const { return from < text.length() ? String(text.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < to && from < text.length() ? String(text.substr(from, to - from)) : String();
+    }
+    void trim() {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    }
+    long toInt() const { return atol(c_str()); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.text); }
+
+private:
+    std::string text;
+
+    static int position(size_t index) { return index == std::string::npos ? -1 : (int)index; }
+};
+
+class Print {
+public:
+    size_t print(const char* text) { return fputs(text, stdout) >= 0 ? strlen(text) : 0; }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text = "") { return print(text) + print("\n"); }
+    size_t println(const String& text) { return println(text.c_str()); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        va_list args;
+        va_start(args, format);
+        int length = vprintf(format, args);
+        va_end(args);
+        return length > 0 ? length : 0;
+    }
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long) {}
+};
+
+// One instance for every translation unit of a test program
+inline HardwareSerial Serial;
+
+// A heap that always has room, for the TLS arbiter's checks
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 200 * 1024; }
+    uint32_t getMinFreeHeap() { return 200 * 1024; }
+    uint32_t getMaxAllocHeap() { return 100 * 1024; }
+};
+
+inline EspClass ESP;
+
+// Starts at 0 like a fresh boot; atomic for tests that poll from a second thread
+inline std::atomic<int64_t>& nativeClockUs() {
+    static std::atomic<int64_t> now(0);
+    return now;
+}
+
+// Moves millis() and micros() forward without sleeping
+inline void advanceClock(unsigned long ms) {
+    nativeClockUs() += (int64_t)ms * 1000;
+}
+
+inline unsigned long millis() { return (unsigned long)(nativeClockUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)nativeClockUs(); }
+inline void delay(unsigned long ms) {
+    advanceClock(ms);
+    std::this_thread::yield();
+}
+inline void yield() {}
+
+inline long random(long max) { return max > 0 ? rand() % max : 0; }
+inline long random(long min, long max) { return max > min ? min + rand() % (max - min) : min; }
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,21 @@
+#ifndef NATIVE_FASTLED_H
+#define NATIVE_FASTLED_H
+
+// The FastLED pixel type, for the frame codecs that only read and write the
+// LED frame buffer
+
+#include <stdint.h>
+
+struct CRGB {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+
+    bool operator==(const CRGB& other) const { return r == other.r && g == other.g && b == other.b; }
+    bool operator!=(const CRGB& other) const { return !(*this == other); }
+};
+
+#endif // NATIVE_FASTLED_H
@@ -0,0 +1,100 @@
+#ifndef NATIVE_HTTP_CLIENT_H
+#define NATIVE_HTTP_CLIENT_H
+
+// An HTTPClient whose server is the test program: nativeHttpHandler()
+// answers every GET with a status, headers and a body, and the response
+// can drop the connection part way through the body
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <vector>
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_PARTIAL_CONTENT = 206,
+    HTTP_CODE_NOT_FOUND = 404
+} t_http_codes;
+
+typedef enum {
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+
+typedef std::vector<std::pair<String, String>> NativeHttpHeaders;
+
+inline String nativeHttpHeader(const NativeHttpHeaders& headers, const String& name) {
+    for (const auto& header : headers) {
+        if (header.first.equalsIgnoreCase(name)) {
+            return header.second;
+        }
+    }
+    return String();
+}
+
+struct NativeHttpRequest {
+    String url;
+    NativeHttpHeaders headers;
+
+    String header(const String& name) const { return nativeHttpHeader(headers, name); }
+};
+
+struct NativeHttpResponse {
+    int code = HTTPC_ERROR_CONNECTION_REFUSED;
+    NativeHttpHeaders headers;
+    std::string body;
+    size_t sent = SIZE_MAX;     // Body bytes that arrive before the connection drops
+};
+
+typedef std::function<void(const NativeHttpRequest& request, NativeHttpResponse& response)> NativeHttpHandler;
+
+// Without a handler every request is refused
+inline NativeHttpHandler& nativeHttpHandler() {
+    static NativeHttpHandler handler;
+    return handler;
+}
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient& client, const String& url) {
+        this->client = &client;
+        request = NativeHttpRequest();
+        request.url = url;
+        return true;
+    }
+    void end() {}
+
+    void setFollowRedirects(followRedirects_t) {}
+    void setUserAgent(const String&) {}
+    void setTimeout(uint16_t) {}
+    void useHTTP10(bool) {}
+    void addHeader(const String& name, const String& value) { request.headers.push_back({name, value}); }
+    void collectHeaders(const char* headerKeys[], size_t count) {}
+
+    int GET() {
+        response = NativeHttpResponse();
+        if (nativeHttpHandler()) {
+            nativeHttpHandler()(request, response);
+        }
+        if (response.code > 0) {
+            client->nativeReceive(response.body.substr(0, response.sent));
+        }
+        return response.code;
+    }
+
+    String header(const char* name) { return nativeHttpHeader(response.headers, name); }
+    int getSize() { return (int)response.body.size(); }
+    WiFiClient* getStreamPtr() { return client; }
+    String getString() { return String(response.body.substr(0, response.sent)); }
+    static String errorToString(int error) { return String("connection refused"); }
+
+private:
+    WiFiClient* client = nullptr;
+    NativeHttpRequest request;
+    NativeHttpResponse response;
+};
+
+#endif // NATIVE_HTTP_CLIENT_H
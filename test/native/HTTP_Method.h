@@ -0,0 +1,16 @@
+#ifndef NATIVE_HTTP_METHOD_H
+#define NATIVE_HTTP_METHOD_H
+
+// Method enum of the Arduino WebServer, which HttpServer keeps for its handlers
+typedef enum {
+    HTTP_DELETE = 0,
+    HTTP_GET = 1,
+    HTTP_HEAD = 2,
+    HTTP_POST = 3,
+    HTTP_PUT = 4,
+    HTTP_OPTIONS = 6,
+    HTTP_PATCH = 28,
+    HTTP_ANY = 255
+} HTTPMethod;
+
+#endif // NATIVE_HTTP_METHOD_H
@@ -0,0 +1,62 @@
+#ifndef NATIVE_UPDATE_H
+#define NATIVE_UPDATE_H
+
+// The OTA writer keeping the partition in memory: an image only counts as
+// installed once end() found it complete
+
+#include <Arduino.h>
+
+class UpdateClass {
+public:
+    bool begin(size_t size) {
+        if (running || size == 0 || size > partitionSize) {
+            error = running ? "already running" : "not enough space";
+            return false;
+        }
+        running = true;
+        expected = size;
+        written.clear();
+        error = nullptr;
+        return true;
+    }
+    size_t write(uint8_t* data, size_t length) {
+        if (!running || written.size() + length > expected) {
+            error = "write past the image size";
+            return 0;
+        }
+        written.append((const char*)data, length);
+        return length;
+    }
+    bool end() {
+        if (!running || written.size() != expected) {
+            error = "image incomplete";
+            return false;
+        }
+        running = false;
+        installed = written;
+        return true;
+    }
+    void abort() {
+        running = false;
+        aborts++;
+    }
+
+    bool isRunning() const { return running; }
+    bool hasError() const { return error != nullptr; }
+    const char* errorString() const { return error ? error : "no error"; }
+
+    // What the tests look at
+    size_t partitionSize = 1024 * 1024;
+    std::string written;        // Partition content since the last begin()
+    std::string installed;      // Image of the last successful end()
+    int aborts = 0;
+
+private:
+    bool running = false;
+    size_t expected = 0;
+    const char* error = nullptr;
+};
+
+inline UpdateClass Update;
+
+#endif // NATIVE_UPDATE_H
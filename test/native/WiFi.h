@@ -0,0 +1,39 @@
+#ifndef NATIVE_WIFI_H
+#define NATIVE_WIFI_H
+
+// The client side of a connection as a download reads it: the native
+// HTTPClient hands it the response body, and the connection closes once
+// the part the server got to send is read
+
+#include <Arduino.h>
+#include <algorithm>
+
+class WiFiClient {
+public:
+    // Bytes a read finds at most, like one TCP segment
+    static constexpr size_t SEGMENT_SIZE = 1460;
+
+    virtual ~WiFiClient() {}
+
+    int available() { return (int)std::min(data.size() - position, SEGMENT_SIZE); }
+    int read(uint8_t* buffer, size_t size) {
+        size_t length = std::min(size, data.size() - position);
+        memcpy(buffer, data.data() + position, length);
+        position += length;
+        return (int)length;
+    }
+    bool connected() { return position < data.size(); }
+    void stop() { data.clear(); position = 0; }
+
+    // What arrives before the connection closes
+    void nativeReceive(const std::string& received) {
+        data = received;
+        position = 0;
+    }
+
+private:
+    std::string data;
+    size_t position = 0;
+};
+
+#endif // NATIVE_WIFI_H
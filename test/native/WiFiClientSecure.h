@@ -0,0 +1,13 @@
+#ifndef NATIVE_WIFI_CLIENT_SECURE_H
+#define NATIVE_WIFI_CLIENT_SECURE_H
+
+// TLS is the real client's business; natively it is a plain WiFiClient
+
+#include <WiFi.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+};
+
+#endif // NATIVE_WIFI_CLIENT_SECURE_H
@@ -0,0 +1,42 @@
+#ifndef NATIVE_LWIP_SOCKETS_H
+#define NATIVE_LWIP_SOCKETS_H
+
+// lwIP's BSD socket calls mapped onto the host's, so the socket code runs
+// against real loopback connections
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+inline int lwip_socket(int domain, int type, int protocol) { return socket(domain, type, protocol); }
+inline int lwip_bind(int fd, const struct sockaddr* address, socklen_t length) { return bind(fd, address, length); }
+inline int lwip_listen(int fd, int backlog) { return listen(fd, backlog); }
+// Accepted sockets get about the send buffer lwIP has on the ESP32 (TCP_SND_BUF, 4 segments)
+// rather than the host's megabytes, so slow clients push back as they do on the device
+inline int lwip_accept(int fd, struct sockaddr* address, socklen_t* length) {
+    int accepted = accept(fd, address, length);
+    int sendBuffer = 5744;
+    if (accepted >= 0) {
+        setsockopt(accepted, SOL_SOCKET, SO_SNDBUF, &sendBuffer, sizeof(sendBuffer));
+    }
+    return accepted;
+}
+inline int lwip_close(int fd) { return close(fd); }
+inline int lwip_fcntl(int fd, int command, int value) { return fcntl(fd, command, value); }
+inline int lwip_recv(int fd, void* data, size_t length, int flags) { return (int)recv(fd, data, length, flags); }
+// A client gone away is an error, not a SIGPIPE, like on lwIP
+inline int lwip_send(int fd, const void* data, size_t length, int flags) {
+    return (int)send(fd, data, length, flags | MSG_NOSIGNAL);
+}
+inline int lwip_setsockopt(int fd, int level, int name, const void* value, socklen_t length) {
+    return setsockopt(fd, level, name, value, length);
+}
+inline int lwip_select(int count, fd_set* readable, fd_set* writable, fd_set* errors, struct timeval* timeout) {
+    return select(count, readable, writable, errors, timeout);
+}
+
+#endif // NATIVE_LWIP_SOCKETS_H
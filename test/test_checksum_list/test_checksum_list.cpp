@@ -0,0 +1,96 @@
+#include <unity.h>
+#include "checksum_list.h"
+
+// Output of sha256sum, the last line from its binary mode (-b)
+static const char LISTING[] =
+    "98736e45aa14a76cc773612ecf4940d0313be3487842ec5040e1295bc7af864f  firmware.bin\n"
+    "aa44acabc1dc0dde5764341e29c1f930e8a370d5685750c0ebdfe28ba9e3451a  firmware.bin.hs\n"
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855 *empty.bin\n";
+
+static const uint8_t FIRMWARE_DIGEST[ChecksumList::DIGEST_SIZE] = {
+    0x98, 0x73, 0x6e, 0x45, 0xaa, 0x14, 0xa7, 0x6c, 0xc7, 0x73, 0x61, 0x2e, 0xcf, 0x49, 0x40, 0xd0,
+    0x31, 0x3b, 0xe3, 0x48, 0x78, 0x42, 0xec, 0x50, 0x40, 0xe1, 0x29, 0x5b, 0xc7, 0xaf, 0x86, 0x4f};
+static const uint8_t COMPRESSED_DIGEST[ChecksumList::DIGEST_SIZE] = {
+    0xaa, 0x44, 0xac, 0xab, 0xc1, 0xdc, 0x0d, 0xde, 0x57, 0x64, 0x34, 0x1e, 0x29, 0xc1, 0xf9, 0x30,
+    0xe8, 0xa3, 0x70, 0xd5, 0x68, 0x57, 0x50, 0xc0, 0xeb, 0xdf, 0xe2, 0x8b, 0xa9, 0xe3, 0x45, 0x1a};
+static const uint8_t EMPTY_DIGEST[ChecksumList::DIGEST_SIZE] = {
+    0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+    0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55};
+
+static const char FIRMWARE_HEX[] = "98736e45aa14a76cc773612ecf4940d0313be3487842ec5040e1295bc7af864f";
+
+static uint8_t digest[ChecksumList::DIGEST_SIZE];
+
+static bool find(const String& listing, const char* fileName) {
+    return ChecksumList::find(listing, fileName, digest);
+}
+
+void setUp() {
+    memset(digest, 0, sizeof(digest));
+}
+
+void tearDown() {
+}
+
+void test_finds_each_file() {
+    TEST_ASSERT_TRUE(find(LISTING, "firmware.bin"));
+    TEST_ASSERT_EQUAL_MEMORY(FIRMWARE_DIGEST, digest, sizeof(digest));
+    TEST_ASSERT_TRUE(find(LISTING, "firmware.bin.hs"));
+    TEST_ASSERT_EQUAL_MEMORY(COMPRESSED_DIGEST, digest, sizeof(digest));
+    TEST_ASSERT_TRUE(find(LISTING, "empty.bin"));
+    TEST_ASSERT_EQUAL_MEMORY(EMPTY_DIGEST, digest, sizeof(digest));
+}
+
+void test_names_match_exactly() {
+    TEST_ASSERT_FALSE(find(LISTING, "firmware"));
+    TEST_ASSERT_FALSE(find(LISTING, "firmware.bin.h"));
+    TEST_ASSERT_FALSE(find(LISTING, "FIRMWARE.BIN"));
+    TEST_ASSERT_FALSE(find(LISTING, "*empty.bin"));
+    TEST_ASSERT_FALSE(find(LISTING, ""));
+    TEST_ASSERT_FALSE(find("", "firmware.bin"));
+}
+
+void test_line_endings_and_spacing() {
+    // CRLF, no newline after the last line, a single space, blank lines
+    String listing = String("\r\n") + FIRMWARE_HEX + " firmware.bin\r\n\r\n" + FIRMWARE_HEX + "  other.bin";
+    TEST_ASSERT_TRUE(find(listing, "firmware.bin"));
+    TEST_ASSERT_EQUAL_MEMORY(FIRMWARE_DIGEST, digest, sizeof(digest));
+    TEST_ASSERT_TRUE(find(listing, "other.bin"));
+
+    // Upper case digits
+    char upper[sizeof(FIRMWARE_HEX)];
+    for (size_t i = 0; i < sizeof(FIRMWARE_HEX); i++) {
+        upper[i] = toupper(FIRMWARE_HEX[i]);
+    }
+    TEST_ASSERT_TRUE(find(String(upper) + "  firmware.bin", "firmware.bin"));
+    TEST_ASSERT_EQUAL_MEMORY(FIRMWARE_DIGEST, digest, sizeof(digest));
+}
+
+void test_malformed_lines_are_skipped() {
+    String hex = FIRMWARE_HEX;
+    const String malformed[] = {
+        hex.substring(0, 63) + "  firmware.bin",              // Digest too short
+        hex + "0  firmware.bin",                              // Too long, e.g. SHA-512
+        hex.substring(0, 10) + "g" + hex.substring(11) + "  firmware.bin",
+        hex.substring(0, 10) + " " + hex.substring(11) + "  firmware.bin",
+        "-" + hex.substring(1) + "  firmware.bin",
+        hex + "\tfirmware.bin",
+        hex + "  ",
+    };
+    for (const String& line : malformed) {
+        TEST_ASSERT_FALSE(find(line, "firmware.bin"));
+    }
+
+    // A malformed line does not hide a good one for the same file further down
+    TEST_ASSERT_TRUE(find(malformed[2] + "\n" + hex + "  firmware.bin\n", "firmware.bin"));
+    TEST_ASSERT_EQUAL_MEMORY(FIRMWARE_DIGEST, digest, sizeof(digest));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_finds_each_file);
+    RUN_TEST(test_names_match_exactly);
+    RUN_TEST(test_line_endings_and_spacing);
+    RUN_TEST(test_malformed_lines_are_skipped);
+    return UNITY_END();
+}
@@ -0,0 +1,315 @@
+#include <unity.h>
+#include "cloud_connection.h"
+
+// Scripted network: the socket and the CONNACK arrive a set time after they
+// were asked for, or never (-1); tests move the clock instead of waiting
+struct FakeTransport : CloudConnection::Transport {
+    bool networkUp;
+    bool canOpen;
+    long socketLatencyMs;
+    long connackLatencyMs;
+    bool subscribeWorks;
+
+    bool socketUp;
+    bool mqttUp;
+    unsigned long openedAt;
+    unsigned long connectSentAt;
+
+    int opens;
+    int socketsOpened;
+    int connectsSent;
+    int onlines;
+    int serviced;
+    int closes;
+    int failures;
+    const char* lastReason;
+
+    void reset() {
+        *this = FakeTransport();
+        networkUp = true;
+        canOpen = true;
+        socketLatencyMs = 200;
+        connackLatencyMs = 50;
+        subscribeWorks = true;
+    }
+
+    // Connection gone from the far side
+    void drop() {
+        socketUp = false;
+        mqttUp = false;
+        socketLatencyMs = -1;
+    }
+
+    bool isNetworkUp() override {
+        return networkUp;
+    }
+
+    bool openSocket() override {
+        opens++;
+        openedAt = millis();
+        return canOpen;
+    }
+
+    bool pollSocket() override {
+        if (!socketUp && socketLatencyMs >= 0 && millis() - openedAt >= (unsigned long)socketLatencyMs) {
+            socketUp = true;
+        }
+        return socketUp;
+    }
+
+    bool isSocketUp() override {
+        return socketUp;
+    }
+
+    void socketOpened() override {
+        socketsOpened++;
+    }
+
+    void sendConnect() override {
+        connectsSent++;
+        connectSentAt = millis();
+    }
+
+    bool pollMqtt() override {
+        if (!mqttUp && socketUp && connackLatencyMs >= 0 && millis() - connectSentAt >= (unsigned long)connackLatencyMs) {
+            mqttUp = true;
+        }
+        return mqttUp;
+    }
+
+    bool subscribe() override {
+        return subscribeWorks;
+    }
+
+    void online() override {
+        onlines++;
+    }
+
+    void serviceOnline() override {
+        serviced++;
+    }
+
+    void closed(const char* reason, bool failed) override {
+        closes++;
+        failures += failed ? 1 : 0;
+        lastReason = reason;
+        socketUp = false;
+        mqttUp = false;
+    }
+};
+
+static const unsigned long BASE_DELAY_MS = 5000;
+
+static FakeTransport transport;
+static RetryBackoff backoff("cloud", BASE_DELAY_MS, 10 * 60 * 1000);
+static CloudConnection connection(transport, backoff);
+
+// loop() every 10 ms of clock time
+static void run(unsigned long ms) {
+    for (unsigned long elapsed = 0; elapsed < ms; elapsed += 10) {
+        advanceClock(10);
+        connection.loop();
+    }
+}
+
+// Runs until the step changes or the time is up, returns how long it took
+static unsigned long runUntilLeaving(ConnectStep step, unsigned long limitMs) {
+    unsigned long elapsed = 0;
+    while (connection.getStep() == step && elapsed < limitMs) {
+        run(10);
+        elapsed += 10;
+    }
+    return elapsed;
+}
+
+static void goOnline() {
+    connection.loop();
+    TEST_ASSERT_EQUAL(ConnectStep::WS_CONNECTING, connection.getStep());
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 20000);
+    runUntilLeaving(ConnectStep::WS_SETTLING, 20000);
+    runUntilLeaving(ConnectStep::MQTT_CONNECTING, 20000);
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::ONLINE, connection.getStep());
+}
+
+void setUp() {
+    connection.disconnect();
+    backoff.retryNow();
+    transport.reset();
+}
+
+void tearDown() {
+}
+
+void test_connects_one_step_at_a_time() {
+    connection.loop();
+    TEST_ASSERT_EQUAL(ConnectStep::WS_CONNECTING, connection.getStep());
+    TEST_ASSERT_EQUAL(1, transport.opens);
+
+    // Socket after 200 ms, then the pause before CONNECT
+    unsigned long took = runUntilLeaving(ConnectStep::WS_CONNECTING, 1000);
+    TEST_ASSERT_TRUE(took >= 190 && took <= 220);
+    TEST_ASSERT_EQUAL(ConnectStep::WS_SETTLING, connection.getStep());
+    TEST_ASSERT_EQUAL(1, transport.socketsOpened);
+    TEST_ASSERT_EQUAL(0, transport.connectsSent);
+
+    took = runUntilLeaving(ConnectStep::WS_SETTLING, 1000);
+    TEST_ASSERT_TRUE(took >= CloudConnection::WS_SETTLE_MS && took <= CloudConnection::WS_SETTLE_MS + 20);
+    TEST_ASSERT_EQUAL(ConnectStep::MQTT_CONNECTING, connection.getStep());
+    TEST_ASSERT_EQUAL(1, transport.connectsSent);
+
+    runUntilLeaving(ConnectStep::MQTT_CONNECTING, 1000);
+    TEST_ASSERT_EQUAL(ConnectStep::SUBSCRIBING, connection.getStep());
+    TEST_ASSERT_EQUAL(0, transport.onlines);
+
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::ONLINE, connection.getStep());
+    TEST_ASSERT_TRUE(connection.isOnline());
+    TEST_ASSERT_EQUAL(1, transport.onlines);
+
+    run(100);
+    TEST_ASSERT_EQUAL(10, transport.serviced);
+    TEST_ASSERT_EQUAL(0, transport.closes);
+    TEST_ASSERT_EQUAL(0, (int)backoff.getConsecutiveFailures());
+}
+
+void test_waits_for_the_network() {
+    transport.networkUp = false;
+    run(60000);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL(0, transport.opens);
+
+    transport.networkUp = true;
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::WS_CONNECTING, connection.getStep());
+}
+
+void test_websocket_timeout_backs_off() {
+    transport.socketLatencyMs = -1;
+    connection.loop();
+
+    unsigned long took = runUntilLeaving(ConnectStep::WS_CONNECTING, 20000);
+    TEST_ASSERT_TRUE(took > CloudConnection::WS_CONNECT_TIMEOUT_MS && took <= CloudConnection::WS_CONNECT_TIMEOUT_MS + 20);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL_STRING("WebSocket connection timeout", transport.lastReason);
+    TEST_ASSERT_EQUAL(1, transport.failures);
+    TEST_ASSERT_EQUAL(1, (int)backoff.getConsecutiveFailures());
+
+    // Jittered between half and all of the base delay, then doubling
+    unsigned long delay = backoff.getCurrentDelay();
+    TEST_ASSERT_TRUE(delay >= BASE_DELAY_MS / 2 && delay <= BASE_DELAY_MS);
+    run(delay - 20);
+    TEST_ASSERT_EQUAL(1, transport.opens);
+    run(30);
+    TEST_ASSERT_EQUAL(2, transport.opens);
+
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 20000);
+    delay = backoff.getCurrentDelay();
+    TEST_ASSERT_EQUAL(2, (int)backoff.getConsecutiveFailures());
+    TEST_ASSERT_TRUE(delay >= BASE_DELAY_MS && delay <= 2 * BASE_DELAY_MS);
+}
+
+void test_connack_timeout() {
+    transport.connackLatencyMs = -1;
+    connection.loop();
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 1000);
+    runUntilLeaving(ConnectStep::WS_SETTLING, 1000);
+    TEST_ASSERT_EQUAL(ConnectStep::MQTT_CONNECTING, connection.getStep());
+
+    unsigned long took = runUntilLeaving(ConnectStep::MQTT_CONNECTING, 20000);
+    TEST_ASSERT_TRUE(took > CloudConnection::MQTT_CONNECT_TIMEOUT_MS &&
+                     took <= CloudConnection::MQTT_CONNECT_TIMEOUT_MS + 20);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL_STRING("MQTT CONNACK timeout", transport.lastReason);
+    TEST_ASSERT_EQUAL(1, transport.failures);
+}
+
+void test_slow_connack_within_timeout_connects() {
+    transport.connackLatencyMs = CloudConnection::MQTT_CONNECT_TIMEOUT_MS - 100;
+    goOnline();
+    TEST_ASSERT_EQUAL(0, transport.failures);
+}
+
+void test_socket_drops_during_handshake() {
+    connection.loop();
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 1000);
+    transport.drop();
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL_STRING("WebSocket dropped before MQTT handshake", transport.lastReason);
+
+    backoff.retryNow();
+    transport.reset();
+    transport.connackLatencyMs = 1000;
+    connection.loop();
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 1000);
+    runUntilLeaving(ConnectStep::WS_SETTLING, 1000);
+    run(100);
+    TEST_ASSERT_EQUAL(ConnectStep::MQTT_CONNECTING, connection.getStep());
+    transport.drop();
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL_STRING("WebSocket dropped during MQTT handshake", transport.lastReason);
+    TEST_ASSERT_EQUAL(1, transport.failures);
+}
+
+void test_failed_subscribe_and_failed_start() {
+    transport.subscribeWorks = false;
+    connection.loop();
+    runUntilLeaving(ConnectStep::WS_CONNECTING, 1000);
+    runUntilLeaving(ConnectStep::WS_SETTLING, 1000);
+    runUntilLeaving(ConnectStep::MQTT_CONNECTING, 1000);
+    run(10);
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL_STRING("Subscribe failed", transport.lastReason);
+    TEST_ASSERT_EQUAL(0, transport.onlines);
+
+    // No TLS slot: the attempt fails right away and counts towards the backoff
+    backoff.retryNow();
+    transport.reset();
+    transport.canOpen = false;
+    TEST_ASSERT_FALSE(connection.connect());
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL(1, transport.failures);
+    TEST_ASSERT_EQUAL(1, (int)backoff.getConsecutiveFailures());
+}
+
+void test_lost_connection_reconnects_within_base_delay() {
+    goOnline();
+    transport.drop();
+    transport.socketLatencyMs = 200;
+    run(10);
+
+    // Not a failure: no backoff growth, the next attempt within the base delay
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_EQUAL(0, transport.failures);
+    TEST_ASSERT_EQUAL_STRING("MQTT connection lost", transport.lastReason);
+    TEST_ASSERT_EQUAL(0, (int)backoff.getConsecutiveFailures());
+    TEST_ASSERT_TRUE(backoff.getCurrentDelay() <= BASE_DELAY_MS);
+
+    run(BASE_DELAY_MS + 2000);
+    TEST_ASSERT_EQUAL(ConnectStep::ONLINE, connection.getStep());
+    TEST_ASSERT_EQUAL(2, transport.onlines);
+}
+
+void test_disconnect_is_not_a_failure() {
+    goOnline();
+    connection.disconnect();
+    TEST_ASSERT_EQUAL(ConnectStep::IDLE, connection.getStep());
+    TEST_ASSERT_NULL(transport.lastReason);
+    TEST_ASSERT_EQUAL(0, transport.failures);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_connects_one_step_at_a_time);
+    RUN_TEST(test_waits_for_the_network);
+    RUN_TEST(test_websocket_timeout_backs_off);
+    RUN_TEST(test_connack_timeout);
+    RUN_TEST(test_slow_connack_within_timeout_connects);
+    RUN_TEST(test_socket_drops_during_handshake);
+    RUN_TEST(test_failed_subscribe_and_failed_start);
+    RUN_TEST(test_lost_connection_reconnects_within_base_delay);
+    RUN_TEST(test_disconnect_is_not_a_failure);
+    return UNITY_END();
+}
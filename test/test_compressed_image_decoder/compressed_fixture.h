@@ -0,0 +1,131 @@
+#ifndef COMPRESSED_FIXTURE_H
+#define COMPRESSED_FIXTURE_H
+
+#include <stdint.h>
+
+// makeImage(6000) and makeImage(1500) from the test, written to a file and
+// packed with scripts/compress_firmware.py: the first with the default
+// 12/4 bit window, the second with --window 8 --lookahead 4
+
+static const uint8_t IMAGE_DEFAULT[] = {
+    0x51, 0x48, 0x53, 0x31, 0x0c, 0x04, 0x00, 0x00, 0x70, 0x17, 0x00, 0x00, 0x80, 0x00, 0x01, 0xa8,
+    0xb5, 0x39, 0x05, 0x26, 0xa7, 0x54, 0x90, 0x51, 0xaa, 0xb4, 0xea, 0x34, 0x82, 0xad, 0x4f, 0xa9,
+    0x48, 0x29, 0x14, 0x1a, 0x65, 0x0a, 0xe3, 0x6c, 0xb7, 0xd8, 0xed, 0x77, 0x4b, 0x45, 0xca, 0xcb,
+    0x65, 0xff, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x0e, 0xf3, 0x48, 0xf7,
+    0xee, 0x21, 0xbb, 0x4f, 0xcf, 0x06, 0x7d, 0x2a, 0xc7, 0xc6, 0x62, 0xd9, 0xec, 0x7d, 0x2a, 0xd5,
+    0xd5, 0xf6, 0x6d, 0xe9, 0xbd, 0x1e, 0xd4, 0x16, 0x27, 0x17, 0xa8, 0x5b, 0xaf, 0x31, 0x0e, 0xc8,
+    0x1b, 0x64, 0x10, 0xfe, 0x01, 0x93, 0x02, 0x67, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00,
+    0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0,
+    0x00, 0x7f, 0xff, 0xff, 0x9e, 0xcc, 0x4f, 0xac, 0x33, 0x7c, 0xd4, 0xee, 0x75, 0xce, 0xfd, 0x5a,
+    0x3f, 0x39, 0x6a, 0xcc, 0x63, 0xc5, 0x03, 0xce, 0xf8, 0x2f, 0x20, 0x23, 0xf0, 0x00, 0x78, 0x00,
+    0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78,
+    0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00,
+    0x78, 0x00, 0x22, 0x8b, 0x53, 0xa8, 0x4c, 0xe6, 0x52, 0xda, 0x1c, 0xce, 0xe5, 0x69, 0xa4, 0xcf,
+    0x3f, 0xb2, 0x69, 0xae, 0xd2, 0x61, 0xfb, 0xee, 0xcb, 0xe0, 0x34, 0xca, 0xa6, 0xc3, 0x47, 0xbd,
+    0xf7, 0x5e, 0xf1, 0x53, 0x39, 0xfc, 0x52, 0xd5, 0xd1, 0x8e, 0x00, 0x57, 0xc0, 0x2a, 0xb2, 0x7a,
+    0xac, 0x1f, 0x3b, 0xab, 0xe2, 0x7f, 0x72, 0xf7, 0x9b, 0x58, 0x04, 0x4c, 0x0a, 0x5e, 0x05, 0x2f,
+    0x02, 0x97, 0x80, 0x55, 0x6c, 0x3d, 0x9b, 0x7c, 0xfe, 0xb7, 0xc9, 0xba, 0xe3, 0x7c, 0x76, 0x5d,
+    0xde, 0x42, 0x59, 0x51, 0xca, 0x63, 0xb5, 0x57, 0x2c, 0xac, 0x2e, 0x23, 0xeb, 0xc8, 0x72, 0x6a,
+    0xd2, 0x0c, 0xdf, 0x3b, 0x59, 0xb5, 0x84, 0xd7, 0x70, 0xf8, 0xfb, 0x7f, 0xeb, 0x39, 0x43, 0xa6,
+    0x53, 0xe8, 0x74, 0xba, 0xfd, 0x12, 0x93, 0x53, 0xa8, 0x53, 0x28, 0x35, 0x90, 0x5f, 0x78, 0x00,
+    0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x00, 0xa0, 0xc1, 0xf0, 0x60, 0xff,
+    0xca, 0x1f, 0xf9, 0x98, 0x7f, 0x21, 0xdf, 0xab, 0xde, 0x8a, 0xdd, 0x79, 0xd1, 0x7d, 0xe6, 0xba,
+    0x9a, 0x4d, 0x3f, 0x4d, 0xfe, 0xaa, 0xcf, 0xa8, 0xb9, 0x9e, 0xbc, 0xa2, 0xd3, 0x73, 0xaf, 0xc9,
+    0x6f, 0x52, 0x09, 0x0e, 0x5f, 0xfd, 0x34, 0xd0, 0xcc, 0xe3, 0x78, 0x4d, 0x1f, 0xae, 0x69, 0x22,
+    0x96, 0x7d, 0x7d, 0xd6, 0x4b, 0xff, 0x7a, 0x41, 0x0d, 0x88, 0x81, 0x8f, 0xc0, 0x01, 0xe0, 0x00,
+    0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0,
+    0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01,
+    0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0,
+    0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03,
+    0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80,
+    0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07,
+    0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00,
+    0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x07,
+    0xe2, 0x6e, 0xf9, 0x73, 0x5b, 0x48, 0x05, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03,
+    0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80,
+    0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07,
+    0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00,
+    0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f,
+    0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00,
+    0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e,
+    0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00,
+    0x1f, 0xff, 0xa4, 0xff, 0x2c, 0x3a, 0xdd, 0x6d, 0xaa, 0xdb, 0x5e, 0xf1, 0x7a, 0xfe, 0x7c, 0x4e,
+    0x54, 0x4e, 0xef, 0x94, 0xc5, 0xed, 0xf7, 0xdc, 0x1c, 0x47, 0xab, 0x95, 0xff, 0x59, 0xdc, 0xe1,
+    0xf7, 0xd9, 0x1b, 0x35, 0xfb, 0xd1, 0x68, 0xce, 0xf3, 0x3e, 0x72, 0xec, 0x4e, 0xd2, 0xa6, 0xbc,
+    0x1f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x39, 0x75, 0x3e,
+    0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00,
+    0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c,
+    0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00,
+    0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x01, 0x37, 0x9f, 0xda, 0xbe, 0x60, 0x23, 0xf0, 0x00, 0x78,
+    0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x01, 0x2a, 0x29, 0xc0, 0x2f, 0xe0, 0x00, 0xf0, 0x00,
+    0x78, 0x00, 0x19, 0x67, 0x9e, 0x00, 0x0a, 0x75, 0x61, 0x80, 0xbb, 0xc0, 0x01, 0xe0, 0x00, 0xf0,
+    0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00,
+    0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0,
+    0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x04, 0x42, 0x99, 0xed, 0xe1, 0x3f, 0xf2, 0x4b, 0xe4,
+    0xb7, 0x5f, 0x52, 0xd4, 0xda, 0x29, 0xb0, 0xcb, 0xac, 0xea, 0x19, 0xf6, 0x9a, 0x79, 0xac, 0x1f,
+    0x5b, 0xd7, 0xc3, 0xfd, 0x1d, 0xec, 0x7f, 0xe5, 0x97, 0x09, 0x24, 0x4a, 0x03, 0x2d, 0xab, 0x52,
+    0xa5, 0x9d, 0x8c, 0x14, 0xda, 0xf1, 0xf6, 0x8c, 0x52, 0x72, 0x37, 0x2a, 0x0d, 0x5f, 0xbf, 0x23,
+    0xc9, 0x79, 0x22, 0xd2, 0xce, 0xee, 0xca, 0x57, 0xf1, 0x9c, 0x71, 0xea, 0x31, 0x6f, 0xb5, 0x9b,
+    0xf9, 0x80, 0xd6, 0x44, 0xfc, 0x35, 0x29, 0x66, 0x4f, 0xe5, 0xe8, 0xb2, 0xff, 0xa3, 0xf5, 0x8d,
+    0x75, 0x86, 0xf3, 0x67, 0xbf, 0xcf, 0x2d, 0xfd, 0x7e, 0x77, 0xce, 0x29, 0xae, 0xe7, 0x4a, 0xb7,
+    0x92, 0xf0, 0x3a, 0xf8, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01,
+    0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0,
+    0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03,
+    0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x67, 0xeb, 0xa1, 0x18, 0xc5, 0x66, 0xf9, 0xbe, 0xae, 0x66,
+    0xbe, 0x63, 0x7a, 0x9c, 0x57, 0x3a, 0x30, 0x50, 0x0f, 0x78, 0x00, 0x2b, 0x71, 0x0d, 0xda, 0x7e,
+    0x78, 0x33, 0xe9, 0x56, 0x3e, 0x32, 0x3d, 0x6f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00,
+    0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x02, 0x89, 0xd1, 0xe4,
+    0xe8, 0x3e, 0xbf, 0xfe, 0x8f, 0x4a, 0x85, 0xce, 0xe1, 0xbb, 0x98, 0xed, 0x03, 0x19, 0x02, 0xe9,
+    0x40, 0xe4, 0xf3, 0xb9, 0x66, 0xdf, 0x07, 0xb7, 0xb8, 0xf4, 0x30, 0x50, 0xa9, 0x2c, 0x0e, 0x95,
+    0x09, 0x85, 0x50, 0xa7, 0xdc, 0x79, 0x37, 0x0e, 0x07, 0x98, 0xbd, 0xc4, 0x2a, 0x19, 0x9e, 0x64,
+    0x13, 0x4f, 0x96, 0xac, 0xe1, 0xf8, 0x72, 0x4e, 0x3f, 0xb7, 0xd5, 0xb7, 0xfc, 0xf2, 0xa2, 0x5f,
+    0x3d, 0x3f, 0xf6, 0xf3, 0x7a, 0x82, 0xf6, 0x39, 0xfb, 0x6f, 0xec, 0x23, 0xf5, 0x38, 0x89, 0xd0,
+    0x63, 0x9d, 0x58, 0x65, 0xe3, 0x39, 0xa2, 0xf5, 0xf8, 0x23, 0x7f, 0x2f, 0xa7, 0xb4, 0x0e, 0xbe,
+    0x00, 0x0f, 0x00, 0x05, 0xeb, 0x3a, 0x90, 0x7e, 0x18, 0x04, 0xfc, 0x00, 0x1e, 0x00, 0x0f, 0x00,
+    0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f,
+    0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00, 0x46, 0x8f, 0x9d, 0x67, 0xc4, 0x4b,
+    0xec, 0xd3, 0xab, 0xed, 0xde, 0x03, 0xab, 0xf7, 0x00, 0x6f, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00,
+    0x50, 0xa0, 0x1e, 0xe9, 0x15, 0xdc, 0xd1, 0xbe, 0x9d, 0x39, 0xb6, 0x46, 0xc5, 0x1d, 0xa9, 0x5c,
+    0xfe, 0x39, 0x7b, 0x0c, 0xbe, 0x2b, 0x26, 0xfb, 0xd2, 0x70, 0x7e, 0xdf, 0x4e, 0x1a, 0x5b, 0x50,
+    0xa4, 0xfa, 0x69, 0x3f, 0x3b, 0x76, 0xda, 0x97, 0xbb, 0xf4, 0xdc, 0x7c, 0xbc, 0xb2, 0x68, 0x28,
+    0x81, 0x5c, 0x09, 0x7e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0, 0x00,
+    0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00, 0xf0,
+    0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0, 0x00,
+    0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x03, 0xc0, 0x01, 0xe0,
+    0x00, 0xf0, 0x00, 0x78, 0x00, 0x3c, 0x00, 0x1e, 0x00, 0x0f, 0x00, 0x07, 0x80, 0x01, 0xf1, 0xfb,
+    0xd8, 0xdd, 0xb6, 0x55, 0x9b, 0x80, 0x70, 0xba, 0xbc, 0x0f, 0xb5, 0xdf, 0xc7, 0x6f, 0xb8, 0xdc,
+    0x7d, 0x32, 0xc9, 0x37, 0x4f, 0x73, 0xbc, 0x83, 0xc0, 0x6d, 0x32, 0x1a, 0x56, 0x7e, 0x99, 0xa1,
+    0xb1, 0xe4, 0xbe, 0xdc, 0x08, 0x27, 0xf6, 0x79, 0x44, 0x98, 0xc9, 0xfe, 0x70, 0xb9, 0x4e, 0xe3,
+    0xd1, 0x37, 0xdc, 0x5d, 0xf6, 0xde, 0xbd, 0x9c, 0xa6, 0xa5, 0x8b, 0x96, 0xf4, 0x7d, 0xfb, 0xcb,
+    0xd6, 0xce, 0x03, 0x60, 0x97, 0x54, 0xe7, 0xa8, 0xb2, 0x32, 0x47, 0x38,
+};
+static const uint8_t IMAGE_SMALL_WINDOW[] = {
+    0x51, 0x48, 0x53, 0x31, 0x08, 0x04, 0x00, 0x00, 0xdc, 0x05, 0x00, 0x00, 0x80, 0x00, 0x1a, 0x8b,
+    0x53, 0x90, 0x52, 0x6a, 0x75, 0x49, 0x05, 0x1a, 0xab, 0x4e, 0xa3, 0x48, 0x2a, 0xd4, 0xfa, 0x94,
+    0x82, 0x91, 0x41, 0xa6, 0x50, 0xae, 0x36, 0xcb, 0x7d, 0x8e, 0xd7, 0x74, 0xb4, 0x5c, 0xac, 0xb6,
+    0x5f, 0xf8, 0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x07, 0x80, 0x0e, 0xf3, 0x48, 0xf7, 0xee, 0x21, 0xbb,
+    0x4f, 0xcf, 0x06, 0x7d, 0x2a, 0xc7, 0xc6, 0x62, 0xd9, 0xec, 0x7d, 0x2a, 0xd5, 0xd5, 0xf6, 0x6d,
+    0xe9, 0xbd, 0x1e, 0xd4, 0x16, 0x27, 0x17, 0xa8, 0x5b, 0xaf, 0x31, 0x0e, 0xc9, 0xb6, 0x50, 0xfe,
+    0x19, 0x32, 0x67, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78, 0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x07,
+    0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x7f, 0xff, 0xff, 0x9e, 0xcc, 0x4f, 0xac, 0x33, 0x7c, 0xd4,
+    0xee, 0x75, 0xce, 0xfd, 0x5a, 0x3f, 0x39, 0x6a, 0xcc, 0x63, 0xc5, 0x03, 0xce, 0xf8, 0x2f, 0x22,
+    0x3f, 0x00, 0x78, 0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x07, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78,
+    0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x07, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78, 0x02, 0x28, 0xb5,
+    0x3a, 0x84, 0xce, 0x65, 0x2d, 0xa1, 0xcc, 0xee, 0x56, 0x9a, 0x4c, 0xf3, 0xfb, 0x26, 0x9a, 0xed,
+    0x26, 0x1f, 0xbe, 0xec, 0xbe, 0x03, 0x4c, 0xaa, 0x6c, 0x34, 0x7b, 0xdf, 0x75, 0xef, 0x15, 0x33,
+    0x9f, 0xc5, 0x2d, 0x5d, 0x18, 0xe0, 0x57, 0xc2, 0xab, 0x27, 0xaa, 0xc1, 0xf3, 0xba, 0xbe, 0x27,
+    0xf7, 0x2f, 0x79, 0xb5, 0x84, 0x4c, 0xa5, 0xe5, 0x2f, 0x29, 0x78, 0x55, 0x6c, 0x3d, 0x9b, 0x7c,
+    0xfe, 0xb7, 0xc9, 0xba, 0xe3, 0x7c, 0x76, 0x5d, 0xde, 0x42, 0x59, 0x51, 0xca, 0x63, 0xb5, 0x57,
+    0x2c, 0xac, 0x2e, 0x23, 0xeb, 0xc8, 0x72, 0x6a, 0xd2, 0x0c, 0xdf, 0x3b, 0x59, 0xb5, 0x84, 0xd7,
+    0x70, 0xf8, 0xfb, 0x7f, 0xeb, 0x39, 0x43, 0xa6, 0x53, 0xe8, 0x74, 0xba, 0xfd, 0x12, 0x93, 0x53,
+    0xa8, 0x53, 0x28, 0x35, 0x95, 0xf7, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78, 0x03, 0xc0, 0x0a,
+    0xc1, 0xf6, 0x0f, 0xfc, 0xa1, 0xff, 0x99, 0x87, 0xf2, 0x1d, 0xfa, 0xbd, 0xe8, 0xad, 0xd7, 0x9d,
+    0x17, 0xde, 0x6b, 0xa9, 0xa4, 0xd3, 0xf4, 0xdf, 0xea, 0xac, 0xfa, 0x8b, 0x99, 0xeb, 0xca, 0x2d,
+    0x37, 0x3a, 0xfc, 0x96, 0xf5, 0x20, 0x90, 0xe5, 0xff, 0xd3, 0x4d, 0x0c, 0xce, 0x37, 0x84, 0xd1,
+    0xfa, 0xe6, 0x92, 0x29, 0x67, 0xd7, 0xdd, 0x64, 0xbf, 0xf7, 0xa4, 0x10, 0xd8, 0x89, 0x8f, 0xc0,
+    0x1e, 0x00, 0xf0, 0x07, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78, 0x03, 0xc0, 0x1e, 0x00, 0xf0,
+    0x07, 0x80, 0x3c, 0x01, 0xe0, 0x0f, 0x00, 0x78, 0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x07, 0x80, 0x3c,
+    0x01, 0xe0, 0x0f, 0x00, 0x78, 0x03, 0xc0, 0x1e, 0x00, 0xf0, 0x05, 0x80,
+};
+
+#endif // COMPRESSED_FIXTURE_H
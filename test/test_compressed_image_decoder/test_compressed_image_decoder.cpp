@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "compressed_image_decoder.h"
+#include "compressed_fixture.h"
+
+// Firmware-like content: random stretches, repeated strings, 0xFF padding
+// that compresses into overlapping references, and copies from further
+// back than the window reaches
+static std::vector<uint8_t> makeImage(size_t size) {
+    static const char* const PHRASES[] = {"qlockthree", "ESP32-C3", "CLOCK_DISPLAY", "\0\0\0\0", "ES IST FUNF VOR HALB"};
+    static const size_t PHRASE_LENGTHS[] = {10, 8, 13, 4, 20};
+    uint32_t seed = 1;
+    auto next = [&seed]() {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+
+    std::vector<uint8_t> image;
+    while (image.size() < size) {
+        switch (next() % 4) {
+            case 0:
+                for (uint32_t count = 1 + next() % 40; count > 0; count--) {
+                    image.push_back(next() & 0xFF);
+                }
+                break;
+            case 1: {
+                uint32_t phrase = next() % 5;
+                image.insert(image.end(), PHRASES[phrase], PHRASES[phrase] + PHRASE_LENGTHS[phrase]);
+                break;
+            }
+            case 2:
+                image.insert(image.end(), 1 + next() % 300, 0xFF);
+                break;
+            default:
+                if (!image.empty()) {
+                    size_t start = next() % image.size();
+                    size_t length = 1 + next() % 64;
+                    std::vector<uint8_t> copy(image.begin() + start,
+                                              image.begin() + std::min(start + length, image.size()));
+                    image.insert(image.end(), copy.begin(), copy.end());
+                }
+                break;
+        }
+    }
+    image.resize(size);
+    return image;
+}
+
+static std::vector<uint8_t> decoded;
+static size_t badPieces;    // Empty or larger than OUTPUT_SIZE
+
+static bool collect(const uint8_t* data, size_t length) {
+    if (length == 0 || length > CompressedImageDecoder::OUTPUT_SIZE) {
+        badPieces++;
+    }
+    decoded.insert(decoded.end(), data, data + length);
+    return true;
+}
+
+// Fed in pieces split at the given offsets
+static bool decode(CompressedImageDecoder& decoder, const uint8_t* data, size_t length,
+                   std::initializer_list<size_t> splits = {}) {
+    decoder.reset();
+    decoded.clear();
+    size_t start = 0;
+    for (size_t split : splits) {
+        if (!decoder.feed(data + start, split - start, collect)) {
+            return false;
+        }
+        start = split;
+    }
+    return decoder.feed(data + start, length - start, collect);
+}
+
+static std::vector<uint8_t> withHeaderByte(size_t index, uint8_t value) {
+    std::vector<uint8_t> image(IMAGE_DEFAULT, IMAGE_DEFAULT + sizeof(IMAGE_DEFAULT));
+    image[index] = value;
+    return image;
+}
+
+void setUp() {
+    badPieces = 0;
+}
+
+void tearDown() {
+    TEST_ASSERT_EQUAL_UINT(0, badPieces);
+}
+
+void test_script_output_decodes() {
+    CompressedImageDecoder decoder;
+    TEST_ASSERT_TRUE(decode(decoder, IMAGE_DEFAULT, sizeof(IMAGE_DEFAULT)));
+    TEST_ASSERT_TRUE(decoder.isComplete());
+    TEST_ASSERT_EQUAL_UINT(6000, decoder.getImageSize());
+    TEST_ASSERT_TRUE(decoded == makeImage(6000));
+
+    // The decoder is reused for the next image
+    TEST_ASSERT_TRUE(decode(decoder, IMAGE_SMALL_WINDOW, sizeof(IMAGE_SMALL_WINDOW)));
+    TEST_ASSERT_TRUE(decoder.isComplete());
+    TEST_ASSERT_TRUE(decoded == makeImage(1500));
+}
+
+void test_split_at_every_byte_boundary() {
+    CompressedImageDecoder decoder;
+    std::vector<uint8_t> expected = makeImage(6000);
+    for (size_t split = 0; split <= sizeof(IMAGE_DEFAULT); split++) {
+        TEST_ASSERT_TRUE(decode(decoder, IMAGE_DEFAULT, sizeof(IMAGE_DEFAULT), {split}));
+        TEST_ASSERT_TRUE(decoder.isComplete());
+        TEST_ASSERT_TRUE(decoded == expected);
+    }
+
+    expected = makeImage(1500);
+    for (size_t split = 0; split <= sizeof(IMAGE_SMALL_WINDOW); split++) {
+        TEST_ASSERT_TRUE(decode(decoder, IMAGE_SMALL_WINDOW, sizeof(IMAGE_SMALL_WINDOW), {split}));
+        TEST_ASSERT_TRUE(decoded == expected);
+    }
+}
+
+void test_byte_by_byte_feed() {
+    CompressedImageDecoder decoder;
+    decoded.clear();
+    for (size_t i = 0; i < sizeof(IMAGE_DEFAULT); i++) {
+        TEST_ASSERT_TRUE(decoder.feed(IMAGE_DEFAULT + i, 1, collect));
+        TEST_ASSERT_EQUAL(i + 1 >= CompressedImageDecoder::HEADER_SIZE, decoder.hasHeader());
+    }
+    TEST_ASSERT_TRUE(decoder.isComplete());
+    TEST_ASSERT_TRUE(decoded == makeImage(6000));
+}
+
+void test_truncated_stream_is_incomplete() {
+    CompressedImageDecoder decoder;
+    TEST_ASSERT_TRUE(decode(decoder, IMAGE_DEFAULT, sizeof(IMAGE_DEFAULT) - 1));
+    TEST_ASSERT_FALSE(decoder.isComplete());
+    TEST_ASSERT_TRUE(decoder.getDecoded() < 6000);
+    TEST_ASSERT_EQUAL_UINT(decoder.getDecoded(), decoded.size());
+}
+
+void test_data_past_the_end_is_rejected() {
+    std::vector<uint8_t> image(IMAGE_DEFAULT, IMAGE_DEFAULT + sizeof(IMAGE_DEFAULT));
+    image.push_back(0);
+    CompressedImageDecoder decoder;
+    TEST_ASSERT_FALSE(decode(decoder, image.data(), image.size()));
+    TEST_ASSERT_FALSE(decode(decoder, image.data(), image.size(), {sizeof(IMAGE_DEFAULT)}));
+}
+
+void test_bad_headers_are_rejected() {
+    CompressedImageDecoder decoder;
+    const std::vector<uint8_t> images[] = {
+        withHeaderByte(0, 'X'),     // Magic
+        withHeaderByte(3, '2'),
+        withHeaderByte(4, 14),      // Window larger than MAX_WINDOW_BITS
+        withHeaderByte(5, 2),       // Lookahead too short
+        withHeaderByte(5, 12),      // Lookahead not shorter than the window
+    };
+    for (const std::vector<uint8_t>& image : images) {
+        TEST_ASSERT_FALSE(decode(decoder, image.data(), image.size()));
+        TEST_ASSERT_FALSE(decoder.hasHeader());
+        TEST_ASSERT_EQUAL_UINT(0, decoded.size());
+    }
+
+    std::vector<uint8_t> empty = withHeaderByte(8, 0);
+    empty[9] = 0;
+    TEST_ASSERT_FALSE(decode(decoder, empty.data(), empty.size()));
+}
+
+void test_sink_can_stop_decoding() {
+    CompressedImageDecoder decoder;
+    int calls = 0;
+    auto failing = [&calls](const uint8_t* data, size_t length) {
+        return ++calls < 3;
+    };
+    TEST_ASSERT_FALSE(decoder.feed(IMAGE_DEFAULT, sizeof(IMAGE_DEFAULT), failing));
+    TEST_ASSERT_EQUAL(3, calls);
+    TEST_ASSERT_FALSE(decoder.isComplete());
+}
+
+void test_decode_throughput() {
+    const int ROUNDS = 2000;
+    CompressedImageDecoder decoder;
+    size_t checksum = 0;
+    auto sink = [&checksum](const uint8_t* data, size_t length) {
+        checksum += data[length - 1];
+        return true;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        decoder.reset();
+        TEST_ASSERT_TRUE(decoder.feed(IMAGE_DEFAULT, sizeof(IMAGE_DEFAULT), sink));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    char message[120];
+    snprintf(message, sizeof(message), "%u -> %u B (%.1f%%), %.0f MB/s decoded (host)",
+             (unsigned)decoder.getImageSize(), (unsigned)sizeof(IMAGE_DEFAULT),
+             100.0 * sizeof(IMAGE_DEFAULT) / decoder.getImageSize(),
+             ROUNDS * decoder.getImageSize() / seconds / 1e6);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(checksum > 0);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_script_output_decodes);
+    RUN_TEST(test_split_at_every_byte_boundary);
+    RUN_TEST(test_byte_by_byte_feed);
+    RUN_TEST(test_truncated_stream_is_incomplete);
+    RUN_TEST(test_data_past_the_end_is_rejected);
+    RUN_TEST(test_bad_headers_are_rejected);
+    RUN_TEST(test_sink_can_stop_decoding);
+    RUN_TEST(test_decode_throughput);
+    return UNITY_END();
+}
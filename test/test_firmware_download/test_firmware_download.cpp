@@ -0,0 +1,258 @@
+#include <unity.h>
+#include <HTTPClient.h>
+#include <Update.h>
+#include <vector>
+#include "firmware_download.h"
+
+static const char URL[] = "https://example.com/firmware.bin";
+static const size_t IMAGE_SIZE = 20000;
+
+// One server for every request of a test
+struct FakeServer {
+    std::string image;
+    std::vector<size_t> drops;      // Body bytes each response sends before dropping; all after these
+    bool ignoreRange;
+    std::string contentRange;       // Replaces the right one when set
+    long flipAt;                    // Byte that arrives inverted, -1 for none
+    std::vector<String> ranges;     // Range header of each request, empty without
+};
+
+static FakeServer server;
+
+static void serve(const NativeHttpRequest& request, NativeHttpResponse& response) {
+    String range = request.header("Range");
+    size_t index = server.ranges.size();
+    server.ranges.push_back(range);
+
+    std::string body = server.image;
+    if (server.flipAt >= 0) {
+        body[server.flipAt] ^= 0xFF;
+    }
+
+    unsigned long first = 0;
+    if (!server.ignoreRange && sscanf(range.c_str(), "bytes=%lu-", &first) == 1) {
+        char header[64];
+        snprintf(header, sizeof(header), "bytes %lu-%lu/%lu", first, (unsigned long)body.size() - 1,
+                 (unsigned long)body.size());
+        response.code = HTTP_CODE_PARTIAL_CONTENT;
+        response.headers.push_back({"Content-Range", server.contentRange.empty() ? header : server.contentRange.c_str()});
+        body = body.substr(first);
+    } else {
+        response.code = HTTP_CODE_OK;
+    }
+    response.body = body;
+    if (index < server.drops.size()) {
+        response.sent = server.drops[index];
+    }
+}
+
+static std::string makeImage(size_t size) {
+    std::string image;
+    uint32_t seed = 7;
+    while (image.size() < size) {
+        seed = seed * 1664525 + 1013904223;
+        image += (char)(seed >> 24);
+    }
+    return image;
+}
+
+static void digestOf(const std::string& data, uint8_t digest[FirmwareDownload::DIGEST_SIZE]) {
+    mbedtls_sha256_context sha;
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    mbedtls_sha256_update(&sha, (const unsigned char*)data.data(), data.size());
+    mbedtls_sha256_finish(&sha, digest);
+    mbedtls_sha256_free(&sha);
+}
+
+static String statusOf(FirmwareDownload& download) {
+    char buffer[512];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    download.writeStatusJSON(json);
+    json.endObject();
+    return String(json.c_str());
+}
+
+static void assertStatus(FirmwareDownload& download, const char* member) {
+    String status = statusOf(download);
+    if (status.indexOf(member) < 0) {
+        TEST_FAIL_MESSAGE((String(member) + " missing in " + status).c_str());
+    }
+}
+
+static void assertRanges(std::initializer_list<const char*> expected) {
+    TEST_ASSERT_EQUAL_UINT(expected.size(), server.ranges.size());
+    size_t i = 0;
+    for (const char* range : expected) {
+        TEST_ASSERT_EQUAL_STRING(range, server.ranges[i++].c_str());
+    }
+}
+
+void setUp() {
+    server = FakeServer();
+    server.image = makeImage(IMAGE_SIZE);
+    server.ignoreRange = false;
+    server.flipAt = -1;
+    nativeHttpHandler() = serve;
+    Update = UpdateClass();
+}
+
+void tearDown() {
+    nativeHttpHandler() = nullptr;
+}
+
+void test_whole_image_is_verified_and_installed() {
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    digestOf(server.image, digest);
+    size_t lastProgress = 0;
+    FirmwareDownload download;
+
+    FirmwareDownload::Result result = download.run(URL, digest, [&lastProgress](size_t written, size_t total) {
+        TEST_ASSERT_TRUE(written > lastProgress && total == IMAGE_SIZE);
+        lastProgress = written;
+    });
+    TEST_ASSERT_TRUE(result == FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    TEST_ASSERT_EQUAL_UINT(IMAGE_SIZE, lastProgress);
+    assertRanges({""});
+    assertStatus(download, "\"verified\":true");
+}
+
+void test_drop_mid_image_resumes_with_a_range() {
+    server.drops = {7000, 5000};
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    digestOf(server.image, digest);
+    FirmwareDownload download;
+
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    assertRanges({"", "bytes=7000-", "bytes=12000-"});
+    assertStatus(download, "\"resumes\":2");
+    TEST_ASSERT_EQUAL(0, Update.aborts);
+}
+
+void test_resume_across_runs() {
+    // Every response drops after 1000 bytes: a run gives up after its
+    // attempts, the next one continues where it stopped
+    server.drops.assign(IMAGE_SIZE / 1000, 1000);
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    digestOf(server.image, digest);
+    FirmwareDownload download;
+
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::INTERRUPTED);
+    size_t firstRun = download.getWritten();
+    TEST_ASSERT_TRUE(firstRun > 0 && firstRun < IMAGE_SIZE);
+    TEST_ASSERT_TRUE(Update.isRunning());
+    assertStatus(download, "\"resumable\":true");
+
+    size_t requests = server.ranges.size();
+    FirmwareDownload::Result result;
+    do {
+        result = download.run(URL, digest, nullptr);
+    } while (result == FirmwareDownload::Result::INTERRUPTED && server.ranges.size() < 100);
+    TEST_ASSERT_TRUE(result == FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    TEST_ASSERT_EQUAL_STRING((String("bytes=") + String((unsigned long)firstRun) + "-").c_str(),
+                             server.ranges[requests].c_str());
+    TEST_ASSERT_EQUAL(0, Update.aborts);
+
+    // Another URL does not continue an interrupted one
+    server.drops.assign(8, 1000);
+    server.ranges.clear();
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::INTERRUPTED);
+    TEST_ASSERT_TRUE(download.run("https://example.com/other.bin", nullptr, nullptr) ==
+                     FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_EQUAL_STRING("", server.ranges.back().c_str());
+    TEST_ASSERT_EQUAL(1, Update.aborts);
+}
+
+void test_server_ignoring_the_range_starts_over() {
+    server.drops = {5000};
+    server.ignoreRange = true;
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    digestOf(server.image, digest);
+    FirmwareDownload download;
+
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::INSTALLED);
+    // Written once from the start, not appended to the first 5000 bytes
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    assertRanges({"", "bytes=5000-"});
+    assertStatus(download, "\"restarts\":1");
+}
+
+void test_unexpected_content_range_is_not_resumed() {
+    const char* ranges[] = {
+        "bytes 0-19999/20000",      // Not where the partition stops
+        "bytes 6000-20999/21000",   // Another image
+        "bytes */20000",
+    };
+    for (const char* range : ranges) {
+        setUp();
+        server.drops = {6000};
+        server.contentRange = range;
+        FirmwareDownload download;
+
+        TEST_ASSERT_TRUE(download.run(URL, nullptr, nullptr) == FirmwareDownload::Result::FAILED);
+        TEST_ASSERT_TRUE(Update.installed.empty());
+        TEST_ASSERT_FALSE(Update.isRunning());
+        TEST_ASSERT_EQUAL_UINT(0, download.getWritten());
+        assertRanges({"", "bytes=6000-"});
+    }
+}
+
+void test_flipped_byte_is_never_installed() {
+    server.drops = {8000};
+    server.flipAt = 12345;
+    uint8_t digest[FirmwareDownload::DIGEST_SIZE];
+    digestOf(server.image, digest);
+    FirmwareDownload download;
+
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::FAILED);
+    TEST_ASSERT_TRUE(Update.installed.empty());
+    TEST_ASSERT_FALSE(Update.isRunning());
+    TEST_ASSERT_EQUAL_UINT(0, download.getWritten());
+    assertStatus(download, "\"digest_mismatches\":1");
+
+    // Nothing left to resume: the next run fetches the whole image again
+    server.flipAt = -1;
+    server.drops.clear();
+    server.ranges.clear();
+    TEST_ASSERT_TRUE(download.run(URL, digest, nullptr) == FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    assertRanges({""});
+}
+
+void test_refused_connection_is_resumable() {
+    // Down for longer than a run keeps trying, after the first 9000 bytes
+    server.drops = {9000};
+    nativeHttpHandler() = [](const NativeHttpRequest& request, NativeHttpResponse& response) {
+        if (server.ranges.empty()) {
+            serve(request, response);
+        } else {
+            server.ranges.push_back(request.header("Range"));
+        }
+    };
+    FirmwareDownload download;
+    TEST_ASSERT_TRUE(download.run(URL, nullptr, nullptr) == FirmwareDownload::Result::INTERRUPTED);
+    TEST_ASSERT_EQUAL_UINT(9000, download.getWritten());
+
+    nativeHttpHandler() = serve;
+    size_t refused = server.ranges.size();
+    TEST_ASSERT_TRUE(download.run(URL, nullptr, nullptr) == FirmwareDownload::Result::INSTALLED);
+    TEST_ASSERT_EQUAL_STRING("bytes=9000-", server.ranges[refused].c_str());
+    TEST_ASSERT_TRUE(Update.installed == server.image);
+    assertStatus(download, "\"verified\":false");
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_whole_image_is_verified_and_installed);
+    RUN_TEST(test_drop_mid_image_resumes_with_a_range);
+    RUN_TEST(test_resume_across_runs);
+    RUN_TEST(test_server_ignoring_the_range_starts_over);
+    RUN_TEST(test_unexpected_content_range_is_not_resumed);
+    RUN_TEST(test_flipped_byte_is_never_installed);
+    RUN_TEST(test_refused_connection_is_resumable);
+    return UNITY_END();
+}
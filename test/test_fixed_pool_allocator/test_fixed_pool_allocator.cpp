@@ -0,0 +1,199 @@
+#include <unity.h>
+#include <chrono>
+#include "fixed_pool_allocator.h"
+
+// Slots are larger on a 64-bit host than on the ESP32, so the documents
+// here get a bigger pool than CloudManager's 3 KB
+static const size_t HOST_POOL_SIZE = 16384;
+
+// {"type":"brightness","payload":{"value":128}}
+static const char BRIGHTNESS_JSON[] = "{\"type\":\"brightness\",\"payload\":{\"value\":128}}";
+static const uint8_t BRIGHTNESS_MSGPACK[] = {
+    0x82,
+    0xA4, 't', 'y', 'p', 'e',
+    0xAA, 'b', 'r', 'i', 'g', 'h', 't', 'n', 'e', 's', 's',
+    0xA7, 'p', 'a', 'y', 'l', 'o', 'a', 'd',
+    0x81,
+    0xA5, 'v', 'a', 'l', 'u', 'e',
+    0xCC, 0x80,
+};
+
+static const char DESIRED_JSON[] =
+    "{\"type\":\"desired\",\"version\":42,\"payload\":{\"power\":\"ON\",\"brightness\":180,"
+    "\"color\":{\"r\":255,\"g\":120,\"b\":0},\"pattern\":\"CLOCK_DISPLAY\"}}";
+
+static uint8_t poolBuffer[HOST_POOL_SIZE];
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_newest_block_grows_and_shrinks_in_place() {
+    uint8_t buffer[256];
+    FixedPoolAllocator pool(buffer, sizeof(buffer));
+
+    char* text = (char*)pool.allocate(10);
+    strcpy(text, "hello");
+    size_t usedSmall = pool.getUsed();
+
+    TEST_ASSERT_EQUAL_PTR(text, pool.reallocate(text, 40));
+    TEST_ASSERT_EQUAL_STRING("hello", text);
+    TEST_ASSERT_TRUE(pool.getUsed() > usedSmall);
+
+    TEST_ASSERT_EQUAL_PTR(text, pool.reallocate(text, 10));
+    TEST_ASSERT_EQUAL_UINT(usedSmall, pool.getUsed());
+    TEST_ASSERT_EQUAL_STRING("hello", text);
+
+    // Handing the newest block back frees it
+    pool.deallocate(text);
+    TEST_ASSERT_EQUAL_UINT(0, pool.getUsed());
+}
+
+void test_older_block_moves_to_grow() {
+    uint8_t buffer[256];
+    FixedPoolAllocator pool(buffer, sizeof(buffer));
+
+    char* first = (char*)pool.allocate(10);
+    strcpy(first, "hello");
+    char* second = (char*)pool.allocate(16);
+    strcpy(second, "second");
+
+    // Not the newest: a copy at the end, the old block waits for reset()
+    char* moved = (char*)pool.reallocate(first, 80);
+    TEST_ASSERT_NOT_NULL(moved);
+    TEST_ASSERT_TRUE(moved != first);
+    TEST_ASSERT_EQUAL_STRING("hello", moved);
+    TEST_ASSERT_EQUAL_STRING("second", second);
+
+    // Shrinking an older block keeps it where it is
+    TEST_ASSERT_EQUAL_PTR(second, pool.reallocate(second, 4));
+    size_t used = pool.getUsed();
+    pool.deallocate(second);
+    TEST_ASSERT_EQUAL_UINT(used, pool.getUsed());
+
+    // Blocks are pointer aligned
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)moved % sizeof(void*));
+    TEST_ASSERT_EQUAL_UINT(0, (uintptr_t)second % sizeof(void*));
+}
+
+void test_full_pool_fails_without_side_effects() {
+    uint8_t buffer[128];
+    FixedPoolAllocator pool(buffer, sizeof(buffer));
+
+    void* block = pool.allocate(32);
+    size_t used = pool.getUsed();
+    TEST_ASSERT_NULL(pool.allocate(1000));
+    TEST_ASSERT_NULL(pool.reallocate(block, 1000));
+    TEST_ASSERT_EQUAL_UINT(used, pool.getUsed());
+
+    pool.reset();
+    TEST_ASSERT_EQUAL_UINT(0, pool.getUsed());
+    TEST_ASSERT_EQUAL_UINT(used, pool.getPeakUsed());
+    TEST_ASSERT_NOT_NULL(pool.allocate(64));
+}
+
+void test_json_and_msgpack_commands_parse_alike() {
+    FixedPoolAllocator pool(poolBuffer, sizeof(poolBuffer));
+
+    JsonDocument fromJson(&pool);
+    TEST_ASSERT_FALSE(deserializeJson(fromJson, BRIGHTNESS_JSON, strlen(BRIGHTNESS_JSON)));
+    TEST_ASSERT_EQUAL_STRING("brightness", fromJson["type"].as<const char*>());
+    TEST_ASSERT_EQUAL(128, fromJson["payload"]["value"].as<int>());
+
+    JsonDocument fromMsgPack(&pool);
+    TEST_ASSERT_FALSE(deserializeMsgPack(fromMsgPack, (const char*)BRIGHTNESS_MSGPACK, sizeof(BRIGHTNESS_MSGPACK)));
+    TEST_ASSERT_EQUAL_STRING("brightness", fromMsgPack["type"].as<const char*>());
+    TEST_ASSERT_EQUAL(128, fromMsgPack["payload"]["value"].as<int>());
+
+    // The encoder produces the same bytes
+    uint8_t encoded[64];
+    size_t length = serializeMsgPack(fromJson, encoded, sizeof(encoded));
+    TEST_ASSERT_EQUAL_UINT(sizeof(BRIGHTNESS_MSGPACK), length);
+    TEST_ASSERT_EQUAL_MEMORY(BRIGHTNESS_MSGPACK, encoded, length);
+}
+
+void test_oversized_command_fails_with_no_memory() {
+    static uint8_t small[256];
+    FixedPoolAllocator pool(small, sizeof(small));
+    JsonDocument doc(&pool);
+    TEST_ASSERT_TRUE(deserializeJson(doc, DESIRED_JSON, strlen(DESIRED_JSON)) == DeserializationError::NoMemory);
+    TEST_ASSERT_TRUE(pool.getPeakUsed() <= sizeof(small));
+}
+
+void test_msgpack_sizes_and_parse_times() {
+    FixedPoolAllocator pool(poolBuffer, sizeof(poolBuffer));
+
+    // Shaped like the full status and a desired command
+    JsonDocument status;
+    status["type"] = "status";
+    status["deviceId"] = "QLCK-A1B2C3";
+    status["version"] = 17;
+    JsonObject reported = status["reported"].to<JsonObject>();
+    reported["power"] = "ON";
+    reported["brightness"] = 180;
+    reported["pattern"] = "CLOCK_DISPLAY";
+    JsonObject color = reported["color"].to<JsonObject>();
+    color["r"] = 255;
+    color["g"] = 120;
+    color["b"] = 0;
+    JsonObject telemetry = status["telemetry"].to<JsonObject>();
+    telemetry["firmware"] = "1.4.2";
+    telemetry["uptime"] = 123456;
+    telemetry["rssi"] = -67;
+    telemetry["heap"] = 143210;
+    JsonArray encodings = status["encodings"].to<JsonArray>();
+    encodings.add("json");
+    encodings.add("msgpack");
+
+    // Gone before the timing loops reset the pool under it
+    char desiredMsgPack[256];
+    size_t desiredMsgPackLength;
+    {
+        JsonDocument desired(&pool);
+        TEST_ASSERT_FALSE(deserializeJson(desired, DESIRED_JSON, strlen(DESIRED_JSON)));
+        desiredMsgPackLength = serializeMsgPack(desired, desiredMsgPack, sizeof(desiredMsgPack));
+    }
+    TEST_ASSERT_TRUE(desiredMsgPackLength > 0);
+
+    size_t statusJson = measureJson(status);
+    size_t statusMsgPack = measureMsgPack(status);
+    TEST_ASSERT_TRUE(statusMsgPack < statusJson);
+    TEST_ASSERT_TRUE(desiredMsgPackLength < strlen(DESIRED_JSON));
+
+    const int ROUNDS = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        pool.reset();
+        JsonDocument doc(&pool);
+        TEST_ASSERT_FALSE(deserializeJson(doc, DESIRED_JSON, strlen(DESIRED_JSON)));
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; i++) {
+        pool.reset();
+        JsonDocument doc(&pool);
+        TEST_ASSERT_FALSE(deserializeMsgPack(doc, desiredMsgPack, desiredMsgPackLength));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double jsonNs = std::chrono::duration<double, std::nano>(middle - start).count() / ROUNDS;
+    double msgPackNs = std::chrono::duration<double, std::nano>(end - middle).count() / ROUNDS;
+
+    char message[200];
+    snprintf(message, sizeof(message),
+             "status %u -> %u B, desired %u -> %u B; desired parse %.0f ns JSON, %.0f ns MessagePack (host)",
+             (unsigned)statusJson, (unsigned)statusMsgPack, (unsigned)strlen(DESIRED_JSON),
+             (unsigned)desiredMsgPackLength, jsonNs, msgPackNs);
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_newest_block_grows_and_shrinks_in_place);
+    RUN_TEST(test_older_block_moves_to_grow);
+    RUN_TEST(test_full_pool_fails_without_side_effects);
+    RUN_TEST(test_json_and_msgpack_commands_parse_alike);
+    RUN_TEST(test_oversized_command_fails_with_no_memory);
+    RUN_TEST(test_msgpack_sizes_and_parse_times);
+    return UNITY_END();
+}
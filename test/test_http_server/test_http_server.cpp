@@ -0,0 +1,385 @@
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include "http_server.h"
+#include <lwip/sockets.h>
+
+// The server runs on its own thread, polled like loop() does; the tests are
+// its clients over loopback.
+
+static const int PORT = 18631;
+static const int CHUNK_SIZE = 64;
+
+static HttpServer server(PORT);
+static std::atomic<bool> running(true);
+
+static std::string chunkText(int index) {
+    char text[CHUNK_SIZE + 1];
+    snprintf(text, sizeof(text), "%-63d\n", index);
+    return text;
+}
+
+static std::string bigText() {
+    std::string text;
+    for (int i = 0; text.size() < 12000; i++) {
+        text += chunkText(i);
+    }
+    return text;
+}
+
+static const size_t STACK_BODY_SIZE = 3000;
+
+static char stackBodyByte(size_t index) {
+    return 'a' + index % 26;
+}
+
+// The body lives in this frame only, like WebServerManager::sendJSON()'s buffer
+static void __attribute__((noinline)) sendFromStack(size_t length) {
+    char body[STACK_BODY_SIZE];
+    for (size_t i = 0; i < length; i++) {
+        body[i] = stackBodyByte(i);
+    }
+    server.send(200, "text/plain", body, length);
+}
+
+// Reuses the stack the body was on before the response goes out
+static void __attribute__((noinline)) overwriteStack() {
+    volatile char scratch[2 * STACK_BODY_SIZE];
+    for (size_t i = 0; i < sizeof(scratch); i++) {
+        scratch[i] = '#';
+    }
+}
+
+static void registerRoutes() {
+    server.on("/hello", HTTP_GET, []() {
+        server.send(200, "text/plain", "hello");
+    });
+    server.on("/echo", HTTP_POST, []() {
+        server.send(200, "text/plain", server.arg("a"));
+    });
+    server.on("/big", HTTP_GET, []() {
+        server.send(200, "text/plain", String(bigText()));
+    });
+    server.on("/chunked", HTTP_GET, []() {
+        int count = server.arg("n").toInt();
+        server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server.send(200, "text/plain", "");
+        for (int i = 0; i < count; i++) {
+            std::string text = chunkText(i);
+            server.sendContent(text.c_str(), text.size());
+        }
+        server.sendContent("");
+    });
+    server.on("/stack", HTTP_GET, []() {
+        size_t length = server.arg("n").toInt();
+        sendFromStack(length < STACK_BODY_SIZE ? length : STACK_BODY_SIZE);
+        overwriteStack();
+    });
+    server.on("/stream", HTTP_GET, []() {
+        server.beginEventStream();
+    });
+}
+
+static void serve() {
+    while (running) {
+        server.handleClient();
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+static int connectClient(int receiveBuffer = 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (receiveBuffer) {
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer, sizeof(receiveBuffer));
+    }
+    struct timeval timeout = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(PORT);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sendText(int fd, const std::string& text) {
+    return send(fd, text.data(), text.size(), MSG_NOSIGNAL) == (ssize_t)text.size();
+}
+
+// Buffered reader for responses on a keep-alive connection
+struct Client {
+    int fd;
+    std::string pending;
+
+    bool fill() {
+        char data[4096];
+        ssize_t received = recv(fd, data, sizeof(data), 0);
+        if (received <= 0) {
+            return false;
+        }
+        pending.append(data, received);
+        return true;
+    }
+
+    bool readLine(std::string& line) {
+        size_t end;
+        while ((end = pending.find("\r\n")) == std::string::npos) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        line = pending.substr(0, end);
+        pending.erase(0, end + 2);
+        return true;
+    }
+
+    bool readBytes(size_t length, std::string& out) {
+        while (pending.size() < length) {
+            if (!fill()) {
+                return false;
+            }
+        }
+        out.append(pending, 0, length);
+        pending.erase(0, length);
+        return true;
+    }
+
+    // Status code, or 0 when the response is malformed or cut off
+    int readResponse(std::string& body) {
+        std::string line;
+        if (!readLine(line) || line.compare(0, 9, "HTTP/1.1 ") != 0) {
+            return 0;
+        }
+        int code = atoi(line.c_str() + 9);
+        long contentLength = -1;
+        bool chunked = false;
+        while (readLine(line) && !line.empty()) {
+            if (strncasecmp(line.c_str(), "Content-Length: ", 16) == 0) {
+                contentLength = atol(line.c_str() + 16);
+            } else if (strcasecmp(line.c_str(), "Transfer-Encoding: chunked") == 0) {
+                chunked = true;
+            }
+        }
+
+        body.clear();
+        if (!chunked) {
+            return contentLength >= 0 && readBytes(contentLength, body) ? code : 0;
+        }
+        while (readLine(line)) {
+            size_t length = strtoul(line.c_str(), nullptr, 16);
+            if (!readBytes(length, body) || !readLine(line)) {
+                return 0;
+            }
+            if (length == 0) {
+                return code;
+            }
+        }
+        return 0;
+    }
+};
+
+static std::string expectedChunks(int count) {
+    std::string text;
+    for (int i = 0; i < count; i++) {
+        text += chunkText(i);
+    }
+    return text;
+}
+
+static long elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_keep_alive_and_pipelining() {
+    Client client = {connectClient(), ""};
+    TEST_ASSERT_TRUE(client.fd >= 0);
+
+    // Three requests in one write, answered in order on the same connection
+    TEST_ASSERT_TRUE(sendText(client.fd,
+                              "GET /hello HTTP/1.1\r\nHost: x\r\n\r\n"
+                              "POST /echo HTTP/1.1\r\nContent-Length: 9\r\n\r\na=b%20c&d"
+                              "GET /missing HTTP/1.1\r\n\r\n"));
+    std::string body;
+    TEST_ASSERT_EQUAL(200, client.readResponse(body));
+    TEST_ASSERT_EQUAL_STRING("hello", body.c_str());
+    TEST_ASSERT_EQUAL(200, client.readResponse(body));
+    TEST_ASSERT_EQUAL_STRING("b c", body.c_str());
+    TEST_ASSERT_EQUAL(404, client.readResponse(body));
+
+    TEST_ASSERT_TRUE(sendText(client.fd, "GET /big HTTP/1.1\r\n\r\n"));
+    TEST_ASSERT_EQUAL(200, client.readResponse(body));
+    TEST_ASSERT_TRUE(body == bigText());
+    close(client.fd);
+}
+
+void test_many_clients_under_load() {
+    const int CLIENTS = 10;
+    const int REQUESTS = 100;
+    std::atomic<int> completed(0);
+    std::atomic<int> failures(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < CLIENTS; c++) {
+        threads.emplace_back([c, &completed, &failures]() {
+            Client client = {connectClient(), ""};
+            std::string body;
+            for (int i = 0; i < REQUESTS && client.fd >= 0; i++) {
+                bool ok;
+                switch ((c + i) % 4) {
+                    case 0:
+                        ok = sendText(client.fd, "GET /hello HTTP/1.1\r\n\r\n") &&
+                             client.readResponse(body) == 200 && body == "hello";
+                        break;
+                    case 1:
+                        ok = sendText(client.fd, "POST /echo HTTP/1.1\r\nContent-Length: 5\r\n\r\na=" +
+                                                     std::to_string(100 + i)) &&
+                             client.readResponse(body) == 200 && body == std::to_string(100 + i);
+                        break;
+                    case 2:
+                        ok = sendText(client.fd, "GET /chunked?n=40 HTTP/1.1\r\n\r\n") &&
+                             client.readResponse(body) == 200 && body == expectedChunks(40);
+                        break;
+                    default:
+                        ok = sendText(client.fd, "GET /big HTTP/1.1\r\n\r\n") &&
+                             client.readResponse(body) == 200 && body == bigText();
+                        break;
+                }
+                ok ? completed++ : failures++;
+            }
+            close(client.fd);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    long ms = elapsedMs(start);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%d clients, %d requests in %ld ms (%ld requests/s)",
+             CLIENTS, completed.load(), ms, ms ? completed.load() * 1000L / ms : 0L);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(0, failures.load());
+    TEST_ASSERT_EQUAL(CLIENTS * REQUESTS, completed.load());
+}
+
+void test_slow_reader_does_not_stall_others() {
+    // Asks for more than the socket buffers hold and then does not read, so most of
+    // the response has to wait in the server
+    Client slow = {connectClient(1024), ""};
+    TEST_ASSERT_TRUE(sendText(slow.fd, "GET /chunked?n=300 HTTP/1.1\r\n\r\n"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    Client fast = {connectClient(), ""};
+    long worst = 0;
+    std::string body;
+    for (int i = 0; i < 20; i++) {
+        auto start = std::chrono::steady_clock::now();
+        TEST_ASSERT_TRUE(sendText(fast.fd, "GET /hello HTTP/1.1\r\n\r\n"));
+        TEST_ASSERT_EQUAL(200, fast.readResponse(body));
+        long ms = elapsedMs(start);
+        worst = ms > worst ? ms : worst;
+    }
+    close(fast.fd);
+    TEST_ASSERT_TRUE(worst < 250);
+
+    // The stalled response is still complete once the client reads it
+    TEST_ASSERT_EQUAL(200, slow.readResponse(body));
+    TEST_ASSERT_TRUE(body == expectedChunks(300));
+    close(slow.fd);
+}
+
+void test_body_from_a_dead_stack_frame() {
+    // A small body fits the connection buffer, a large one spills to the heap
+    Client client = {connectClient(), ""};
+    for (size_t length : {(size_t)200, STACK_BODY_SIZE}) {
+        TEST_ASSERT_TRUE(sendText(client.fd, "GET /stack?n=" + std::to_string(length) + " HTTP/1.1\r\n\r\n"));
+        std::string body;
+        TEST_ASSERT_EQUAL(200, client.readResponse(body));
+        std::string expected;
+        for (size_t i = 0; i < length; i++) {
+            expected += stackBodyByte(i);
+        }
+        TEST_ASSERT_TRUE(body == expected);
+    }
+    close(client.fd);
+}
+
+static int openStream(Client& client) {
+    client.fd = connectClient();
+    if (client.fd < 0 || !sendText(client.fd, "GET /stream HTTP/1.1\r\n\r\n")) {
+        return -1;
+    }
+    std::string line;
+    while (client.readLine(line) && !line.empty()) {
+    }
+    advanceClock(20); // Distinct start times
+    return client.pending == "retry: 3000\n\n" ? 0 : -1;
+}
+
+// 1 closed by the server, 0 still open, -1 sent something unexpected
+static int streamState(Client& client, long waitMs) {
+    struct timeval timeout = {0, waitMs * 1000};
+    setsockopt(client.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char data[64];
+    ssize_t received = recv(client.fd, data, sizeof(data), 0);
+    if (received == 0) {
+        return 1;
+    }
+    return received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+}
+
+void test_event_stream_eviction_drops_the_oldest() {
+    Client first = {}, second = {}, third = {}, fourth = {}, fifth = {};
+    TEST_ASSERT_EQUAL(0, openStream(first));
+    TEST_ASSERT_EQUAL(0, openStream(second));
+    TEST_ASSERT_EQUAL(0, openStream(third));
+
+    // The fourth stream takes the first one's slot, so the oldest is no longer in the first slot
+    close(first.fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    TEST_ASSERT_EQUAL(0, openStream(fourth));
+    TEST_ASSERT_EQUAL(0, openStream(fifth));
+
+    TEST_ASSERT_EQUAL(1, streamState(second, 900));
+    TEST_ASSERT_EQUAL(0, streamState(third, 100));
+    TEST_ASSERT_EQUAL(0, streamState(fourth, 100));
+    TEST_ASSERT_EQUAL(0, streamState(fifth, 100));
+
+    close(second.fd);
+    close(third.fd);
+    close(fourth.fd);
+    close(fifth.fd);
+}
+
+int main(int argc, char** argv) {
+    registerRoutes();
+    server.begin();
+    std::thread serverThread(serve);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_keep_alive_and_pipelining);
+    RUN_TEST(test_many_clients_under_load);
+    RUN_TEST(test_slow_reader_does_not_stall_others);
+    RUN_TEST(test_body_from_a_dead_stack_frame);
+    RUN_TEST(test_event_stream_eviction_drops_the_oldest);
+    int result = UNITY_END();
+
+    running = false;
+    serverThread.join();
+    return result;
+}
@@ -0,0 +1,201 @@
+#include <unity.h>
+#include <new>
+#include <string>
+#include "json_writer.h"
+
+// Every operator new in the program, to show the writer does not allocate
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* pointer = malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    free(pointer);
+}
+
+struct Collected {
+    char text[4096];
+    size_t length;
+    int flushes;
+};
+
+static void collect(void* context, const char* data, size_t length) {
+    Collected* out = (Collected*)context;
+    memcpy(out->text + out->length, data, length);
+    out->length += length;
+    out->text[out->length] = '\0';
+    out->flushes++;
+}
+
+// Shaped like the device status: nested objects, an array and every value type
+static void writeStatus(JsonWriter& json) {
+    json.beginObject();
+    json.add("version", "1.4.2");
+    json.add("uptime", 123456ul);
+    json.add("rssi", -67);
+    json.add("connected", true);
+    json.add("temperature", 41.256, 1);
+    json.addNull("error");
+    json.beginObject("time");
+    json.add("timezone", "Europe/Berlin");
+    json.add("epoch_us", 1700000000123456ll);
+    json.endObject();
+    json.beginArray("sources");
+    for (int i = 0; i < 12; i++) {
+        json.beginObject();
+        json.add("type", i % 2 ? "ntp" : "peer");
+        json.add("offset_ms", (long)(i * 7 - 30));
+        json.add("selected", i % 3 != 0);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_members_and_nesting() {
+    char buffer[256];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    json.add("a", 1);
+    json.beginArray("list");
+    json.add(nullptr, "x");
+    json.beginObject();
+    json.endObject();
+    json.beginArray();
+    json.endArray();
+    json.add(nullptr, false);
+    json.endArray();
+    json.beginObject("empty");
+    json.endObject();
+    json.addRaw("raw", "[1,2]");
+    json.add("big", -123456789012ll);
+    json.add("u", 4000000000ul);
+    json.endObject();
+
+    TEST_ASSERT_FALSE(json.hasOverflowed());
+    TEST_ASSERT_EQUAL_STRING("{\"a\":1,\"list\":[\"x\",{},[],false],\"empty\":{},\"raw\":[1,2],"
+                             "\"big\":-123456789012,\"u\":4000000000}", json.c_str());
+}
+
+void test_escaping() {
+    char buffer[128];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    json.add("q\"k", "say \"hi\"\\\n\r\t\x01 gr\xC3\xBC\xC3\x9F");
+    json.add("null", (const char*)nullptr);
+    json.endObject();
+    TEST_ASSERT_EQUAL_STRING("{\"q\\\"k\":\"say \\\"hi\\\"\\\\\\n\\r\\t\\u0001 gr\xC3\xBC\xC3\x9F\",\"null\":null}",
+                             json.c_str());
+}
+
+void test_numbers() {
+    char buffer[128];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginArray();
+    json.add(nullptr, 1.5);
+    json.add(nullptr, -0.125, 3);
+    json.add(nullptr, NAN);
+    json.add(nullptr, INFINITY);
+    json.add(nullptr, 0u);
+    json.endArray();
+    TEST_ASSERT_EQUAL_STRING("[1.50,-0.125,null,null,0]", json.c_str());
+}
+
+void test_chunked_output_matches_buffered() {
+    char large[4096];
+    JsonWriter whole(large, sizeof(large));
+    writeStatus(whole);
+    TEST_ASSERT_FALSE(whole.hasOverflowed());
+
+    // Every buffer size from tiny to larger than the output, each a different split
+    for (size_t size = 2; size < 80; size++) {
+        char small[80];
+        Collected out = {};
+        JsonWriter chunked(small, size, collect, &out);
+        writeStatus(chunked);
+        chunked.flush();
+        TEST_ASSERT_FALSE(chunked.hasOverflowed());
+        TEST_ASSERT_EQUAL_STRING(whole.c_str(), out.text);
+        TEST_ASSERT_GREATER_THAN(1, out.flushes);
+    }
+}
+
+void test_truncates_without_callback() {
+    char buffer[16];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeStatus(json);
+    TEST_ASSERT_TRUE(json.hasOverflowed());
+    TEST_ASSERT_EQUAL_UINT(15, json.length());
+    TEST_ASSERT_EQUAL_STRING("{\"version\":\"1.4", json.c_str());
+
+    JsonWriter none(nullptr, 0);
+    none.beginObject();
+    TEST_ASSERT_TRUE(none.hasOverflowed());
+}
+
+void test_no_heap_allocation() {
+    char buffer[768];
+    Collected out = {};
+
+    size_t before = allocations;
+    JsonWriter json(buffer, sizeof(buffer), collect, &out);
+    for (int i = 0; i < 100; i++) {
+        out.length = 0;
+        writeStatus(json);
+        json.flush();
+    }
+    size_t writerAllocations = allocations - before;
+
+    // The same text built by String concatenation, as the handlers used to
+    before = allocations;
+    for (int i = 0; i < 100; i++) {
+        String text = "{\"version\":\"1.4.2\",\"uptime\":";
+        text += String(123456ul);
+        text += ",\"rssi\":";
+        text += String(-67);
+        text += ",\"sources\":[";
+        for (int s = 0; s < 12; s++) {
+            text += s ? ",{\"type\":\"" : "{\"type\":\"";
+            text += s % 2 ? "ntp" : "peer";
+            text += "\",\"offset_ms\":";
+            text += String(s * 7 - 30);
+            text += "}";
+        }
+        text += "]}";
+    }
+    size_t concatenationAllocations = allocations - before;
+
+    char message[96];
+    snprintf(message, sizeof(message), "100 status documents: %u allocations with JsonWriter, %u with String +=",
+             (unsigned)writerAllocations, (unsigned)concatenationAllocations);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT(0, writerAllocations);
+    TEST_ASSERT_GREATER_THAN(100, concatenationAllocations);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_members_and_nesting);
+    RUN_TEST(test_escaping);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_chunked_output_matches_buffered);
+    RUN_TEST(test_truncates_without_callback);
+    RUN_TEST(test_no_heap_allocation);
+    return UNITY_END();
+}
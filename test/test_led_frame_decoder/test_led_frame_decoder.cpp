@@ -0,0 +1,179 @@
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include "led_frame_decoder.h"
+
+// A 121 LED face in runs of seven, with the colors both formats can carry
+// exactly: off, white and blue
+static const int LED_COUNT = 121;
+static const int COLOR_COUNT = 3;
+static const uint16_t RGB565_COLORS[COLOR_COUNT] = {0x0000, 0xFFFF, 0x001F};
+static const CRGB COLORS[COLOR_COUNT] = {CRGB(0, 0, 0), CRGB(255, 255, 255), CRGB(0, 0, 255)};
+
+static int colorAt(int led) {
+    return (led / 7) % COLOR_COUNT;
+}
+
+static std::vector<uint8_t> buildFrame(uint8_t format, bool rle, int pixels = LED_COUNT) {
+    std::vector<uint8_t> frame = {(uint8_t)(format | (rle ? LEDFrameDecoder::FLAG_RLE : 0)),
+                                  (uint8_t)(pixels & 0xFF), (uint8_t)(pixels >> 8)};
+    if (format == LEDFrameDecoder::PALETTE) {
+        frame.push_back(COLOR_COUNT);
+        for (const CRGB& color : COLORS) {
+            frame.insert(frame.end(), {color.r, color.g, color.b});
+        }
+    }
+
+    int led = 0;
+    while (led < pixels) {
+        int color = colorAt(led);
+        int run = 1;
+        if (rle) {
+            while (led + run < pixels && run < 255 && colorAt(led + run) == color) {
+                run++;
+            }
+            frame.push_back(run);
+        }
+        if (format == LEDFrameDecoder::RGB565) {
+            frame.push_back(RGB565_COLORS[color] & 0xFF);
+            frame.push_back(RGB565_COLORS[color] >> 8);
+        } else {
+            frame.push_back(color);
+        }
+        led += run;
+    }
+    return frame;
+}
+
+static std::vector<std::vector<uint8_t>> allFormats() {
+    return {buildFrame(LEDFrameDecoder::RGB565, false), buildFrame(LEDFrameDecoder::RGB565, true),
+            buildFrame(LEDFrameDecoder::PALETTE, false), buildFrame(LEDFrameDecoder::PALETTE, true)};
+}
+
+// Rejected, and the LEDs keep what they showed before
+static void assertRejected(const std::vector<uint8_t>& frame, size_t length) {
+    CRGB leds[LED_COUNT];
+    for (CRGB& led : leds) {
+        led = CRGB(1, 2, 3);
+    }
+    TEST_ASSERT_FALSE(LEDFrameDecoder::isValid(frame.data(), length, LED_COUNT));
+    TEST_ASSERT_FALSE(LEDFrameDecoder::decode(frame.data(), length, leds, LED_COUNT));
+    for (const CRGB& led : leds) {
+        TEST_ASSERT_TRUE(led == CRGB(1, 2, 3));
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_all_formats_decode_to_the_same_frame() {
+    for (const std::vector<uint8_t>& frame : allFormats()) {
+        CRGB leds[LED_COUNT];
+        TEST_ASSERT_TRUE(LEDFrameDecoder::decode(frame.data(), frame.size(), leds, LED_COUNT));
+        for (int i = 0; i < LED_COUNT; i++) {
+            TEST_ASSERT_TRUE(leds[i] == COLORS[colorAt(i)]);
+        }
+    }
+
+    // RGB565 white expands to full white
+    const uint8_t white[] = {LEDFrameDecoder::RGB565, 1, 0, 0xFF, 0xFF};
+    CRGB led;
+    TEST_ASSERT_TRUE(LEDFrameDecoder::decode(white, sizeof(white), &led, 1));
+    TEST_ASSERT_TRUE(led == CRGB(255, 255, 255));
+}
+
+void test_short_frame_turns_the_rest_off() {
+    std::vector<uint8_t> frame = buildFrame(LEDFrameDecoder::PALETTE, true, 20);
+    CRGB leds[LED_COUNT];
+    for (CRGB& led : leds) {
+        led = CRGB(9, 9, 9);
+    }
+    TEST_ASSERT_TRUE(LEDFrameDecoder::decode(frame.data(), frame.size(), leds, LED_COUNT));
+    for (int i = 0; i < LED_COUNT; i++) {
+        TEST_ASSERT_TRUE(leds[i] == (i < 20 ? COLORS[colorAt(i)] : CRGB(0, 0, 0)));
+    }
+}
+
+void test_truncated_frames_are_rejected() {
+    for (const std::vector<uint8_t>& frame : allFormats()) {
+        for (size_t length = 0; length < frame.size(); length++) {
+            assertRejected(frame, length);
+        }
+    }
+    assertRejected({}, 0);
+}
+
+void test_trailing_bytes_are_rejected() {
+    for (std::vector<uint8_t> frame : allFormats()) {
+        frame.push_back(0);
+        assertRejected(frame, frame.size());
+    }
+}
+
+void test_palette_index_out_of_range_is_rejected() {
+    std::vector<uint8_t> frame = buildFrame(LEDFrameDecoder::PALETTE, false);
+    frame.back() = COLOR_COUNT;
+    assertRejected(frame, frame.size());
+
+    frame = buildFrame(LEDFrameDecoder::PALETTE, true);
+    frame.back() = 255;
+    assertRejected(frame, frame.size());
+
+    // An empty palette has nothing to index
+    const uint8_t empty[] = {LEDFrameDecoder::PALETTE, 1, 0, 0, 0};
+    assertRejected(std::vector<uint8_t>(empty, empty + sizeof(empty)), sizeof(empty));
+}
+
+void test_bad_headers_and_runs_are_rejected() {
+    // More LEDs than the strip has, and an unknown format
+    std::vector<uint8_t> frame = buildFrame(LEDFrameDecoder::RGB565, false, LED_COUNT + 1);
+    assertRejected(frame, frame.size());
+
+    frame = buildFrame(LEDFrameDecoder::RGB565, false);
+    frame[0] = 2;
+    assertRejected(frame, frame.size());
+
+    // A zero length run, and a run past the LED count
+    frame = buildFrame(LEDFrameDecoder::RGB565, true);
+    frame[LEDFrameDecoder::HEADER_SIZE] = 0;
+    assertRejected(frame, frame.size());
+
+    const uint8_t overrun[] = {LEDFrameDecoder::RGB565 | LEDFrameDecoder::FLAG_RLE, 4, 0, 5, 0xFF, 0xFF};
+    assertRejected(std::vector<uint8_t>(overrun, overrun + sizeof(overrun)), sizeof(overrun));
+}
+
+void test_decode_throughput() {
+    const char* names[] = {"rgb565", "rgb565+rle", "palette", "palette+rle"};
+    const int ROUNDS = 20000;
+    std::vector<std::vector<uint8_t>> frames = allFormats();
+    CRGB leds[LED_COUNT];
+
+    for (size_t f = 0; f < frames.size(); f++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ROUNDS; i++) {
+            TEST_ASSERT_TRUE(LEDFrameDecoder::decode(frames[f].data(), frames[f].size(), leds, LED_COUNT));
+        }
+        auto end = std::chrono::steady_clock::now();
+        double frameNs = std::chrono::duration<double, std::nano>(end - start).count() / ROUNDS;
+
+        char message[120];
+        snprintf(message, sizeof(message), "%-12s %3u B, %.0f ns per frame, %.1f ns per LED (host)",
+                 names[f], (unsigned)frames[f].size(), frameNs, frameNs / LED_COUNT);
+        TEST_MESSAGE(message);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_all_formats_decode_to_the_same_frame);
+    RUN_TEST(test_short_frame_turns_the_rest_off);
+    RUN_TEST(test_truncated_frames_are_rejected);
+    RUN_TEST(test_trailing_bytes_are_rejected);
+    RUN_TEST(test_palette_index_out_of_range_is_rejected);
+    RUN_TEST(test_bad_headers_and_runs_are_rejected);
+    RUN_TEST(test_decode_throughput);
+    return UNITY_END();
+}
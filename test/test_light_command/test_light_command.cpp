@@ -0,0 +1,69 @@
+#include <unity.h>
+#include "light_command.h"
+
+static JsonDocument command;
+
+static DeserializationError translate(const char* payload, bool poweredOn) {
+    return LightCommand::translate(payload, strlen(payload), poweredOn, command);
+}
+
+void setUp() {
+    command.clear();
+}
+
+void tearDown() {
+}
+
+void test_full_command_maps_to_shadow_fields() {
+    TEST_ASSERT_FALSE(translate("{\"state\":\"ON\",\"brightness\":180,\"color\":{\"r\":255,\"g\":120,\"b\":0},"
+                                "\"effect\":\"RAINBOW\"}", false));
+    TEST_ASSERT_EQUAL_STRING("desired", command["type"].as<const char*>());
+    JsonObject desired = command["state"];
+    TEST_ASSERT_EQUAL(180, desired["brightness"].as<int>());
+    TEST_ASSERT_EQUAL(255, desired["colorR"].as<int>());
+    TEST_ASSERT_EQUAL(120, desired["colorG"].as<int>());
+    TEST_ASSERT_EQUAL(0, desired["colorB"].as<int>());
+    TEST_ASSERT_EQUAL_STRING("RAINBOW", desired["pattern"].as<const char*>());
+    TEST_ASSERT_EQUAL_STRING("ON", desired["powerState"].as<const char*>());
+}
+
+void test_repeated_on_keeps_the_pattern() {
+    // Home Assistant sends the state with a brightness change
+    TEST_ASSERT_FALSE(translate("{\"state\":\"ON\",\"brightness\":40}", true));
+    JsonObject desired = command["state"];
+    TEST_ASSERT_EQUAL(40, desired["brightness"].as<int>());
+    TEST_ASSERT_FALSE(desired["powerState"].is<const char*>());
+    TEST_ASSERT_EQUAL(1, desired.size());
+}
+
+void test_off_is_always_passed_on() {
+    TEST_ASSERT_FALSE(translate("{\"state\":\"OFF\"}", true));
+    TEST_ASSERT_EQUAL_STRING("OFF", command["state"]["powerState"].as<const char*>());
+
+    TEST_ASSERT_FALSE(translate("{\"state\":\"OFF\"}", false));
+    TEST_ASSERT_EQUAL_STRING("OFF", command["state"]["powerState"].as<const char*>());
+}
+
+void test_unknown_and_mistyped_fields_are_left_out() {
+    TEST_ASSERT_FALSE(translate("{\"brightness\":\"high\",\"color\":[1,2,3],\"effect\":7,"
+                                "\"state\":\"TOGGLE\",\"transition\":2}", false));
+    TEST_ASSERT_EQUAL_STRING("desired", command["type"].as<const char*>());
+    TEST_ASSERT_EQUAL(0, command["state"].as<JsonObject>().size());
+}
+
+void test_malformed_payload_is_an_error() {
+    command["type"] = "untouched";
+    TEST_ASSERT_TRUE(translate("{\"state\":\"ON\"", false));
+    TEST_ASSERT_TRUE(translate("", false));
+    TEST_ASSERT_EQUAL_STRING("untouched", command["type"].as<const char*>());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_full_command_maps_to_shadow_fields);
+    RUN_TEST(test_repeated_on_keeps_the_pattern);
+    RUN_TEST(test_off_is_always_passed_on);
+    RUN_TEST(test_unknown_and_mistyped_fields_are_left_out);
+    RUN_TEST(test_malformed_payload_is_an_error);
+    return UNITY_END();
+}
@@ -0,0 +1,275 @@
+#include <unity.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <thread>
+#include "time_sample_filter.h"
+
+static const int64_t SECOND_US = 1000000LL;
+static const int64_t NTP_UNIX_OFFSET_S = 2208988800LL;
+
+static TimeSample makeSample(TimeSourceType type, uint32_t sourceId, int64_t offsetUs, int64_t errorUs) {
+    TimeSample sample;
+    sample.type = type;
+    sample.sourceId = sourceId;
+    sample.offsetUs = offsetUs;
+    sample.errorUs = errorUs;
+    sample.delayUs = 2 * errorUs;
+    sample.takenAtUs = 0;
+    sample.selected = false;
+    return sample;
+}
+
+static int64_t epochNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t)tv.tv_sec * SECOND_US + tv.tv_usec;
+}
+
+// Written independently of TimeSampleFilter, the way a server encodes it
+static void writeNtpTimestamp(uint8_t* out, int64_t epochUs) {
+    uint64_t seconds = (uint64_t)(epochUs / SECOND_US + NTP_UNIX_OFFSET_S);
+    uint64_t fraction = ((uint64_t)(epochUs % SECOND_US) << 32) / SECOND_US;
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(seconds >> (24 - 8 * i));
+        out[4 + i] = (uint8_t)(fraction >> (24 - 8 * i));
+    }
+}
+
+// Reply a server would send: its clock is serverOffsetUs ahead of ours
+static void buildServerReply(const uint8_t* request, uint8_t* reply, int64_t receiveUs, int64_t transmitUs) {
+    memset(reply, 0, TimeSampleFilter::NTP_PACKET_SIZE);
+    reply[0] = 0x24;        // LI 0, version 4, mode 4 (server)
+    reply[1] = 2;           // Stratum 2
+    reply[10] = 0x10;       // Root dispersion 1/16 s
+    memcpy(reply + 24, request + 40, 8);
+    writeNtpTimestamp(reply + 32, receiveUs);
+    writeNtpTimestamp(reply + 40, transmitUs);
+}
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+void test_majority_rejects_falseticker() {
+    TimeSampleFilter filter;
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 2500000, 20000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 2, 2510000, 15000));
+    filter.addSample(makeSample(TimeSourceType::PEER, 3, 2495000, 30000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 4, 9000000, 10000));  // Falseticker
+
+    TimeEstimate estimate;
+    TEST_ASSERT_TRUE(filter.select(0, estimate));
+    TEST_ASSERT_EQUAL_INT(3, estimate.sourcesUsed);
+    TEST_ASSERT_EQUAL_INT(4, estimate.sourcesTotal);
+    // Inside [2.495 s, 2.520 s], where all three truechimers overlap
+    TEST_ASSERT_GREATER_OR_EQUAL(2495000, estimate.offsetUs);
+    TEST_ASSERT_LESS_OR_EQUAL(2520000, estimate.offsetUs);
+    TEST_ASSERT_LESS_OR_EQUAL(25000, estimate.errorUs);
+
+    for (int i = 0; i < filter.getSampleCount(); i++) {
+        const TimeSample& sample = filter.getSample(i);
+        TEST_ASSERT_EQUAL(sample.sourceId != 4, sample.selected);
+    }
+}
+
+void test_estimate_stays_inside_intersection() {
+    TimeSampleFilter filter;
+    // Intersection is [1.00 s, 1.01 s]; the precise source pulls the median
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 1005000, 5000));
+    filter.addSample(makeSample(TimeSourceType::HTTP_DATE, 0, 1400000, 600000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 2, 990000, 20000));
+
+    TimeEstimate estimate;
+    TEST_ASSERT_TRUE(filter.select(0, estimate));
+    TEST_ASSERT_EQUAL_INT(3, estimate.sourcesUsed);
+    TEST_ASSERT_GREATER_OR_EQUAL(1000000, estimate.offsetUs);
+    TEST_ASSERT_LESS_OR_EQUAL(1010000, estimate.offsetUs);
+}
+
+void test_no_majority_fails() {
+    TimeSampleFilter filter;
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 0, 10000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 2, 5000, 10000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 3, 5000000, 10000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 4, 5005000, 10000));
+
+    TimeEstimate estimate;
+    TEST_ASSERT_FALSE(filter.select(0, estimate));
+    TEST_ASSERT_EQUAL_INT(0, estimate.sourcesUsed);
+}
+
+void test_touching_intervals_agree() {
+    TimeSampleFilter filter;
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 0, 10000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 2, 20000, 10000));
+
+    TimeEstimate estimate;
+    TEST_ASSERT_TRUE(filter.select(0, estimate));
+    TEST_ASSERT_EQUAL_INT(2, estimate.sourcesUsed);
+    TEST_ASSERT_EQUAL_INT64(10000, estimate.offsetUs);
+}
+
+void test_samples_age_and_expire() {
+    TimeSampleFilter filter;
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 0, 1000));
+
+    // 50 ppm over 10 minutes widens the bound by 30 ms
+    TimeEstimate estimate;
+    TEST_ASSERT_TRUE(filter.select(600 * SECOND_US, estimate));
+    TEST_ASSERT_INT64_WITHIN(1, 31000, estimate.errorUs);
+
+    // Older than 15 minutes no longer counts
+    TEST_ASSERT_FALSE(filter.select(16 * 60 * SECOND_US, estimate));
+    TEST_ASSERT_EQUAL_INT(0, filter.getSampleCount());
+}
+
+void test_same_source_replaces_and_clock_step_shifts() {
+    TimeSampleFilter filter;
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 700000, 1000));
+    filter.addSample(makeSample(TimeSourceType::NTP, 1, 500000, 1000));
+    filter.addSample(makeSample(TimeSourceType::PEER, 1, 510000, 1000));
+    TEST_ASSERT_EQUAL_INT(2, filter.getSampleCount());
+
+    filter.applyClockStep(500000);
+    TEST_ASSERT_EQUAL_INT64(0, filter.getSample(0).offsetUs);
+    TEST_ASSERT_EQUAL_INT64(10000, filter.getSample(1).offsetUs);
+}
+
+void test_ntp_round_trip_over_udp() {
+    // Stand-in NTP server on loopback whose clock runs 2.5 s ahead
+    const int64_t serverOffsetUs = 2500000;
+    int server = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, server);
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, bind(server, (struct sockaddr*)&address, sizeof(address)));
+    socklen_t addressLength = sizeof(address);
+    getsockname(server, (struct sockaddr*)&address, &addressLength);
+
+    std::thread responder([&]() {
+        uint8_t request[TimeSampleFilter::NTP_PACKET_SIZE];
+        uint8_t reply[TimeSampleFilter::NTP_PACKET_SIZE];
+        struct sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        ssize_t length = recvfrom(server, request, sizeof(request), 0, (struct sockaddr*)&from, &fromLength);
+        if (length != (ssize_t)sizeof(request)) {
+            return;
+        }
+        int64_t receiveUs = epochNowUs() + serverOffsetUs;
+        usleep(2000); // Server processing time, not part of the path delay
+        buildServerReply(request, reply, receiveUs, epochNowUs() + serverOffsetUs);
+        sendto(server, reply, sizeof(reply), 0, (struct sockaddr*)&from, fromLength);
+    });
+
+    int client = socket(AF_INET, SOCK_DGRAM, 0);
+    struct timeval timeout = {2, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    uint8_t packet[TimeSampleFilter::NTP_PACKET_SIZE];
+    int64_t transmitUs = epochNowUs();
+    TimeSampleFilter::buildNtpRequest(packet, transmitUs);
+    TEST_ASSERT_EQUAL_HEX8(0x23, packet[0]);
+    sendto(client, packet, sizeof(packet), 0, (struct sockaddr*)&address, sizeof(address));
+    ssize_t length = recv(client, packet, sizeof(packet), 0);
+    int64_t receiveUs = epochNowUs();
+    responder.join();
+    close(client);
+    close(server);
+
+    TEST_ASSERT_EQUAL_INT((int)TimeSampleFilter::NTP_PACKET_SIZE, (int)length);
+    TimeSample sample;
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseNtpResponse(packet, length, transmitUs, receiveUs, sample));
+    TEST_ASSERT_TRUE(sample.type == TimeSourceType::NTP);
+    // Loopback is fast and symmetric: the offset is exact to well under a millisecond
+    TEST_ASSERT_INT64_WITHIN(1000, serverOffsetUs, sample.offsetUs);
+    TEST_ASSERT_LESS_THAN(2000, sample.delayUs);
+    // Half the delay plus the 62.5 ms root dispersion
+    TEST_ASSERT_GREATER_OR_EQUAL(62500, sample.errorUs);
+    TEST_ASSERT_LESS_THAN(62500 + 1000, sample.errorUs);
+}
+
+void test_ntp_rejects_bad_replies() {
+    uint8_t request[TimeSampleFilter::NTP_PACKET_SIZE];
+    uint8_t reply[TimeSampleFilter::NTP_PACKET_SIZE];
+    int64_t transmitUs = 1700000000LL * SECOND_US;
+    TimeSampleFilter::buildNtpRequest(request, transmitUs);
+    TimeSample sample;
+
+    buildServerReply(request, reply, transmitUs + 1000, transmitUs + 1100);
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseNtpResponse(reply, sizeof(reply), transmitUs, transmitUs + 2000, sample));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(reply, sizeof(reply) - 1, transmitUs, transmitUs + 2000, sample));
+
+    // Reply to a different request
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(reply, sizeof(reply), transmitUs + 1, transmitUs + 2000, sample));
+
+    uint8_t bad[TimeSampleFilter::NTP_PACKET_SIZE];
+    memcpy(bad, reply, sizeof(bad));
+    bad[0] = 0x23;          // Client mode
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(bad, sizeof(bad), transmitUs, transmitUs + 2000, sample));
+
+    memcpy(bad, reply, sizeof(bad));
+    bad[1] = 0;             // Kiss-o'-death
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(bad, sizeof(bad), transmitUs, transmitUs + 2000, sample));
+
+    memcpy(bad, reply, sizeof(bad));
+    bad[0] = 0xE4;          // Leap indicator 3: server not synchronized
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(bad, sizeof(bad), transmitUs, transmitUs + 2000, sample));
+
+    memcpy(bad, reply, sizeof(bad));
+    memset(bad + 40, 0, 8); // No transmit timestamp
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseNtpResponse(bad, sizeof(bad), transmitUs, transmitUs + 2000, sample));
+}
+
+void test_ntp_timestamps_after_2036() {
+    // NTP era 1 starts 2036-02-07; 2040-01-01 wraps the 32 bit seconds
+    uint8_t request[TimeSampleFilter::NTP_PACKET_SIZE];
+    uint8_t reply[TimeSampleFilter::NTP_PACKET_SIZE];
+    int64_t transmitUs = 2208988800LL * SECOND_US;
+    TimeSampleFilter::buildNtpRequest(request, transmitUs);
+    buildServerReply(request, reply, transmitUs - 300000 + 5000, transmitUs - 300000 + 5000);
+
+    TimeSample sample;
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseNtpResponse(reply, sizeof(reply), transmitUs, transmitUs + 10000, sample));
+    TEST_ASSERT_INT64_WITHIN(1, -300000, sample.offsetUs);
+    TEST_ASSERT_INT64_WITHIN(1, 10000, sample.delayUs);
+}
+
+void test_http_date() {
+    int64_t seconds = 0;
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", &seconds));
+    TEST_ASSERT_EQUAL_INT64(784111777, seconds);
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseHttpDate("Thu, 29 Feb 2024 23:59:60 GMT", &seconds));
+    TEST_ASSERT_EQUAL_INT64(1709251200, seconds);
+    TEST_ASSERT_TRUE(TimeSampleFilter::parseHttpDate("Sat, 01 Jan 2039 00:00:00 GMT", &seconds));
+    TEST_ASSERT_EQUAL_INT64(2177452800LL, seconds);
+
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate(nullptr, &seconds));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate("", &seconds));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", &seconds));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate("Sun, 06 Nov 1994 24:49:37 GMT", &seconds));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate("Sun, 32 Nov 1994 08:49:37 GMT", &seconds));
+    TEST_ASSERT_FALSE(TimeSampleFilter::parseHttpDate("Sunday, 06-Nov-94 08:49:37", &seconds));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_majority_rejects_falseticker);
+    RUN_TEST(test_estimate_stays_inside_intersection);
+    RUN_TEST(test_no_majority_fails);
+    RUN_TEST(test_touching_intervals_agree);
+    RUN_TEST(test_samples_age_and_expire);
+    RUN_TEST(test_same_source_replaces_and_clock_step_shifts);
+    RUN_TEST(test_ntp_round_trip_over_udp);
+    RUN_TEST(test_ntp_rejects_bad_replies);
+    RUN_TEST(test_ntp_timestamps_after_2036);
+    RUN_TEST(test_http_date);
+    return UNITY_END();
+}
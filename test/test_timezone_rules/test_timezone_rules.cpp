@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timezone_rules.h"
+
+// From 1971 on, every 1789 s (about half an hour, never aligned to a zone
+// offset), so each year is sampled at many different local times of day
+static const time_t SCAN_START = 366L * 86400;
+static const time_t SCAN_END = 51L * 365 * 86400 + SCAN_START;
+static const time_t SCAN_STEP = 1789;
+
+// Zones the rules have to agree with libc on:
+// - "M.5" means the last weekday of the month, even in a 4-week month
+// - Jn never counts February 29, n does
+// - southern zones have DST across the turn of the year
+static const char* const ZONES[] = {
+    "UTC0",
+    "CET-1CEST,M3.5.0,M10.5.0/3",
+    "EET-2EEST,M3.5.0/3,M10.5.0/4",
+    "WET0WEST,M3.5.0/1,M10.5.0",
+    "EST5EDT,M3.2.0,M11.1.0",
+    "PST8PDT,M3.2.0,M11.1.0",
+    "AEST-10AEDT,M10.1.0,M4.1.0/3",
+    "NZST-12NZDT,M9.5.0,M4.1.0/3",
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1",
+    "IST-5:30",
+    "<+0545>-5:45",
+    "XXX3YYY,J60/1,300/23:30:15",
+    "AAA-2BBB,59,J365/25",
+    "FEB5FEBD,M2.5.0,M11.5.6/2",
+};
+
+static bool sameLocal(const struct tm& a, const struct tm& b) {
+    return a.tm_year == b.tm_year && a.tm_yday == b.tm_yday && a.tm_mon == b.tm_mon &&
+           a.tm_mday == b.tm_mday && a.tm_wday == b.tm_wday && a.tm_hour == b.tm_hour &&
+           a.tm_min == b.tm_min && a.tm_sec == b.tm_sec && a.tm_isdst == b.tm_isdst;
+}
+
+static void assertMatchesLibc(TimezoneRules& rules, const char* zone, time_t utc) {
+    struct tm expected, actual;
+    localtime_r(&utc, &expected);
+    TEST_ASSERT_TRUE(rules.toLocal(utc, actual));
+    if (!sameLocal(expected, actual)) {
+        char message[256];
+        snprintf(message, sizeof(message), "%s at %lld: libc %04d-%02d-%02d %02d:%02d:%02d dst %d, rules %04d-%02d-%02d %02d:%02d:%02d dst %d",
+                 zone, (long long)utc,
+                 expected.tm_year + 1900, expected.tm_mon + 1, expected.tm_mday,
+                 expected.tm_hour, expected.tm_min, expected.tm_sec, expected.tm_isdst,
+                 actual.tm_year + 1900, actual.tm_mon + 1, actual.tm_mday,
+                 actual.tm_hour, actual.tm_min, actual.tm_sec, actual.tm_isdst);
+        TEST_FAIL_MESSAGE(message);
+    }
+}
+
+void setUp() {
+}
+
+void tearDown() {
+    unsetenv("TZ");
+    tzset();
+}
+
+void test_matches_libc_for_fifty_years() {
+    for (const char* zone : ZONES) {
+        TimezoneRules rules;
+        TEST_ASSERT_TRUE_MESSAGE(rules.parse(zone), zone);
+        setenv("TZ", zone, 1);
+        tzset();
+
+        struct tm previous;
+        time_t previousUtc = SCAN_START;
+        localtime_r(&previousUtc, &previous);
+        for (time_t utc = SCAN_START; utc < SCAN_END; utc += SCAN_STEP) {
+            assertMatchesLibc(rules, zone, utc);
+
+            // Exact second of every transition libc sees between two samples
+            struct tm current;
+            localtime_r(&utc, &current);
+            if (current.tm_isdst != previous.tm_isdst) {
+                time_t before = previousUtc;
+                time_t after = utc;
+                while (after - before > 1) {
+                    time_t middle = before + (after - before) / 2;
+                    struct tm probe;
+                    localtime_r(&middle, &probe);
+                    if (probe.tm_isdst == previous.tm_isdst) {
+                        before = middle;
+                    } else {
+                        after = middle;
+                    }
+                }
+                assertMatchesLibc(rules, zone, before);
+                assertMatchesLibc(rules, zone, after);
+            }
+            previous = current;
+            previousUtc = utc;
+        }
+    }
+}
+
+void test_last_sunday_of_march_and_october() {
+    TimezoneRules rules;
+    TEST_ASSERT_TRUE(rules.parse("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    // 2024-03-31 01:00 UTC: 02:00 CET becomes 03:00 CEST
+    time_t start = (time_t)TimezoneRules::daysFromCivil(2024, 3, 31) * 86400 + 3600;
+    bool dst = true;
+    TEST_ASSERT_EQUAL(3600, rules.getUtcOffset(start - 1, &dst));
+    TEST_ASSERT_FALSE(dst);
+    TEST_ASSERT_EQUAL(7200, rules.getUtcOffset(start, &dst));
+    TEST_ASSERT_TRUE(dst);
+
+    // 2024-10-27 01:00 UTC: 03:00 CEST becomes 02:00 CET
+    time_t end = (time_t)TimezoneRules::daysFromCivil(2024, 10, 27) * 86400 + 3600;
+    TEST_ASSERT_EQUAL(7200, rules.getUtcOffset(end - 1, &dst));
+    TEST_ASSERT_TRUE(dst);
+    TEST_ASSERT_EQUAL(3600, rules.getUtcOffset(end, &dst));
+    TEST_ASSERT_FALSE(dst);
+}
+
+void test_southern_hemisphere_dst_spans_new_year() {
+    TimezoneRules rules;
+    TEST_ASSERT_TRUE(rules.parse("AEST-10AEDT,M10.1.0,M4.1.0/3"));
+
+    bool dst = false;
+    time_t january = (time_t)TimezoneRules::daysFromCivil(2025, 1, 15) * 86400;
+    TEST_ASSERT_EQUAL(11 * 3600, rules.getUtcOffset(january, &dst));
+    TEST_ASSERT_TRUE(dst);
+
+    time_t july = (time_t)TimezoneRules::daysFromCivil(2025, 7, 15) * 86400;
+    TEST_ASSERT_EQUAL(10 * 3600, rules.getUtcOffset(july, &dst));
+    TEST_ASSERT_FALSE(dst);
+}
+
+void test_julian_rules_around_february_29() {
+    TimezoneRules rules;
+    struct tm local;
+
+    // J60 is March 1 in every year, the day the transition happens
+    TEST_ASSERT_TRUE(rules.parse("XXX3YYY,J60/1,J300/2"));
+    time_t march1 = (time_t)TimezoneRules::daysFromCivil(2024, 3, 1) * 86400 + 4 * 3600;
+    TEST_ASSERT_TRUE(rules.toLocal(march1 - 1, local));
+    TEST_ASSERT_EQUAL_INT(0, local.tm_isdst);
+    TEST_ASSERT_TRUE(rules.toLocal(march1, local));
+    TEST_ASSERT_EQUAL_INT(1, local.tm_isdst);
+
+    // Zero-based day 59 is February 29 in a leap year
+    TEST_ASSERT_TRUE(rules.parse("XXX3YYY,59/1,300/2"));
+    time_t february29 = (time_t)TimezoneRules::daysFromCivil(2024, 2, 29) * 86400 + 4 * 3600;
+    TEST_ASSERT_TRUE(rules.toLocal(february29, local));
+    TEST_ASSERT_EQUAL_INT(1, local.tm_isdst);
+    TEST_ASSERT_TRUE(rules.toLocal(february29 - 1, local));
+    TEST_ASSERT_EQUAL_INT(0, local.tm_isdst);
+}
+
+void test_rejects_malformed_strings() {
+    TimezoneRules rules;
+    TEST_ASSERT_FALSE(rules.parse(nullptr));
+    TEST_ASSERT_FALSE(rules.parse(""));
+    TEST_ASSERT_FALSE(rules.parse("CET"));
+    TEST_ASSERT_FALSE(rules.parse("CET-1CEST,M13.5.0,M10.5.0"));
+    TEST_ASSERT_FALSE(rules.parse("CET-1CEST,M3.6.0,M10.5.0"));
+    TEST_ASSERT_FALSE(rules.isValid());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_matches_libc_for_fifty_years);
+    RUN_TEST(test_last_sunday_of_march_and_october);
+    RUN_TEST(test_southern_hemisphere_dst_spans_new_year);
+    RUN_TEST(test_julian_rules_around_february_29);
+    RUN_TEST(test_rejects_malformed_strings);
+    return UNITY_END();
+}